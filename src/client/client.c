@@ -55,6 +55,7 @@ void client_destroy(Client* client) {
         renderer_destroy(client->renderer);
     }
 
+    shm_world_reader_close(client->shared_world);
     proto_world_free(&client->local_world);
     
     free(client);
@@ -72,13 +73,40 @@ bool client_connect(Client* client, const char* host, uint16_t port) {
     net_set_nonblocking(client->socket, true);
     net_set_nodelay(client->socket, true);
     
-    // Send connect message
-    if (protocol_send_message(client->socket->fd, MSG_CONNECT, NULL, 0) < 0) {
+    // Send connect message advertising what this client can decode
+    ProtoConnect connect = {
+        .capabilities = PROTO_CAP_COMPRESSION | PROTO_CAP_WIDE_IDS | PROTO_CAP_COLONY_PAGES |
+                        PROTO_CAP_LARGE_GRID | PROTO_CAP_COLONY_DELTA | PROTO_CAP_SPAN_DELTA |
+                        PROTO_CAP_VIEWPORT,
+        .version = PROTOCOL_VERSION,
+    };
+    // A viewer on the server's host reads world frames from its shm segment;
+    // the port check keeps it from mapping some other server's world. It is
+    // reopened on every connect, since a restarted server replaces the segment.
+    const char* shm_name = getenv("FEROX_SHM_NAME");
+    shm_world_reader_close(client->shared_world);
+    client->shared_world = NULL;
+    if (shm_name && *shm_name) {
+        client->shared_world = shm_world_reader_open(shm_name);
+        if (client->shared_world && shm_world_reader_port(client->shared_world) != port) {
+            shm_world_reader_close(client->shared_world);
+            client->shared_world = NULL;
+        }
+    }
+    if (client->shared_world) {
+        connect.capabilities |= PROTO_CAP_SHARED_WORLD;
+    }
+    uint8_t connect_buf[CONNECT_SERIALIZED_SIZE];
+    protocol_serialize_connect(&connect, connect_buf);
+    if (protocol_send_message(client->socket->fd, MSG_CONNECT, connect_buf, sizeof(connect_buf)) < 0) {
         net_socket_close(client->socket);
         client->socket = NULL;
         return false;
     }
     
+    // Until MSG_CONNECT_ACK arrives, assume a version 1 server
+    client->server_version = 1;
+    client->capabilities = (connect.capabilities & ~PROTO_CAP_SHARED_WORLD) | PROTO_CAP_LEGACY_DEFAULT;
     client->connected = true;
     return true;
 }
@@ -106,6 +134,26 @@ void client_send_command(Client* client, CommandType cmd, void* data) {
     protocol_send_message(client->socket->fd, MSG_COMMAND, buffer, (size_t)len);
 }
 
+void client_sync_viewport(Client* client) {
+    if (!client || !client->connected || !client->renderer) return;
+    if (!(client->capabilities & PROTO_CAP_VIEWPORT)) return;
+
+    const Renderer* renderer = client->renderer;
+    CommandSetViewport view = {
+        .x = renderer->view_x > 0 ? (uint32_t)renderer->view_x : 0,
+        .y = renderer->view_y > 0 ? (uint32_t)renderer->view_y : 0,
+        .width = renderer->view_width > 0 ? (uint32_t)renderer->view_width : 0,
+        .height = renderer->view_height > 0 ? (uint32_t)renderer->view_height : 0,
+    };
+    if (client->viewport_sent && memcmp(&view, &client->viewport, sizeof(view)) == 0) {
+        return;
+    }
+
+    client_send_command(client, CMD_SET_VIEWPORT, &view);
+    client->viewport = view;
+    client->viewport_sent = true;
+}
+
 void client_handle_message(Client* client, MessageType type, const uint8_t* payload, size_t len) {
     if (!client) return;
     
@@ -118,6 +166,34 @@ void client_handle_message(Client* client, MessageType type, const uint8_t* payl
             client_apply_world_delta(client, payload, len);
             break;
             
+        case MSG_COLONY_PAGE:
+            if (payload) {
+                ProtoColonyPage page;
+                if (protocol_deserialize_colony_page(payload, len, &page) == 0) {
+                    proto_world_apply_colony_page(&client->local_world, &page);
+                }
+                proto_colony_page_free(&page);
+            }
+            break;
+
+        case MSG_COLONY_DELTA:
+            client_apply_colony_delta(client, payload, len);
+            break;
+
+        case MSG_CONNECT_ACK:
+            if (payload) {
+                ProtoConnect agreed;
+                if (protocol_deserialize_connect(payload, len, &agreed) == 0) {
+                    client->server_version = agreed.version;
+                    client->capabilities = agreed.capabilities;
+                    if (!(agreed.capabilities & PROTO_CAP_SHARED_WORLD)) {
+                        shm_world_reader_close(client->shared_world);
+                        client->shared_world = NULL;
+                    }
+                }
+            }
+            break;
+
         case MSG_COLONY_INFO:
             if (payload && len >= COLONY_DETAIL_SERIALIZED_SIZE) {
                 ProtoColonyDetail detail;
@@ -171,10 +247,22 @@ void client_handle_message(Client* client, MessageType type, const uint8_t* payl
     }
 }
 
+void client_send_world_ack(Client* client, uint32_t tick) {
+    if (!client || !client->connected || !client->socket) return;
+    // The server builds colony deltas against acked ticks too; without a
+    // usable table, let the baseline age out until a keyframe resends it.
+    if (client->colony_table_stale) return;
+
+    ProtoWorldAck ack = { .tick = tick };
+    uint8_t buffer[WORLD_ACK_SERIALIZED_SIZE];
+    if (protocol_serialize_world_ack(&ack, buffer) < 0) return;
+
+    protocol_send_message(client->socket->fd, MSG_ACK, buffer, sizeof(buffer));
+}
+
 void client_update_world(Client* client, const uint8_t* data, size_t len) {
     if (!client || !data) return;
 
-    proto_world_free(&client->local_world);
     client->pending_grid_active = false;
     client->pending_grid_tick = 0;
     client->pending_grid_next_index = 0;
@@ -185,15 +273,132 @@ void client_update_world(Client* client, const uint8_t* data, size_t len) {
         client_clear_command_status(client);
     }
     
-    if (protocol_deserialize_world_state(data, len, &client->local_world) < 0) {
+    ProtoWorld incoming;
+    proto_world_init(&incoming);
+    if (protocol_deserialize_world_state(data, len, &incoming) < 0) {
         // Failed to deserialize
+        proto_world_free(&incoming);
+        return;
+    }
+
+    // A state without an inline grid is followed by a delta or keyframe
+    // chunks; keep the current grid as the base they apply to.
+    bool keep_grid = !incoming.has_grid &&
+                     client->local_world.has_grid && client->local_world.grid &&
+                     client->local_world.width == incoming.width &&
+                     client->local_world.height == incoming.height;
+    uint32_t* kept_grid = NULL;
+    uint32_t kept_grid_size = 0;
+    uint32_t kept_grid_level = 0;
+    if (keep_grid) {
+        kept_grid = client->local_world.grid;
+        kept_grid_size = client->local_world.grid_size;
+        kept_grid_level = client->local_world.grid_level;
+        client->local_world.grid = NULL;
+    }
+
+    // Colony delta clients already hold this tick's table; the state omits it
+    if (client->has_colony_table && client->colony_tick == incoming.tick) {
+        free(incoming.extra_colonies);
+        incoming.colony_count = client->local_world.colony_count;
+        memcpy(incoming.colonies, client->local_world.colonies,
+               (size_t)incoming.colony_count * sizeof(ProtoColony));
+        incoming.extra_colonies = client->local_world.extra_colonies;
+        incoming.extra_colony_count = client->local_world.extra_colony_count;
+        client->local_world.extra_colonies = NULL;
+        client->local_world.extra_colony_count = 0;
+    } else {
+        client->has_colony_table = false;
+    }
+    proto_world_free(&client->local_world);
+
+    client->local_world = incoming;
+    if (keep_grid) {
+        client->local_world.grid = kept_grid;
+        client->local_world.grid_size = kept_grid_size;
+        client->local_world.grid_level = kept_grid_level;
+        client->local_world.has_grid = true;
+    } else if (incoming.has_grid) {
+        client->grid_tick = incoming.tick;
+        client_send_world_ack(client, incoming.tick);
+    }
+}
+
+bool client_read_shared_world(Client* client) {
+    if (!client || !client->shared_world || !(client->capabilities & PROTO_CAP_SHARED_WORLD)) {
+        return false;
+    }
+    if (shm_world_reader_read(client->shared_world, &client->local_world) <= 0) {
+        return false;
+    }
+    // Every frame is whole; nothing on TCP builds on it
+    client->grid_tick = client->local_world.tick;
+    client->has_colony_table = false;
+    client->pending_grid_active = false;
+    return true;
+}
+
+void client_apply_colony_delta(Client* client, const uint8_t* data, size_t len) {
+    if (!client || !data) return;
+
+    // Like span deltas, a colony delta is exact for any table in [base_tick, tick]
+    ProtoColonyDelta delta;
+    bool applied = protocol_deserialize_colony_delta(data, len, &delta) == 0 &&
+                   (delta.full ||
+                    (client->has_colony_table && delta.base_tick <= client->colony_tick &&
+                     client->colony_tick <= delta.tick)) &&
+                   proto_world_apply_colony_delta(&client->local_world, &delta) == 0;
+    if (applied) {
+        client->has_colony_table = true;
+        client->colony_tick = delta.tick;
+        if (delta.full) {
+            client->colony_table_stale = false;
+        }
+    } else {
+        // Keep showing the old table until a full one arrives
+        client->colony_table_stale = true;
+    }
+    proto_colony_delta_free(&delta);
+}
+
+static void client_apply_world_delta_spans(Client* client, const uint8_t* data, size_t len) {
+    ProtoWorldDeltaSpans delta;
+    proto_world_delta_spans_init(&delta);
+    if (protocol_deserialize_world_delta_spans(data, len, &delta) < 0) {
+        proto_world_delta_spans_free(&delta);
         return;
     }
+
+    // The delta carries every cell changed after base_tick, so it is exact
+    // for any local grid in [base_tick, tick].
+    uint32_t level = client->local_world.grid_level;
+    bool applicable = client->local_world.has_grid && client->local_world.grid &&
+                      proto_grid_level_dim(client->local_world.width, level) == delta.width &&
+                      proto_grid_level_dim(client->local_world.height, level) == delta.height &&
+                      delta.base_tick <= client->grid_tick &&
+                      client->grid_tick <= delta.tick;
+    if (!applicable ||
+        proto_world_delta_spans_apply(&delta, client->local_world.grid, client->local_world.grid_size) < 0) {
+        client->deltas_rejected++;
+        proto_world_delta_spans_free(&delta);
+        return;
+    }
+
+    client->grid_tick = delta.tick;
+    client->deltas_applied++;
+    client_send_world_ack(client, delta.tick);
+    proto_world_delta_spans_free(&delta);
 }
 
 void client_apply_world_delta(Client* client, const uint8_t* data, size_t len) {
     if (!client || !data) return;
 
+    if (len > 0 && (data[0] == (uint8_t)PROTO_WORLD_DELTA_GRID_SPANS ||
+                    data[0] == (uint8_t)PROTO_WORLD_DELTA_GRID_SPANS_WIDE)) {
+        client_apply_world_delta_spans(client, data, len);
+        return;
+    }
+
     ProtoWorldDeltaGridChunk chunk;
     proto_world_delta_grid_chunk_init(&chunk);
     if (protocol_deserialize_world_delta_grid_chunk(data, len, &chunk) < 0) {
@@ -201,9 +406,10 @@ void client_apply_world_delta(Client* client, const uint8_t* data, size_t len) {
         return;
     }
 
-    if (client->local_world.tick != chunk.tick ||
-        client->local_world.width != chunk.width ||
-        client->local_world.height != chunk.height) {
+    // Chunks of a grid pyramid level carry that level's dimensions
+    int level = proto_grid_level_for_dims(client->local_world.width, client->local_world.height,
+                                          chunk.width, chunk.height);
+    if (client->local_world.tick != chunk.tick || level < 0) {
         proto_world_delta_grid_chunk_free(&chunk);
         return;
     }
@@ -211,11 +417,18 @@ void client_apply_world_delta(Client* client, const uint8_t* data, size_t len) {
     if (!client->pending_grid_active ||
         client->pending_grid_tick != chunk.tick ||
         client->local_world.grid_size != chunk.total_cells ||
+        client->local_world.grid_level != (uint32_t)level ||
         chunk.start_index == 0) {
-        proto_world_free(&client->local_world);
-        client->local_world.width = chunk.width;
-        client->local_world.height = chunk.height;
-        proto_world_alloc_grid(&client->local_world, chunk.width, chunk.height);
+        // A viewport keyframe starts at the first chunk it covers; cells
+        // outside it keep their last value when the grid can be reused.
+        bool reuse_grid = chunk.start_index != 0 && client->local_world.grid &&
+                          client->local_world.grid_size == chunk.total_cells &&
+                          client->local_world.grid_level == (uint32_t)level;
+        if (!reuse_grid) {
+            proto_world_free(&client->local_world);
+            proto_world_alloc_grid(&client->local_world, chunk.width, chunk.height);
+            client->local_world.grid_level = (uint32_t)level;
+        }
         if (!client->local_world.grid) {
             proto_world_delta_grid_chunk_free(&chunk);
             return;
@@ -223,7 +436,7 @@ void client_apply_world_delta(Client* client, const uint8_t* data, size_t len) {
         client->local_world.has_grid = false;
         client->pending_grid_active = true;
         client->pending_grid_tick = chunk.tick;
-        client->pending_grid_next_index = 0;
+        client->pending_grid_next_index = chunk.start_index;
     }
 
     if (chunk.start_index != client->pending_grid_next_index ||
@@ -234,12 +447,14 @@ void client_apply_world_delta(Client* client, const uint8_t* data, size_t len) {
     }
 
     memcpy(&client->local_world.grid[chunk.start_index], chunk.cells,
-           (size_t)chunk.cell_count * sizeof(uint16_t));
+           (size_t)chunk.cell_count * sizeof(uint32_t));
     client->pending_grid_next_index = chunk.start_index + chunk.cell_count;
 
     if (chunk.final_chunk || client->pending_grid_next_index >= client->local_world.grid_size) {
         client->local_world.has_grid = true;
         client->pending_grid_active = false;
+        client->grid_tick = chunk.tick;
+        client_send_world_ack(client, chunk.tick);
     }
 
     proto_world_delta_grid_chunk_free(&chunk);
@@ -248,7 +463,8 @@ void client_apply_world_delta(Client* client, const uint8_t* data, size_t len) {
 void client_select_next_colony(Client* client) {
     if (!client) return;
     
-    if (client->local_world.colony_count == 0) {
+    uint32_t count = proto_world_colony_total(&client->local_world);
+    if (count == 0) {
         client->selected_colony = 0;
         client->selected_index = 0;
         client->has_selected_detail = false;
@@ -258,7 +474,6 @@ void client_select_next_colony(Client* client) {
     
     // Find next alive colony starting from current index
     uint32_t start_index = client->selected_index;
-    uint32_t count = client->local_world.colony_count;
     
     for (uint32_t i = 0; i < count; i++) {
         uint32_t check_index = (start_index + i + 1) % count;
@@ -268,15 +483,15 @@ void client_select_next_colony(Client* client) {
             check_index = 0;
         }
         
-        if (client->local_world.colonies[check_index].alive) {
+        const ProtoColony* colony = proto_world_colony_at(&client->local_world, check_index);
+        if (colony->alive) {
             client->selected_index = check_index;
-            client->selected_colony = client->local_world.colonies[check_index].id;
+            client->selected_colony = colony->id;
             if (!client->has_selected_detail || client->selected_detail.base.id != client->selected_colony) {
                 client->has_selected_detail = false;
             }
             
             // Center view on selected colony
-            const ProtoColony* colony = &client->local_world.colonies[check_index];
             renderer_center_on(client->renderer, (int)colony->x, (int)colony->y);
             return;
         }
@@ -298,17 +513,9 @@ void client_deselect_colony(Client* client) {
 const ProtoColony* client_get_selected_colony(Client* client) {
     if (!client || client->selected_colony == 0) return NULL;
     
-    for (uint32_t i = 0; i < client->local_world.colony_count; i++) {
-        if (client->local_world.colonies[i].id == client->selected_colony) {
-            // Return NULL for dead colonies (hide them from info panel)
-            if (!client->local_world.colonies[i].alive) {
-                return NULL;
-            }
-            return &client->local_world.colonies[i];
-        }
-    }
-    
-    return NULL;
+    // Return NULL for dead colonies (hide them from info panel)
+    const ProtoColony* colony = proto_world_find_colony(&client->local_world, client->selected_colony);
+    return colony && colony->alive ? colony : NULL;
 }
 
 static void client_process_input(Client* client) {
@@ -427,8 +634,9 @@ static void client_render(Client* client) {
     
     // Draw status bar
     int alive_count = 0;
-    for (uint32_t i = 0; i < client->local_world.colony_count; i++) {
-        if (client->local_world.colonies[i].alive) alive_count++;
+    uint32_t colony_total = proto_world_colony_total(&client->local_world);
+    for (uint32_t i = 0; i < colony_total; i++) {
+        if (proto_world_colony_at(&client->local_world, i)->alive) alive_count++;
     }
     
     renderer_draw_status(client->renderer,
@@ -452,7 +660,9 @@ void client_run(Client* client) {
         
         // Receive network updates
         if (client->connected) {
+            client_sync_viewport(client);
             client_receive_updates(client);
+            client_read_shared_world(client);
         }
         
         // Render
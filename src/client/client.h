@@ -5,15 +5,19 @@
 #include <stdbool.h>
 #include "../shared/network.h"
 #include "../shared/protocol.h"
+#include "../shared/shm_world.h"
 #include "renderer.h"
 
 typedef struct Client {
     NetSocket* socket;
+    ShmWorldReader* shared_world; // FEROX_SHM_NAME segment; used once PROTO_CAP_SHARED_WORLD is agreed
     Renderer* renderer;
     ProtoWorld local_world;       // Local copy of world state
     ProtoColonyDetail selected_detail;
     ProtoCommandStatus last_command_status;
     bool connected;
+    uint32_t server_version;      // From MSG_CONNECT_ACK; 1 for servers that do not send it
+    uint32_t capabilities;        // PROTO_CAP_* in effect for this connection
     bool running;
     bool has_selected_detail;
     bool has_command_status;
@@ -22,6 +26,14 @@ typedef struct Client {
     bool pending_grid_active;
     uint32_t pending_grid_tick;
     uint32_t pending_grid_next_index;
+    uint32_t grid_tick;           // Tick local_world.grid reflects when has_grid
+    uint64_t deltas_applied;
+    uint64_t deltas_rejected;     // Span deltas whose base did not match the local grid
+    bool has_colony_table;        // local_world's colonies came from MSG_COLONY_DELTA
+    uint32_t colony_tick;         // Tick the colony table reflects when has_colony_table
+    bool colony_table_stale;      // A colony delta was rejected; acks wait for a full table
+    bool viewport_sent;
+    CommandSetViewport viewport;  // Last viewport subscribed with CMD_SET_VIEWPORT
 } Client;
 
 // Create and destroy
@@ -37,11 +49,15 @@ void client_run(Client* client);  // Main loop
 
 // Commands
 void client_send_command(Client* client, CommandType cmd, void* data);
+void client_sync_viewport(Client* client);  // Subscribe to the renderer's view if it moved
 
 // Message handling
 void client_handle_message(Client* client, MessageType type, const uint8_t* payload, size_t len);
 void client_update_world(Client* client, const uint8_t* data, size_t len);
 void client_apply_world_delta(Client* client, const uint8_t* data, size_t len);
+void client_apply_colony_delta(Client* client, const uint8_t* data, size_t len);
+void client_send_world_ack(Client* client, uint32_t tick);
+bool client_read_shared_world(Client* client);  // Take the newest shm frame; true if there was one
 
 // Selection
 void client_select_next_colony(Client* client);
@@ -210,8 +210,9 @@ void renderer_draw_world(Renderer* renderer, const ProtoWorld* world) {
     renderer_reset_colors(renderer);
     
     // Draw each colony
-    for (uint32_t i = 0; i < world->colony_count; i++) {
-        const ProtoColony* colony = &world->colonies[i];
+    uint32_t colony_total = proto_world_colony_total(world);
+    for (uint32_t i = 0; i < colony_total; i++) {
+        const ProtoColony* colony = proto_world_colony_at(world, i);
         if (!colony->alive) continue;
         
         // Calculate colony's visual representation based on radius
@@ -14,6 +14,7 @@
 
 #define FRAME_DELAY_US 16666  // ~60 FPS
 #define PAN_SPEED 5.0f
+#define VIEWPORT_ALIGN 16     // Viewport edges snap to this many grid cells so panning rarely resubscribes
 
 static void gui_client_clear_command_status(GuiClient* client) {
     if (!client) {
@@ -65,6 +66,7 @@ void gui_client_destroy(GuiClient* client) {
         gui_renderer_destroy(client->renderer);
     }
     
+    shm_world_reader_close(client->shared_world);
     proto_world_free(&client->local_world);
     
     free(client);
@@ -82,13 +84,39 @@ bool gui_client_connect(GuiClient* client, const char* host, uint16_t port) {
     net_set_nonblocking(client->socket, true);
     net_set_nodelay(client->socket, true);
     
-    // Send connect message
-    if (protocol_send_message(client->socket->fd, MSG_CONNECT, NULL, 0) < 0) {
+    // Send connect message advertising what this client can decode; span
+    // deltas are left out since only keyframe chunks are applied here
+    ProtoConnect connect = {
+        .capabilities = PROTO_CAP_COMPRESSION | PROTO_CAP_WIDE_IDS | PROTO_CAP_COLONY_PAGES |
+                        PROTO_CAP_LARGE_GRID | PROTO_CAP_COLONY_DELTA | PROTO_CAP_VIEWPORT,
+        .version = PROTOCOL_VERSION,
+    };
+    // Same as the terminal client: same-host viewers read frames from shm,
+    // reopened on every connect in case a restarted server replaced it
+    const char* shm_name = getenv("FEROX_SHM_NAME");
+    shm_world_reader_close(client->shared_world);
+    client->shared_world = NULL;
+    if (shm_name && *shm_name) {
+        client->shared_world = shm_world_reader_open(shm_name);
+        if (client->shared_world && shm_world_reader_port(client->shared_world) != port) {
+            shm_world_reader_close(client->shared_world);
+            client->shared_world = NULL;
+        }
+    }
+    if (client->shared_world) {
+        connect.capabilities |= PROTO_CAP_SHARED_WORLD;
+    }
+    uint8_t connect_buf[CONNECT_SERIALIZED_SIZE];
+    protocol_serialize_connect(&connect, connect_buf);
+    if (protocol_send_message(client->socket->fd, MSG_CONNECT, connect_buf, sizeof(connect_buf)) < 0) {
         net_socket_close(client->socket);
         client->socket = NULL;
         return false;
     }
     
+    // Until MSG_CONNECT_ACK arrives, assume a version 1 server
+    client->server_version = 1;
+    client->capabilities = (connect.capabilities & ~PROTO_CAP_SHARED_WORLD) | PROTO_CAP_LEGACY_DEFAULT;
     client->connected = true;
     return true;
 }
@@ -115,6 +143,40 @@ void gui_client_send_command(GuiClient* client, CommandType cmd, void* data) {
     protocol_send_message(client->socket->fd, MSG_COMMAND, buffer, (size_t)len);
 }
 
+void gui_client_sync_viewport(GuiClient* client) {
+    if (!client || !client->connected || !client->renderer) return;
+    if (!(client->capabilities & PROTO_CAP_VIEWPORT)) return;
+
+    float left, top, right, bottom;
+    gui_renderer_screen_to_world(client->renderer, 0, 0, &left, &top);
+    gui_renderer_screen_to_world(client->renderer, client->renderer->window_width,
+                                 client->renderer->window_height, &right, &bottom);
+    if (left < 0.0f) left = 0.0f;
+    if (top < 0.0f) top = 0.0f;
+    if (right < left || bottom < top) return;
+
+    // Zoomed out past one pixel per cell: ask for the pyramid level whose
+    // cells are about a pixel wide instead of every cell on screen
+    uint32_t level = 0;
+    while (level < PROTO_GRID_MAX_LEVEL && client->renderer->zoom * (float)(2u << level) <= 1.0f) {
+        level++;
+    }
+
+    uint32_t align = (uint32_t)VIEWPORT_ALIGN << level;
+    uint32_t x0 = ((uint32_t)left / align) * align;
+    uint32_t y0 = ((uint32_t)top / align) * align;
+    uint32_t x1 = ((uint32_t)right / align + 1) * align;
+    uint32_t y1 = ((uint32_t)bottom / align + 1) * align;
+    CommandSetViewport view = { .x = x0, .y = y0, .width = x1 - x0, .height = y1 - y0, .level = level };
+    if (client->viewport_sent && memcmp(&view, &client->viewport, sizeof(view)) == 0) {
+        return;
+    }
+
+    gui_client_send_command(client, CMD_SET_VIEWPORT, &view);
+    client->viewport = view;
+    client->viewport_sent = true;
+}
+
 void gui_client_handle_message(GuiClient* client, MessageType type,
                                 const uint8_t* payload, size_t len) {
     if (!client) return;
@@ -126,6 +188,31 @@ void gui_client_handle_message(GuiClient* client, MessageType type,
         case MSG_WORLD_DELTA:
             gui_client_apply_world_delta(client, payload, len);
             break;
+        case MSG_COLONY_DELTA:
+            gui_client_apply_colony_delta(client, payload, len);
+            break;
+        case MSG_CONNECT_ACK:
+            if (payload) {
+                ProtoConnect agreed;
+                if (protocol_deserialize_connect(payload, len, &agreed) == 0) {
+                    client->server_version = agreed.version;
+                    client->capabilities = agreed.capabilities;
+                    if (!(agreed.capabilities & PROTO_CAP_SHARED_WORLD)) {
+                        shm_world_reader_close(client->shared_world);
+                        client->shared_world = NULL;
+                    }
+                }
+            }
+            break;
+        case MSG_COLONY_PAGE:
+            if (payload) {
+                ProtoColonyPage page;
+                if (protocol_deserialize_colony_page(payload, len, &page) == 0) {
+                    proto_world_apply_colony_page(&client->local_world, &page);
+                }
+                proto_colony_page_free(&page);
+            }
+            break;
         case MSG_COLONY_INFO:
             if (payload && len >= COLONY_DETAIL_SERIALIZED_SIZE) {
                 ProtoColonyDetail detail;
@@ -181,11 +268,44 @@ void gui_client_handle_message(GuiClient* client, MessageType type,
     }
 }
 
+// Refresh the staleness clock and the ticks-per-second estimate
+static void gui_client_note_world_update(GuiClient* client, uint32_t now) {
+    client->last_world_update_ms = now;
+    if (client->last_tick_sample_time == 0) {
+        client->last_tick_sample = client->local_world.tick;
+        client->last_tick_sample_time = now;
+    } else if (now > client->last_tick_sample_time) {
+        uint32_t elapsed_ms = now - client->last_tick_sample_time;
+        uint32_t tick_delta = client->local_world.tick - client->last_tick_sample;
+        if (elapsed_ms >= 250) {
+            client->tps = (float)tick_delta * 1000.0f / (float)elapsed_ms;
+            client->last_tick_sample = client->local_world.tick;
+            client->last_tick_sample_time = now;
+        }
+    }
+}
+
 void gui_client_update_world(GuiClient* client, const uint8_t* data, size_t len) {
     if (!client || !data) return;
 
     uint32_t now = SDL_GetTicks();
-    
+
+    // Colony delta tables outlive the state that omits them; keep the current
+    // one aside in case the incoming state is for the same tick.
+    ProtoWorld kept_colonies;
+    memset(&kept_colonies, 0, sizeof(kept_colonies));
+    bool had_colony_table = client->has_colony_table;
+    client->has_colony_table = false;
+    if (had_colony_table) {
+        kept_colonies.colony_count = client->local_world.colony_count;
+        memcpy(kept_colonies.colonies, client->local_world.colonies,
+               (size_t)kept_colonies.colony_count * sizeof(ProtoColony));
+        kept_colonies.extra_colonies = client->local_world.extra_colonies;
+        kept_colonies.extra_colony_count = client->local_world.extra_colony_count;
+        client->local_world.extra_colonies = NULL;
+        client->local_world.extra_colony_count = 0;
+    }
+
     // Free old grid before deserializing new one
     proto_world_free(&client->local_world);
     client->pending_grid_active = false;
@@ -199,22 +319,37 @@ void gui_client_update_world(GuiClient* client, const uint8_t* data, size_t len)
     }
     
     if (protocol_deserialize_world_state(data, len, &client->local_world) < 0) {
+        proto_world_free(&kept_colonies);
         return;
     }
+    if (had_colony_table && client->colony_tick == client->local_world.tick) {
+        free(client->local_world.extra_colonies);
+        client->local_world.colony_count = kept_colonies.colony_count;
+        memcpy(client->local_world.colonies, kept_colonies.colonies,
+               (size_t)kept_colonies.colony_count * sizeof(ProtoColony));
+        client->local_world.extra_colonies = kept_colonies.extra_colonies;
+        client->local_world.extra_colony_count = kept_colonies.extra_colony_count;
+        kept_colonies.extra_colonies = NULL;
+        kept_colonies.extra_colony_count = 0;
+        client->has_colony_table = true;
+    }
+    proto_world_free(&kept_colonies);
 
-    client->last_world_update_ms = now;
-    if (client->last_tick_sample_time == 0) {
-        client->last_tick_sample = client->local_world.tick;
-        client->last_tick_sample_time = now;
-    } else if (now > client->last_tick_sample_time) {
-        uint32_t elapsed_ms = now - client->last_tick_sample_time;
-        uint32_t tick_delta = client->local_world.tick - client->last_tick_sample;
-        if (elapsed_ms >= 250) {
-            client->tps = (float)tick_delta * 1000.0f / (float)elapsed_ms;
-            client->last_tick_sample = client->local_world.tick;
-            client->last_tick_sample_time = now;
-        }
+    gui_client_note_world_update(client, now);
+}
+
+bool gui_client_read_shared_world(GuiClient* client) {
+    if (!client || !client->shared_world || !(client->capabilities & PROTO_CAP_SHARED_WORLD)) {
+        return false;
     }
+    if (shm_world_reader_read(client->shared_world, &client->local_world) <= 0) {
+        return false;
+    }
+    // Every frame is whole; nothing on TCP builds on it
+    client->has_colony_table = false;
+    client->pending_grid_active = false;
+    gui_client_note_world_update(client, SDL_GetTicks());
+    return true;
 }
 
 void gui_client_apply_world_delta(GuiClient* client, const uint8_t* data, size_t len) {
@@ -227,9 +362,10 @@ void gui_client_apply_world_delta(GuiClient* client, const uint8_t* data, size_t
         return;
     }
 
-    if (client->local_world.tick != chunk.tick ||
-        client->local_world.width != chunk.width ||
-        client->local_world.height != chunk.height) {
+    // Chunks of a grid pyramid level carry that level's dimensions
+    int level = proto_grid_level_for_dims(client->local_world.width, client->local_world.height,
+                                          chunk.width, chunk.height);
+    if (client->local_world.tick != chunk.tick || level < 0) {
         proto_world_delta_grid_chunk_free(&chunk);
         return;
     }
@@ -237,11 +373,18 @@ void gui_client_apply_world_delta(GuiClient* client, const uint8_t* data, size_t
     if (!client->pending_grid_active ||
         client->pending_grid_tick != chunk.tick ||
         client->local_world.grid_size != chunk.total_cells ||
+        client->local_world.grid_level != (uint32_t)level ||
         chunk.start_index == 0) {
-        proto_world_free(&client->local_world);
-        client->local_world.width = chunk.width;
-        client->local_world.height = chunk.height;
-        proto_world_alloc_grid(&client->local_world, chunk.width, chunk.height);
+        // A viewport keyframe starts at the first chunk it covers; cells
+        // outside it keep their last value when the grid can be reused.
+        bool reuse_grid = chunk.start_index != 0 && client->local_world.grid &&
+                          client->local_world.grid_size == chunk.total_cells &&
+                          client->local_world.grid_level == (uint32_t)level;
+        if (!reuse_grid) {
+            proto_world_free(&client->local_world);
+            proto_world_alloc_grid(&client->local_world, chunk.width, chunk.height);
+            client->local_world.grid_level = (uint32_t)level;
+        }
         if (!client->local_world.grid) {
             proto_world_delta_grid_chunk_free(&chunk);
             return;
@@ -249,7 +392,7 @@ void gui_client_apply_world_delta(GuiClient* client, const uint8_t* data, size_t
         client->local_world.has_grid = false;
         client->pending_grid_active = true;
         client->pending_grid_tick = chunk.tick;
-        client->pending_grid_next_index = 0;
+        client->pending_grid_next_index = chunk.start_index;
     }
 
     if (chunk.start_index != client->pending_grid_next_index ||
@@ -260,7 +403,7 @@ void gui_client_apply_world_delta(GuiClient* client, const uint8_t* data, size_t
     }
 
     memcpy(&client->local_world.grid[chunk.start_index], chunk.cells,
-           (size_t)chunk.cell_count * sizeof(uint16_t));
+           (size_t)chunk.cell_count * sizeof(uint32_t));
     client->pending_grid_next_index = chunk.start_index + chunk.cell_count;
 
     if (chunk.final_chunk || client->pending_grid_next_index >= client->local_world.grid_size) {
@@ -271,8 +414,24 @@ void gui_client_apply_world_delta(GuiClient* client, const uint8_t* data, size_t
     proto_world_delta_grid_chunk_free(&chunk);
 }
 
+void gui_client_apply_colony_delta(GuiClient* client, const uint8_t* data, size_t len) {
+    if (!client || !data) return;
+
+    // Exact for any table in [base_tick, tick]; otherwise wait for a full one
+    ProtoColonyDelta delta;
+    if (protocol_deserialize_colony_delta(data, len, &delta) == 0 &&
+        (delta.full ||
+         (client->has_colony_table && delta.base_tick <= client->colony_tick &&
+          client->colony_tick <= delta.tick)) &&
+        proto_world_apply_colony_delta(&client->local_world, &delta) == 0) {
+        client->has_colony_table = true;
+        client->colony_tick = delta.tick;
+    }
+    proto_colony_delta_free(&delta);
+}
+
 void gui_client_select_next_colony(GuiClient* client) {
-    if (!client || client->local_world.colony_count == 0) {
+    if (!client || proto_world_colony_total(&client->local_world) == 0) {
         client->selected_colony = 0;
         client->selected_index = 0;
         client->has_selected_detail = false;
@@ -281,7 +440,7 @@ void gui_client_select_next_colony(GuiClient* client) {
     }
     
     uint32_t start_index = client->selected_index;
-    uint32_t count = client->local_world.colony_count;
+    uint32_t count = proto_world_colony_total(&client->local_world);
     
     for (uint32_t i = 0; i < count; i++) {
         uint32_t check_index = (start_index + i + 1) % count;
@@ -290,14 +449,14 @@ void gui_client_select_next_colony(GuiClient* client) {
             check_index = 0;
         }
         
-        if (client->local_world.colonies[check_index].alive) {
+        const ProtoColony* colony = proto_world_colony_at(&client->local_world, check_index);
+        if (colony->alive) {
             client->selected_index = check_index;
-            client->selected_colony = client->local_world.colonies[check_index].id;
+            client->selected_colony = colony->id;
             if (!client->has_selected_detail || client->selected_detail.base.id != client->selected_colony) {
                 client->has_selected_detail = false;
             }
             
-            const ProtoColony* colony = &client->local_world.colonies[check_index];
             gui_renderer_center_on(client->renderer, colony->x, colony->y);
             client->renderer->selected_colony = client->selected_colony;
             return;
@@ -310,7 +469,7 @@ void gui_client_select_next_colony(GuiClient* client) {
 }
 
 void gui_client_select_prev_colony(GuiClient* client) {
-    if (!client || client->local_world.colony_count == 0) {
+    if (!client || proto_world_colony_total(&client->local_world) == 0) {
         client->selected_colony = 0;
         client->selected_index = 0;
         client->has_selected_detail = false;
@@ -319,19 +478,19 @@ void gui_client_select_prev_colony(GuiClient* client) {
     }
     
     uint32_t start_index = client->selected_index;
-    uint32_t count = client->local_world.colony_count;
+    uint32_t count = proto_world_colony_total(&client->local_world);
     
     for (uint32_t i = 0; i < count; i++) {
         uint32_t check_index = (start_index + count - i - 1) % count;
         
-        if (client->local_world.colonies[check_index].alive) {
+        const ProtoColony* colony = proto_world_colony_at(&client->local_world, check_index);
+        if (colony->alive) {
             client->selected_index = check_index;
-            client->selected_colony = client->local_world.colonies[check_index].id;
+            client->selected_colony = colony->id;
             if (!client->has_selected_detail || client->selected_detail.base.id != client->selected_colony) {
                 client->has_selected_detail = false;
             }
             
-            const ProtoColony* colony = &client->local_world.colonies[check_index];
             gui_renderer_center_on(client->renderer, colony->x, colony->y);
             client->renderer->selected_colony = client->selected_colony;
             return;
@@ -355,8 +514,9 @@ void gui_client_select_colony_at(GuiClient* client, float world_x, float world_y
     if (!client) return;
     
     // Find colony under cursor
-    for (uint32_t i = 0; i < client->local_world.colony_count; i++) {
-        const ProtoColony* colony = &client->local_world.colonies[i];
+    uint32_t colony_total = proto_world_colony_total(&client->local_world);
+    for (uint32_t i = 0; i < colony_total; i++) {
+        const ProtoColony* colony = proto_world_colony_at(&client->local_world, i);
         if (!colony->alive) continue;
         
         float dx = world_x - colony->x;
@@ -383,14 +543,8 @@ void gui_client_select_colony_at(GuiClient* client, float world_x, float world_y
 const ProtoColony* gui_client_get_selected_colony(GuiClient* client) {
     if (!client || client->selected_colony == 0) return NULL;
     
-    for (uint32_t i = 0; i < client->local_world.colony_count; i++) {
-        if (client->local_world.colonies[i].id == client->selected_colony) {
-            if (!client->local_world.colonies[i].alive) return NULL;
-            return &client->local_world.colonies[i];
-        }
-    }
-    
-    return NULL;
+    const ProtoColony* colony = proto_world_find_colony(&client->local_world, client->selected_colony);
+    return colony && colony->alive ? colony : NULL;
 }
 
 static void gui_client_process_input(GuiClient* client, GuiInputState* input) {
@@ -561,8 +715,9 @@ static void gui_client_render(GuiClient* client) {
     
     // Draw status bar
     int alive_count = 0;
-    for (uint32_t i = 0; i < client->local_world.colony_count; i++) {
-        if (client->local_world.colonies[i].alive) alive_count++;
+    uint32_t colony_total = proto_world_colony_total(&client->local_world);
+    for (uint32_t i = 0; i < colony_total; i++) {
+        if (proto_world_colony_at(&client->local_world, i)->alive) alive_count++;
     }
     
     gui_renderer_draw_status_bar(client->renderer,
@@ -649,7 +804,9 @@ void gui_client_run(GuiClient* client) {
         
         // Receive network updates
         if (client->connected) {
+            gui_client_sync_viewport(client);
             gui_client_receive_updates(client);
+            gui_client_read_shared_world(client);
         }
         
         // Render
@@ -5,15 +5,19 @@
 #include <stdbool.h>
 #include "../shared/network.h"
 #include "../shared/protocol.h"
+#include "../shared/shm_world.h"
 #include "gui_renderer.h"
 
 typedef struct GuiClient {
     NetSocket* socket;
+    ShmWorldReader* shared_world; // FEROX_SHM_NAME segment; used once PROTO_CAP_SHARED_WORLD is agreed
     GuiRenderer* renderer;
     ProtoWorld local_world;       // Local copy of world state
     ProtoColonyDetail selected_detail;
     ProtoCommandStatus last_command_status;
     bool connected;
+    uint32_t server_version;      // From MSG_CONNECT_ACK; 1 for servers that do not send it
+    uint32_t capabilities;        // PROTO_CAP_* in effect for this connection
     bool running;
     bool has_selected_detail;
     bool has_command_status;
@@ -27,6 +31,10 @@ typedef struct GuiClient {
     uint32_t last_tick_sample;
     uint32_t last_tick_sample_time;
     uint32_t last_world_update_ms;
+    bool viewport_sent;
+    CommandSetViewport viewport;  // Last viewport subscribed with CMD_SET_VIEWPORT
+    bool has_colony_table;        // local_world's colonies came from MSG_COLONY_DELTA
+    uint32_t colony_tick;         // Tick the colony table reflects when has_colony_table
 } GuiClient;
 
 // Create and destroy
@@ -42,12 +50,15 @@ void gui_client_run(GuiClient* client);
 
 // Commands
 void gui_client_send_command(GuiClient* client, CommandType cmd, void* data);
+void gui_client_sync_viewport(GuiClient* client);  // Subscribe to the visible cells if they moved
 
 // Message handling
 void gui_client_handle_message(GuiClient* client, MessageType type, 
                                  const uint8_t* payload, size_t len);
 void gui_client_update_world(GuiClient* client, const uint8_t* data, size_t len);
 void gui_client_apply_world_delta(GuiClient* client, const uint8_t* data, size_t len);
+void gui_client_apply_colony_delta(GuiClient* client, const uint8_t* data, size_t len);
+bool gui_client_read_shared_world(GuiClient* client);  // Take the newest shm frame; true if there was one
 
 // Selection
 void gui_client_select_next_colony(GuiClient* client);
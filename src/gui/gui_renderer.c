@@ -219,8 +219,8 @@ void gui_renderer_screen_to_world(GuiRenderer* renderer, int sx, int sy, float*
 void gui_renderer_set_zoom(GuiRenderer* renderer, float zoom) {
     if (!renderer) return;
     renderer->zoom = zoom;
-    if (renderer->zoom < 1.0f) renderer->zoom = 1.0f;
-    if (renderer->zoom > 50.0f) renderer->zoom = 50.0f;
+    if (renderer->zoom < GUI_MIN_ZOOM) renderer->zoom = GUI_MIN_ZOOM;
+    if (renderer->zoom > GUI_MAX_ZOOM) renderer->zoom = GUI_MAX_ZOOM;
 }
 
 void gui_renderer_pan(GuiRenderer* renderer, float dx, float dy) {
@@ -244,8 +244,8 @@ void gui_renderer_zoom_at(GuiRenderer* renderer, int screen_x, int screen_y, flo
     
     // Apply zoom
     float new_zoom = renderer->zoom * factor;
-    if (new_zoom < 1.0f) new_zoom = 1.0f;
-    if (new_zoom > 50.0f) new_zoom = 50.0f;
+    if (new_zoom < GUI_MIN_ZOOM) new_zoom = GUI_MIN_ZOOM;
+    if (new_zoom > GUI_MAX_ZOOM) new_zoom = GUI_MAX_ZOOM;
     renderer->zoom = new_zoom;
     
     // Adjust view to keep cursor position stable
@@ -323,33 +323,13 @@ static void draw_aa_line(SDL_Renderer* r, float x1, float y1, float x2, float y2
     }
 }
 
-static const ProtoColony* gui_renderer_find_colony_by_id(const ProtoWorld* world, uint16_t colony_id) {
-    if (!world || colony_id == 0 || world->colony_count == 0) {
+static const ProtoColony* gui_renderer_find_colony_by_id(const ProtoWorld* world, uint32_t colony_id) {
+    if (!world || colony_id == 0) {
         return NULL;
     }
 
-    int left = 0;
-    int right = (int)world->colony_count - 1;
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
-        uint32_t mid_id = world->colonies[mid].id;
-        if (mid_id == colony_id) {
-            return world->colonies[mid].alive ? &world->colonies[mid] : NULL;
-        }
-        if (mid_id < colony_id) {
-            left = mid + 1;
-        } else {
-            right = mid - 1;
-        }
-    }
-
-    for (uint32_t i = 0; i < world->colony_count; i++) {
-        if (world->colonies[i].id == colony_id && world->colonies[i].alive) {
-            return &world->colonies[i];
-        }
-    }
-
-    return NULL;
+    const ProtoColony* colony = proto_world_find_colony(world, colony_id);
+    return colony && colony->alive ? colony : NULL;
 }
 
 // Draw a single colony with organic shape
@@ -616,13 +596,23 @@ void gui_renderer_draw_world(GuiRenderer* renderer, const ProtoWorld* world) {
     
     // Use grid-based rendering if grid data is available
     if (world->has_grid && world->grid && world->grid_size > 0) {
+        // A pyramid level grid cell covers scale x scale world cells
+        int level = (int)world->grid_level;
+        int scale = 1 << level;
+        int grid_width = (int)proto_grid_level_dim(world->width, world->grid_level);
+        int grid_height = (int)proto_grid_level_dim(world->height, world->grid_level);
+        start_x >>= level;
+        start_y >>= level;
+        end_x = (end_x + scale - 1) >> level;
+        end_y = (end_y + scale - 1) >> level;
+
         // Direct cell rendering from grid data
         for (int wy = start_y; wy < end_y; wy++) {
             for (int wx = start_x; wx < end_x; wx++) {
-                int idx = wy * (int)world->width + wx;
+                int idx = wy * grid_width + wx;
                 if (idx < 0 || idx >= (int)world->grid_size) continue;
                 
-                uint16_t colony_id = world->grid[idx];
+                uint32_t colony_id = world->grid[idx];
                 if (colony_id == 0) continue;  // Empty cell
                 
                 // Find colony data
@@ -636,11 +626,11 @@ void gui_renderer_draw_world(GuiRenderer* renderer, const ProtoWorld* world) {
                 for (int d = 0; d < 4; d++) {
                     int nx = wx + dx[d];
                     int ny = wy + dy[d];
-                    if (nx < 0 || nx >= (int)world->width || ny < 0 || ny >= (int)world->height) {
+                    if (nx < 0 || nx >= grid_width || ny < 0 || ny >= grid_height) {
                         is_border = true;
                         break;
                     }
-                    int nidx = ny * (int)world->width + nx;
+                    int nidx = ny * grid_width + nx;
                     if (world->grid[nidx] != colony_id) {
                         is_border = true;
                         break;
@@ -649,8 +639,9 @@ void gui_renderer_draw_world(GuiRenderer* renderer, const ProtoWorld* world) {
                 
                 // Get screen position
                 int sx0, sy0, sx1, sy1;
-                gui_renderer_world_to_screen(renderer, (float)wx, (float)wy, &sx0, &sy0);
-                gui_renderer_world_to_screen(renderer, (float)(wx + 1), (float)(wy + 1), &sx1, &sy1);
+                gui_renderer_world_to_screen(renderer, (float)(wx * scale), (float)(wy * scale), &sx0, &sy0);
+                gui_renderer_world_to_screen(renderer, (float)((wx + 1) * scale), (float)((wy + 1) * scale),
+                                             &sx1, &sy1);
 
                 int cell_w = sx1 - sx0;
                 int cell_h = sy1 - sy0;
@@ -684,8 +675,9 @@ void gui_renderer_draw_world(GuiRenderer* renderer, const ProtoWorld* world) {
         }
     } else {
         // Fallback: simple colony center rendering (no grid data)
-        for (uint32_t i = 0; i < world->colony_count; i++) {
-            const ProtoColony* colony = &world->colonies[i];
+        uint32_t colony_total = proto_world_colony_total(world);
+        for (uint32_t i = 0; i < colony_total; i++) {
+            const ProtoColony* colony = proto_world_colony_at(world, i);
             if (!colony->alive) continue;
             
             int cx, cy;
@@ -13,6 +13,8 @@
 // Rendering settings
 #define COLONY_SEGMENTS 64      // Number of segments for colony border
 #define GRID_CELL_SIZE 20       // Size of grid cells in pixels
+#define GUI_MIN_ZOOM 0.0625f    // Below 1 pixel per cell the client streams a pyramid level
+#define GUI_MAX_ZOOM 50.0f
 
 // Colony info panel dimensions
 #define INFO_PANEL_WIDTH 250
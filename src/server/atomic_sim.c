@@ -6,7 +6,9 @@
  */
 
 #include "atomic_sim.h"
+#include "cpu_topology.h"
 #include "genetics.h"
+#include "grid_alloc.h"
 #include "simulation.h"
 #include "../shared/utils.h"
 #include <stdlib.h>
@@ -23,9 +25,13 @@ enum {
     ATOMIC_PHASE_IDLE = 0,
     ATOMIC_PHASE_AGE = 1,
     ATOMIC_PHASE_SPREAD = 2,
-    ATOMIC_PHASE_SPREAD_FRONTIER = 3
+    ATOMIC_PHASE_SPREAD_FRONTIER = 3,
+    ATOMIC_PHASE_FIRST_TOUCH = 4
 };
 
+// Frontier tile edge (cells) used to order spread_frontier_indices.
+#define ATOMIC_FRONTIER_TILE 32
+
 // ============================================================================
 // Thread-local RNG for deterministic parallel processing
 // ============================================================================
@@ -380,6 +386,20 @@ static float atomic_calculate_behavioral_spread_modifier(
     return utils_clamp_f(modifier, 0.15f, 2.5f);
 }
 
+static inline void atomic_frontier_consider(AtomicWorld* aworld, const AtomicCell* current,
+                                            int width, int height, int idx, int* frontier_count) {
+    uint32_t colony_id = atomic_load_explicit(&current[idx].colony_id, memory_order_relaxed);
+    if (colony_id == 0) {
+        return;
+    }
+
+    if (!atomic_cell_has_empty_neighbor(current, width, height, idx)) {
+        return;
+    }
+
+    aworld->spread_frontier_indices[(*frontier_count)++] = idx;
+}
+
 static void atomic_rebuild_spread_frontier(AtomicWorld* aworld) {
     if (!aworld || !aworld->spread_frontier_indices) {
         return;
@@ -399,39 +419,40 @@ static void atomic_rebuild_spread_frontier(AtomicWorld* aworld) {
     bool reverse_y = (tick & 1u) != 0u;
     bool reverse_x_base = ((tick >> 1) & 1u) != 0u;
 
-    int frontier_count = 0;
-    for (int row = 0; row < height; row++) {
-        int y = reverse_y ? (height - 1 - row) : row;
-        int row_base = y * width;
-        bool reverse_x = reverse_x_base ^ ((row & 1) != 0);
-
-        if (reverse_x) {
-            for (int x = width - 1; x >= 0; x--) {
-                int idx = row_base + x;
-                uint32_t colony_id = atomic_load_explicit(&current[idx].colony_id, memory_order_relaxed);
-                if (colony_id == 0) {
-                    continue;
-                }
-
-                if (!atomic_cell_has_empty_neighbor(current, width, height, idx)) {
-                    continue;
-                }
+    // Emit tile-major so a claimed chunk covers a compact patch of the grid
+    // rather than a thin strip across it. The serpentine, tick-alternating
+    // order is kept at both the tile and the cell level to avoid a fixed
+    // directional bias in who claims contested cells first.
+    int tiles_x = (width + ATOMIC_FRONTIER_TILE - 1) / ATOMIC_FRONTIER_TILE;
+    int tiles_y = (height + ATOMIC_FRONTIER_TILE - 1) / ATOMIC_FRONTIER_TILE;
 
-                aworld->spread_frontier_indices[frontier_count++] = idx;
-            }
-        } else {
-            for (int x = 0; x < width; x++) {
-                int idx = row_base + x;
-                uint32_t colony_id = atomic_load_explicit(&current[idx].colony_id, memory_order_relaxed);
-                if (colony_id == 0) {
-                    continue;
-                }
-
-                if (!atomic_cell_has_empty_neighbor(current, width, height, idx)) {
-                    continue;
+    int frontier_count = 0;
+    for (int tile_row = 0; tile_row < tiles_y; tile_row++) {
+        int ty = reverse_y ? (tiles_y - 1 - tile_row) : tile_row;
+        bool reverse_tx = reverse_x_base ^ ((tile_row & 1) != 0);
+
+        for (int tile_col = 0; tile_col < tiles_x; tile_col++) {
+            int tx = reverse_tx ? (tiles_x - 1 - tile_col) : tile_col;
+            int x0 = tx * ATOMIC_FRONTIER_TILE;
+            int y0 = ty * ATOMIC_FRONTIER_TILE;
+            int x1 = x0 + ATOMIC_FRONTIER_TILE < width ? x0 + ATOMIC_FRONTIER_TILE : width;
+            int y1 = y0 + ATOMIC_FRONTIER_TILE < height ? y0 + ATOMIC_FRONTIER_TILE : height;
+            int tile_h = y1 - y0;
+
+            for (int row = 0; row < tile_h; row++) {
+                int y = reverse_y ? (y1 - 1 - row) : (y0 + row);
+                int row_base = y * width;
+                bool reverse_x = reverse_x_base ^ ((row & 1) != 0);
+
+                if (reverse_x) {
+                    for (int x = x1 - 1; x >= x0; x--) {
+                        atomic_frontier_consider(aworld, current, width, height, row_base + x, &frontier_count);
+                    }
+                } else {
+                    for (int x = x0; x < x1; x++) {
+                        atomic_frontier_consider(aworld, current, width, height, row_base + x, &frontier_count);
+                    }
                 }
-
-                aworld->spread_frontier_indices[frontier_count++] = idx;
             }
         }
     }
@@ -591,109 +612,176 @@ static void atomic_spread_from_cell(
     }
 }
 
-static void* atomic_phase_worker(void* arg) {
-    AtomicRegionWork* worker = (AtomicRegionWork*)arg;
-    AtomicWorld* aworld = worker->aworld;
-    int worker_id = worker->thread_id;
-    if (!aworld || worker_id < 0 || worker_id >= aworld->phase_worker_count) {
-        return NULL;
-    }
-    uint32_t seen_generation = 0;
+// Region holding a grid cell, using the same split as atomic_world_create().
+static int atomic_region_of_cell(const AtomicWorld* aworld, size_t cell) {
+    int x = (int)(cell % (size_t)aworld->grid.width);
+    int y = (int)(cell / (size_t)aworld->grid.width);
+    int region_width = aworld->grid.width / aworld->regions_x;
+    int region_height = aworld->grid.height / aworld->regions_y;
+    int rx = region_width > 0 ? x / region_width : 0;
+    int ry = region_height > 0 ? y / region_height : 0;
+    if (rx >= aworld->regions_x) {
+        rx = aworld->regions_x - 1;
+    }
+    if (ry >= aworld->regions_y) {
+        ry = aworld->regions_y - 1;
+    }
+    return ry * aworld->regions_x + rx;
+}
 
-    while (1) {
-        pthread_mutex_lock(&aworld->phase_mutex);
-        while (!aworld->phase_state.phase_shutdown && seen_generation == aworld->phase_state.phase_generation) {
-            pthread_cond_wait(&aworld->phase_cond, &aworld->phase_mutex);
+// Zero, in both grid buffers, every page whose first cell falls in regions
+// [start, end). A page is placed whole on the node of the thread that faults
+// it in, and under THP one 2 MB page spans many regions, so ownership is
+// decided per page of the actual backing rather than per region row.
+static void atomic_first_touch_pages(AtomicWorld* aworld, int start, int end) {
+    size_t bytes = (size_t)aworld->grid.width * (size_t)aworld->grid.height * sizeof(AtomicCell);
+    for (int b = 0; b < 2; b++) {
+        uint8_t* base = (uint8_t*)aworld->grid.buffers[b];
+        size_t page = ferox_grid_page_size(base);
+        size_t offset = 0;
+        while (offset < bytes) {
+            uintptr_t addr = (uintptr_t)(base + offset);
+            size_t next = offset + (size_t)(page - addr % page);
+            if (next > bytes) {
+                next = bytes;
+            }
+            int region = atomic_region_of_cell(aworld, offset / sizeof(AtomicCell));
+            if (region >= start && region < end) {
+                memset(base + offset, 0, next - offset);
+            }
+            offset = next;
         }
+    }
+}
 
-        if (aworld->phase_state.phase_shutdown) {
-            pthread_mutex_unlock(&aworld->phase_mutex);
-            break;
+// Guided self-scheduling: each claim takes a share of what is left, so early
+// chunks are large (few cursor hits) and the tail is split finely enough that
+// no worker is left holding a long chunk while the others wait. The size is
+// computed from the claimed start inside the CAS, so chunk boundaries come
+// out the same whichever worker wins each claim.
+static bool atomic_frontier_claim_chunk(AtomicWorld* aworld, int* chunk_start, int* chunk_end) {
+    int total = aworld->spread_state.spread_frontier_count;
+    int start = atomic_load_explicit(&aworld->spread_frontier_cursor, memory_order_relaxed);
+    int chunk = 0;
+    do {
+        if (start >= total) {
+            return false;
         }
-
-        seen_generation = aworld->phase_state.phase_generation;
-        int phase = aworld->phase_state.active_phase;
-        int start = aworld->worker_region_start[worker_id];
-        int end = aworld->worker_region_end[worker_id];
-        int stride = aworld->phase_state.phase_region_stride;
-        if (stride < 1) {
-            stride = 1;
+        chunk = (total - start) / (2 * aworld->phase_worker_count);
+        if (chunk < aworld->frontier_min_chunk) {
+            chunk = aworld->frontier_min_chunk;
         }
-        pthread_mutex_unlock(&aworld->phase_mutex);
+    } while (!atomic_compare_exchange_weak_explicit(&aworld->spread_frontier_cursor, &start, start + chunk,
+                                                    memory_order_relaxed, memory_order_relaxed));
 
-        if (phase == ATOMIC_PHASE_AGE) {
-            for (int i = start; i < end; i += stride) {
-                atomic_age_region(&aworld->region_work[i]);
-            }
-        } else if (phase == ATOMIC_PHASE_SPREAD) {
-            for (int i = start; i < end; i += stride) {
-                atomic_spread_region(&aworld->region_work[i]);
-            }
-        } else if (phase == ATOMIC_PHASE_SPREAD_FRONTIER) {
-            size_t slot_base = (size_t)worker_id * aworld->max_colonies;
-            int32_t* slot_deltas = &aworld->spread_deltas[slot_base];
-            uint32_t* slot_touched = &aworld->spread_touched_ids[slot_base];
-            uint32_t touched_count = 0;
-            uint32_t rng_state = aworld->thread_seeds[worker_id];
-            bool reverse_frontier = (((aworld->world ? (uint32_t)aworld->world->tick : 0u) + (uint32_t)worker_id) & 1u) != 0u;
-
-            if (reverse_frontier) {
-                int last = end - 1;
-                if (stride > 1 && last >= start) {
-                    last -= (last - start) % stride;
-                }
-                for (int i = last; i >= start; i -= stride) {
-                    int idx = aworld->spread_frontier_indices[i];
-                    int x = idx % aworld->grid.width;
-                    int y = idx / aworld->grid.width;
-                    atomic_spread_from_cell(
-                        aworld,
-                        x,
-                        y,
-                        slot_deltas,
-                        slot_touched,
-                        &touched_count,
-                        &rng_state
-                    );
-                }
-            } else {
-                for (int i = start; i < end; i += stride) {
-                    int idx = aworld->spread_frontier_indices[i];
-                    int x = idx % aworld->grid.width;
-                    int y = idx / aworld->grid.width;
-                    atomic_spread_from_cell(
-                        aworld,
-                        x,
-                        y,
-                        slot_deltas,
-                        slot_touched,
-                        &touched_count,
-                        &rng_state
-                    );
-                }
-            }
+    *chunk_start = start;
+    *chunk_end = start + chunk < total ? start + chunk : total;
+    return true;
+}
 
-            aworld->spread_touched_counts[worker_id] = touched_count;
-            aworld->thread_seeds[worker_id] = rng_state;
-        }
+// RNG state for one frontier chunk: a hash of the tick and the chunk's start,
+// so each cell's draws do not depend on which worker claimed the chunk.
+static uint32_t atomic_frontier_chunk_seed(uint32_t tick, int chunk_start) {
+    uint32_t h = tick * 0x9E3779B1u ^ (uint32_t)chunk_start * 0x85EBCA77u;
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h != 0u ? h : 0x6D2B79F5u;  // xorshift32 never leaves 0
+}
 
-        pthread_mutex_lock(&aworld->phase_mutex);
-        aworld->phase_state.phase_done_count++;
-        if (aworld->phase_state.phase_done_count >= aworld->phase_worker_count) {
-            pthread_cond_signal(&aworld->phase_done_cond);
+static void atomic_phase_run_worker_slice(AtomicWorld* aworld, int worker_id, int phase, int start, int end, int stride) {
+    if (phase == ATOMIC_PHASE_FIRST_TOUCH) {
+        // Always assigned as contiguous ranges (stride 1).
+        atomic_first_touch_pages(aworld, start, end);
+    } else if (phase == ATOMIC_PHASE_AGE) {
+        for (int i = start; i < end; i += stride) {
+            atomic_age_region(&aworld->region_work[i]);
+        }
+    } else if (phase == ATOMIC_PHASE_SPREAD) {
+        for (int i = start; i < end; i += stride) {
+            atomic_spread_region(&aworld->region_work[i]);
         }
-        pthread_mutex_unlock(&aworld->phase_mutex);
+    } else if (phase == ATOMIC_PHASE_SPREAD_FRONTIER) {
+        (void)start;
+        (void)end;
+        (void)stride;
+        size_t slot_base = (size_t)worker_id * aworld->max_colonies;
+        int32_t* slot_deltas = &aworld->spread_deltas[slot_base];
+        uint32_t* slot_touched = &aworld->spread_touched_ids[slot_base];
+        uint32_t touched_count = 0;
+        uint32_t tick = aworld->world ? (uint32_t)aworld->world->tick : 0u;
+
+        int chunk_start = 0;
+        int chunk_end = 0;
+        while (atomic_frontier_claim_chunk(aworld, &chunk_start, &chunk_end)) {
+            uint32_t rng_state = atomic_frontier_chunk_seed(tick, chunk_start);
+            bool reverse_frontier = (rng_state >> 31) != 0u;
+            for (int n = 0; n < chunk_end - chunk_start; n++) {
+                int i = reverse_frontier ? (chunk_end - 1 - n) : (chunk_start + n);
+                int idx = aworld->spread_frontier_indices[i];
+                int x = idx % aworld->grid.width;
+                int y = idx / aworld->grid.width;
+                atomic_spread_from_cell(
+                    aworld,
+                    x,
+                    y,
+                    slot_deltas,
+                    slot_touched,
+                    &touched_count,
+                    &rng_state
+                );
+            }
+        }
+
+        aworld->spread_touched_counts[worker_id] = touched_count;
     }
+}
 
-    return NULL;
+static void atomic_phase_gang_worker(void* arg, int worker_id, int worker_count) {
+    AtomicWorld* aworld = (AtomicWorld*)arg;
+    (void)worker_count;
+    if (!aworld || worker_id < 0 || worker_id >= aworld->phase_worker_count) {
+        return;
+    }
+
+    // Phase id, ranges and stride were written before the gang was published
+    // under the pool's queue mutex.
+    int phase = aworld->phase_state.active_phase;
+    int start = aworld->worker_region_start[worker_id];
+    int end = aworld->worker_region_end[worker_id];
+    int stride = aworld->phase_state.phase_region_stride;
+    if (stride < 1) {
+        stride = 1;
+    }
+
+    double busy_start = atomic_now_ms();
+    atomic_phase_run_worker_slice(aworld, worker_id, phase, start, end, stride);
+    aworld->worker_busy_ms[worker_id] += atomic_now_ms() - busy_start;
+}
+
+static void atomic_phase_system_free(AtomicWorld* aworld) {
+    free(aworld->worker_region_start);
+    free(aworld->worker_region_end);
+    free(aworld->worker_busy_ms);
+    aworld->worker_region_start = NULL;
+    aworld->worker_region_end = NULL;
+    aworld->worker_busy_ms = NULL;
 }
 
 static int atomic_phase_system_create(AtomicWorld* aworld) {
-    if (!aworld || aworld->thread_count <= 0 || aworld->region_count <= 0) {
+    if (!aworld || !aworld->pool || aworld->thread_count <= 0 || aworld->region_count <= 0) {
         return -1;
     }
 
+    // Phases run as gangs of the pool's workers plus the ticking thread, so
+    // never plan more slices than that: no extra runnable threads beyond the
+    // core budget.
     aworld->phase_worker_count = aworld->thread_count;
+    if (aworld->phase_worker_count > threadpool_gang_width(aworld->pool)) {
+        aworld->phase_worker_count = threadpool_gang_width(aworld->pool);
+    }
     if (aworld->phase_worker_count > aworld->region_count) {
         aworld->phase_worker_count = aworld->region_count;
     }
@@ -701,56 +789,17 @@ static int atomic_phase_system_create(AtomicWorld* aworld) {
         return -1;
     }
 
-    aworld->phase_threads = (pthread_t*)calloc((size_t)aworld->phase_worker_count, sizeof(pthread_t));
-    aworld->phase_worker_args = (AtomicRegionWork*)calloc((size_t)aworld->phase_worker_count, sizeof(AtomicRegionWork));
     aworld->worker_region_start = (int*)calloc((size_t)aworld->phase_worker_count, sizeof(int));
     aworld->worker_region_end = (int*)calloc((size_t)aworld->phase_worker_count, sizeof(int));
-    if (!aworld->phase_threads || !aworld->phase_worker_args || !aworld->worker_region_start || !aworld->worker_region_end) {
-        free(aworld->phase_threads);
-        free(aworld->phase_worker_args);
-        free(aworld->worker_region_start);
-        free(aworld->worker_region_end);
-        aworld->phase_threads = NULL;
-        aworld->phase_worker_args = NULL;
-        aworld->worker_region_start = NULL;
-        aworld->worker_region_end = NULL;
+    aworld->worker_busy_ms = (double*)calloc((size_t)aworld->phase_worker_count, sizeof(double));
+    if (!aworld->worker_region_start || !aworld->worker_region_end || !aworld->worker_busy_ms) {
+        atomic_phase_system_free(aworld);
         return -1;
     }
 
-    if (pthread_mutex_init(&aworld->phase_mutex, NULL) != 0) {
-        free(aworld->phase_threads);
-        free(aworld->worker_region_start);
-        free(aworld->worker_region_end);
-        aworld->phase_threads = NULL;
-        aworld->worker_region_start = NULL;
-        aworld->worker_region_end = NULL;
-        return -1;
-    }
-    if (pthread_cond_init(&aworld->phase_cond, NULL) != 0) {
-        pthread_mutex_destroy(&aworld->phase_mutex);
-        free(aworld->phase_threads);
-        free(aworld->phase_worker_args);
-        free(aworld->worker_region_start);
-        free(aworld->worker_region_end);
-        aworld->phase_threads = NULL;
-        aworld->phase_worker_args = NULL;
-        aworld->worker_region_start = NULL;
-        aworld->worker_region_end = NULL;
-        return -1;
-    }
-    if (pthread_cond_init(&aworld->phase_done_cond, NULL) != 0) {
-        pthread_cond_destroy(&aworld->phase_cond);
-        pthread_mutex_destroy(&aworld->phase_mutex);
-        free(aworld->phase_threads);
-        free(aworld->phase_worker_args);
-        free(aworld->worker_region_start);
-        free(aworld->worker_region_end);
-        aworld->phase_threads = NULL;
-        aworld->phase_worker_args = NULL;
-        aworld->worker_region_start = NULL;
-        aworld->worker_region_end = NULL;
-        return -1;
-    }
+    int spins = atomic_parse_env_int("FEROX_ATOMIC_BARRIER_SPINS",
+                                     aworld->pool->gang_barrier.spin_limit, 0, 1 << 20);
+    threadpool_set_gang_spin_limit(aworld->pool, spins);
 
     for (int w = 0; w < aworld->phase_worker_count; w++) {
         int start = (w * aworld->region_count) / aworld->phase_worker_count;
@@ -759,36 +808,8 @@ static int atomic_phase_system_create(AtomicWorld* aworld) {
         aworld->worker_region_end[w] = end;
     }
 
-    aworld->phase_state.phase_generation = 0;
-    aworld->phase_state.phase_done_count = 0;
     aworld->phase_state.active_phase = ATOMIC_PHASE_IDLE;
     aworld->phase_state.phase_region_stride = 1;
-    aworld->phase_state.phase_shutdown = false;
-
-    for (int w = 0; w < aworld->phase_worker_count; w++) {
-        aworld->phase_worker_args[w].aworld = aworld;
-        aworld->phase_worker_args[w].thread_id = w;
-        if (pthread_create(&aworld->phase_threads[w], NULL, atomic_phase_worker, &aworld->phase_worker_args[w]) != 0) {
-            aworld->phase_state.phase_shutdown = true;
-            pthread_cond_broadcast(&aworld->phase_cond);
-            for (int j = 0; j < w; j++) {
-                pthread_join(aworld->phase_threads[j], NULL);
-            }
-            pthread_cond_destroy(&aworld->phase_done_cond);
-            pthread_cond_destroy(&aworld->phase_cond);
-            pthread_mutex_destroy(&aworld->phase_mutex);
-            free(aworld->phase_threads);
-            free(aworld->phase_worker_args);
-            free(aworld->worker_region_start);
-            free(aworld->worker_region_end);
-            aworld->phase_threads = NULL;
-            aworld->phase_worker_args = NULL;
-            aworld->worker_region_start = NULL;
-            aworld->worker_region_end = NULL;
-            return -1;
-        }
-    }
-
     aworld->phase_state.phase_system_ready = true;
     return 0;
 }
@@ -798,18 +819,6 @@ static void atomic_phase_system_destroy(AtomicWorld* aworld) {
         return;
     }
 
-    pthread_mutex_lock(&aworld->phase_mutex);
-    aworld->phase_state.phase_shutdown = true;
-    pthread_cond_broadcast(&aworld->phase_cond);
-    pthread_mutex_unlock(&aworld->phase_mutex);
-
-    for (int w = 0; w < aworld->phase_worker_count; w++) {
-        pthread_join(aworld->phase_threads[w], NULL);
-    }
-
-    pthread_cond_destroy(&aworld->phase_done_cond);
-    pthread_cond_destroy(&aworld->phase_cond);
-    pthread_mutex_destroy(&aworld->phase_mutex);
     aworld->phase_state.phase_system_ready = false;
 }
 
@@ -818,18 +827,11 @@ static void atomic_run_phase(AtomicWorld* aworld, int phase) {
         return;
     }
 
-    pthread_mutex_lock(&aworld->phase_mutex);
     aworld->phase_state.active_phase = phase;
-    aworld->phase_state.phase_done_count = 0;
-    aworld->phase_state.phase_generation++;
-    pthread_cond_broadcast(&aworld->phase_cond);
-
-    while (aworld->phase_state.phase_done_count < aworld->phase_worker_count) {
-        pthread_cond_wait(&aworld->phase_done_cond, &aworld->phase_mutex);
-    }
-
+    double wall_start = atomic_now_ms();
+    threadpool_run_gang(aworld->pool, atomic_phase_gang_worker, aworld);
+    aworld->phase_wall_ms += atomic_now_ms() - wall_start;
     aworld->phase_state.active_phase = ATOMIC_PHASE_IDLE;
-    pthread_mutex_unlock(&aworld->phase_mutex);
 }
 
 static void atomic_phase_assign_ranges(AtomicWorld* aworld, int total_units) {
@@ -837,7 +839,6 @@ static void atomic_phase_assign_ranges(AtomicWorld* aworld, int total_units) {
         return;
     }
 
-    pthread_mutex_lock(&aworld->phase_mutex);
     aworld->phase_state.phase_region_stride = 1;
     for (int w = 0; w < aworld->phase_worker_count; w++) {
         int start = (w * total_units) / aworld->phase_worker_count;
@@ -845,7 +846,6 @@ static void atomic_phase_assign_ranges(AtomicWorld* aworld, int total_units) {
         aworld->worker_region_start[w] = start;
         aworld->worker_region_end[w] = end;
     }
-    pthread_mutex_unlock(&aworld->phase_mutex);
 }
 
 static void atomic_phase_assign_interleaved(AtomicWorld* aworld, int total_units) {
@@ -853,7 +853,13 @@ static void atomic_phase_assign_interleaved(AtomicWorld* aworld, int total_units
         return;
     }
 
-    pthread_mutex_lock(&aworld->phase_mutex);
+    // With node-major pinning, contiguous ranges keep each worker on the
+    // regions it first-touched; interleaving would send half of them remote.
+    if (aworld->numa_local) {
+        atomic_phase_assign_ranges(aworld, total_units);
+        return;
+    }
+
     aworld->phase_state.phase_region_stride = aworld->phase_worker_count;
     if (aworld->phase_state.phase_region_stride < 1) {
         aworld->phase_state.phase_region_stride = 1;
@@ -863,7 +869,33 @@ static void atomic_phase_assign_interleaved(AtomicWorld* aworld, int total_units
         aworld->worker_region_start[w] = w;
         aworld->worker_region_end[w] = total_units;
     }
-    pthread_mutex_unlock(&aworld->phase_mutex);
+}
+
+static void atomic_place_workers(AtomicWorld* aworld) {
+    aworld->numa_local = false;
+    if (!aworld->phase_state.phase_system_ready || !atomic_parse_env_bool("FEROX_PIN_THREADS", false)) {
+        return;
+    }
+
+    FeroxCpuTopology topology;
+    if (ferox_cpu_topology_detect(&topology) != 0) {
+        return;
+    }
+
+    int pinned = ferox_cpu_topology_pin_pool(aworld->pool, &topology);
+    aworld->numa_local = pinned == threadpool_gang_width(aworld->pool) && topology.node_count > 1;
+}
+
+static void atomic_first_touch_grid(AtomicWorld* aworld) {
+    if (!aworld->phase_state.phase_system_ready) {
+        size_t bytes = (size_t)aworld->grid.width * (size_t)aworld->grid.height * sizeof(AtomicCell);
+        memset(aworld->grid.buffers[0], 0, bytes);
+        memset(aworld->grid.buffers[1], 0, bytes);
+        return;
+    }
+
+    atomic_phase_assign_ranges(aworld, aworld->region_count);
+    atomic_run_phase(aworld, ATOMIC_PHASE_FIRST_TOUCH);
 }
 
 // ============================================================================
@@ -1004,6 +1036,8 @@ AtomicWorld* atomic_world_create(World* world, ThreadPool* pool, int thread_coun
     aworld->thread_count = thread_count;
     aworld->serial_interval = atomic_parse_env_int("FEROX_ATOMIC_SERIAL_INTERVAL", 5, 1, 32);
     aworld->frontier_dense_pct = atomic_parse_env_int("FEROX_ATOMIC_FRONTIER_DENSE_PCT", 15, 5, 90);
+    aworld->frontier_min_chunk = atomic_parse_env_int("FEROX_ATOMIC_FRONTIER_MIN_CHUNK", 64, 1, 65536);
+    atomic_init(&aworld->spread_frontier_cursor, 0);
     
     int grid_size = world->width * world->height;
     
@@ -1012,12 +1046,14 @@ AtomicWorld* atomic_world_create(World* world, ThreadPool* pool, int thread_coun
     aworld->grid.height = world->height;
     aworld->grid.current_buffer = 0;
     
-    aworld->grid.buffers[0] = (AtomicCell*)calloc(grid_size, sizeof(AtomicCell));
-    aworld->grid.buffers[1] = (AtomicCell*)calloc(grid_size, sizeof(AtomicCell));
+    // No backing touches the pages here, so they are only faulted in by
+    // atomic_first_touch_grid(), one page per owning worker.
+    aworld->grid.buffers[0] = (AtomicCell*)ferox_grid_calloc((size_t)grid_size, sizeof(AtomicCell));
+    aworld->grid.buffers[1] = (AtomicCell*)ferox_grid_calloc((size_t)grid_size, sizeof(AtomicCell));
     
     if (!aworld->grid.buffers[0] || !aworld->grid.buffers[1]) {
-        free(aworld->grid.buffers[0]);
-        free(aworld->grid.buffers[1]);
+        ferox_grid_free(aworld->grid.buffers[0]);
+        ferox_grid_free(aworld->grid.buffers[1]);
         free(aworld);
         return NULL;
     }
@@ -1027,8 +1063,8 @@ AtomicWorld* atomic_world_create(World* world, ThreadPool* pool, int thread_coun
     aworld->max_colonies = 4096;  // Support many divisions
     aworld->colony_stats = (AtomicColonyStats*)calloc(aworld->max_colonies, sizeof(AtomicColonyStats));
     if (!aworld->colony_stats) {
-        free(aworld->grid.buffers[0]);
-        free(aworld->grid.buffers[1]);
+        ferox_grid_free(aworld->grid.buffers[0]);
+        ferox_grid_free(aworld->grid.buffers[1]);
         free(aworld);
         return NULL;
     }
@@ -1037,6 +1073,8 @@ AtomicWorld* atomic_world_create(World* world, ThreadPool* pool, int thread_coun
     int regions_y = 1;
     compute_region_grid(aworld->grid.width, aworld->grid.height, aworld->thread_count, &regions_x, &regions_y);
     aworld->region_count = regions_x * regions_y;
+    aworld->regions_x = regions_x;
+    aworld->regions_y = regions_y;
 
     int seed_count = aworld->region_count;
     if (seed_count < aworld->thread_count) {
@@ -1045,8 +1083,8 @@ AtomicWorld* atomic_world_create(World* world, ThreadPool* pool, int thread_coun
     aworld->thread_seeds = (uint32_t*)malloc((size_t)seed_count * sizeof(uint32_t));
     if (!aworld->thread_seeds) {
         free(aworld->colony_stats);
-        free(aworld->grid.buffers[0]);
-        free(aworld->grid.buffers[1]);
+        ferox_grid_free(aworld->grid.buffers[0]);
+        ferox_grid_free(aworld->grid.buffers[1]);
         free(aworld);
         return NULL;
     }
@@ -1059,8 +1097,8 @@ AtomicWorld* atomic_world_create(World* world, ThreadPool* pool, int thread_coun
     if (!aworld->region_work) {
         free(aworld->thread_seeds);
         free(aworld->colony_stats);
-        free(aworld->grid.buffers[0]);
-        free(aworld->grid.buffers[1]);
+        ferox_grid_free(aworld->grid.buffers[0]);
+        ferox_grid_free(aworld->grid.buffers[1]);
         free(aworld);
         return NULL;
     }
@@ -1070,8 +1108,8 @@ AtomicWorld* atomic_world_create(World* world, ThreadPool* pool, int thread_coun
         free(aworld->region_work);
         free(aworld->thread_seeds);
         free(aworld->colony_stats);
-        free(aworld->grid.buffers[0]);
-        free(aworld->grid.buffers[1]);
+        ferox_grid_free(aworld->grid.buffers[0]);
+        ferox_grid_free(aworld->grid.buffers[1]);
         free(aworld);
         return NULL;
     }
@@ -1081,8 +1119,8 @@ AtomicWorld* atomic_world_create(World* world, ThreadPool* pool, int thread_coun
         free(aworld->region_work);
         free(aworld->thread_seeds);
         free(aworld->colony_stats);
-        free(aworld->grid.buffers[0]);
-        free(aworld->grid.buffers[1]);
+        ferox_grid_free(aworld->grid.buffers[0]);
+        ferox_grid_free(aworld->grid.buffers[1]);
         free(aworld);
         return NULL;
     }
@@ -1098,8 +1136,8 @@ AtomicWorld* atomic_world_create(World* world, ThreadPool* pool, int thread_coun
         free(aworld->region_work);
         free(aworld->thread_seeds);
         free(aworld->colony_stats);
-        free(aworld->grid.buffers[0]);
-        free(aworld->grid.buffers[1]);
+        ferox_grid_free(aworld->grid.buffers[0]);
+        ferox_grid_free(aworld->grid.buffers[1]);
         free(aworld);
         return NULL;
     }
@@ -1125,6 +1163,9 @@ AtomicWorld* atomic_world_create(World* world, ThreadPool* pool, int thread_coun
     if (atomic_phase_system_create(aworld) != 0) {
         aworld->phase_state.phase_system_ready = false;
     }
+
+    atomic_place_workers(aworld);
+    atomic_first_touch_grid(aworld);
     
     // Sync from world
     atomic_world_sync_from_world(aworld);
@@ -1137,10 +1178,9 @@ void atomic_world_destroy(AtomicWorld* aworld) {
     
     atomic_phase_system_destroy(aworld);
 
+    free(aworld->worker_busy_ms);
     free(aworld->worker_region_end);
     free(aworld->worker_region_start);
-    free(aworld->phase_worker_args);
-    free(aworld->phase_threads);
     free(aworld->spread_frontier_indices);
     free(aworld->spread_deltas);
     free(aworld->spread_touched_ids);
@@ -1149,8 +1189,8 @@ void atomic_world_destroy(AtomicWorld* aworld) {
     free(aworld->region_work);
     free(aworld->thread_seeds);
     free(aworld->colony_stats);
-    free(aworld->grid.buffers[0]);
-    free(aworld->grid.buffers[1]);
+    ferox_grid_free(aworld->grid.buffers[0]);
+    ferox_grid_free(aworld->grid.buffers[1]);
     free(aworld);
 }
 
@@ -1394,7 +1434,7 @@ void atomic_spread(AtomicWorld* aworld) {
 
         if (use_frontier) {
             aworld->spread_state.spread_slots_used = aworld->phase_worker_count;
-            atomic_phase_assign_interleaved(aworld, aworld->spread_state.spread_frontier_count);
+            atomic_store_explicit(&aworld->spread_frontier_cursor, 0, memory_order_relaxed);
             atomic_run_phase(aworld, ATOMIC_PHASE_SPREAD_FRONTIER);
         } else {
             aworld->spread_state.spread_slots_used = aworld->region_count;
@@ -1436,6 +1476,17 @@ int atomic_get_spread_frontier_count(AtomicWorld* aworld) {
     return aworld->spread_state.spread_frontier_count;
 }
 
+void atomic_get_phase_barrier_stats(AtomicWorld* aworld, PhaseBarrierStats* stats) {
+    if (!stats) {
+        return;
+    }
+    if (!aworld || !aworld->phase_state.phase_system_ready) {
+        phase_barrier_get_stats(NULL, stats);
+        return;
+    }
+    threadpool_get_gang_stats(aworld->pool, stats);
+}
+
 void atomic_barrier(AtomicWorld* aworld) {
     if (!aworld) return;
     if (aworld->phase_state.phase_system_ready) {
@@ -1512,6 +1563,12 @@ void atomic_tick_with_breakdown(AtomicWorld* aworld, AtomicTickBreakdown* breakd
 
     AtomicTickBreakdown local = {0};
     World* world = aworld->world;
+    PhaseBarrierStats barrier_before;
+    atomic_get_phase_barrier_stats(aworld, &barrier_before);
+    aworld->phase_wall_ms = 0.0;
+    if (aworld->worker_busy_ms) {
+        memset(aworld->worker_busy_ms, 0, (size_t)aworld->phase_worker_count * sizeof(double));
+    }
     double total_start = atomic_now_ms();
 
     double phase_start = atomic_now_ms();
@@ -1553,6 +1610,24 @@ void atomic_tick_with_breakdown(AtomicWorld* aworld, AtomicTickBreakdown* breakd
     world->tick++;
     local.total_ms = atomic_now_ms() - total_start;
 
+    // Every gang of this tick returned after its workers counted their waits
+    PhaseBarrierStats barrier_after;
+    atomic_get_phase_barrier_stats(aworld, &barrier_after);
+    local.barrier_spin_waits = barrier_after.spin_waits - barrier_before.spin_waits;
+    local.barrier_park_waits = barrier_after.park_waits - barrier_before.park_waits;
+
+    if (aworld->phase_state.phase_system_ready && aworld->worker_busy_ms) {
+        local.worker_count = aworld->phase_worker_count < ATOMIC_BREAKDOWN_MAX_WORKERS
+            ? aworld->phase_worker_count
+            : ATOMIC_BREAKDOWN_MAX_WORKERS;
+        for (int w = 0; w < local.worker_count; w++) {
+            double busy = aworld->worker_busy_ms[w];
+            double idle = aworld->phase_wall_ms - busy;
+            local.worker_busy_ms[w] = busy;
+            local.worker_idle_ms[w] = idle > 0.0 ? idle : 0.0;
+        }
+    }
+
     if (breakdown) {
         *breakdown = local;
     }
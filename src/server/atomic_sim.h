@@ -11,6 +11,7 @@
 #include "../shared/cacheline.h"
 #include "../shared/atomic_types.h"
 #include "../shared/types.h"
+#include "phase_wait.h"
 #include "threadpool.h"
 
 struct AtomicWorld;
@@ -40,16 +41,13 @@ _Static_assert(sizeof(AtomicSpreadSharedState) == FEROX_CACHELINE_SIZE,
                "AtomicSpreadSharedState should be one cacheline");
 
 typedef struct {
-    uint32_t phase_generation;
-    int phase_done_count;
     int active_phase;
     int phase_region_stride;
-    bool phase_shutdown;
     bool phase_system_ready;
-    uint8_t cacheline_padding[FEROX_CACHELINE_SIZE - sizeof(uint32_t) - (sizeof(int) * 3) - (sizeof(bool) * 2)];
+    uint8_t cacheline_padding[FEROX_CACHELINE_SIZE - (sizeof(int) * 2) - sizeof(bool)];
 } AtomicPhaseSharedState;
 
-_Static_assert(FEROX_CACHELINE_SIZE >= (int)(sizeof(uint32_t) + (sizeof(int) * 3) + (sizeof(bool) * 2)),
+_Static_assert(FEROX_CACHELINE_SIZE >= (int)((sizeof(int) * 2) + sizeof(bool)),
                "FEROX_CACHELINE_SIZE too small for AtomicPhaseSharedState");
 _Static_assert(sizeof(AtomicPhaseSharedState) == FEROX_CACHELINE_SIZE,
                "AtomicPhaseSharedState should be one cacheline");
@@ -82,6 +80,8 @@ typedef struct AtomicWorld {
     // Precomputed region work items for parallel phases
     AtomicRegionWork* region_work;
     int region_count;
+    int regions_x;                   // Region grid columns (region_work is row-major)
+    int regions_y;                   // Region grid rows
 
     // Reusable argument vector for batched task submission
     void** submit_args;
@@ -93,19 +93,26 @@ typedef struct AtomicWorld {
     FEROX_CACHELINE_ALIGN AtomicSpreadSharedState spread_state;
 
     // Active-frontier tracking for sparse spread processing
-    int* spread_frontier_indices;     // [width * height] active source cell indices
+    int* spread_frontier_indices;     // [width * height] active source cell indices, tile-major
+    int frontier_min_chunk;           // Smallest guided chunk a worker claims
 
-    // Dedicated phase workers for low-overhead atomic phases
-    pthread_t* phase_threads;
-    AtomicRegionWork* phase_worker_args;
+    // Shared claim cursor into spread_frontier_indices; kept on its own line
+    // because every worker hits it once per chunk.
+    FEROX_CACHELINE_ALIGN atomic_int spread_frontier_cursor;
+
+    // Phase slices, run as gang jobs on the shared pool's workers and the
+    // ticking thread (gang members with id >= phase_worker_count sit a phase out)
     int phase_worker_count;
     int* worker_region_start;
     int* worker_region_end;
-    pthread_mutex_t phase_mutex;
-    pthread_cond_t phase_cond;
-    pthread_cond_t phase_done_cond;
+    double* worker_busy_ms;          // [phase_worker_count] time inside phase slices
+    double phase_wall_ms;            // Dispatcher-side gang time, same window
     FEROX_CACHELINE_ALIGN AtomicPhaseSharedState phase_state;
 
+    // Pool workers are pinned node-major and the grid was first-touched by
+    // range, so phases keep contiguous ranges instead of interleaving.
+    bool numa_local;
+
     // Run expensive serial maintenance every N ticks.
     int serial_interval;
 
@@ -114,8 +121,11 @@ typedef struct AtomicWorld {
 } AtomicWorld;
 
 FEROX_CACHELINE_ASSERT_MEMBER_ALIGNED(AtomicWorld, spread_state);
+FEROX_CACHELINE_ASSERT_MEMBER_ALIGNED(AtomicWorld, spread_frontier_cursor);
 FEROX_CACHELINE_ASSERT_MEMBER_ALIGNED(AtomicWorld, phase_state);
 
+#define ATOMIC_BREAKDOWN_MAX_WORKERS 64
+
 typedef struct {
     double age_ms;
     double spread_ms;
@@ -123,6 +133,11 @@ typedef struct {
     double serial_ms;
     double sync_from_world_ms;
     double total_ms;
+    uint64_t barrier_spin_waits;     // Barrier waits released while spinning this tick
+    uint64_t barrier_park_waits;     // Barrier waits that parked on the futex this tick
+    int worker_count;                // Phase workers reported below (<= ATOMIC_BREAKDOWN_MAX_WORKERS)
+    double worker_busy_ms[ATOMIC_BREAKDOWN_MAX_WORKERS]; // Time running phase slices this tick
+    double worker_idle_ms[ATOMIC_BREAKDOWN_MAX_WORKERS]; // Phase wall time minus busy time
 } AtomicTickBreakdown;
 
 // ============================================================================
@@ -131,7 +146,9 @@ typedef struct {
 
 /**
  * Create an atomic world wrapper around an existing world.
- * Allocates double-buffered grid and atomic stats.
+ * Allocates double-buffered grid and atomic stats. Phases use at most
+ * thread_count gang members; pass threadpool_gang_width(pool) to give the
+ * ticking thread a slice as well.
  */
 AtomicWorld* atomic_world_create(World* world, ThreadPool* pool, int thread_count);
 
@@ -202,6 +219,13 @@ void atomic_set_spread_frontier_enabled(AtomicWorld* aworld, bool enabled);
  */
 int atomic_get_spread_frontier_count(AtomicWorld* aworld);
 
+/**
+ * Snapshot cumulative phase-barrier counters (spin vs. park outcomes).
+ * These are the shared pool's gang-barrier counters, so they also include
+ * gangs dispatched by other users of the pool.
+ */
+void atomic_get_phase_barrier_stats(AtomicWorld* aworld, PhaseBarrierStats* stats);
+
 /**
  * Parallel age phase only.
  * Increment age of all occupied cells atomically.
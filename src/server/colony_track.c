@@ -0,0 +1,205 @@
+#include "colony_track.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int colony_track_compare_id(const void* a, const void* b) {
+    uint32_t left = ((const ColonyTrackEntry*)a)->descriptor.id;
+    uint32_t right = ((const ColonyTrackEntry*)b)->descriptor.id;
+    return (left > right) - (left < right);
+}
+
+static int colony_track_compare_u32(const void* a, const void* b) {
+    uint32_t left = *(const uint32_t*)a;
+    uint32_t right = *(const uint32_t*)b;
+    return (left > right) - (left < right);
+}
+
+static int colony_track_reserve(ColonyTrackEntry** entries, uint32_t* capacity, uint32_t count) {
+    if (count <= *capacity) {
+        return 0;
+    }
+    ColonyTrackEntry* grown = (ColonyTrackEntry*)realloc(*entries, (size_t)count * sizeof(ColonyTrackEntry));
+    if (!grown) {
+        return -1;
+    }
+    *entries = grown;
+    *capacity = count;
+    return 0;
+}
+
+static int colony_track_note_removal(ColonyTrack* track, uint32_t id, uint32_t tick) {
+    if (track->removed_count == track->removed_capacity) {
+        uint32_t capacity = track->removed_capacity ? track->removed_capacity * 2u : 64u;
+        ColonyTrackRemoval* grown = (ColonyTrackRemoval*)realloc(track->removed,
+                                                                 (size_t)capacity * sizeof(ColonyTrackRemoval));
+        if (!grown) {
+            return -1;
+        }
+        track->removed = grown;
+        track->removed_capacity = capacity;
+    }
+    track->removed[track->removed_count].id = id;
+    track->removed[track->removed_count].tick = tick;
+    track->removed_count++;
+    return 0;
+}
+
+void colony_track_init(ColonyTrack* track) {
+    if (!track) return;
+    memset(track, 0, sizeof(*track));
+}
+
+void colony_track_destroy(ColonyTrack* track) {
+    if (!track) return;
+    free(track->entries);
+    free(track->scratch);
+    free(track->removed);
+    colony_track_init(track);
+}
+
+void colony_track_invalidate(ColonyTrack* track) {
+    if (!track) return;
+    track->valid = false;
+    track->count = 0;
+    track->removed_count = 0;
+}
+
+int colony_track_update(ColonyTrack* track, const ProtoWorld* snapshot, uint32_t tick, uint32_t max_gap) {
+    if (!track || !snapshot) {
+        return -1;
+    }
+
+    uint32_t total = proto_world_colony_total(snapshot);
+    if (colony_track_reserve(&track->scratch, &track->scratch_capacity, total) < 0) {
+        colony_track_invalidate(track);
+        return -1;
+    }
+    ColonyTrackEntry* next = track->scratch;
+    bool sorted = true;
+    for (uint32_t i = 0; i < total; i++) {
+        proto_colony_quantize(proto_world_colony_at(snapshot, i), &next[i].descriptor, &next[i].dynamic);
+        next[i].descriptor_tick = tick;
+        next[i].dynamic_tick = tick;
+        if (i > 0 && next[i].descriptor.id <= next[i - 1].descriptor.id) {
+            sorted = false;
+        }
+    }
+    if (!sorted) {
+        qsort(next, total, sizeof(ColonyTrackEntry), colony_track_compare_id);
+    }
+
+    if (!track->valid || tick <= track->tick) {
+        // Fresh history: no earlier base is trustworthy
+        track->removed_count = 0;
+        track->floor_tick = tick;
+    } else {
+        // Both tables are sorted by id; carry over the stamps of unchanged parts
+        uint32_t old_index = 0;
+        for (uint32_t i = 0; i <= total; i++) {
+            uint32_t id = i < total ? next[i].descriptor.id : UINT32_MAX;
+            while (old_index < track->count &&
+                   (track->entries[old_index].descriptor.id < id || i == total)) {
+                if (colony_track_note_removal(track, track->entries[old_index].descriptor.id, tick) < 0) {
+                    colony_track_invalidate(track);
+                    return -1;
+                }
+                old_index++;
+            }
+            if (i == total || old_index >= track->count || track->entries[old_index].descriptor.id != id) {
+                continue;
+            }
+            const ColonyTrackEntry* old = &track->entries[old_index++];
+            if (memcmp(&old->descriptor, &next[i].descriptor, sizeof(ProtoColonyDescriptor)) == 0) {
+                next[i].descriptor_tick = old->descriptor_tick;
+            }
+            if (memcmp(&old->dynamic, &next[i].dynamic, sizeof(ProtoColonyDynamic)) == 0) {
+                next[i].dynamic_tick = old->dynamic_tick;
+            }
+        }
+
+        // No client base is older than max_gap ticks
+        if (tick > max_gap && tick - max_gap > track->floor_tick) {
+            track->floor_tick = tick - max_gap;
+        }
+        uint32_t keep = 0;
+        while (keep < track->removed_count && track->removed[keep].tick <= track->floor_tick) {
+            keep++;
+        }
+        if (keep > 0) {
+            memmove(track->removed, track->removed + keep,
+                    (size_t)(track->removed_count - keep) * sizeof(ColonyTrackRemoval));
+            track->removed_count -= keep;
+        }
+    }
+
+    track->scratch = track->entries;
+    track->entries = next;
+    uint32_t capacity = track->capacity;
+    track->capacity = track->scratch_capacity;
+    track->scratch_capacity = capacity;
+    track->count = total;
+    track->tick = tick;
+    track->valid = true;
+    return 0;
+}
+
+int colony_track_build_delta(const ColonyTrack* track, bool full, uint32_t base_tick, ProtoColonyDelta* delta) {
+    if (!track || !delta) {
+        return -1;
+    }
+    proto_colony_delta_init(delta);
+    if (!track->valid || (!full && (base_tick < track->floor_tick || base_tick > track->tick))) {
+        return -1;
+    }
+
+    delta->tick = track->tick;
+    delta->base_tick = full ? 0u : base_tick;
+    delta->full = full;
+    delta->total_count = track->count;
+
+    uint32_t first_removed = track->removed_count;
+    uint32_t descriptor_count = 0;
+    uint32_t dynamic_count = 0;
+    if (!full) {
+        while (first_removed > 0 && track->removed[first_removed - 1].tick > base_tick) {
+            first_removed--;
+        }
+    }
+    for (uint32_t i = 0; i < track->count; i++) {
+        descriptor_count += full || track->entries[i].descriptor_tick > base_tick;
+        dynamic_count += full || track->entries[i].dynamic_tick > base_tick;
+    }
+
+    uint32_t removed_count = track->removed_count - first_removed;
+    if ((removed_count > 0 &&
+         !(delta->removed = (uint32_t*)malloc((size_t)removed_count * sizeof(uint32_t)))) ||
+        (descriptor_count > 0 &&
+         !(delta->descriptors = (ProtoColonyDescriptor*)malloc((size_t)descriptor_count *
+                                                               sizeof(ProtoColonyDescriptor)))) ||
+        (dynamic_count > 0 &&
+         !(delta->dynamics = (ProtoColonyDynamic*)malloc((size_t)dynamic_count * sizeof(ProtoColonyDynamic))))) {
+        proto_colony_delta_free(delta);
+        return -1;
+    }
+
+    // Removals are in tick order; the wire wants them sorted by id
+    for (uint32_t i = 0; i < removed_count; i++) {
+        delta->removed[i] = track->removed[first_removed + i].id;
+    }
+    if (removed_count > 1) {
+        qsort(delta->removed, removed_count, sizeof(uint32_t), colony_track_compare_u32);
+    }
+    delta->removed_count = removed_count;
+
+    for (uint32_t i = 0; i < track->count; i++) {
+        const ColonyTrackEntry* entry = &track->entries[i];
+        if (full || entry->descriptor_tick > base_tick) {
+            delta->descriptors[delta->descriptor_count++] = entry->descriptor;
+        }
+        if (full || entry->dynamic_tick > base_tick) {
+            delta->dynamics[delta->dynamic_count++] = entry->dynamic;
+        }
+    }
+    return 0;
+}
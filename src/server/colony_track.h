@@ -0,0 +1,68 @@
+#ifndef FEROX_COLONY_TRACK_H
+#define FEROX_COLONY_TRACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../shared/protocol.h"
+
+/**
+ * Colony table history for MSG_COLONY_DELTA.
+ *
+ * Holds the table as of the last update, sorted by id, split into descriptor
+ * and quantized dynamic record, each stamped with the tick it last changed.
+ * Colonies that left the table are remembered with the tick they left. A
+ * delta from base tick B lists everything stamped after B, the same way span
+ * deltas list the cells changed after B.
+ *
+ * Not thread-safe; the server only touches it from the broadcasting thread.
+ */
+typedef struct {
+    ProtoColonyDescriptor descriptor;
+    ProtoColonyDynamic dynamic;
+    uint32_t descriptor_tick;  // Tick at which the descriptor last changed
+    uint32_t dynamic_tick;     // Tick at which the quantized record last changed
+} ColonyTrackEntry;
+
+typedef struct {
+    uint32_t id;
+    uint32_t tick;
+} ColonyTrackRemoval;
+
+typedef struct {
+    ColonyTrackEntry* entries;     // Sorted by id
+    uint32_t count;
+    uint32_t capacity;
+    ColonyTrackEntry* scratch;     // Next table while updating; swapped with entries
+    uint32_t scratch_capacity;
+    ColonyTrackRemoval* removed;   // Oldest first
+    uint32_t removed_count;
+    uint32_t removed_capacity;
+    uint32_t floor_tick;           // Oldest base tick a delta can be built from
+    uint32_t tick;                 // Tick of the last update
+    bool valid;
+} ColonyTrack;
+
+void colony_track_init(ColonyTrack* track);
+void colony_track_destroy(ColonyTrack* track);
+
+// Forget the history; the next update starts over.
+void colony_track_invalidate(ColonyTrack* track);
+
+/**
+ * Bring the table up to date with a snapshot's colonies (inline and paged).
+ * Starts over when invalid or when tick does not advance. Removals that no
+ * base within max_gap ticks can need are dropped and floor_tick follows.
+ * @return 0 on success, -1 on allocation failure (the track is invalidated)
+ */
+int colony_track_update(ColonyTrack* track, const ProtoWorld* snapshot, uint32_t tick, uint32_t max_gap);
+
+/**
+ * Fill delta with the whole table, or with every change after base_tick.
+ * The lists are allocated; free them with proto_colony_delta_free.
+ * @return 0 on success, -1 if the track is invalid, base_tick is outside
+ *         [floor_tick, tick], or on allocation failure
+ */
+int colony_track_build_delta(const ColonyTrack* track, bool full, uint32_t base_tick, ProtoColonyDelta* delta);
+
+#endif // FEROX_COLONY_TRACK_H
@@ -0,0 +1,202 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpu_topology.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Parse a sysfs cpulist ("0-3,8-11") into a membership bitmap.
+static void parse_cpulist(const char* text, bool* member, int member_len) {
+    const char* p = text;
+    while (*p) {
+        char* next = NULL;
+        long lo = strtol(p, &next, 10);
+        if (next == p) {
+            break;
+        }
+        long hi = lo;
+        p = next;
+        if (*p == '-') {
+            p++;
+            hi = strtol(p, &next, 10);
+            if (next == p) {
+                break;
+            }
+            p = next;
+        }
+        for (long cpu = lo; cpu <= hi && cpu < member_len; cpu++) {
+            if (cpu >= 0) {
+                member[cpu] = true;
+            }
+        }
+        while (*p == ',' || *p == '\n' || *p == ' ') {
+            p++;
+        }
+    }
+}
+
+static bool read_node_cpulist(int node, char* buffer, size_t buffer_size) {
+    char path[96];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        return false;
+    }
+    bool ok = fgets(buffer, (int)buffer_size, fp) != NULL;
+    fclose(fp);
+    return ok;
+}
+
+static int collect_usable_cpus(bool* usable, int usable_len) {
+    int count = 0;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < usable_len && cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                usable[cpu] = true;
+                count++;
+            }
+        }
+        if (count > 0) {
+            return count;
+        }
+    }
+#endif
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online < 1) {
+        online = 1;
+    }
+    for (int cpu = 0; cpu < online && cpu < usable_len; cpu++) {
+        usable[cpu] = true;
+        count++;
+    }
+    return count;
+}
+
+int ferox_cpu_topology_detect(FeroxCpuTopology* topo) {
+    if (!topo) {
+        return -1;
+    }
+
+    memset(topo, 0, sizeof(*topo));
+
+    bool usable[FEROX_TOPOLOGY_MAX_CPUS];
+    bool placed[FEROX_TOPOLOGY_MAX_CPUS];
+    bool node_member[FEROX_TOPOLOGY_MAX_CPUS];
+    memset(usable, 0, sizeof(usable));
+    memset(placed, 0, sizeof(placed));
+
+    if (collect_usable_cpus(usable, FEROX_TOPOLOGY_MAX_CPUS) <= 0) {
+        return -1;
+    }
+
+    char line[1024];
+    for (int node = 0; node < FEROX_TOPOLOGY_MAX_NODES; node++) {
+        if (!read_node_cpulist(node, line, sizeof(line))) {
+            continue;
+        }
+        topo->from_sysfs = true;
+
+        memset(node_member, 0, sizeof(node_member));
+        parse_cpulist(line, node_member, FEROX_TOPOLOGY_MAX_CPUS);
+
+        int added = 0;
+        for (int cpu = 0; cpu < FEROX_TOPOLOGY_MAX_CPUS; cpu++) {
+            if (node_member[cpu] && usable[cpu] && !placed[cpu]) {
+                topo->cpus[topo->cpu_count] = cpu;
+                topo->cpu_node[topo->cpu_count] = (short)node;
+                topo->cpu_count++;
+                placed[cpu] = true;
+                added++;
+            }
+        }
+        if (added > 0) {
+            topo->node_count++;
+        }
+    }
+
+    // CPUs sysfs did not attribute to a node (or no sysfs at all) go to node 0.
+    int orphans = 0;
+    for (int cpu = 0; cpu < FEROX_TOPOLOGY_MAX_CPUS; cpu++) {
+        if (usable[cpu] && !placed[cpu]) {
+            topo->cpus[topo->cpu_count] = cpu;
+            topo->cpu_node[topo->cpu_count] = 0;
+            topo->cpu_count++;
+            orphans++;
+        }
+    }
+    if (topo->node_count == 0 && orphans > 0) {
+        topo->node_count = 1;
+    }
+
+    return topo->cpu_count > 0 ? 0 : -1;
+}
+
+int ferox_cpu_topology_slot_for_worker(const FeroxCpuTopology* topo, int worker_id, int worker_count) {
+    if (!topo || topo->cpu_count <= 0 || worker_count <= 0 || worker_id < 0) {
+        return 0;
+    }
+    if (worker_count > topo->cpu_count) {
+        return worker_id % topo->cpu_count;
+    }
+    return (int)(((long long)worker_id * topo->cpu_count) / worker_count);
+}
+
+int ferox_cpu_topology_node_for_worker(const FeroxCpuTopology* topo, int worker_id, int worker_count) {
+    if (!topo || topo->cpu_count <= 0) {
+        return 0;
+    }
+    return topo->cpu_node[ferox_cpu_topology_slot_for_worker(topo, worker_id, worker_count)];
+}
+
+int ferox_pin_current_thread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return -1;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? 0 : -1;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+typedef struct {
+    const FeroxCpuTopology* topo;
+    atomic_int pinned;
+} PinPoolArgs;
+
+static void pin_pool_worker(void* arg, int worker_id, int worker_count) {
+    PinPoolArgs* args = (PinPoolArgs*)arg;
+    int slot = ferox_cpu_topology_slot_for_worker(args->topo, worker_id, worker_count);
+    if (ferox_pin_current_thread(args->topo->cpus[slot]) == 0) {
+        atomic_fetch_add_explicit(&args->pinned, 1, memory_order_relaxed);
+    }
+}
+
+int ferox_cpu_topology_pin_pool(ThreadPool* pool, const FeroxCpuTopology* topo) {
+    if (!pool || !topo || topo->cpu_count <= 0) {
+        return -1;
+    }
+
+    PinPoolArgs args;
+    args.topo = topo;
+    atomic_init(&args.pinned, 0);
+    threadpool_run_gang(pool, pin_pool_worker, &args);
+    return atomic_load_explicit(&args.pinned, memory_order_relaxed);
+}
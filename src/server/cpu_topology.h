@@ -0,0 +1,54 @@
+#ifndef FEROX_CPU_TOPOLOGY_H
+#define FEROX_CPU_TOPOLOGY_H
+
+#include <stdbool.h>
+
+#include "threadpool.h"
+
+#define FEROX_TOPOLOGY_MAX_CPUS 1024
+#define FEROX_TOPOLOGY_MAX_NODES 64
+
+/**
+ * CPUs usable by this process, grouped by NUMA node.
+ *
+ * `cpus` is ordered node-major (all of node 0's CPUs, then node 1's, ...), so
+ * contiguous worker ids mapped through it land on the same node. When sysfs
+ * node information is unavailable every CPU reports node 0.
+ */
+typedef struct {
+    int cpu_count;
+    int node_count;
+    int cpus[FEROX_TOPOLOGY_MAX_CPUS];
+    short cpu_node[FEROX_TOPOLOGY_MAX_CPUS];
+    bool from_sysfs;
+} FeroxCpuTopology;
+
+/**
+ * Detect usable CPUs (affinity mask) and their NUMA nodes.
+ * @return 0 on success, -1 if no CPU could be enumerated
+ */
+int ferox_cpu_topology_detect(FeroxCpuTopology* topo);
+
+/**
+ * Map a worker to a CPU index in `topo->cpus`, spreading workers evenly so
+ * each node receives a contiguous block of worker ids.
+ */
+int ferox_cpu_topology_slot_for_worker(const FeroxCpuTopology* topo, int worker_id, int worker_count);
+
+int ferox_cpu_topology_node_for_worker(const FeroxCpuTopology* topo, int worker_id, int worker_count);
+
+/**
+ * Restrict the calling thread to a single CPU.
+ * @return 0 on success, -1 if unsupported or the kernel refused
+ */
+int ferox_pin_current_thread(int cpu);
+
+/**
+ * Pin every gang member of the pool to its CPU from ferox_cpu_topology_slot_for_worker().
+ * Runs as a gang job, so each worker pins itself; the calling thread, which
+ * runs the pool's gangs, takes the last slot.
+ * @return number of threads pinned, or -1 on invalid arguments
+ */
+int ferox_cpu_topology_pin_pool(ThreadPool* pool, const FeroxCpuTopology* topo);
+
+#endif // FEROX_CPU_TOPOLOGY_H
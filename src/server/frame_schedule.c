@@ -0,0 +1,73 @@
+#include "frame_schedule.h"
+
+#include <errno.h>
+#include <time.h>
+
+uint64_t frame_schedule_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * FRAME_SCHEDULE_NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t frame_schedule_period_ns(double hz) {
+    if (!(hz > 0.0)) {
+        return 0;
+    }
+    double period = (double)FRAME_SCHEDULE_NS_PER_SEC / hz;
+    return period < 1.0 ? 1u : (uint64_t)period;
+}
+
+void frame_schedule_init(FrameSchedule* schedule, uint64_t period_ns, uint64_t now_ns) {
+    if (!schedule) return;
+    schedule->period_ns = period_ns;
+    schedule->next_ns = now_ns;
+}
+
+void frame_schedule_set_period(FrameSchedule* schedule, uint64_t period_ns, uint64_t now_ns) {
+    if (!schedule || period_ns == schedule->period_ns) return;
+    if (schedule->period_ns == 0 || schedule->next_ns < schedule->period_ns) {
+        schedule->next_ns = now_ns;
+    } else {
+        schedule->next_ns = schedule->next_ns - schedule->period_ns + period_ns;
+    }
+    schedule->period_ns = period_ns;
+}
+
+bool frame_schedule_due(const FrameSchedule* schedule, uint64_t now_ns) {
+    return schedule && (schedule->period_ns == 0 || now_ns >= schedule->next_ns);
+}
+
+void frame_schedule_advance(FrameSchedule* schedule, uint64_t now_ns) {
+    if (!schedule) return;
+    if (schedule->period_ns == 0) {
+        schedule->next_ns = now_ns;
+        return;
+    }
+    schedule->next_ns += schedule->period_ns;
+    if (schedule->next_ns <= now_ns) {
+        // Behind: drop the missed slots but stay on the grid
+        uint64_t missed = (now_ns - schedule->next_ns) / schedule->period_ns + 1u;
+        schedule->next_ns += missed * schedule->period_ns;
+    }
+}
+
+void frame_schedule_sleep_until(uint64_t deadline_ns) {
+    struct timespec ts;
+#if defined(__APPLE__)
+    // No clock_nanosleep; the deadline is still absolute, only the wait is relative
+    uint64_t now = frame_schedule_now_ns();
+    if (deadline_ns <= now) {
+        return;
+    }
+    uint64_t wait = deadline_ns - now;
+    ts.tv_sec = (time_t)(wait / FRAME_SCHEDULE_NS_PER_SEC);
+    ts.tv_nsec = (long)(wait % FRAME_SCHEDULE_NS_PER_SEC);
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+#else
+    ts.tv_sec = (time_t)(deadline_ns / FRAME_SCHEDULE_NS_PER_SEC);
+    ts.tv_nsec = (long)(deadline_ns % FRAME_SCHEDULE_NS_PER_SEC);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+#endif
+}
@@ -0,0 +1,45 @@
+#ifndef FEROX_FRAME_SCHEDULE_H
+#define FEROX_FRAME_SCHEDULE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Fixed-rate deadlines on CLOCK_MONOTONIC.
+ *
+ * Slots sit on a grid anchored at the first one: each deadline is the last
+ * plus the period, never "now" plus the period, so time spent working does
+ * not accumulate as drift. A caller that falls behind skips the slots it
+ * missed instead of running them back to back. A zero period makes every
+ * check due (unpaced).
+ */
+typedef struct {
+    uint64_t period_ns;  // 0 = unpaced
+    uint64_t next_ns;    // Absolute time of the next slot
+} FrameSchedule;
+
+#define FRAME_SCHEDULE_NS_PER_SEC 1000000000ull
+
+uint64_t frame_schedule_now_ns(void);
+
+// Period for a rate in Hz; 0 for rates <= 0.
+uint64_t frame_schedule_period_ns(double hz);
+
+// The first slot is due at now_ns.
+void frame_schedule_init(FrameSchedule* schedule, uint64_t period_ns, uint64_t now_ns);
+
+/**
+ * Change the period, keeping the last slot as the anchor. Leaving unpaced
+ * makes the next slot due at now_ns.
+ */
+void frame_schedule_set_period(FrameSchedule* schedule, uint64_t period_ns, uint64_t now_ns);
+
+bool frame_schedule_due(const FrameSchedule* schedule, uint64_t now_ns);
+
+// Move to the first slot after now_ns.
+void frame_schedule_advance(FrameSchedule* schedule, uint64_t now_ns);
+
+// Sleep until an absolute CLOCK_MONOTONIC time; returns at once if it passed.
+void frame_schedule_sleep_until(uint64_t deadline_ns);
+
+#endif // FEROX_FRAME_SCHEDULE_H
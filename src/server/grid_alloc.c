@@ -0,0 +1,326 @@
+#include "grid_alloc.h"
+#include "../shared/cacheline.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define FEROX_GRID_ALLOC_HAVE_MMAP 1
+#endif
+
+#define GRID_ALLOC_MAGIC 0x47524944u  // "GRID"
+#define GRID_ALLOC_HEADER_SIZE ((size_t)FEROX_CACHELINE_SIZE)
+#define GRID_ALLOC_HUGE_PAGE ((size_t)2 * 1024 * 1024)
+
+typedef enum {
+    GRID_BACKING_HEAP = 0,
+    GRID_BACKING_MMAP,
+    GRID_BACKING_THP,
+    GRID_BACKING_HUGETLB
+} GridBacking;
+
+// Lives in the cacheline just below the returned pointer.
+typedef struct {
+    void* base;
+    size_t map_len;
+    size_t user_bytes;
+    uint32_t magic;
+    uint32_t backing;
+} GridAllocHeader;
+
+_Static_assert(sizeof(GridAllocHeader) <= FEROX_CACHELINE_SIZE,
+               "GridAllocHeader must fit in the header cacheline");
+
+static atomic_uint_fast64_t g_backing_bytes[4];
+static atomic_uint_fast64_t g_hugetlb_failures;
+static atomic_int g_mode = ATOMIC_VAR_INIT(-1);
+
+bool ferox_hugepage_mode_from_string(const char* raw, FeroxHugePageMode* out) {
+    if (!raw || !out) {
+        return false;
+    }
+    if (strcasecmp(raw, "off") == 0 || strcmp(raw, "0") == 0) {
+        *out = FEROX_HUGEPAGE_OFF;
+        return true;
+    }
+    if (strcasecmp(raw, "thp") == 0 || strcmp(raw, "1") == 0) {
+        *out = FEROX_HUGEPAGE_THP;
+        return true;
+    }
+    if (strcasecmp(raw, "hugetlb") == 0) {
+        *out = FEROX_HUGEPAGE_HUGETLB;
+        return true;
+    }
+    return false;
+}
+
+const char* ferox_hugepage_mode_name(FeroxHugePageMode mode) {
+    switch (mode) {
+        case FEROX_HUGEPAGE_OFF:
+            return "off";
+        case FEROX_HUGEPAGE_HUGETLB:
+            return "hugetlb";
+        case FEROX_HUGEPAGE_THP:
+        default:
+            return "thp";
+    }
+}
+
+FeroxHugePageMode ferox_grid_alloc_get_mode(void) {
+    int mode = atomic_load_explicit(&g_mode, memory_order_relaxed);
+    if (mode >= 0) {
+        return (FeroxHugePageMode)mode;
+    }
+
+    FeroxHugePageMode parsed = FEROX_HUGEPAGE_THP;
+    const char* raw = getenv("FEROX_HUGEPAGES");
+    if (raw && *raw && !ferox_hugepage_mode_from_string(raw, &parsed)) {
+        parsed = FEROX_HUGEPAGE_THP;
+    }
+
+    int expected = -1;
+    atomic_compare_exchange_strong(&g_mode, &expected, (int)parsed);
+    return (FeroxHugePageMode)atomic_load_explicit(&g_mode, memory_order_relaxed);
+}
+
+void ferox_grid_alloc_set_mode(FeroxHugePageMode mode) {
+    atomic_store_explicit(&g_mode, (int)mode, memory_order_relaxed);
+}
+
+static size_t round_up(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+static void* grid_finish(void* base, size_t map_len, size_t user_bytes, GridBacking backing) {
+    GridAllocHeader* header = (GridAllocHeader*)base;
+    header->base = base;
+    header->map_len = map_len;
+    header->user_bytes = user_bytes;
+    header->magic = GRID_ALLOC_MAGIC;
+    header->backing = (uint32_t)backing;
+    atomic_fetch_add_explicit(&g_backing_bytes[backing], user_bytes, memory_order_relaxed);
+    return (uint8_t*)base + GRID_ALLOC_HEADER_SIZE;
+}
+
+// calloc rather than posix_memalign + memset: large blocks come back as fresh
+// zero pages, so they are faulted in by the first real toucher (the owning
+// worker under FEROX_PIN_THREADS) instead of all landing on this thread's node.
+static void* grid_alloc_heap(size_t user_bytes) {
+    uint8_t* raw = (uint8_t*)calloc(1, GRID_ALLOC_HEADER_SIZE + user_bytes + FEROX_CACHELINE_SIZE);
+    if (!raw) {
+        return NULL;
+    }
+    uint8_t* base = (uint8_t*)round_up((size_t)(uintptr_t)raw, FEROX_CACHELINE_SIZE);
+    void* ptr = grid_finish(base, 0, user_bytes, GRID_BACKING_HEAP);
+    ((GridAllocHeader*)base)->base = raw;
+    return ptr;
+}
+
+#ifdef FEROX_GRID_ALLOC_HAVE_MMAP
+static void* grid_alloc_hugetlb(size_t user_bytes) {
+#ifdef MAP_HUGETLB
+    size_t map_len = round_up(GRID_ALLOC_HEADER_SIZE + user_bytes, GRID_ALLOC_HUGE_PAGE);
+    void* base = mmap(NULL, map_len, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base != MAP_FAILED) {
+        return grid_finish(base, map_len, user_bytes, GRID_BACKING_HUGETLB);
+    }
+#else
+    (void)user_bytes;
+#endif
+    atomic_fetch_add_explicit(&g_hugetlb_failures, 1, memory_order_relaxed);
+    return NULL;
+}
+
+static void* grid_alloc_mapped(size_t user_bytes, bool advise_huge) {
+    size_t map_len = round_up(GRID_ALLOC_HEADER_SIZE + user_bytes, GRID_ALLOC_HUGE_PAGE);
+
+    // Over-map by one huge page and trim so the region starts 2 MB aligned;
+    // otherwise THP can only back the interior spans.
+    size_t raw_len = map_len + GRID_ALLOC_HUGE_PAGE;
+    uint8_t* raw = (uint8_t*)mmap(NULL, raw_len, PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return NULL;
+    }
+
+    uint8_t* base = (uint8_t*)round_up((size_t)(uintptr_t)raw, GRID_ALLOC_HUGE_PAGE);
+    size_t head = (size_t)(base - raw);
+    size_t tail = raw_len - head - map_len;
+    if (head > 0) {
+        munmap(raw, head);
+    }
+    if (tail > 0) {
+        munmap(base + map_len, tail);
+    }
+
+    GridBacking backing = GRID_BACKING_MMAP;
+#ifdef MADV_HUGEPAGE
+    if (advise_huge && madvise(base, map_len, MADV_HUGEPAGE) == 0) {
+        backing = GRID_BACKING_THP;
+    }
+#else
+    (void)advise_huge;
+#endif
+    return grid_finish(base, map_len, user_bytes, backing);
+}
+#endif
+
+void* ferox_grid_calloc(size_t count, size_t size) {
+    if (count == 0 || size == 0) {
+        return NULL;
+    }
+    if (count > (SIZE_MAX - GRID_ALLOC_HEADER_SIZE - GRID_ALLOC_HUGE_PAGE * 2) / size) {
+        return NULL;
+    }
+
+    size_t user_bytes = count * size;
+    FeroxHugePageMode mode = ferox_grid_alloc_get_mode();
+    if (mode == FEROX_HUGEPAGE_OFF || user_bytes < FEROX_GRID_ALLOC_HUGE_MIN) {
+        return grid_alloc_heap(user_bytes);
+    }
+
+#ifdef FEROX_GRID_ALLOC_HAVE_MMAP
+    if (mode == FEROX_HUGEPAGE_HUGETLB) {
+        void* ptr = grid_alloc_hugetlb(user_bytes);
+        if (ptr) {
+            return ptr;
+        }
+    }
+
+    void* ptr = grid_alloc_mapped(user_bytes, true);
+    if (ptr) {
+        return ptr;
+    }
+#endif
+    return grid_alloc_heap(user_bytes);
+}
+
+static const GridAllocHeader* grid_header_of(const void* ptr) {
+    if (!ptr) {
+        return NULL;
+    }
+    const GridAllocHeader* header = (const GridAllocHeader*)((const uint8_t*)ptr - GRID_ALLOC_HEADER_SIZE);
+    if (header->magic != GRID_ALLOC_MAGIC || header->backing > GRID_BACKING_HUGETLB) {
+        return NULL;
+    }
+    return header;
+}
+
+void ferox_grid_free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    GridAllocHeader* header = (GridAllocHeader*)grid_header_of(ptr);
+    if (!header) {
+        return;
+    }
+    header->magic = 0;
+    atomic_fetch_sub_explicit(&g_backing_bytes[header->backing], header->user_bytes, memory_order_relaxed);
+
+    if (header->backing == GRID_BACKING_HEAP) {
+        free(header->base);
+        return;
+    }
+#ifdef FEROX_GRID_ALLOC_HAVE_MMAP
+    munmap(header->base, header->map_len);
+#endif
+}
+
+static size_t grid_system_page_size(void) {
+#ifdef FEROX_GRID_ALLOC_HAVE_MMAP
+    long page = sysconf(_SC_PAGESIZE);
+    if (page > 0) {
+        return (size_t)page;
+    }
+#endif
+    return 4096;
+}
+
+size_t ferox_grid_page_size(const void* ptr) {
+    const GridAllocHeader* header = grid_header_of(ptr);
+    if (header && (header->backing == GRID_BACKING_THP || header->backing == GRID_BACKING_HUGETLB)) {
+        return GRID_ALLOC_HUGE_PAGE;
+    }
+    return grid_system_page_size();
+}
+
+const char* ferox_grid_backing_name(const void* ptr) {
+    const GridAllocHeader* header = grid_header_of(ptr);
+    if (!header) {
+        return "unknown";
+    }
+    switch ((GridBacking)header->backing) {
+        case GRID_BACKING_MMAP:
+            return "4k-mmap";
+        case GRID_BACKING_THP:
+            return "thp";
+        case GRID_BACKING_HUGETLB:
+            return "hugetlb";
+        case GRID_BACKING_HEAP:
+        default:
+            return "heap";
+    }
+}
+
+void ferox_grid_alloc_get_stats(FeroxGridAllocStats* stats) {
+    if (!stats) {
+        return;
+    }
+    stats->heap_bytes = atomic_load_explicit(&g_backing_bytes[GRID_BACKING_HEAP], memory_order_relaxed);
+    stats->mmap_bytes = atomic_load_explicit(&g_backing_bytes[GRID_BACKING_MMAP], memory_order_relaxed);
+    stats->thp_bytes = atomic_load_explicit(&g_backing_bytes[GRID_BACKING_THP], memory_order_relaxed);
+    stats->hugetlb_bytes = atomic_load_explicit(&g_backing_bytes[GRID_BACKING_HUGETLB], memory_order_relaxed);
+    stats->hugetlb_failures = atomic_load_explicit(&g_hugetlb_failures, memory_order_relaxed);
+}
+
+// Sum a "Key:   N kB" field from /proc/self/smaps_rollup; -1 if unavailable.
+static long long read_smaps_rollup_kb(const char* key) {
+    FILE* fp = fopen("/proc/self/smaps_rollup", "r");
+    if (!fp) {
+        return -1;
+    }
+
+    long long total = -1;
+    size_t key_len = strlen(key);
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, key, key_len) == 0 && line[key_len] == ':') {
+            total = strtoll(line + key_len + 1, NULL, 10);
+            break;
+        }
+    }
+    fclose(fp);
+    return total;
+}
+
+void ferox_grid_alloc_print_report(FILE* stream) {
+    if (!stream) {
+        return;
+    }
+
+    FeroxGridAllocStats stats;
+    ferox_grid_alloc_get_stats(&stats);
+    const double mib = 1024.0 * 1024.0;
+
+    fprintf(stream, "Grid storage:    hugepages=%s hugetlb=%.1f MiB thp-advised=%.1f MiB 4k-mmap=%.1f MiB heap=%.1f MiB",
+            ferox_hugepage_mode_name(ferox_grid_alloc_get_mode()),
+            (double)stats.hugetlb_bytes / mib,
+            (double)stats.thp_bytes / mib,
+            (double)stats.mmap_bytes / mib,
+            (double)stats.heap_bytes / mib);
+    if (stats.hugetlb_failures > 0) {
+        fprintf(stream, " (hugetlb fallbacks=%llu)", (unsigned long long)stats.hugetlb_failures);
+    }
+    fprintf(stream, "\n");
+
+    long long anon_huge_kb = read_smaps_rollup_kb("AnonHugePages");
+    if (anon_huge_kb >= 0) {
+        fprintf(stream, "                 kernel AnonHugePages=%.1f MiB\n", (double)anon_huge_kb / 1024.0);
+    }
+}
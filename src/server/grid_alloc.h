@@ -0,0 +1,81 @@
+#ifndef FEROX_GRID_ALLOC_H
+#define FEROX_GRID_ALLOC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Zeroed storage for per-cell arrays (world fields, atomic grid buffers).
+ *
+ * Allocations of at least FEROX_GRID_ALLOC_HUGE_MIN bytes are served by
+ * anonymous mmap and backed by 2 MB pages when the mode allows it:
+ * - off:     plain heap allocation
+ * - thp:     2 MB aligned mapping + madvise(MADV_HUGEPAGE)
+ * - hugetlb: MAP_HUGETLB from the reserved pool, falling back to thp
+ * Smaller requests always use the heap. No path touches the returned pages,
+ * so callers decide which thread (and NUMA node) faults them in. Every
+ * fallback is silent; the stats and report show what was actually obtained.
+ */
+
+#define FEROX_GRID_ALLOC_HUGE_MIN ((size_t)2 * 1024 * 1024)
+
+typedef enum {
+    FEROX_HUGEPAGE_OFF = 0,
+    FEROX_HUGEPAGE_THP,
+    FEROX_HUGEPAGE_HUGETLB
+} FeroxHugePageMode;
+
+typedef struct {
+    uint64_t heap_bytes;       // Live bytes on the heap (small or mode=off)
+    uint64_t mmap_bytes;       // Live bytes mapped with 4 KB pages only
+    uint64_t thp_bytes;        // Live bytes mapped with MADV_HUGEPAGE accepted
+    uint64_t hugetlb_bytes;    // Live bytes mapped with MAP_HUGETLB
+    uint64_t hugetlb_failures; // MAP_HUGETLB attempts that fell back
+} FeroxGridAllocStats;
+
+/**
+ * Parse "off", "thp" or "hugetlb" (case-insensitive).
+ * @return true on success
+ */
+bool ferox_hugepage_mode_from_string(const char* raw, FeroxHugePageMode* out);
+const char* ferox_hugepage_mode_name(FeroxHugePageMode mode);
+
+/**
+ * Current mode. Defaults to FEROX_HUGEPAGES from the environment (thp when
+ * unset or invalid) the first time it is needed.
+ */
+FeroxHugePageMode ferox_grid_alloc_get_mode(void);
+void ferox_grid_alloc_set_mode(FeroxHugePageMode mode);
+
+/**
+ * Allocate count * size zeroed bytes, cacheline aligned.
+ * @return pointer to release with ferox_grid_free(), or NULL on failure/overflow
+ */
+void* ferox_grid_calloc(size_t count, size_t size);
+void ferox_grid_free(void* ptr);
+
+/**
+ * Page size backing a ferox_grid_calloc() block: 2 MB for thp/hugetlb
+ * mappings, the system page size for 4 KB mappings and the heap. First-touch
+ * placement has to split work on this granularity, since one page lands
+ * whole on the node of whichever thread faults it in.
+ */
+size_t ferox_grid_page_size(const void* ptr);
+
+/**
+ * Backing actually used for a block: "heap", "4k-mmap", "thp", "hugetlb",
+ * or "unknown" for pointers not from ferox_grid_calloc().
+ */
+const char* ferox_grid_backing_name(const void* ptr);
+
+void ferox_grid_alloc_get_stats(FeroxGridAllocStats* stats);
+
+/**
+ * Print mode, live bytes per backing, and (on Linux) the AnonHugePages the
+ * kernel actually assigned to this process.
+ */
+void ferox_grid_alloc_print_report(FILE* stream);
+
+#endif // FEROX_GRID_ALLOC_H
@@ -0,0 +1,168 @@
+#include "grid_pyramid.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Majority id of the (up to) 2x2 children of cell (x, y).
+static uint32_t grid_pyramid_majority(const uint32_t* child, uint32_t child_width, uint32_t child_height,
+                                      uint32_t x, uint32_t y) {
+    uint32_t ids[4] = { 0 };
+    uint32_t count = 0;
+    for (uint32_t cy = y * 2; cy < y * 2 + 2 && cy < child_height; cy++) {
+        for (uint32_t cx = x * 2; cx < x * 2 + 2 && cx < child_width; cx++) {
+            ids[count++] = child[(size_t)cy * child_width + cx];
+        }
+    }
+
+    uint32_t best = ids[0];
+    uint32_t best_votes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t votes = 0;
+        for (uint32_t j = 0; j < count; j++) {
+            votes += ids[j] == ids[i];
+        }
+        if (votes > best_votes || (votes == best_votes && best == 0 && ids[i] != 0)) {
+            best = ids[i];
+            best_votes = votes;
+        }
+    }
+    return best;
+}
+
+static void grid_pyramid_mark_level(GridPyramid* pyramid, uint32_t level, uint32_t x, uint32_t y) {
+    GridPyramidLevel* dst = &pyramid->levels[level];
+    uint32_t index = y * dst->width + x;
+    if (!dst->dirty_flag[index]) {
+        dst->dirty_flag[index] = 1;
+        dst->dirty[dst->dirty_count++] = index;
+    }
+}
+
+void grid_pyramid_init(GridPyramid* pyramid) {
+    if (!pyramid) return;
+    memset(pyramid, 0, sizeof(*pyramid));
+}
+
+void grid_pyramid_destroy(GridPyramid* pyramid) {
+    if (!pyramid) return;
+    for (uint32_t level = 1; level <= PROTO_GRID_MAX_LEVEL; level++) {
+        GridPyramidLevel* dst = &pyramid->levels[level];
+        free(dst->cells);
+        free(dst->changed_tick);
+        free(dst->dirty);
+        free(dst->dirty_flag);
+    }
+    grid_pyramid_init(pyramid);
+}
+
+int grid_pyramid_build(GridPyramid* pyramid, const uint32_t* base,
+                       uint32_t width, uint32_t height, uint32_t tick) {
+    if (!pyramid || !base || width == 0 || height == 0) {
+        return -1;
+    }
+
+    uint32_t level_count = 0;
+    while (level_count < PROTO_GRID_MAX_LEVEL &&
+           (proto_grid_level_dim(width, level_count) > 1 || proto_grid_level_dim(height, level_count) > 1)) {
+        level_count++;
+    }
+
+    // Reuse buffers when the dimensions did not change
+    bool same_shape = pyramid->base_width == width && pyramid->base_height == height &&
+                      pyramid->level_count == level_count;
+    if (!same_shape) {
+        grid_pyramid_destroy(pyramid);
+    }
+
+    const uint32_t* child = base;
+    uint32_t child_width = width;
+    uint32_t child_height = height;
+    for (uint32_t level = 1; level <= level_count; level++) {
+        GridPyramidLevel* dst = &pyramid->levels[level];
+        dst->width = proto_grid_level_dim(width, level);
+        dst->height = proto_grid_level_dim(height, level);
+        size_t cells = (size_t)dst->width * dst->height;
+        if (!same_shape) {
+            dst->cells = (uint32_t*)malloc(cells * sizeof(uint32_t));
+            dst->changed_tick = (uint32_t*)malloc(cells * sizeof(uint32_t));
+            dst->dirty = (uint32_t*)malloc(cells * sizeof(uint32_t));
+            dst->dirty_flag = (uint8_t*)calloc(cells, 1);
+            if (!dst->cells || !dst->changed_tick || !dst->dirty || !dst->dirty_flag) {
+                grid_pyramid_destroy(pyramid);
+                return -1;
+            }
+        } else {
+            memset(dst->dirty_flag, 0, cells);
+        }
+        dst->dirty_count = 0;
+
+        for (uint32_t y = 0; y < dst->height; y++) {
+            for (uint32_t x = 0; x < dst->width; x++) {
+                dst->cells[(size_t)y * dst->width + x] =
+                    grid_pyramid_majority(child, child_width, child_height, x, y);
+            }
+        }
+        for (size_t i = 0; i < cells; i++) {
+            dst->changed_tick[i] = tick;
+        }
+
+        child = dst->cells;
+        child_width = dst->width;
+        child_height = dst->height;
+    }
+
+    pyramid->base_width = width;
+    pyramid->base_height = height;
+    pyramid->level_count = level_count;
+    pyramid->floor_tick = tick;
+    return 0;
+}
+
+void grid_pyramid_mark(GridPyramid* pyramid, uint32_t index) {
+    if (!pyramid || pyramid->level_count == 0) {
+        return;
+    }
+    uint32_t x = index % pyramid->base_width;
+    uint32_t y = index / pyramid->base_width;
+    grid_pyramid_mark_level(pyramid, 1, x / 2, y / 2);
+}
+
+void grid_pyramid_update(GridPyramid* pyramid, const uint32_t* base, uint32_t tick) {
+    if (!pyramid || !base) {
+        return;
+    }
+
+    const uint32_t* child = base;
+    uint32_t child_width = pyramid->base_width;
+    uint32_t child_height = pyramid->base_height;
+    for (uint32_t level = 1; level <= pyramid->level_count; level++) {
+        GridPyramidLevel* dst = &pyramid->levels[level];
+        for (uint32_t d = 0; d < dst->dirty_count; d++) {
+            uint32_t index = dst->dirty[d];
+            dst->dirty_flag[index] = 0;
+            uint32_t x = index % dst->width;
+            uint32_t y = index / dst->width;
+            uint32_t id = grid_pyramid_majority(child, child_width, child_height, x, y);
+            if (id == dst->cells[index]) {
+                continue;
+            }
+            dst->cells[index] = id;
+            dst->changed_tick[index] = tick;
+            if (level < pyramid->level_count) {
+                grid_pyramid_mark_level(pyramid, level + 1, x / 2, y / 2);
+            }
+        }
+        dst->dirty_count = 0;
+
+        child = dst->cells;
+        child_width = dst->width;
+        child_height = dst->height;
+    }
+}
+
+const GridPyramidLevel* grid_pyramid_level(const GridPyramid* pyramid, uint32_t level) {
+    if (!pyramid || level == 0 || level > pyramid->level_count) {
+        return NULL;
+    }
+    return &pyramid->levels[level];
+}
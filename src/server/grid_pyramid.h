@@ -0,0 +1,66 @@
+#ifndef FEROX_GRID_PYRAMID_H
+#define FEROX_GRID_PYRAMID_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../shared/protocol.h"
+
+/**
+ * Downsampled copies of the cell grid for zoomed-out clients.
+ *
+ * Level L has proto_grid_level_dim(width, L) x proto_grid_level_dim(height, L)
+ * cells; each holds the majority id of the 2x2 block below it (ties go to the
+ * first non-empty id in row order). Level 0 is the caller's grid and is not
+ * stored here.
+ *
+ * Updates are incremental: the caller marks base cells that changed, and
+ * grid_pyramid_update() recomputes only the parents of dirty blocks, walking
+ * up while a parent actually changes. Every level keeps the tick at which each
+ * cell last changed, so span deltas can be encoded per level exactly like the
+ * base grid.
+ *
+ * Not thread-safe; the server only touches it from the broadcasting thread.
+ */
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint32_t* cells;
+    uint32_t* changed_tick;  // Tick at which each cell last changed
+    uint32_t* dirty;         // Cells whose children changed since the last update
+    uint32_t dirty_count;
+    uint8_t* dirty_flag;     // Dedupes `dirty`
+} GridPyramidLevel;
+
+typedef struct {
+    uint32_t base_width;
+    uint32_t base_height;
+    uint32_t level_count;    // Levels 1..level_count are valid
+    uint32_t floor_tick;     // changed_tick values before this are unknown
+    GridPyramidLevel levels[PROTO_GRID_MAX_LEVEL + 1];  // levels[0] unused
+} GridPyramid;
+
+void grid_pyramid_init(GridPyramid* pyramid);
+void grid_pyramid_destroy(GridPyramid* pyramid);
+
+/**
+ * (Re)build every level from `base` and stamp all cells with `tick`.
+ * Levels stop once both dimensions reach 1 or at PROTO_GRID_MAX_LEVEL.
+ * @return 0 on success, -1 on allocation failure (the pyramid is left empty)
+ */
+int grid_pyramid_build(GridPyramid* pyramid, const uint32_t* base,
+                       uint32_t width, uint32_t height, uint32_t tick);
+
+// Record that base cell `index` changed; cheap and idempotent per block.
+void grid_pyramid_mark(GridPyramid* pyramid, uint32_t index);
+
+/**
+ * Recompute the parents of marked cells, level by level, from the current
+ * `base` grid. Cells whose majority changes get changed_tick = tick.
+ */
+void grid_pyramid_update(GridPyramid* pyramid, const uint32_t* base, uint32_t tick);
+
+// @return the level, or NULL if level is 0 or beyond level_count
+const GridPyramidLevel* grid_pyramid_level(const GridPyramid* pyramid, uint32_t level);
+
+#endif // FEROX_GRID_PYRAMID_H
@@ -1,4 +1,5 @@
 #include "hardware_profile.h"
+#include "cpu_topology.h"
 
 #include <ctype.h>
 #include <dirent.h>
@@ -83,6 +84,18 @@ static bool env_is_set(const char* name) {
     return raw && *raw;
 }
 
+static int io_reserved_cores_for(int core_budget) {
+    // Keep one core free for the accept/broadcast path once there are enough
+    // cores that losing one to IO costs less than workers preempting it.
+    return core_budget >= 4 ? 1 : 0;
+}
+
+static int encode_helpers_for(int core_budget) {
+    // Keyframe chunks only pay for extra encoders on wide hosts; they come
+    // out of the gang's share so encoding never waits on a tick's workers.
+    return core_budget / 8;
+}
+
 static int clamp_thread_count(int logical_cpus) {
     if (logical_cpus < 1) {
         return 1;
@@ -239,6 +252,7 @@ void ferox_hardware_info_init(FeroxHardwareInfo* info) {
     copy_string(info->arch_name, sizeof(info->arch_name), "unknown");
     copy_string(info->cpu_vendor, sizeof(info->cpu_vendor), "unknown");
     info->logical_cpus = 1;
+    info->numa_nodes = 1;
 }
 
 int ferox_detect_hardware(FeroxHardwareInfo* info) {
@@ -259,6 +273,11 @@ int ferox_detect_hardware(FeroxHardwareInfo* info) {
         info->logical_cpus = clamp_thread_count((int)cpus);
     }
 
+    FeroxCpuTopology topology;
+    if (ferox_cpu_topology_detect(&topology) == 0 && topology.node_count > 0) {
+        info->numa_nodes = topology.node_count;
+    }
+
 #if defined(__APPLE__)
     bool arm64_host = is_arm64_arch(info->arch_name);
     if (arm64_host) {
@@ -376,7 +395,20 @@ void ferox_runtime_tuning_init(
 
     memset(tuning, 0, sizeof(*tuning));
     tuning->requested = requested;
-    tuning->recommended_threads = clamp_thread_count(info ? info->logical_cpus : 1);
+    tuning->core_budget = clamp_thread_count(info ? info->logical_cpus : 1);
+    tuning->io_reserved_cores = io_reserved_cores_for(tuning->core_budget);
+    tuning->encode_helpers = encode_helpers_for(tuning->core_budget);
+    // What is left after the network, simulation and broadcast threads and
+    // the encode helpers; the simulation thread makes the gang one wider.
+    tuning->recommended_threads = tuning->core_budget - tuning->io_reserved_cores - 2 -
+                                  tuning->encode_helpers;
+    if (tuning->recommended_threads < 1) {
+        tuning->recommended_threads = 1;
+    }
+    tuning->pin_threads = info && info->numa_nodes > 1;
+    // THP needs no reserved pool and degrades to 4 KB pages on its own;
+    // hugetlb stays opt-in because it draws from an admin-sized pool.
+    tuning->hugepage_mode = "thp";
 
     switch (requested) {
         case FEROX_ACCELERATOR_PREFERENCE_CPU:
@@ -436,6 +468,20 @@ void ferox_apply_runtime_tuning_env(const FeroxRuntimeTuning* tuning) {
     if (!env_is_set("FEROX_ATOMIC_USE_FRONTIER")) {
         setenv("FEROX_ATOMIC_USE_FRONTIER", tuning->atomic_frontier_enabled ? "1" : "0", 0);
     }
+
+    if (tuning->hugepage_mode && !env_is_set("FEROX_HUGEPAGES")) {
+        setenv("FEROX_HUGEPAGES", tuning->hugepage_mode, 0);
+    }
+
+    if (!env_is_set("FEROX_ENCODE_HELPERS")) {
+        char value[16];
+        snprintf(value, sizeof(value), "%d", tuning->encode_helpers);
+        setenv("FEROX_ENCODE_HELPERS", value, 0);
+    }
+
+    if (!env_is_set("FEROX_PIN_THREADS")) {
+        setenv("FEROX_PIN_THREADS", tuning->pin_threads ? "1" : "0", 0);
+    }
 }
 
 void ferox_print_hardware_report(FILE* stream, const FeroxHardwareInfo* info, const FeroxRuntimeTuning* tuning) {
@@ -448,6 +494,7 @@ void ferox_print_hardware_report(FILE* stream, const FeroxHardwareInfo* info, co
     fprintf(stream, "  Arch: %s\n", info->arch_name);
     fprintf(stream, "  CPU vendor: %s\n", info->cpu_vendor);
     fprintf(stream, "  Logical CPUs: %d\n", info->logical_cpus);
+    fprintf(stream, "  NUMA nodes: %d\n", info->numa_nodes);
     fprintf(stream, "  GPU vendor: %s\n", info->gpu_vendor);
     fprintf(stream, "  Compute GPU available: %s\n", info->has_compute_gpu ? "yes" : "no");
     fprintf(stream, "  Unified memory: %s\n", info->unified_memory ? "yes" : "no");
@@ -455,7 +502,12 @@ void ferox_print_hardware_report(FILE* stream, const FeroxHardwareInfo* info, co
     fprintf(stream, "  Accelerator request: %s\n", ferox_accelerator_preference_name(tuning->requested));
     fprintf(stream, "  Selected target: %s\n", ferox_accelerator_backend_name(tuning->selected));
     fprintf(stream, "  GPU offload active: %s\n", tuning->gpu_offload_enabled ? "yes" : "no");
-    fprintf(stream, "  Recommended threads: %d\n", tuning->recommended_threads);
+    fprintf(stream, "  Core budget: %d (%d reserved for network/IO)\n",
+            tuning->core_budget, tuning->io_reserved_cores);
+    fprintf(stream, "  Encode helpers: %d\n", tuning->encode_helpers);
+    fprintf(stream, "  Recommended threads: %d (+1 simulation thread per gang)\n", tuning->recommended_threads);
+    fprintf(stream, "  Thread pinning default: %s\n", tuning->pin_threads ? "node-major" : "off");
+    fprintf(stream, "  Huge pages default: %s\n", tuning->hugepage_mode ? tuning->hugepage_mode : "thp");
     fprintf(stream, "  Threadpool profile default: %s\n", tuning->threadpool_profile ? tuning->threadpool_profile : "balanced");
     fprintf(stream, "  Atomic serial interval default: %d\n", tuning->atomic_serial_interval);
     fprintf(stream, "  Atomic frontier dense threshold default: %d%%\n", tuning->atomic_frontier_dense_pct);
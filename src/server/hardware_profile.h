@@ -23,6 +23,7 @@ typedef struct {
     char cpu_vendor[64];
     char gpu_vendor[64];
     int logical_cpus;
+    int numa_nodes;
     bool has_gpu;
     bool has_compute_gpu;
     bool has_apple_gpu;
@@ -33,11 +34,16 @@ typedef struct {
 typedef struct {
     FeroxAcceleratorPreference requested;
     FeroxAcceleratorBackend selected;
-    int recommended_threads;
+    int core_budget;          // Logical CPUs the server may keep runnable
+    int io_reserved_cores;    // Cores held back from the pool for network/IO
+    int encode_helpers;       // Keyframe encode threads beside the broadcast thread
+    int recommended_threads;  // Pool workers; see ferox_runtime_tuning_init()
     const char* threadpool_profile;
     int atomic_serial_interval;
     int atomic_frontier_dense_pct;
     bool atomic_frontier_enabled;
+    bool pin_threads;         // Pin pool workers node-major (default on multi-node hosts)
+    const char* hugepage_mode; // Grid storage backing: "off", "thp" or "hugetlb"
     bool gpu_offload_enabled;
     const char* reason;
 } FeroxRuntimeTuning;
@@ -49,6 +55,14 @@ bool ferox_accelerator_preference_from_string(const char* raw, FeroxAcceleratorP
 const char* ferox_accelerator_preference_name(FeroxAcceleratorPreference preference);
 const char* ferox_accelerator_backend_name(FeroxAcceleratorBackend backend);
 
+/**
+ * Fill in defaults for the detected hardware. The core budget is split as
+ * io_reserved_cores for the network thread, one core each for the
+ * simulation thread (which runs a slice of every gang) and the broadcast
+ * thread, encode_helpers, and recommended_threads pool workers. Below four
+ * cores the budget cannot cover those fixed threads and the pool keeps one
+ * worker anyway.
+ */
 void ferox_runtime_tuning_init(
     const FeroxHardwareInfo* info,
     FeroxAcceleratorPreference requested,
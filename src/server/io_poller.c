@@ -0,0 +1,163 @@
+#include "io_poller.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define IO_POLLER_EPOLL 1
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#include <sys/event.h>
+#include <sys/time.h>
+#define IO_POLLER_KQUEUE 1
+#endif
+
+#define IO_POLLER_WAKE_TAG UINT64_MAX
+#define IO_POLLER_BATCH 64
+
+int io_poller_init(IoPoller* poller) {
+    if (!poller) {
+        return -1;
+    }
+    poller->fd = -1;
+    poller->wake_fd = -1;
+
+#if defined(IO_POLLER_EPOLL)
+    poller->fd = epoll_create1(EPOLL_CLOEXEC);
+    if (poller->fd < 0) {
+        return -1;
+    }
+    poller->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.u64 = IO_POLLER_WAKE_TAG;
+    if (poller->wake_fd < 0 || epoll_ctl(poller->fd, EPOLL_CTL_ADD, poller->wake_fd, &ev) < 0) {
+        io_poller_destroy(poller);
+        return -1;
+    }
+    return 0;
+#elif defined(IO_POLLER_KQUEUE)
+    poller->fd = kqueue();
+    if (poller->fd < 0) {
+        return -1;
+    }
+    struct kevent change;
+    EV_SET(&change, 0, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, (void*)(uintptr_t)IO_POLLER_WAKE_TAG);
+    if (kevent(poller->fd, &change, 1, NULL, 0, NULL) < 0) {
+        io_poller_destroy(poller);
+        return -1;
+    }
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+void io_poller_destroy(IoPoller* poller) {
+    if (!poller) {
+        return;
+    }
+    if (poller->wake_fd >= 0) {
+        close(poller->wake_fd);
+    }
+    if (poller->fd >= 0) {
+        close(poller->fd);
+    }
+    poller->fd = -1;
+    poller->wake_fd = -1;
+}
+
+int io_poller_add(IoPoller* poller, int fd, uint64_t tag) {
+    if (!poller || poller->fd < 0 || fd < 0 || tag == IO_POLLER_WAKE_TAG) {
+        return -1;
+    }
+
+#if defined(IO_POLLER_EPOLL)
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.u64 = tag;
+    return epoll_ctl(poller->fd, EPOLL_CTL_ADD, fd, &ev) == 0 ? 0 : -1;
+#elif defined(IO_POLLER_KQUEUE)
+    struct kevent changes[2];
+    EV_SET(&changes[0], fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, (void*)(uintptr_t)tag);
+    EV_SET(&changes[1], fd, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0, (void*)(uintptr_t)tag);
+    return kevent(poller->fd, changes, 2, NULL, 0, NULL) == 0 ? 0 : -1;
+#else
+    (void)tag;
+    return -1;
+#endif
+}
+
+int io_poller_wait(IoPoller* poller, IoPollerEvent* events, int max_events, int timeout_ms) {
+    if (!poller || poller->fd < 0 || !events || max_events <= 0) {
+        return -1;
+    }
+    if (max_events > IO_POLLER_BATCH) {
+        max_events = IO_POLLER_BATCH;
+    }
+
+    int count = 0;
+#if defined(IO_POLLER_EPOLL)
+    struct epoll_event ready[IO_POLLER_BATCH];
+    int n = epoll_wait(poller->fd, ready, max_events, timeout_ms);
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    for (int i = 0; i < n; i++) {
+        if (ready[i].data.u64 == IO_POLLER_WAKE_TAG) {
+            uint64_t value;
+            ssize_t ignored = read(poller->wake_fd, &value, sizeof(value));
+            (void)ignored;
+            continue;
+        }
+        IoPollerEvent* out = &events[count++];
+        out->tag = ready[i].data.u64;
+        out->readable = (ready[i].events & EPOLLIN) != 0;
+        out->writable = (ready[i].events & EPOLLOUT) != 0;
+        out->closed = (ready[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0;
+    }
+#elif defined(IO_POLLER_KQUEUE)
+    struct kevent ready[IO_POLLER_BATCH];
+    struct timespec timeout;
+    struct timespec* timeout_ptr = NULL;
+    if (timeout_ms >= 0) {
+        timeout.tv_sec = timeout_ms / 1000;
+        timeout.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+        timeout_ptr = &timeout;
+    }
+    int n = kevent(poller->fd, NULL, 0, ready, max_events, timeout_ptr);
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    for (int i = 0; i < n; i++) {
+        uint64_t tag = (uint64_t)(uintptr_t)ready[i].udata;
+        if (ready[i].filter == EVFILT_USER) {
+            continue;
+        }
+        IoPollerEvent* out = &events[count++];
+        out->tag = tag;
+        out->readable = ready[i].filter == EVFILT_READ;
+        out->writable = ready[i].filter == EVFILT_WRITE;
+        out->closed = (ready[i].flags & (EV_EOF | EV_ERROR)) != 0;
+    }
+#else
+    (void)timeout_ms;
+#endif
+    return count;
+}
+
+void io_poller_wake(IoPoller* poller) {
+    if (!poller || poller->fd < 0) {
+        return;
+    }
+#if defined(IO_POLLER_EPOLL)
+    uint64_t one = 1;
+    ssize_t ignored = write(poller->wake_fd, &one, sizeof(one));
+    (void)ignored;
+#elif defined(IO_POLLER_KQUEUE)
+    struct kevent change;
+    EV_SET(&change, 0, EVFILT_USER, 0, NOTE_TRIGGER, 0, (void*)(uintptr_t)IO_POLLER_WAKE_TAG);
+    kevent(poller->fd, &change, 1, NULL, 0, NULL);
+#endif
+}
@@ -0,0 +1,49 @@
+#ifndef FEROX_IO_POLLER_H
+#define FEROX_IO_POLLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Edge-triggered readiness notification for the server I/O thread.
+ *
+ * Linux uses epoll with an eventfd for wake-ups; BSD/macOS use kqueue with
+ * EV_CLEAR and an EVFILT_USER trigger. Every registered fd reports both read
+ * and write readiness, once per transition, so the owner must drain reads
+ * and writes until EAGAIN. Closing an fd removes it from the set.
+ */
+typedef struct {
+    int fd;       // epoll or kqueue descriptor, -1 when not initialised
+    int wake_fd;  // eventfd (Linux only)
+} IoPoller;
+
+typedef struct {
+    uint64_t tag;
+    bool readable;
+    bool writable;
+    bool closed;  // Peer hung up or the socket reported an error
+} IoPollerEvent;
+
+/**
+ * @return 0 on success, -1 if the platform has no supported poller
+ */
+int io_poller_init(IoPoller* poller);
+void io_poller_destroy(IoPoller* poller);
+
+/**
+ * Watch `fd` for read and write readiness, reported under `tag`.
+ * @return 0 on success, -1 on failure
+ */
+int io_poller_add(IoPoller* poller, int fd, uint64_t tag);
+
+/**
+ * Wait up to timeout_ms (-1 = forever) for readiness or a wake-up.
+ * Wake-ups are consumed internally and not reported as events.
+ * @return number of events written, or -1 on failure
+ */
+int io_poller_wait(IoPoller* poller, IoPollerEvent* events, int max_events, int timeout_ms);
+
+// Interrupt a concurrent io_poller_wait. Async-signal-safe on Linux.
+void io_poller_wake(IoPoller* poller);
+
+#endif // FEROX_IO_POLLER_H
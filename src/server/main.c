@@ -13,6 +13,7 @@
 #include "server.h"
 #include "world.h"
 #include "atomic_sim.h"
+#include "grid_alloc.h"
 #include "hardware_profile.h"
 
 // Global server pointer for signal handler
@@ -34,9 +35,12 @@ static void print_usage(const char* program) {
     printf("  -p, --port <port>        Port to listen on (default: 8080, 0 for auto)\n");
     printf("  -w, --width <width>      World width (default: %d)\n", DEFAULT_WORLD_WIDTH);
     printf("  -H, --height <height>    World height (default: %d)\n", DEFAULT_WORLD_HEIGHT);
-    printf("  -t, --threads <count>    Thread pool size (default: detected logical CPUs)\n");
+    printf("  -t, --threads <count>    Thread pool size (default: logical CPUs minus IO reserve)\n");
     printf("  -c, --colonies <count>   Initial colony count (default: %d)\n", DEFAULT_INITIAL_COLONY_COUNT);
-    printf("  -r, --rate <ms>          Tick rate in milliseconds (default: %d)\n", DEFAULT_TICK_RATE_MS);
+    printf("  -r, --rate <ms>          Tick rate in milliseconds, 0 = as fast as possible (default: %d)\n",
+           DEFAULT_TICK_RATE_MS);
+    printf("  -f, --broadcast-hz <n>   World frames sent per second, 0 = every tick (default: %d)\n",
+           DEFAULT_BROADCAST_HZ);
     printf("  -a, --accelerator <id>   Accelerator target: auto, cpu, apple, amd\n");
     printf("      --print-hardware     Print detected hardware profile and exit\n");
     printf("  -h, --help               Show this help message\n");
@@ -50,6 +54,7 @@ int main(int argc, char* argv[]) {
     int thread_count = 0;
     int initial_colonies = DEFAULT_INITIAL_COLONY_COUNT;
     int tick_rate_ms = DEFAULT_TICK_RATE_MS;
+    int broadcast_hz = -1;  // FEROX_BROADCAST_HZ or the default unless given
     bool thread_count_overridden = false;
     bool accelerator_overridden = false;
     bool print_hardware_only = false;
@@ -63,6 +68,7 @@ int main(int argc, char* argv[]) {
         {"threads",  required_argument, 0, 't'},
         {"colonies", required_argument, 0, 'c'},
         {"rate",     required_argument, 0, 'r'},
+        {"broadcast-hz", required_argument, 0, 'f'},
         {"accelerator", required_argument, 0, 'a'},
         {"print-hardware", no_argument, 0, 1000},
         {"help",     no_argument,       0, 'h'},
@@ -72,7 +78,7 @@ int main(int argc, char* argv[]) {
     // Parse command line arguments
     int opt;
     int option_index = 0;
-    while ((opt = getopt_long(argc, argv, "p:w:H:t:c:r:a:h", long_options, &option_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "p:w:H:t:c:r:f:a:h", long_options, &option_index)) != -1) {
         switch (opt) {
             case 'p':
                 port = (uint16_t)atoi(optarg);
@@ -108,11 +114,18 @@ int main(int argc, char* argv[]) {
                 break;
             case 'r':
                 tick_rate_ms = atoi(optarg);
-                if (tick_rate_ms <= 0) {
+                if (tick_rate_ms < 0) {
                     fprintf(stderr, "Error: Invalid tick rate\n");
                     return 1;
                 }
                 break;
+            case 'f':
+                broadcast_hz = atoi(optarg);
+                if (broadcast_hz < 0) {
+                    fprintf(stderr, "Error: Invalid broadcast rate\n");
+                    return 1;
+                }
+                break;
             case 'a':
                 if (!ferox_accelerator_preference_from_string(optarg, &accelerator_pref)) {
                     fprintf(stderr, "Error: Invalid accelerator target '%s'\n", optarg);
@@ -170,9 +183,14 @@ int main(int argc, char* argv[]) {
     printf("Compute GPU:     %s\n", hardware.has_compute_gpu ? "detected" : "not detected");
     printf("Port:            %u%s\n", port, port == 0 ? " (auto)" : "");
     printf("World size:      %dx%d\n", world_width, world_height);
-    printf("Thread count:    %d\n", thread_count);
+    printf("Thread count:    %d (core budget %d, %d reserved for IO, %d encode helpers)\n",
+           thread_count, tuning.core_budget, tuning.io_reserved_cores, tuning.encode_helpers);
     printf("Initial colonies: %d\n", initial_colonies);
-    printf("Tick rate:       %d ms\n", tick_rate_ms);
+    if (tick_rate_ms > 0) {
+        printf("Tick rate:       %d ms\n", tick_rate_ms);
+    } else {
+        printf("Tick rate:       unpaced\n");
+    }
     printf("Thread profile:  %s\n", tuning.threadpool_profile);
     printf("Atomic tuning:   serial=%d frontier_dense=%d%%\n",
            tuning.atomic_serial_interval,
@@ -188,8 +206,13 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    ferox_grid_alloc_print_report(stdout);
+    
     // Set tick rate
     server->tick_rate_ms = tick_rate_ms;
+    if (broadcast_hz >= 0) {
+        server->broadcast_hz = broadcast_hz;
+    }
     server->default_colonies = initial_colonies;
     
     // Initialize colonies
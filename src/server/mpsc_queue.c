@@ -0,0 +1,46 @@
+#include "mpsc_queue.h"
+
+#include <stddef.h>
+
+void mpsc_queue_init(MpscQueue* queue) {
+    atomic_init(&queue->stub.next, NULL);
+    atomic_init(&queue->head, &queue->stub);
+    queue->tail = &queue->stub;
+}
+
+void mpsc_queue_push(MpscQueue* queue, MpscNode* node) {
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    MpscNode* prev = atomic_exchange_explicit(&queue->head, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+MpscNode* mpsc_queue_pop(MpscQueue* queue) {
+    MpscNode* tail = queue->tail;
+    MpscNode* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    if (tail == &queue->stub) {
+        if (!next) {
+            return NULL;
+        }
+        queue->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+
+    if (next) {
+        queue->tail = next;
+        return tail;
+    }
+
+    // tail is the last linked node; hand it out only once nothing is mid-push
+    if (tail != atomic_load_explicit(&queue->head, memory_order_acquire)) {
+        return NULL;
+    }
+    mpsc_queue_push(queue, &queue->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next) {
+        queue->tail = next;
+        return tail;
+    }
+    return NULL;
+}
@@ -0,0 +1,37 @@
+#ifndef FEROX_MPSC_QUEUE_H
+#define FEROX_MPSC_QUEUE_H
+
+#include <stdatomic.h>
+
+/**
+ * Intrusive lock-free multi-producer / single-consumer FIFO.
+ *
+ * Producers link a node with one atomic exchange on `head` and never wait on
+ * each other or on the consumer. The consumer walks from `tail` with plain
+ * loads. A producer preempted between its exchange and its link makes the
+ * queue look empty past that point until it resumes; pop simply returns NULL
+ * and the node is delivered on a later call. Embed MpscNode as the first
+ * member of the queued type; the queue never allocates or frees nodes.
+ */
+typedef struct MpscNode {
+    _Atomic(struct MpscNode*) next;
+} MpscNode;
+
+typedef struct {
+    _Atomic(MpscNode*) head;  // Producers exchange here
+    MpscNode* tail;           // Consumer only
+    MpscNode stub;
+} MpscQueue;
+
+void mpsc_queue_init(MpscQueue* queue);
+
+// Safe from any thread.
+void mpsc_queue_push(MpscQueue* queue, MpscNode* node);
+
+/**
+ * Dequeue the oldest fully linked node. Consumer thread only.
+ * @return the node, or NULL if nothing is ready
+ */
+MpscNode* mpsc_queue_pop(MpscQueue* queue);
+
+#endif // FEROX_MPSC_QUEUE_H
@@ -48,3 +48,130 @@ void phase_wake_all(atomic_int* value) {
     (void)value;
 #endif
 }
+
+void phase_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    atomic_signal_fence(memory_order_seq_cst);
+#endif
+}
+
+int phase_barrier_init(PhaseBarrier* barrier, int participants, int spin_limit) {
+    if (!barrier || participants < 1) {
+        return -1;
+    }
+
+    atomic_init(&barrier->sense, 0);
+    atomic_init(&barrier->remaining, participants);
+    atomic_init(&barrier->parked, 0);
+    barrier->participants = participants;
+    barrier->spin_limit = spin_limit < 0 ? PHASE_BARRIER_DEFAULT_SPINS : spin_limit;
+    atomic_init(&barrier->spin_waits, 0);
+    atomic_init(&barrier->park_waits, 0);
+    atomic_init(&barrier->releases, 0);
+    atomic_init(&barrier->wake_calls, 0);
+    atomic_init(&barrier->waits_expected, 0);
+    return 0;
+}
+
+bool phase_barrier_wait(PhaseBarrier* barrier, int* local_sense) {
+    int target = *local_sense ? 0 : 1;
+    *local_sense = target;
+
+    if (atomic_fetch_sub_explicit(&barrier->remaining, 1, memory_order_acq_rel) == 1) {
+        // Last arrival: re-arm the count before publishing the new sense so the
+        // next episode never observes a stale remaining value.
+        atomic_store_explicit(&barrier->remaining, barrier->participants, memory_order_relaxed);
+        atomic_fetch_add_explicit(&barrier->releases, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&barrier->waits_expected, (uint_fast64_t)(barrier->participants - 1),
+                                  memory_order_relaxed);
+        atomic_store_explicit(&barrier->sense, target, memory_order_release);
+
+        // Pairs with the fence on the parking side: either the waiter sees the
+        // flipped sense before sleeping, or we see its parked count here.
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&barrier->parked, memory_order_relaxed) > 0) {
+            atomic_fetch_add_explicit(&barrier->wake_calls, 1, memory_order_relaxed);
+            phase_wake_all(&barrier->sense);
+        }
+        return true;
+    }
+
+    for (int spin = 0; spin < barrier->spin_limit; spin++) {
+        if (atomic_load_explicit(&barrier->sense, memory_order_acquire) == target) {
+            // Last touch of the barrier; phase_barrier_quiesce() pairs with it
+            atomic_fetch_add_explicit(&barrier->spin_waits, 1, memory_order_release);
+            return false;
+        }
+        phase_cpu_relax();
+    }
+
+    atomic_fetch_add_explicit(&barrier->parked, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    phase_wait_eq(&barrier->sense, target ? 0 : 1);
+    atomic_fetch_sub_explicit(&barrier->parked, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&barrier->park_waits, 1, memory_order_release);
+    return false;
+}
+
+void phase_barrier_drop_participants(PhaseBarrier* barrier, int count) {
+    if (!barrier || count <= 0 || count >= barrier->participants) {
+        return;
+    }
+
+    barrier->participants -= count;
+    atomic_fetch_sub_explicit(&barrier->remaining, count, memory_order_acq_rel);
+}
+
+void phase_barrier_quiesce(const PhaseBarrier* barrier) {
+    if (!barrier) {
+        return;
+    }
+
+    // A waiter counts itself before it can arrive again, so counts from a
+    // later episode never stand in for a straggler of an earlier one.
+    uint64_t expected = (uint64_t)atomic_load_explicit(&barrier->waits_expected, memory_order_acquire);
+    for (;;) {
+        uint64_t counted = (uint64_t)atomic_load_explicit(&barrier->spin_waits, memory_order_acquire) +
+                           (uint64_t)atomic_load_explicit(&barrier->park_waits, memory_order_acquire);
+        if (counted >= expected) {
+            return;
+        }
+        phase_cpu_relax();
+    }
+}
+
+void phase_barrier_get_stats(const PhaseBarrier* barrier, PhaseBarrierStats* stats) {
+    if (!stats) {
+        return;
+    }
+    if (!barrier) {
+        stats->spin_waits = 0;
+        stats->park_waits = 0;
+        stats->releases = 0;
+        stats->wake_calls = 0;
+        return;
+    }
+
+    phase_barrier_quiesce(barrier);
+    stats->spin_waits = (uint64_t)atomic_load_explicit(&barrier->spin_waits, memory_order_relaxed);
+    stats->park_waits = (uint64_t)atomic_load_explicit(&barrier->park_waits, memory_order_relaxed);
+    stats->releases = (uint64_t)atomic_load_explicit(&barrier->releases, memory_order_relaxed);
+    stats->wake_calls = (uint64_t)atomic_load_explicit(&barrier->wake_calls, memory_order_relaxed);
+}
+
+void phase_barrier_reset_stats(PhaseBarrier* barrier) {
+    if (!barrier) {
+        return;
+    }
+
+    // Expectation first, so a concurrent quiesce never waits on counts just cleared
+    atomic_store_explicit(&barrier->waits_expected, 0, memory_order_relaxed);
+    atomic_store_explicit(&barrier->spin_waits, 0, memory_order_relaxed);
+    atomic_store_explicit(&barrier->park_waits, 0, memory_order_relaxed);
+    atomic_store_explicit(&barrier->releases, 0, memory_order_relaxed);
+    atomic_store_explicit(&barrier->wake_calls, 0, memory_order_relaxed);
+}
@@ -2,9 +2,82 @@
 #define FEROX_PHASE_WAIT_H
 
 #include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../shared/cacheline.h"
+
+#define PHASE_BARRIER_DEFAULT_SPINS 4096
 
 void phase_wait_backoff(int* spin_count);
 void phase_wait_eq(atomic_int* value, int expected);
 void phase_wake_all(atomic_int* value);
+void phase_cpu_relax(void);
+
+/**
+ * Sense-reversing barrier with a bounded spin before parking.
+ *
+ * Arrivals count down on `remaining`; the last arrival resets the count and
+ * flips `sense`, which doubles as the futex word. Waiters poll `sense` with a
+ * pause hint for up to `spin_limit` iterations and only then park, so short
+ * phases complete without a kernel round trip. `parked` lets the releaser skip
+ * the wake syscall when every waiter was still spinning.
+ *
+ * A waiter only knows whether it spun or parked once it has been released, so
+ * it counts itself on the way out. The releaser adds the episode's waiters to
+ * `waits_expected` before releasing, which lets readers of the counters wait
+ * for stragglers instead of seeing a released episode half counted.
+ */
+typedef struct {
+    FEROX_CACHELINE_ALIGN atomic_int sense;
+    atomic_int remaining;
+    atomic_int parked;
+    int participants;
+    int spin_limit;
+    FEROX_CACHELINE_ALIGN atomic_uint_fast64_t spin_waits;
+    atomic_uint_fast64_t park_waits;
+    atomic_uint_fast64_t releases;
+    atomic_uint_fast64_t wake_calls;
+    atomic_uint_fast64_t waits_expected;  // Waiters of every released episode
+} PhaseBarrier;
+
+typedef struct {
+    uint64_t spin_waits;  // Waits satisfied while spinning
+    uint64_t park_waits;  // Waits that had to park in the kernel
+    uint64_t releases;    // Episodes completed (one per last arrival)
+    uint64_t wake_calls;  // Releases that issued a wake syscall
+} PhaseBarrierStats;
+
+/**
+ * Initialize a barrier for `participants` threads.
+ * A negative spin_limit selects PHASE_BARRIER_DEFAULT_SPINS.
+ * @return 0 on success, -1 on invalid arguments
+ */
+int phase_barrier_init(PhaseBarrier* barrier, int participants, int spin_limit);
+
+/**
+ * Block until all participants have arrived.
+ * `local_sense` is per-thread state, initialized to 0 and owned by the caller.
+ * @return true for exactly one participant per episode (the releaser)
+ */
+bool phase_barrier_wait(PhaseBarrier* barrier, int* local_sense);
+
+/**
+ * Permanently remove `count` participants (e.g. workers that failed to start).
+ * Must be called by a participant that has not yet arrived in the current
+ * episode, so the barrier can never be released by the drop itself.
+ */
+void phase_barrier_drop_participants(PhaseBarrier* barrier, int count);
+
+/**
+ * Wait until every waiter of the episodes released so far has counted itself
+ * and stopped touching the barrier. Waiters of a released episode only have a
+ * few instructions left, so this spins.
+ */
+void phase_barrier_quiesce(const PhaseBarrier* barrier);
+
+// Quiesces first, so the wait counts cover every released episode.
+void phase_barrier_get_stats(const PhaseBarrier* barrier, PhaseBarrierStats* stats);
+void phase_barrier_reset_stats(PhaseBarrier* barrier);
 
 #endif // FEROX_PHASE_WAIT_H
@@ -0,0 +1,406 @@
+#include "send_queue.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#if defined(__linux__)
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define SEND_QUEUE_HAVE_ZEROCOPY 1
+#endif
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+int send_queue_init(ClientSendQueue* queue, size_t max_frames, size_t max_bytes) {
+    if (!queue) {
+        return -1;
+    }
+
+    memset(queue, 0, sizeof(*queue));
+    queue->capacity = max_frames > 0 ? max_frames : SEND_QUEUE_DEFAULT_MAX_FRAMES;
+    queue->max_bytes = max_bytes > 0 ? max_bytes : SEND_QUEUE_DEFAULT_MAX_BYTES;
+    queue->entries = (SendQueueEntry*)calloc(queue->capacity, sizeof(SendQueueEntry));
+    if (!queue->entries) {
+        queue->capacity = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void send_queue_destroy(ClientSendQueue* queue) {
+    if (!queue) {
+        return;
+    }
+
+    for (size_t i = 0; i < queue->count; i++) {
+        proto_frame_release(queue->entries[(queue->head + i) % queue->capacity].frame);
+    }
+    for (size_t i = 0; i < queue->pinned_count; i++) {
+        proto_frame_release(queue->pinned[i].frame);
+    }
+    free(queue->entries);
+    free(queue->pinned);
+    memset(queue, 0, sizeof(*queue));
+}
+
+static void send_queue_note_bytes(ClientSendQueue* queue) {
+    if (queue->stats.queued_bytes > queue->stats.peak_queued_bytes) {
+        queue->stats.peak_queued_bytes = queue->stats.queued_bytes;
+    }
+    queue->stats.queued_frames = queue->count;
+}
+
+static int send_queue_grow(ClientSendQueue* queue) {
+    size_t new_capacity = queue->capacity > 0 ? queue->capacity * 2 : SEND_QUEUE_DEFAULT_MAX_FRAMES;
+    SendQueueEntry* entries = (SendQueueEntry*)calloc(new_capacity, sizeof(SendQueueEntry));
+    if (!entries) {
+        return -1;
+    }
+    for (size_t i = 0; i < queue->count; i++) {
+        entries[i] = queue->entries[(queue->head + i) % queue->capacity];
+    }
+    free(queue->entries);
+    queue->entries = entries;
+    queue->capacity = new_capacity;
+    queue->head = 0;
+    return 0;
+}
+
+static void send_queue_append(ClientSendQueue* queue, ProtoFrame* frame, uint32_t group, uint8_t frame_class) {
+    SendQueueEntry* entry = &queue->entries[(queue->head + queue->count) % queue->capacity];
+    entry->frame = proto_frame_retain(frame);
+    entry->group = group;
+    entry->frame_class = frame_class;
+    queue->count++;
+    queue->stats.queued_bytes += proto_frame_wire_size(frame);
+}
+
+int send_queue_push_control(ClientSendQueue* queue, ProtoFrame* frame) {
+    if (!queue || !frame) {
+        return -1;
+    }
+
+    size_t bytes = proto_frame_wire_size(frame);
+    if (queue->stats.queued_bytes + bytes > queue->max_bytes * SEND_QUEUE_CONTROL_OVERRUN) {
+        return -1;
+    }
+    // Control frames are never refused for lack of slots.
+    if (queue->count == queue->capacity && send_queue_grow(queue) < 0) {
+        return -1;
+    }
+
+    send_queue_append(queue, frame, queue->next_group++, SEND_FRAME_CONTROL);
+    send_queue_note_bytes(queue);
+    return 0;
+}
+
+int send_queue_push_world(ClientSendQueue* queue, ProtoFrame* const* frames, size_t count, bool keyframe) {
+    if (!queue || (!frames && count > 0)) {
+        return 1;
+    }
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        bytes += proto_frame_wire_size(frames[i]);
+    }
+
+    // An empty queue always accepts one group so oversized keyframes still go out.
+    if (queue->count + count > queue->capacity ||
+        (queue->count > 0 && queue->stats.queued_bytes + bytes > queue->max_bytes)) {
+        queue->stats.world_groups_dropped++;
+        return 1;
+    }
+
+    uint32_t group = queue->next_group++;
+    uint8_t frame_class = keyframe ? SEND_FRAME_KEYFRAME : SEND_FRAME_WORLD;
+    for (size_t i = 0; i < count; i++) {
+        send_queue_append(queue, frames[i], group, frame_class);
+    }
+    send_queue_note_bytes(queue);
+    return 0;
+}
+
+size_t send_queue_drop_pending_world(ClientSendQueue* queue, bool* dropped_keyframe) {
+    if (dropped_keyframe) {
+        *dropped_keyframe = false;
+    }
+    if (!queue || queue->count == 0) {
+        return 0;
+    }
+
+    size_t kept = 0;
+    size_t groups = 0;
+    bool have_last_dropped = false;
+    uint32_t last_dropped_group = 0;
+    for (size_t i = 0; i < queue->count; i++) {
+        SendQueueEntry entry = queue->entries[(queue->head + i) % queue->capacity];
+        bool started = queue->has_started_group && entry.group == queue->started_group;
+        if (entry.frame_class == SEND_FRAME_CONTROL || started || (i == 0 && queue->head_offset > 0)) {
+            queue->entries[(queue->head + kept) % queue->capacity] = entry;
+            kept++;
+            continue;
+        }
+
+        if (!have_last_dropped || entry.group != last_dropped_group) {
+            groups++;
+            have_last_dropped = true;
+            last_dropped_group = entry.group;
+        }
+        if (entry.frame_class == SEND_FRAME_KEYFRAME && dropped_keyframe) {
+            *dropped_keyframe = true;
+        }
+        queue->stats.queued_bytes -= proto_frame_wire_size(entry.frame);
+        proto_frame_release(entry.frame);
+    }
+
+    queue->count = kept;
+    queue->stats.world_groups_coalesced += groups;
+    queue->stats.queued_frames = queue->count;
+    return groups;
+}
+
+bool send_queue_has_pending(const ClientSendQueue* queue) {
+    return queue && queue->count > 0;
+}
+
+int send_queue_enable_zerocopy(ClientSendQueue* queue, int fd, size_t min_bytes) {
+    if (!queue || fd < 0 || min_bytes == 0) {
+        return -1;
+    }
+#if defined(SEND_QUEUE_HAVE_ZEROCOPY)
+    int one = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0) {
+        queue->zerocopy_min = min_bytes;
+        return 0;
+    }
+#endif
+    return -1;
+}
+
+// Make room for `extra` more pins, so pinning after a send cannot fail.
+static int send_queue_reserve_pins(ClientSendQueue* queue, size_t extra) {
+    if (queue->pinned_count + extra <= queue->pinned_capacity) {
+        return 0;
+    }
+    size_t capacity = queue->pinned_capacity > 0 ? queue->pinned_capacity : 16;
+    while (capacity < queue->pinned_count + extra) {
+        capacity *= 2;
+    }
+    SendQueuePinned* pinned = (SendQueuePinned*)realloc(queue->pinned, capacity * sizeof(SendQueuePinned));
+    if (!pinned) {
+        return -1;
+    }
+    queue->pinned = pinned;
+    queue->pinned_capacity = capacity;
+    return 0;
+}
+
+// Caller has reserved the slot with send_queue_reserve_pins.
+static void send_queue_pin(ClientSendQueue* queue, ProtoFrame* frame, uint32_t id) {
+    queue->pinned[queue->pinned_count].frame = proto_frame_retain(frame);
+    queue->pinned[queue->pinned_count].id = id;
+    queue->pinned_count++;
+}
+
+// Release frames whose zerocopy sends the kernel has finished with.
+static void send_queue_reap_zerocopy(ClientSendQueue* queue, int fd) {
+#if defined(SEND_QUEUE_HAVE_ZEROCOPY)
+    while (queue->pinned_count > 0) {
+        uint8_t control[128];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            break;
+        }
+
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            bool recverr = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                           (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+            if (!recverr) {
+                continue;
+            }
+            struct sock_extended_err err;
+            memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+            if (err.ee_errno != 0 || err.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+            // Completions cover the inclusive id range [ee_info, ee_data]
+            uint32_t hi = err.ee_data;
+            if (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                queue->stats.zerocopy_copied += (uint64_t)(hi - err.ee_info) + 1u;
+            }
+            size_t done = 0;
+            while (done < queue->pinned_count && (int32_t)(queue->pinned[done].id - hi) <= 0) {
+                proto_frame_release(queue->pinned[done].frame);
+                done++;
+            }
+            memmove(queue->pinned, queue->pinned + done, (queue->pinned_count - done) * sizeof(SendQueuePinned));
+            queue->pinned_count -= done;
+        }
+    }
+#else
+    (void)fd;
+#endif
+    queue->stats.zerocopy_pending = queue->pinned_count;
+}
+
+// Gather [header, payload] slices from the head onwards, honouring head_offset.
+// @return iovec entries used; *frames_out is the number of frames touched
+static int send_queue_gather(const ClientSendQueue* queue, struct iovec* iov, size_t* frames_out,
+                             bool* has_large_payload) {
+    int iov_count = 0;
+    size_t frames = 0;
+    size_t skip = queue->head_offset;
+    *has_large_payload = false;
+
+    while (frames < queue->count && iov_count + 2 <= SEND_QUEUE_MAX_IOV) {
+        const ProtoFrame* frame = queue->entries[(queue->head + frames) % queue->capacity].frame;
+        if (skip < MESSAGE_HEADER_SIZE) {
+            iov[iov_count].iov_base = (void*)(frame->header + skip);
+            iov[iov_count].iov_len = MESSAGE_HEADER_SIZE - skip;
+            iov_count++;
+            skip = 0;
+        } else {
+            skip -= MESSAGE_HEADER_SIZE;
+        }
+        if (frame->payload_len > skip) {
+            iov[iov_count].iov_base = frame->payload + skip;
+            iov[iov_count].iov_len = frame->payload_len - skip;
+            iov_count++;
+            if (queue->zerocopy_min > 0 && frame->payload_len - skip >= queue->zerocopy_min) {
+                *has_large_payload = true;
+            }
+        }
+        skip = 0;
+        frames++;
+    }
+
+    *frames_out = frames;
+    return iov_count;
+}
+
+// Retire `sent` bytes from the front of the queue.
+static void send_queue_advance(ClientSendQueue* queue, size_t sent) {
+    queue->stats.queued_bytes -= sent;
+    queue->stats.bytes_sent += (uint64_t)sent;
+
+    while (sent > 0 && queue->count > 0) {
+        SendQueueEntry* entry = &queue->entries[queue->head];
+        size_t remaining = proto_frame_wire_size(entry->frame) - queue->head_offset;
+        queue->started_group = entry->group;
+        queue->has_started_group = true;
+        if (sent < remaining) {
+            queue->head_offset += sent;
+            return;
+        }
+        sent -= remaining;
+        proto_frame_release(entry->frame);
+        entry->frame = NULL;
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+        queue->head_offset = 0;
+        queue->stats.frames_sent++;
+    }
+}
+
+int send_queue_flush(ClientSendQueue* queue, int fd, bool wait) {
+    if (!queue || fd < 0) {
+        return -1;
+    }
+
+    if (queue->pinned_count > 0) {
+        send_queue_reap_zerocopy(queue, fd);
+    }
+
+    struct iovec iov[SEND_QUEUE_MAX_IOV];
+    while (queue->count > 0) {
+        size_t frames = 0;
+        bool large = false;
+        int iov_count = send_queue_gather(queue, iov, &frames, &large);
+
+        int flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+#if defined(SEND_QUEUE_HAVE_ZEROCOPY)
+        // Pages handed over by MSG_ZEROCOPY must stay pinned until the
+        // kernel reports completion, so without room to record the frames
+        // this batch goes by copy instead
+        if (large && send_queue_reserve_pins(queue, frames) != 0) {
+            large = false;
+        }
+        if (large) {
+            flags |= MSG_ZEROCOPY;
+        }
+#endif
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iov_count;
+
+        ssize_t n = sendmsg(fd, &msg, flags);
+#if defined(SEND_QUEUE_HAVE_ZEROCOPY)
+        if (n < 0 && errno == ENOBUFS && (flags & MSG_ZEROCOPY)) {
+            // Out of pinned-page budget (optmem): send this batch by copy
+            large = false;
+            n = sendmsg(fd, &msg, flags & ~MSG_ZEROCOPY);
+        }
+#endif
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!wait) {
+                    queue->stats.send_would_block++;
+                    return 0;
+                }
+                struct pollfd pfd = { .fd = fd, .events = POLLOUT, .revents = 0 };
+                if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+                    return -1;
+                }
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            return -1;
+        }
+
+        queue->stats.send_calls++;
+#if defined(SEND_QUEUE_HAVE_ZEROCOPY)
+        if (large) {
+            // The kernel numbers every successful MSG_ZEROCOPY call on the socket
+            uint32_t id = queue->zerocopy_next_id++;
+            for (size_t i = 0; i < frames; i++) {
+                send_queue_pin(queue, queue->entries[(queue->head + i) % queue->capacity].frame, id);
+            }
+            queue->stats.zerocopy_sends++;
+            queue->stats.zerocopy_pending = queue->pinned_count;
+        }
+#endif
+        send_queue_advance(queue, (size_t)n);
+    }
+
+    queue->stats.queued_frames = 0;
+    return 0;
+}
+
+void send_queue_get_stats(const ClientSendQueue* queue, SendQueueStats* stats) {
+    if (!stats) {
+        return;
+    }
+    if (!queue) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    *stats = queue->stats;
+    stats->queued_frames = queue->count;
+}
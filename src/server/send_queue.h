@@ -0,0 +1,135 @@
+#ifndef FEROX_SEND_QUEUE_H
+#define FEROX_SEND_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../shared/protocol.h"
+
+#define SEND_QUEUE_DEFAULT_MAX_FRAMES 256
+#define SEND_QUEUE_DEFAULT_MAX_BYTES ((size_t)8 * 1024 * 1024)
+// Control frames may overrun max_bytes up to this factor before the client is
+// considered stuck.
+#define SEND_QUEUE_CONTROL_OVERRUN 4
+// iovec entries per sendmsg (header + payload per frame)
+#define SEND_QUEUE_MAX_IOV 64
+
+/**
+ * Bounded outbound queue of shared frames for one client.
+ *
+ * World frames are pushed as groups (a world state plus its delta or keyframe
+ * chunks). A group that has not started sending is obsolete once a newer one
+ * is ready, so send_queue_drop_pending_world() discards it; control frames
+ * (command status, colony detail) are never dropped. Only the frame at the
+ * head may be partially sent; `head_offset` tracks its progress.
+ *
+ * Flushes gather the queued frames into one iovec of [header, payload, ...]
+ * and write as many as fit with a single sendmsg. With zerocopy enabled
+ * (Linux only), a batch that carries a payload of at least zerocopy_min bytes
+ * is sent with MSG_ZEROCOPY. Each frame in the batch stays referenced until
+ * the kernel reports completion on the socket error queue.
+ *
+ * The queue has no lock of its own: callers serialize access (the server
+ * holds clients_mutex).
+ */
+typedef enum {
+    SEND_FRAME_CONTROL = 0,
+    SEND_FRAME_WORLD = 1,
+    SEND_FRAME_KEYFRAME = 2  // World frame that belongs to a keyframe group
+} SendFrameClass;
+
+typedef struct {
+    ProtoFrame* frame;
+    uint32_t group;
+    uint8_t frame_class;
+} SendQueueEntry;
+
+typedef struct {
+    uint64_t frames_sent;
+    uint64_t bytes_sent;
+    uint64_t world_groups_coalesced;  // Unsent groups replaced by a newer one
+    uint64_t world_groups_dropped;    // Groups refused because the queue was full
+    uint64_t send_would_block;        // Flushes that stopped on a full socket buffer
+    uint64_t send_calls;              // sendmsg calls that wrote data
+    uint64_t zerocopy_sends;          // ... of which used MSG_ZEROCOPY
+    uint64_t zerocopy_copied;         // Zerocopy sends the kernel fell back to copying
+    size_t zerocopy_pending;          // Frames pinned until completion arrives
+    size_t queued_frames;
+    size_t queued_bytes;              // Unsent wire bytes, head progress excluded
+    size_t peak_queued_bytes;
+} SendQueueStats;
+
+typedef struct {
+    ProtoFrame* frame;
+    uint32_t id;  // Kernel zerocopy counter of the sendmsg that used it
+} SendQueuePinned;
+
+typedef struct {
+    SendQueueEntry* entries;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    size_t head_offset;      // Wire bytes of the head frame already sent
+    size_t max_bytes;
+    uint32_t next_group;
+    uint32_t started_group;  // Group of the frame most recently (partly) sent
+    bool has_started_group;
+    size_t zerocopy_min;     // 0 when MSG_ZEROCOPY is off
+    uint32_t zerocopy_next_id;
+    SendQueuePinned* pinned;
+    size_t pinned_count;
+    size_t pinned_capacity;
+    SendQueueStats stats;
+} ClientSendQueue;
+
+/**
+ * @param max_frames Frame slots (0 selects SEND_QUEUE_DEFAULT_MAX_FRAMES)
+ * @param max_bytes Queued byte budget for world groups (0 selects the default)
+ * @return 0 on success, -1 on allocation failure
+ */
+int send_queue_init(ClientSendQueue* queue, size_t max_frames, size_t max_bytes);
+
+// Release every queued frame and the entry storage.
+void send_queue_destroy(ClientSendQueue* queue);
+
+/**
+ * Queue a control frame. Takes a new reference on success.
+ * @return 0 on success, -1 if the queue is hopelessly backed up
+ */
+int send_queue_push_control(ClientSendQueue* queue, ProtoFrame* frame);
+
+/**
+ * Queue a world group atomically (all frames or none). Takes a reference on
+ * each frame on success.
+ * @return 0 on success, 1 if dropped because the queue is full
+ */
+int send_queue_push_world(ClientSendQueue* queue, ProtoFrame* const* frames, size_t count, bool keyframe);
+
+/**
+ * Discard queued world groups that have not started sending.
+ * @param dropped_keyframe Set to true if a discarded group was a keyframe (may be NULL)
+ * @return number of groups discarded
+ */
+size_t send_queue_drop_pending_world(ClientSendQueue* queue, bool* dropped_keyframe);
+
+bool send_queue_has_pending(const ClientSendQueue* queue);
+
+/**
+ * Opt the socket into MSG_ZEROCOPY for batches carrying a payload of at least
+ * `min_bytes`. Only TCP sockets on Linux 4.14+ accept it.
+ * @return 0 if enabled, -1 if unsupported (the queue keeps copying sends)
+ */
+int send_queue_enable_zerocopy(ClientSendQueue* queue, int fd, size_t min_bytes);
+
+/**
+ * Write queued frames to `fd` with non-blocking sends.
+ * With `wait` set, a full socket buffer is waited out with poll() instead of
+ * returning early (used when no I/O thread is running).
+ * @return 0 when the socket would block or the queue is empty, -1 on a socket error
+ */
+int send_queue_flush(ClientSendQueue* queue, int fd, bool wait);
+
+void send_queue_get_stats(const ClientSendQueue* queue, SendQueueStats* stats);
+
+#endif // FEROX_SEND_QUEUE_H
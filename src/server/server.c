@@ -7,6 +7,7 @@
 #include "simulation.h"
 #include "parallel.h"
 #include "genetics.h"
+#include "frame_schedule.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,6 +15,8 @@
 #include <errno.h>
 #include <time.h>
 #include <math.h>
+#include <fcntl.h>
+#include <sys/socket.h>
 
 // Protocol types - we need to include protocol.h but types.h already defined World/Colony
 // So we include protocol.h here and use the types directly knowing they come from types.h (via world.h)
@@ -22,8 +25,10 @@
 #include "../shared/names.h"
 
 // Forward declarations for thread functions
-static void* accept_thread_func(void* arg);
 static void* simulation_thread_func(void* arg);
+static void server_invalidate_world_deltas(Server* server);
+static ProtoFrame* server_build_colony_info_frame(Server* server, uint32_t colony_id,
+                                                  const ProtoColony* snapshot_colony);
 
 static void copy_colony_name(char dst[MAX_COLONY_NAME], const char* src) {
     if (!dst) {
@@ -84,19 +89,69 @@ static void server_fill_command_status(ProtoCommandStatus* status,
     }
 }
 
+// Nudge the I/O thread. Only the first caller since its last pass pays for
+// the wake syscall.
+static void server_wake_io(Server* server) {
+    if (atomic_exchange_explicit(&server->io_wake_pending, true, memory_order_acq_rel)) {
+        return;
+    }
+    io_poller_wake(&server->io_poller);
+}
+
+// Push queued frames towards the client: hand off to the I/O thread when it
+// runs, otherwise write them out now. Caller holds clients_mutex.
+static int server_flush_client(Server* server, ClientSession* client) {
+    if (client->send_failed) {
+        return -1;
+    }
+    if (server->io_thread_running) {
+        server_wake_io(server);
+        return 0;
+    }
+    if (send_queue_flush(&client->send_queue, client->socket->fd, true) < 0) {
+        client->send_failed = true;
+        return -1;
+    }
+    return 0;
+}
+
+static int server_enqueue_control(Server* server, ClientSession* client, ProtoFrame* frame) {
+    if (!client->socket || client->socket->fd < 0) {
+        return -1;
+    }
+    if (send_queue_push_control(&client->send_queue, frame) < 0) {
+        // Backlog far past the world budget: the client is not reading
+        client->send_failed = true;
+        return -1;
+    }
+    return server_flush_client(server, client);
+}
+
+static void server_free_client(ClientSession* client) {
+    if (client->socket) {
+        net_socket_close(client->socket);
+    }
+    send_queue_destroy(&client->send_queue);
+    proto_frame_reader_free(&client->reader);
+    free(client);
+}
+
 static void server_send_command_status(Server* server,
                                        ClientSession* client,
                                        MessageType type,
                                        const ProtoCommandStatus* status) {
-    (void)server;
-    if (!client || !client->socket || client->socket->fd < 0 || !status) {
+    if (!server || !client || !client->socket || client->socket->fd < 0 || !status) {
         return;
     }
 
     uint8_t buffer[COMMAND_STATUS_SERIALIZED_SIZE];
     int len = protocol_serialize_command_status(status, buffer);
     if (len > 0) {
-        protocol_send_message(client->socket->fd, type, buffer, (size_t)len);
+        ProtoFrame* frame = proto_frame_copy(type, buffer, (size_t)len);
+        if (frame) {
+            server_enqueue_control(server, client, frame);
+            proto_frame_release(frame);
+        }
     }
 }
 
@@ -221,6 +276,44 @@ static void server_clear_selected_colonies(Server* server) {
     }
 }
 
+// Every client gets a keyframe next. Caller holds clients_mutex.
+static void server_reset_client_baselines(Server* server) {
+    for (ClientSession* client = server->clients; client; client = client->next) {
+        client->keyframe_sent = false;
+        client->has_baseline = false;
+    }
+}
+
+// Rebuild watched_colonies from the sessions' selections. Caller holds
+// clients_mutex.
+static void server_collect_selected_colonies(Server* server) {
+    uint32_t count = 0;
+    for (ClientSession* client = server->clients; client; client = client->next) {
+        uint32_t id = client->selected_colony;
+        if (!client->active || id == 0) {
+            continue;
+        }
+        uint32_t i = 0;
+        while (i < count && server->watched_colonies[i] != id) {
+            i++;
+        }
+        if (i < count) {
+            continue;
+        }
+        if (count == server->watched_colony_capacity) {
+            uint32_t capacity = count ? count * 2u : 8u;
+            uint32_t* grown = (uint32_t*)realloc(server->watched_colonies, (size_t)capacity * sizeof(uint32_t));
+            if (!grown) {
+                break;
+            }
+            server->watched_colonies = grown;
+            server->watched_colony_capacity = capacity;
+        }
+        server->watched_colonies[count++] = id;
+    }
+    server->watched_colony_count = count;
+}
+
 static MessageType server_reset_world(Server* server,
                                       ClientSession* client,
                                       ProtoCommandStatus* status) {
@@ -236,7 +329,7 @@ static MessageType server_reset_world(Server* server,
     AtomicWorld* new_atomic_world = NULL;
     if (new_world) {
         world_init_random_colonies(new_world, server->default_colonies);
-        new_atomic_world = atomic_world_create(new_world, server->pool, server->pool->thread_count);
+        new_atomic_world = atomic_world_create(new_world, server->pool, threadpool_gang_width(server->pool));
     }
 
     if (!new_world || !new_atomic_world) {
@@ -262,6 +355,9 @@ static MessageType server_reset_world(Server* server,
     }
 
     server_clear_selected_colonies(server);
+    // The rebuilt world starts a new snapshot history, which restarts the
+    // broadcast's own tracking; only the client baselines are ours to drop
+    server_reset_client_baselines(server);
     server_fill_command_status(status, CMD_RESET,
                                PROTO_COMMAND_STATUS_ACCEPTED,
                                0,
@@ -399,19 +495,21 @@ static void fill_proto_colony_detail_base(const World* world,
     }
 }
 
-// Helper to get current time in milliseconds
-static long get_time_ms(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
-}
+static int server_parse_env_int(const char* name, int default_value, int min_value, int max_value) {
+    const char* raw = getenv(name);
+    if (!raw || !*raw) {
+        return default_value;
+    }
 
-// Helper to sleep for milliseconds
-static void sleep_ms(int ms) {
-    struct timespec ts;
-    ts.tv_sec = ms / 1000;
-    ts.tv_nsec = (ms % 1000) * 1000000L;
-    nanosleep(&ts, NULL);
+    char* end = NULL;
+    long value = strtol(raw, &end, 10);
+    if (end == raw || (end && *end != '\0')) {
+        return default_value;
+    }
+
+    if (value < min_value) value = min_value;
+    if (value > max_value) value = max_value;
+    return (int)value;
 }
 
 Server* server_create(uint16_t port, int world_width, int world_height, int thread_count) {
@@ -459,7 +557,8 @@ Server* server_create(uint16_t port, int world_width, int world_height, int thre
     parallel_init_regions(server->parallel_ctx, world_width, world_height);
     
     // Create atomic world for lock-free parallel simulation
-    server->atomic_world = atomic_world_create(server->world, server->pool, thread_count);
+    server->atomic_world = atomic_world_create(server->world, server->pool,
+                                               threadpool_gang_width(server->pool));
     if (!server->atomic_world) {
         parallel_destroy(server->parallel_ctx);
         threadpool_destroy(server->pool);
@@ -491,6 +590,43 @@ Server* server_create(uint16_t port, int world_width, int world_height, int thre
     server->tick_rate_ms = DEFAULT_TICK_RATE_MS;
     server->speed_multiplier = 1.0f;
     server->next_client_id = 1;
+    server->delta_max_gap = SERVER_DELTA_MAX_GAP_TICKS;
+    server->io_poller.fd = -1;
+    server->io_poller.wake_fd = -1;
+    server->send_zerocopy_min = (size_t)server_parse_env_int("FEROX_SEND_ZEROCOPY_MIN", 0, 0, 64 * 1024 * 1024);
+    server->compress_min_bytes = (size_t)server_parse_env_int("FEROX_COMPRESS_MIN_BYTES",
+                                                              PROTO_COMPRESS_DEFAULT_MIN_BYTES,
+                                                              0, MAX_PAYLOAD_SIZE);
+    server->capabilities = (uint32_t)server_parse_env_int("FEROX_SERVER_CAPS", (int)PROTO_CAP_ALL,
+                                                          0, (int)PROTO_CAP_ALL) & PROTO_CAP_ALL;
+    const char* shm_name = getenv("FEROX_SHM_NAME");
+    if (shm_name && *shm_name) {
+        uint32_t shm_colonies = (uint32_t)server_parse_env_int("FEROX_SHM_COLONIES",
+                                                               (int)SHM_WORLD_DEFAULT_COLONIES, 0, 1 << 20);
+        server->shm_world = shm_world_writer_create(shm_name, (uint32_t)world_width * (uint32_t)world_height,
+                                                    shm_colonies, server->listener->port);
+        if (!server->shm_world) {
+            fprintf(stderr, "Shared memory world %s unavailable; viewers stay on TCP\n", shm_name);
+        }
+    }
+    if (!server->shm_world) {
+        server->capabilities &= ~PROTO_CAP_SHARED_WORLD;
+    }
+    // Keyframe chunk encoders get threads of their own rather than tasks on
+    // the simulation pool, where they would hold up the next gang.
+    int encode_helpers = server_parse_env_int("FEROX_ENCODE_HELPERS", 0, 0, 64);
+    if (encode_helpers > 0) {
+        server->encode_pool = threadpool_create(encode_helpers);
+        if (!server->encode_pool) {
+            fprintf(stderr, "Encode helpers unavailable; keyframes encode on the broadcast thread\n");
+        }
+    }
+    server->pipeline = server_parse_env_int("FEROX_PIPELINE", 1, 0, 1) != 0;
+    server->broadcast_hz = server_parse_env_int("FEROX_BROADCAST_HZ", DEFAULT_BROADCAST_HZ, 0, 1000);
+    mpsc_queue_init(&server->inbound);
+    mpsc_queue_init(&server->acks);
+    proto_buffer_pool_init(&server->recv_pool);
+    world_snapshot_publisher_init(&server->snapshots);
     
     return server;
 }
@@ -526,7 +662,8 @@ Server* server_create_headless(int world_width, int world_height, int thread_cou
     }
     parallel_init_regions(server->parallel_ctx, world_width, world_height);
 
-    server->atomic_world = atomic_world_create(server->world, server->pool, thread_count);
+    server->atomic_world = atomic_world_create(server->world, server->pool,
+                                               threadpool_gang_width(server->pool));
     if (!server->atomic_world) {
         parallel_destroy(server->parallel_ctx);
         threadpool_destroy(server->pool);
@@ -552,8 +689,16 @@ Server* server_create_headless(int world_width, int world_height, int thread_cou
     server->running = false;
     server->paused = false;
     server->tick_rate_ms = DEFAULT_TICK_RATE_MS;
+    server->broadcast_hz = DEFAULT_BROADCAST_HZ;
     server->speed_multiplier = 1.0f;
     server->next_client_id = 1;
+    server->delta_max_gap = SERVER_DELTA_MAX_GAP_TICKS;
+    server->io_poller.fd = -1;
+    server->io_poller.wake_fd = -1;
+    mpsc_queue_init(&server->inbound);
+    mpsc_queue_init(&server->acks);
+    proto_buffer_pool_init(&server->recv_pool);
+    world_snapshot_publisher_init(&server->snapshots);
 
     return server;
 }
@@ -565,21 +710,28 @@ void server_destroy(Server* server) {
     if (server->running) {
         server_stop(server);
     }
+    server_stop_broadcast_thread(server);
     
     // Clean up all clients
     pthread_mutex_lock(&server->clients_mutex);
     ClientSession* client = server->clients;
     while (client) {
         ClientSession* next = client->next;
-        if (client->socket) {
-            net_socket_close(client->socket);
-        }
-        free(client);
+        server_free_client(client);
         client = next;
     }
     server->clients = NULL;
     server->client_count = 0;
     pthread_mutex_unlock(&server->clients_mutex);
+
+    MpscNode* node;
+    while ((node = mpsc_queue_pop(&server->inbound)) != NULL) {
+        free(node);
+    }
+    while ((node = mpsc_queue_pop(&server->acks)) != NULL) {
+        free(node);
+    }
+    proto_buffer_pool_destroy(&server->recv_pool);
     
     // Destroy resources
     pthread_mutex_destroy(&server->clients_mutex);
@@ -593,70 +745,345 @@ void server_destroy(Server* server) {
     if (server->pool) {
         threadpool_destroy(server->pool);
     }
+    threadpool_destroy(server->encode_pool);
     if (server->world) {
         world_destroy(server->world);
     }
     if (server->listener) {
         net_server_destroy(server->listener);
     }
+
+    free(server->delta_grid);
+    free(server->delta_changed_tick);
+    free(server->delta_span_scratch);
+    free(server->delta_cell_scratch);
+    grid_pyramid_destroy(&server->delta_pyramid);
+    colony_track_destroy(&server->colony_track);
+    world_snapshot_publisher_destroy(&server->snapshots);
+    free(server->watched_colonies);
+    shm_world_writer_destroy(server->shm_world);
     
     free(server);
 }
 
-static void* accept_thread_func(void* arg) {
-    Server* server = (Server*)arg;
-    
-    while (server->running) {
-        // Accept new connection (blocking)
+// Command polling interval while paused with unpaced ticks
+#define SERVER_PAUSED_POLL_NS 1000000ull
+
+#define SERVER_IO_LISTENER_TAG ((uint64_t)UINT32_MAX + 1)
+#define SERVER_IO_MAX_EVENTS 64
+// Upper bound on epoll/kqueue sleeps; wake-ups normally end them sooner
+#define SERVER_IO_TIMEOUT_MS 100
+
+static ClientSession* server_find_client(Server* server, uint32_t id) {
+    for (ClientSession* client = server->clients; client; client = client->next) {
+        if (client->id == id) {
+            return client;
+        }
+    }
+    return NULL;
+}
+
+static void server_queue_inbound(Server* server, uint32_t client_id, ServerInboundKind kind,
+                                 const MessageHeader* header, const uint8_t* payload) {
+    ServerInboundEvent* event = (ServerInboundEvent*)calloc(1, sizeof(ServerInboundEvent));
+    if (!event) {
+        return;
+    }
+    event->client_id = client_id;
+    event->kind = kind;
+
+    if (kind == SERVER_INBOUND_COMMAND) {
+        // Zero-padded copy so short payloads never read past the frame
+        uint8_t scratch[SERVER_INBOUND_DATA_SIZE];
+        memset(scratch, 0, sizeof(scratch));
+        size_t copy = header->payload_len < sizeof(scratch) ? header->payload_len : sizeof(scratch);
+        memcpy(scratch, payload, copy);
+        if (header->payload_len < 4 ||
+            protocol_deserialize_command(scratch, &event->command, event->data) <= 0) {
+            free(event);
+            return;
+        }
+    } else if (kind == SERVER_INBOUND_ACK) {
+        ProtoWorldAck ack;
+        if (protocol_deserialize_world_ack(payload, header->payload_len, &ack) <= 0) {
+            free(event);
+            return;
+        }
+        event->ack_tick = ack.tick;
+        // Baselines belong to the broadcast; it applies acks itself
+        mpsc_queue_push(&server->acks, &event->node);
+        return;
+    }
+
+    mpsc_queue_push(&server->inbound, &event->node);
+}
+
+// Turn every complete frame buffered for the client into an inbound event.
+// @return -1 on a malformed frame, 0 otherwise
+static int server_decode_inbound(Server* server, ClientSession* client) {
+    MessageHeader header;
+    ProtoPayloadView payload;
+    int result = 0;
+
+    while (!client->recv_closed &&
+           (result = proto_frame_reader_next(&client->reader, &header, &payload)) > 0) {
+        switch (header.type) {
+            case MSG_CONNECT: {
+                // Capabilities only change how this client's frames are encoded
+                ProtoConnect connect;
+                if (protocol_deserialize_connect(payload.data, payload.len, &connect) == 0) {
+                    server_negotiate_client(server, client, &connect);
+                }
+                break;
+            }
+            case MSG_COMMAND:
+                server_queue_inbound(server, client->id, SERVER_INBOUND_COMMAND, &header, payload.data);
+                break;
+            case MSG_ACK:
+                server_queue_inbound(server, client->id, SERVER_INBOUND_ACK, &header, payload.data);
+                break;
+            case MSG_DISCONNECT:
+                server_queue_inbound(server, client->id, SERVER_INBOUND_DISCONNECT, &header, payload.data);
+                client->recv_closed = true;
+                break;
+            default:
+                break;
+        }
+        proto_frame_reader_release(&client->reader, &payload);
+    }
+    return client->recv_closed ? 0 : result;
+}
+
+// Read until the socket would block (required by edge-triggered readiness),
+// framing as the ring fills. Caller holds clients_mutex.
+static void server_read_client(Server* server, ClientSession* client) {
+    if (client->recv_closed || !client->active || !client->socket ||
+        !client->socket->connected || client->socket->fd < 0) {
+        return;
+    }
+
+    bool failed = false;
+    while (!client->recv_closed) {
+        bool drained = false;
+        size_t buffered = client->reader.len;
+        ssize_t n = proto_frame_reader_fill(&client->reader, client->socket->fd, &drained);
+        if (n < 0 || server_decode_inbound(server, client) < 0) {
+            failed = true;
+            break;
+        }
+        if (client->reader.closed && !client->recv_closed) {
+            failed = true;  // EOF after the last complete frame
+            break;
+        }
+        if (drained || (n == 0 && client->reader.len == buffered)) {
+            break;
+        }
+    }
+
+    if (failed && !client->recv_closed) {
+        // Disconnect goes through the queue so earlier commands still apply
+        client->recv_closed = true;
+        server_queue_inbound(server, client->id, SERVER_INBOUND_DISCONNECT, NULL, NULL);
+    }
+}
+
+static void server_io_accept(Server* server) {
+    for (;;) {
         NetSocket* socket = net_server_accept(server->listener);
         if (!socket) {
-            if (!server->running) break;
-            continue;
+            break;
         }
-        
-        // Set socket options
+
         net_set_nonblocking(socket, true);
         net_set_nodelay(socket, true);
-        
-        // Add client
+
         ClientSession* client = server_add_client(server, socket);
-        if (client) {
-            printf("Client %u connected from %s:%u\n", 
-                   client->id, socket->address, socket->port);
-        } else {
+        if (!client) {
             net_socket_close(socket);
+            continue;
+        }
+        if (io_poller_add(&server->io_poller, socket->fd, client->id) < 0) {
+            server_remove_client(server, client);
+            continue;
         }
+        printf("Client %u connected from %s:%u\n",
+               client->id, socket->address, socket->port);
     }
-    
+}
+
+// Drain send queues and free sessions the simulation has retired.
+static void server_io_service_clients(Server* server) {
+    pthread_mutex_lock(&server->clients_mutex);
+    ClientSession* prev = NULL;
+    ClientSession* client = server->clients;
+    while (client) {
+        ClientSession* next = client->next;
+
+        if (client->active && !client->send_failed && client->socket &&
+            send_queue_has_pending(&client->send_queue) &&
+            send_queue_flush(&client->send_queue, client->socket->fd, false) < 0) {
+            client->send_failed = true;
+        }
+        if (!client->active || client->send_failed) {
+            if (client->send_failed) {
+                printf("Client %u disconnected\n", client->id);
+            }
+            if (prev) {
+                prev->next = next;
+            } else {
+                server->clients = next;
+            }
+            server_free_client(client);
+            server->client_count--;
+            client = next;
+            continue;
+        }
+
+        prev = client;
+        client = next;
+    }
+    pthread_mutex_unlock(&server->clients_mutex);
+}
+
+static void* io_thread_func(void* arg) {
+    Server* server = (Server*)arg;
+    IoPollerEvent events[SERVER_IO_MAX_EVENTS];
+
+    while (server->running) {
+        int n = io_poller_wait(&server->io_poller, events, SERVER_IO_MAX_EVENTS, SERVER_IO_TIMEOUT_MS);
+        if (n < 0) {
+            break;
+        }
+        // Clear before servicing so frames queued from here on wake us again
+        atomic_store_explicit(&server->io_wake_pending, false, memory_order_release);
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].tag == SERVER_IO_LISTENER_TAG) {
+                server_io_accept(server);
+                continue;
+            }
+            if (!events[i].readable && !events[i].closed) {
+                continue;  // Writability is picked up by the service pass
+            }
+            pthread_mutex_lock(&server->clients_mutex);
+            ClientSession* client = server_find_client(server, (uint32_t)events[i].tag);
+            if (client) {
+                server_read_client(server, client);
+            }
+            pthread_mutex_unlock(&server->clients_mutex);
+        }
+
+        server_io_service_clients(server);
+    }
+
     return NULL;
 }
 
+static int server_start_io_thread(Server* server) {
+    if (!server->listener || io_poller_init(&server->io_poller) < 0) {
+        return -1;
+    }
+
+    int flags = fcntl(server->listener->fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(server->listener->fd, F_SETFL, flags | O_NONBLOCK) < 0 ||
+        io_poller_add(&server->io_poller, server->listener->fd, SERVER_IO_LISTENER_TAG) < 0) {
+        io_poller_destroy(&server->io_poller);
+        return -1;
+    }
+
+    // Sessions added before server_run are handed to the I/O thread too
+    pthread_mutex_lock(&server->clients_mutex);
+    for (ClientSession* client = server->clients; client; client = client->next) {
+        if (client->socket && client->socket->fd >= 0) {
+            io_poller_add(&server->io_poller, client->socket->fd, client->id);
+        }
+    }
+    atomic_store(&server->io_wake_pending, false);
+    server->io_thread_running = true;
+    pthread_mutex_unlock(&server->clients_mutex);
+
+    if (pthread_create(&server->io_thread, NULL, io_thread_func, server) != 0) {
+        pthread_mutex_lock(&server->clients_mutex);
+        server->io_thread_running = false;
+        pthread_mutex_unlock(&server->clients_mutex);
+        io_poller_destroy(&server->io_poller);
+        return -1;
+    }
+    return 0;
+}
+
+static void server_join_io_thread(Server* server) {
+    if (!server->io_thread_running) {
+        return;
+    }
+    io_poller_wake(&server->io_poller);
+    pthread_join(server->io_thread, NULL);
+
+    pthread_mutex_lock(&server->clients_mutex);
+    server->io_thread_running = false;
+    pthread_mutex_unlock(&server->clients_mutex);
+    io_poller_destroy(&server->io_poller);
+}
+
+// Tick period at the current speed; 0 runs ticks back to back
+static uint64_t server_tick_period_ns(const Server* server) {
+    if (server->tick_rate_ms <= 0) {
+        return 0;
+    }
+    float speed = server->speed_multiplier;
+    if (speed < 0.1f) speed = 0.1f;  // Clamp to prevent division issues
+    return (uint64_t)((double)server->tick_rate_ms * 1000000.0 / speed);
+}
+
 static void* simulation_thread_func(void* arg) {
     Server* server = (Server*)arg;
     
+    // Ticks and frames run on separate deadline grids: the simulation rate
+    // never multiplies network output beyond broadcast_hz
+    uint64_t now = frame_schedule_now_ns();
+    FrameSchedule ticks;
+    FrameSchedule frames;
+    frame_schedule_init(&ticks, server_tick_period_ns(server), now);
+    frame_schedule_init(&frames, frame_schedule_period_ns(server->broadcast_hz), now);
+    bool frame_pending = false;  // A tick ran since the last broadcast
+    
     while (server->running) {
-        long start_time = get_time_ms();
-        
-        if (!server->paused) {
+        now = frame_schedule_now_ns();
+        frame_schedule_set_period(&ticks, server_tick_period_ns(server), now);
+        frame_schedule_set_period(&frames, frame_schedule_period_ns(server->broadcast_hz), now);
+        if (!server->paused && frame_schedule_due(&ticks, now)) {
             // Run simulation tick using atomic lock-free parallel processing
             atomic_tick(server->atomic_world);
-            
-            // Broadcast world state to all clients
+            frame_schedule_advance(&ticks, now);
+            frame_pending = true;
+            now = frame_schedule_now_ns();
+        }
+        
+        // A frame carries the newest tick; ticks in between are never sent.
+        // The broadcast thread encodes it while the next tick runs (or it is
+        // broadcast here without that thread).
+        if (frame_pending && frame_schedule_due(&frames, now)) {
             server_broadcast_world_state(server);
+            frame_schedule_advance(&frames, now);
+            frame_pending = false;
         }
         
-        // Process client messages
+        // Commands apply between ticks, never during one
         server_process_clients(server);
         
-        // Calculate sleep time to maintain tick rate
-        long elapsed = get_time_ms() - start_time;
-        // Ensure target_ms is at least 1ms to prevent busy-waiting and timing issues
-        float speed = server->speed_multiplier;
-        if (speed < 0.1f) speed = 0.1f;  // Clamp to prevent division issues
-        int target_ms = (int)(server->tick_rate_ms / speed);
-        if (target_ms < 1) target_ms = 1;  // Minimum 1ms tick to prevent CPU spinning
-        if (elapsed < target_ms) {
-            sleep_ms(target_ms - (int)elapsed);
+        // Sleep to the nearer of the next tick and the next pending frame.
+        // Unpaced ticks do not sleep; paused ones still poll for commands.
+        uint64_t wake = 0;  // 0: straight on to the next tick
+        if (server->paused) {
+            wake = now + (ticks.period_ns ? ticks.period_ns : SERVER_PAUSED_POLL_NS);
+        } else if (ticks.period_ns > 0) {
+            wake = ticks.next_ns;
+        }
+        if (wake > 0 && frame_pending && frames.period_ns > 0 && frames.next_ns < wake) {
+            wake = frames.next_ns;
+        }
+        if (wake > 0) {
+            frame_schedule_sleep_until(wake);
         }
     }
     
@@ -668,39 +1095,48 @@ void server_run(Server* server) {
     
     server->running = true;
     
-    // Start accept thread
-    if (pthread_create(&server->accept_thread, NULL, accept_thread_func, server) != 0) {
+    // The I/O thread owns accept, reads and writes for every socket
+    if (server_start_io_thread(server) < 0) {
+        fprintf(stderr, "Failed to start network I/O thread\n");
         server->running = false;
         return;
     }
     
+    // Encoding and sending overlap the next tick
+    if (server->pipeline && server_start_broadcast_thread(server) < 0) {
+        fprintf(stderr, "Failed to start broadcast thread; broadcasting between ticks\n");
+    }
+    
     // Run simulation in current thread (blocking)
     simulation_thread_func(server);
     
-    // Wait for accept thread
-    pthread_join(server->accept_thread, NULL);
+    server_stop_broadcast_thread(server);
+    server_join_io_thread(server);
 }
 
 void server_stop(Server* server) {
     if (!server || !server->running) return;
     
+    // Wake first: the poller is torn down once the I/O thread sees !running
+    io_poller_wake(&server->io_poller);
     server->running = false;
-    
-    // Close listener to unblock accept
-    if (server->listener) {
-        net_server_destroy(server->listener);
-        server->listener = NULL;
-    }
 }
 
-int server_build_protocol_world_snapshot(const World* world,
-                                         bool paused,
-                                         float speed_multiplier,
-                                         ProtoWorld* proto_world) {
-    if (!world || !proto_world) {
-        return -1;
-    }
-
+// Per-colony centroid accumulator for snapshots
+typedef struct {
+    float sum_x;
+    float sum_y;
+    uint32_t samples;
+} ServerColonyCentroid;
+
+// Colony table, centroids and (for small worlds) the inline grid. Cell ids
+// come from `ids` when given, and the inline grid then aliases it instead of
+// being copied; otherwise from world->cells.
+static int server_fill_protocol_world(const World* world,
+                                      uint32_t* ids,
+                                      bool paused,
+                                      float speed_multiplier,
+                                      ProtoWorld* proto_world) {
     proto_world_init(proto_world);
     
     proto_world->width = (uint32_t)world->width;
@@ -709,13 +1145,29 @@ int server_build_protocol_world_snapshot(const World* world,
     proto_world->paused = paused;
     proto_world->speed_multiplier = speed_multiplier;
 
+    // The first MAX_COLONIES active colonies go in the MSG_WORLD_STATE
+    // table, the rest in extra_colonies for MSG_COLONY_PAGE.
+    size_t extra_capacity = world->colony_count > MAX_COLONIES ? world->colony_count - MAX_COLONIES : 0;
+    if (extra_capacity > 0) {
+        proto_world->extra_colonies = (ProtoColony*)malloc(extra_capacity * sizeof(ProtoColony));
+        if (!proto_world->extra_colonies) {
+            return -1;
+        }
+    }
+
     uint32_t count = 0;
-    uint16_t proto_index_by_colony_id_stack[512];
-    uint16_t* proto_index_by_colony_id = NULL;
+    uint32_t proto_index_by_colony_id_stack[512];
+    uint32_t* proto_index_by_colony_id = NULL;
     size_t proto_index_by_colony_id_capacity = 0;
-    float sum_x[MAX_COLONIES] = {0};
-    float sum_y[MAX_COLONIES] = {0};
-    uint32_t sample_count[MAX_COLONIES] = {0};
+    ServerColonyCentroid centroid_stack[MAX_COLONIES];
+    ServerColonyCentroid* centroids = centroid_stack;
+    if (extra_capacity > 0) {
+        centroids = (ServerColonyCentroid*)malloc(world->colony_count * sizeof(ServerColonyCentroid));
+        if (!centroids) {
+            proto_world_free(proto_world);
+            return -1;
+        }
+    }
 
     if (world->colony_index_capacity > 0) {
         proto_index_by_colony_id_capacity = world->colony_index_capacity;
@@ -723,26 +1175,31 @@ int server_build_protocol_world_snapshot(const World* world,
             (sizeof(proto_index_by_colony_id_stack) / sizeof(proto_index_by_colony_id_stack[0]))) {
             proto_index_by_colony_id = proto_index_by_colony_id_stack;
         } else {
-            proto_index_by_colony_id = (uint16_t*)malloc(proto_index_by_colony_id_capacity *
-                                                         sizeof(uint16_t));
+            proto_index_by_colony_id = (uint32_t*)malloc(proto_index_by_colony_id_capacity *
+                                                         sizeof(uint32_t));
         }
 
         if (!proto_index_by_colony_id) {
+            if (centroids != centroid_stack) {
+                free(centroids);
+            }
+            proto_world_free(proto_world);
             return -1;
         }
 
         memset(proto_index_by_colony_id,
                0xFF,
-               proto_index_by_colony_id_capacity * sizeof(uint16_t));
+               proto_index_by_colony_id_capacity * sizeof(uint32_t));
     }
 
-    for (size_t i = 0; i < world->colony_count && count < MAX_COLONIES; i++) {
+    for (size_t i = 0; i < world->colony_count && count < MAX_COLONIES + extra_capacity; i++) {
         const Colony* colony = &world->colonies[i];
         if (!colony->active) {
             continue;
         }
 
-        ProtoColony* proto_colony = &proto_world->colonies[count];
+        ProtoColony* proto_colony = count < MAX_COLONIES ? &proto_world->colonies[count]
+                                                         : &proto_world->extra_colonies[count - MAX_COLONIES];
         proto_colony->id = colony->id;
         copy_colony_name(proto_colony->name, colony->name);
         proto_colony->population = (uint32_t)colony->cell_count;
@@ -758,23 +1215,36 @@ int server_build_protocol_world_snapshot(const World* world,
         proto_colony->x = 0.0f;
         proto_colony->y = 0.0f;
         proto_colony->radius = 0.0f;
+        centroids[count].sum_x = 0.0f;
+        centroids[count].sum_y = 0.0f;
+        centroids[count].samples = 0;
 
         if (proto_index_by_colony_id && (size_t)colony->id < proto_index_by_colony_id_capacity) {
-            proto_index_by_colony_id[colony->id] = (uint16_t)count;
+            proto_index_by_colony_id[colony->id] = count;
         }
         count++;
     }
     
     // Build grid data from world cells for smaller snapshots and always
-    // accumulate centroid data in the same pass.
+    // accumulate centroid data in the same pass. Once ids outgrow 16 bits the
+    // grid goes out as keyframe chunks instead, which bound the wide encoding
+    // per message.
     uint32_t grid_size = proto_world->width * proto_world->height;
-    bool inline_grid = (grid_size > 0 && grid_size <= MAX_INLINE_GRID_SIZE);
-    if (inline_grid) {
-        proto_world->grid = (uint16_t*)malloc((size_t)grid_size * sizeof(uint16_t));
+    bool wide_ids = atomic_load_explicit(&world->next_colony_id, memory_order_relaxed) > (uint32_t)UINT16_MAX + 1u;
+    bool inline_grid = (grid_size > 0 && grid_size <= MAX_INLINE_GRID_SIZE && !wide_ids);
+    if (inline_grid && ids) {
+        proto_world->grid = ids;
+        proto_world->grid_size = grid_size;
+        proto_world->has_grid = true;
+    } else if (inline_grid) {
+        proto_world->grid = (uint32_t*)malloc((size_t)grid_size * sizeof(uint32_t));
         if (!proto_world->grid) {
             if (proto_index_by_colony_id != proto_index_by_colony_id_stack) {
                 free(proto_index_by_colony_id);
             }
+            if (centroids != centroid_stack) {
+                free(centroids);
+            }
             proto_world_free(proto_world);
             return -1;
         }
@@ -786,10 +1256,9 @@ int server_build_protocol_world_snapshot(const World* world,
         int row_base = y * world->width;
         for (int x = 0; x < world->width; x++) {
             int idx = row_base + x;
-            const Cell* cell = &world->cells[idx];
-            uint32_t colony_id = cell->colony_id;
-            if (proto_world->grid) {
-                proto_world->grid[idx] = (uint16_t)colony_id;
+            uint32_t colony_id = ids ? ids[idx] : world->cells[idx].colony_id;
+            if (proto_world->grid && !ids) {
+                proto_world->grid[idx] = colony_id;
             }
 
             if (colony_id == 0 || !proto_index_by_colony_id ||
@@ -797,117 +1266,1116 @@ int server_build_protocol_world_snapshot(const World* world,
                 continue;
             }
 
-            uint16_t proto_index = proto_index_by_colony_id[colony_id];
-            if (proto_index == UINT16_MAX || proto_index >= count) {
+            uint32_t proto_index = proto_index_by_colony_id[colony_id];
+            if (proto_index >= count) {
                 continue;
             }
 
-            sum_x[proto_index] += (float)x;
-            sum_y[proto_index] += (float)y;
-            sample_count[proto_index]++;
+            centroids[proto_index].sum_x += (float)x;
+            centroids[proto_index].sum_y += (float)y;
+            centroids[proto_index].samples++;
         }
     }
 
     for (uint32_t i = 0; i < count; i++) {
-        ProtoColony* proto_colony = &proto_world->colonies[i];
-        if (sample_count[i] > 0) {
-            proto_colony->x = sum_x[i] / (float)sample_count[i];
-            proto_colony->y = sum_y[i] / (float)sample_count[i];
+        ProtoColony* proto_colony = i < MAX_COLONIES ? &proto_world->colonies[i]
+                                                     : &proto_world->extra_colonies[i - MAX_COLONIES];
+        if (centroids[i].samples > 0) {
+            proto_colony->x = centroids[i].sum_x / (float)centroids[i].samples;
+            proto_colony->y = centroids[i].sum_y / (float)centroids[i].samples;
         }
         proto_colony->radius = proto_colony->population > 0 ? sqrtf((float)proto_colony->population / 3.14159f) : 0.0f;
     }
 
-    proto_world->colony_count = count;
+    proto_world->colony_count = count < MAX_COLONIES ? count : MAX_COLONIES;
+    proto_world->extra_colony_count = count - proto_world->colony_count;
+    if (proto_world->extra_colony_count == 0) {
+        free(proto_world->extra_colonies);
+        proto_world->extra_colonies = NULL;
+    }
     if (proto_index_by_colony_id != proto_index_by_colony_id_stack) {
         free(proto_index_by_colony_id);
     }
+    if (centroids != centroid_stack) {
+        free(centroids);
+    }
     return 0;
 }
 
-// Convert internal World/Colony to protocol ProtoWorld for serialization
-static int build_protocol_world(Server* server, ProtoWorld* proto_world) {
-    return server_build_protocol_world_snapshot(server->world,
-                                                server->paused,
-                                                server->speed_multiplier,
-                                                proto_world);
+int server_build_protocol_world_snapshot(const World* world,
+                                         bool paused,
+                                         float speed_multiplier,
+                                         ProtoWorld* proto_world) {
+    if (!world || !proto_world) {
+        return -1;
+    }
+    return server_fill_protocol_world(world, NULL, paused, speed_multiplier, proto_world);
 }
 
-void server_broadcast_world_state(Server* server) {
-    if (!server) return;
-    
-    // Build protocol world state
-    ProtoWorld proto_world;
-    if (build_protocol_world(server, &proto_world) < 0) {
-        return;
+int server_publish_world_snapshot(Server* server) {
+    if (!server || !server->world) {
+        return -1;
     }
-    
-    // Serialize
-    uint8_t* buffer = NULL;
-    size_t len = 0;
-    if (protocol_serialize_world_state(&proto_world, &buffer, &len) < 0) {
-        proto_world_free(&proto_world);
+
+    WorldSnapshot* snapshot = world_snapshot_begin(&server->snapshots, server->world);
+    if (!snapshot) {
+        return -1;
+    }
+    if (server_fill_protocol_world(server->world, snapshot->cells, server->paused,
+                                   server->speed_multiplier, &snapshot->world) < 0) {
+        world_snapshot_abandon(&server->snapshots, snapshot);
+        return -1;
+    }
+    // Details read the live world, so they are taken here and not by the encoder
+    for (uint32_t i = 0; i < server->watched_colony_count; i++) {
+        uint32_t id = server->watched_colonies[i];
+        // The snapshot already has the centroid; no grid scan per colony
+        ProtoFrame* info = server_build_colony_info_frame(server, id,
+                                                          proto_world_find_colony(&snapshot->world, id));
+        if (info && world_snapshot_add_colony_info(snapshot, id, info) < 0) {
+            proto_frame_release(info);
+        }
+    }
+    world_snapshot_publish(&server->snapshots, snapshot);
+    return 0;
+}
+
+static void server_invalidate_world_deltas(Server* server) {
+    if (!server) {
         return;
     }
 
-    uint32_t grid_size = (uint32_t)(server->world->width * server->world->height);
-    size_t chunk_count = 0;
-    uint8_t** chunk_buffers = NULL;
-    size_t* chunk_lengths = NULL;
-    uint16_t* chunk_cells = NULL;
-
-    if (!proto_world.has_grid && grid_size > 0 && grid_size <= MAX_GRID_SIZE) {
-        chunk_count = (grid_size + MAX_GRID_CHUNK_CELLS - 1u) / MAX_GRID_CHUNK_CELLS;
-        chunk_buffers = (uint8_t**)calloc(chunk_count, sizeof(uint8_t*));
-        chunk_lengths = (size_t*)calloc(chunk_count, sizeof(size_t));
-        chunk_cells = (uint16_t*)malloc((size_t)MAX_GRID_CHUNK_CELLS * sizeof(uint16_t));
-        if (!chunk_buffers || !chunk_lengths || !chunk_cells) {
-            free(chunk_buffers);
-            free(chunk_lengths);
-            free(chunk_cells);
-            free(buffer);
-            proto_world_free(&proto_world);
-            return;
-        }
+    server->delta_cells = 0;
+    colony_track_invalidate(&server->colony_track);
+    server_reset_client_baselines(server);
+}
 
-        for (size_t chunk_idx = 0; chunk_idx < chunk_count; chunk_idx++) {
-            uint32_t start_index = (uint32_t)(chunk_idx * MAX_GRID_CHUNK_CELLS);
-            uint32_t cell_count = grid_size - start_index;
-            if (cell_count > MAX_GRID_CHUNK_CELLS) {
-                cell_count = MAX_GRID_CHUNK_CELLS;
-            }
+// Keep the grid pyramid in step with delta_grid once a client has asked for
+// a zoomed-out level; it is rebuilt with the delta history and otherwise
+// updated from the cells marked while tracking.
+static void server_track_pyramid(Server* server, const WorldSnapshot* snapshot, bool rebuild) {
+    if (!server->pyramid_wanted) {
+        return;
+    }
+    uint32_t tick = snapshot->tick;
+    if (rebuild || server->delta_pyramid.level_count == 0) {
+        if (grid_pyramid_build(&server->delta_pyramid, server->delta_grid,
+                               snapshot->width, snapshot->height, tick) < 0) {
+            server->pyramid_wanted = false;
+        }
+        return;
+    }
+    grid_pyramid_update(&server->delta_pyramid, server->delta_grid, tick);
+}
 
-            for (uint32_t i = 0; i < cell_count; i++) {
-                chunk_cells[i] = (uint16_t)server->world->cells[start_index + i].colony_id;
-            }
+// Bring delta_grid/delta_changed_tick up to date with a snapshot, visiting
+// only the snapshot tiles that changed since the last tracked one. Returns
+// false when deltas cannot be built this tick (every client gets a keyframe).
+static bool server_track_world_changes(Server* server, const WorldSnapshot* snapshot) {
+    uint32_t tick = snapshot->tick;
+    uint32_t grid_size = snapshot->width * snapshot->height;
+    if (grid_size == 0 || grid_size > MAX_GRID_SIZE) {
+        return false;
+    }
+
+    bool restart = server->delta_cells != grid_size || tick <= server->delta_tick;
+    if (restart) {
+        // Fresh history (first broadcast, new dimensions, reset, or a tick that
+        // did not advance): no earlier baseline is trustworthy any more.
+        server_invalidate_world_deltas(server);
+
+        uint32_t* grid = (uint32_t*)realloc(server->delta_grid, (size_t)grid_size * sizeof(uint32_t));
+        if (!grid) {
+            return false;
+        }
+        server->delta_grid = grid;
+        uint32_t* changed = (uint32_t*)realloc(server->delta_changed_tick, (size_t)grid_size * sizeof(uint32_t));
+        if (!changed) {
+            return false;
+        }
+        server->delta_changed_tick = changed;
 
-            ProtoWorldDeltaGridChunk chunk = {
-                .tick = proto_world.tick,
-                .width = proto_world.width,
-                .height = proto_world.height,
-                .total_cells = grid_size,
-                .start_index = start_index,
-                .cell_count = cell_count,
-                .final_chunk = (chunk_idx + 1u == chunk_count),
-                .cells = chunk_cells,
-            };
+        // Deltas never exceed half a raw grid or one payload, which bounds
+        // both scratch arrays; wide ids take at least a byte per cell.
+        size_t budget = ((size_t)grid_size * sizeof(uint16_t)) / 2;
+        if (budget > MAX_PAYLOAD_SIZE) {
+            budget = MAX_PAYLOAD_SIZE;
+        }
+        size_t span_capacity = budget / GRID_SPAN_HEADER_SIZE + 1;
+        size_t cell_capacity = budget + 1;
+        ProtoGridSpan* spans = (ProtoGridSpan*)realloc(server->delta_span_scratch,
+                                                       span_capacity * sizeof(ProtoGridSpan));
+        if (!spans) {
+            return false;
+        }
+        server->delta_span_scratch = spans;
+        server->delta_span_capacity = span_capacity;
+        uint32_t* cells = (uint32_t*)realloc(server->delta_cell_scratch, cell_capacity * sizeof(uint32_t));
+        if (!cells) {
+            return false;
+        }
+        server->delta_cell_scratch = cells;
+        server->delta_cell_capacity = cell_capacity;
 
-            if (protocol_serialize_world_delta_grid_chunk(&chunk, &chunk_buffers[chunk_idx], &chunk_lengths[chunk_idx]) < 0) {
-                for (size_t free_idx = 0; free_idx < chunk_count; free_idx++) {
-                    free(chunk_buffers[free_idx]);
+        memcpy(server->delta_grid, snapshot->cells, (size_t)grid_size * sizeof(uint32_t));
+        for (uint32_t i = 0; i < grid_size; i++) {
+            server->delta_changed_tick[i] = tick;
+        }
+        server->delta_cells = grid_size;
+        server->delta_floor_tick = tick;
+        server->delta_tick = tick;
+        server->delta_generation = snapshot->generation;
+        server_track_pyramid(server, snapshot, true);
+        return true;
+    }
+
+    // Tiles untouched since delta_tick still match delta_grid, as long as
+    // the snapshot continues the history delta_grid was tracked from
+    bool same_history = snapshot->generation == server->delta_generation;
+    bool pyramid = server->delta_pyramid.level_count > 0;
+    for (uint32_t tile = 0; tile < snapshot->tile_count; tile++) {
+        if (same_history && snapshot->tile_tick[tile] <= server->delta_tick) {
+            continue;
+        }
+        uint32_t start = tile * WORLD_SNAPSHOT_TILE_CELLS;
+        uint32_t end = start + WORLD_SNAPSHOT_TILE_CELLS < grid_size ? start + WORLD_SNAPSHOT_TILE_CELLS : grid_size;
+        for (uint32_t i = start; i < end; i++) {
+            uint32_t id = snapshot->cells[i];
+            if (id != server->delta_grid[i]) {
+                server->delta_grid[i] = id;
+                server->delta_changed_tick[i] = tick;
+                if (pyramid) {
+                    grid_pyramid_mark(&server->delta_pyramid, i);
                 }
-                free(chunk_buffers);
-                free(chunk_lengths);
-                free(chunk_cells);
-                free(buffer);
-                proto_world_free(&proto_world);
-                return;
             }
         }
     }
-    free(chunk_cells);
-    
+    server->delta_tick = tick;
+    server->delta_generation = snapshot->generation;
+    server_track_pyramid(server, snapshot, false);
+    return true;
+}
+
+// Half-open cell rectangle [x0, x1) x [y0, y1)
+typedef struct {
+    uint32_t x0, y0, x1, y1;
+} ServerGridRect;
+
+// Cells a client receives grid updates for: its viewport grown by
+// SERVER_VIEWPORT_MARGIN and clamped to the world, or the whole grid.
+static ServerGridRect server_client_grid_rect(const Server* server, const ClientSession* client) {
+    uint32_t width = (uint32_t)server->world->width;
+    uint32_t height = (uint32_t)server->world->height;
+    ServerGridRect rect = { 0, 0, width, height };
+    if (!client->has_viewport) {
+        return rect;
+    }
+
+    const CommandSetViewport* view = &client->viewport;
+    uint64_t x0 = view->x > SERVER_VIEWPORT_MARGIN ? view->x - SERVER_VIEWPORT_MARGIN : 0;
+    uint64_t y0 = view->y > SERVER_VIEWPORT_MARGIN ? view->y - SERVER_VIEWPORT_MARGIN : 0;
+    uint64_t x1 = (uint64_t)view->x + view->width + SERVER_VIEWPORT_MARGIN;
+    uint64_t y1 = (uint64_t)view->y + view->height + SERVER_VIEWPORT_MARGIN;
+    if (x0 >= width || y0 >= height) {
+        // Looking past the edge of the dish: nothing to stream
+        rect.x1 = rect.x0;
+        return rect;
+    }
+    rect.x0 = (uint32_t)x0;
+    rect.y0 = (uint32_t)y0;
+    rect.x1 = x1 < width ? (uint32_t)x1 : width;
+    rect.y1 = y1 < height ? (uint32_t)y1 : height;
+    return rect;
+}
+
+// The same rect in pyramid level cells, widened to whole level cells.
+static ServerGridRect server_grid_rect_at_level(ServerGridRect rect, uint32_t level) {
+    rect.x0 >>= level;
+    rect.y0 >>= level;
+    rect.x1 = proto_grid_level_dim(rect.x1, level);
+    rect.y1 = proto_grid_level_dim(rect.y1, level);
+    return rect;
+}
+
+static bool server_grid_rect_equal(const ServerGridRect* a, const ServerGridRect* b) {
+    return a->x0 == b->x0 && a->y0 == b->y0 && a->x1 == b->x1 && a->y1 == b->y1;
+}
+
+// Encode the cells of grid (the tracked base grid or a pyramid level) inside
+// rect changed after base_tick as a span delta. Only rows of the rect are
+// scanned, so a viewport costs O(viewport cells).
+// @return 0 on success, 1 if a keyframe is cheaper, -1 on failure
+static int server_encode_world_delta(Server* server, const GridPyramidLevel* grid, uint32_t base_tick,
+                                     const ServerGridRect* rect, uint8_t** buffer, size_t* len) {
+    const uint32_t* changed = grid->changed_tick;
+    uint32_t width = grid->width;
+    uint32_t rect_width = rect->x1 > rect->x0 ? rect->x1 - rect->x0 : 0;
+    uint32_t rect_height = rect->y1 > rect->y0 ? rect->y1 - rect->y0 : 0;
+    size_t budget = ((size_t)rect_width * rect_height * sizeof(uint16_t)) / 2;
+    if (budget > MAX_PAYLOAD_SIZE - WORLD_DELTA_SPANS_HEADER_SIZE) {
+        budget = MAX_PAYLOAD_SIZE - WORLD_DELTA_SPANS_HEADER_SIZE;
+    }
+
+    // Full-width rects are one contiguous range, so spans may cross rows.
+    bool full_rows = rect_width == width;
+    uint32_t segments = full_rows ? (rect_height > 0 ? 1u : 0u) : rect_height;
+
+    // Sizes as uint16 ids and as varints; the serializer switches to varints
+    // once any id needs them.
+    size_t bytes = 0;
+    size_t wide_bytes = 0;
+    bool wide = false;
+    uint32_t span_count = 0;
+    uint32_t cell_count = 0;
+    for (uint32_t segment = 0; segment < segments && rect_width > 0; segment++) {
+        uint32_t i = (rect->y0 + segment) * width + rect->x0;
+        uint32_t end = full_rows ? rect->y1 * width : i + rect_width;
+        while (i < end) {
+            if (changed[i] <= base_tick) {
+                i++;
+                continue;
+            }
+
+            // Extend the span while changed cells keep appearing within the merge gap.
+            uint32_t start = i;
+            uint32_t last = i;
+            uint32_t j = i + 1;
+            while (j < end && j - start < UINT16_MAX && j - last <= SERVER_DELTA_SPAN_MERGE_GAP) {
+                if (changed[j] > base_tick) {
+                    last = j;
+                }
+                j++;
+            }
+
+            uint32_t length = last - start + 1;
+            bytes += GRID_SPAN_HEADER_SIZE + (size_t)length * sizeof(uint16_t);
+            wide_bytes += GRID_SPAN_HEADER_SIZE;
+            for (uint32_t k = start; k <= last; k++) {
+                wide_bytes += proto_grid_id_varint_size(grid->cells[k]);
+                wide = wide || grid->cells[k] > UINT16_MAX;
+            }
+            if ((wide ? wide_bytes : bytes) > budget) {
+                return 1;
+            }
+
+            server->delta_span_scratch[span_count].start = start;
+            server->delta_span_scratch[span_count].length = (uint16_t)length;
+            memcpy(&server->delta_cell_scratch[cell_count], &grid->cells[start],
+                   (size_t)length * sizeof(uint32_t));
+            span_count++;
+            cell_count += length;
+            i = last + 1;
+        }
+    }
+
+    ProtoWorldDeltaSpans delta = {
+        .tick = server->delta_tick,
+        .base_tick = base_tick,
+        .width = grid->width,
+        .height = grid->height,
+        .span_count = span_count,
+        .cell_count = cell_count,
+        .spans = server->delta_span_scratch,
+        .cells = server->delta_cell_scratch,
+    };
+    return protocol_serialize_world_delta_spans(&delta, buffer, len) == 0 ? 0 : -1;
+}
+
+// Encode one keyframe grid chunk of the world, or of pyramid level lod when
+// not NULL. final_chunk is also set on the last chunk of a viewport's range,
+// which is not the last chunk of the grid.
+static ProtoFrame* server_encode_keyframe_chunk(const WorldSnapshot* snapshot,
+                                                const GridPyramidLevel* lod, size_t chunk_idx,
+                                                bool final_chunk) {
+    uint32_t width = lod ? lod->width : snapshot->width;
+    uint32_t height = lod ? lod->height : snapshot->height;
+    uint32_t grid_size = width * height;
+    uint32_t start_index = (uint32_t)(chunk_idx * MAX_GRID_CHUNK_CELLS);
+    uint32_t cell_count = grid_size - start_index;
+    if (cell_count > MAX_GRID_CHUNK_CELLS) {
+        cell_count = MAX_GRID_CHUNK_CELLS;
+    }
+
+    // Encoded straight from the plane; the serializer only reads the cells
+    const uint32_t* source = lod ? lod->cells : snapshot->cells;
+    ProtoWorldDeltaGridChunk chunk = {
+        .tick = snapshot->tick,
+        .width = width,
+        .height = height,
+        .total_cells = grid_size,
+        .start_index = start_index,
+        .cell_count = cell_count,
+        .final_chunk = final_chunk,
+        .cells = (uint32_t*)&source[start_index],
+    };
+
+    uint8_t* chunk_buffer = NULL;
+    size_t chunk_len = 0;
+    if (protocol_serialize_world_delta_grid_chunk(&chunk, &chunk_buffer, &chunk_len) < 0) {
+        return NULL;
+    }
+    return proto_frame_create(MSG_WORLD_DELTA, chunk_buffer, chunk_len);
+}
+
+// Keyframe chunks shared out between pool workers and the broadcasting
+// thread. Heap-allocated and counted: a task the pool starts late finds
+// nothing left to claim and only drops its reference.
+typedef struct {
+    atomic_int refs;
+    atomic_size_t next_chunk;
+    const WorldSnapshot* snapshot;
+    const GridPyramidLevel* lod;
+    ProtoFrame** frames;
+    size_t chunk_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t done_cond;
+    size_t done_count;  // Guarded by mutex
+} ServerChunkJob;
+
+static void server_chunk_job_release(ServerChunkJob* job) {
+    if (atomic_fetch_sub(&job->refs, 1) == 1) {
+        pthread_cond_destroy(&job->done_cond);
+        pthread_mutex_destroy(&job->mutex);
+        free(job);
+    }
+}
+
+static void server_chunk_job_run(ServerChunkJob* job) {
+    size_t encoded = 0;
+    for (;;) {
+        size_t chunk_idx = atomic_fetch_add(&job->next_chunk, 1u);
+        if (chunk_idx >= job->chunk_count) {
+            break;
+        }
+        job->frames[chunk_idx] = server_encode_keyframe_chunk(job->snapshot, job->lod, chunk_idx,
+                                                              chunk_idx + 1u == job->chunk_count);
+        encoded++;
+    }
+    if (encoded > 0) {
+        pthread_mutex_lock(&job->mutex);
+        job->done_count += encoded;
+        if (job->done_count == job->chunk_count) {
+            pthread_cond_signal(&job->done_cond);
+        }
+        pthread_mutex_unlock(&job->mutex);
+    }
+}
+
+static void server_chunk_job_task(void* arg) {
+    ServerChunkJob* job = (ServerChunkJob*)arg;
+    server_chunk_job_run(job);
+    server_chunk_job_release(job);
+}
+
+// Encode every chunk into frames with up to one helper task per encode
+// helper; the caller encodes too, so this finishes even while the helpers
+// are slow to start. Only the caller waits, and only for claimed chunks.
+// @return 0 once all are attempted, -1 if the job could not be set up
+static int server_encode_chunks_parallel(ThreadPool* pool, const WorldSnapshot* snapshot,
+                                         const GridPyramidLevel* lod, ProtoFrame** frames,
+                                         size_t chunk_count) {
+    size_t helpers = chunk_count - 1u;
+    if (!pool || pool->thread_count < 1 || helpers == 0) {
+        return -1;
+    }
+    if (helpers > (size_t)pool->thread_count) {
+        helpers = (size_t)pool->thread_count;
+    }
+
+    ServerChunkJob* job = (ServerChunkJob*)calloc(1, sizeof(ServerChunkJob));
+    void** args = (void**)malloc(helpers * sizeof(void*));
+    if (!job || !args) {
+        free(job);
+        free(args);
+        return -1;
+    }
+    if (pthread_mutex_init(&job->mutex, NULL) != 0) {
+        free(job);
+        free(args);
+        return -1;
+    }
+    if (pthread_cond_init(&job->done_cond, NULL) != 0) {
+        pthread_mutex_destroy(&job->mutex);
+        free(job);
+        free(args);
+        return -1;
+    }
+    atomic_init(&job->refs, (int)helpers + 1);
+    atomic_init(&job->next_chunk, 0u);
+    job->snapshot = snapshot;
+    job->lod = lod;
+    job->frames = frames;
+    job->chunk_count = chunk_count;
+    for (size_t h = 0; h < helpers; h++) {
+        args[h] = job;
+    }
+
+    threadpool_submit_batch(pool, server_chunk_job_task, (void* const*)args, (int)helpers);
+    free(args);
+    server_chunk_job_run(job);
+
+    pthread_mutex_lock(&job->mutex);
+    while (job->done_count < chunk_count) {
+        pthread_cond_wait(&job->done_cond, &job->mutex);
+    }
+    pthread_mutex_unlock(&job->mutex);
+    server_chunk_job_release(job);
+    return 0;
+}
+
+// Keyframe grid chunks for worlds too large to inline in MSG_WORLD_STATE, or
+// for pyramid level lod (never inlined). Chunks are encoded in parallel on
+// the encode helpers when there are any and more than one chunk.
+static int server_build_keyframe_chunks(ThreadPool* pool, const WorldSnapshot* snapshot,
+                                        const GridPyramidLevel* lod,
+                                        ProtoFrame*** out_frames, size_t* out_count) {
+    uint32_t grid_size = lod ? lod->width * lod->height : snapshot->width * snapshot->height;
+    *out_frames = NULL;
+    *out_count = 0;
+    if ((!lod && snapshot->world.has_grid) || grid_size == 0 || grid_size > MAX_GRID_SIZE) {
+        return 0;
+    }
+
+    size_t chunk_count = (grid_size + MAX_GRID_CHUNK_CELLS - 1u) / MAX_GRID_CHUNK_CELLS;
+    ProtoFrame** chunk_frames = (ProtoFrame**)calloc(chunk_count, sizeof(ProtoFrame*));
+    if (!chunk_frames) {
+        return -1;
+    }
+
+    if (server_encode_chunks_parallel(pool, snapshot, lod, chunk_frames, chunk_count) < 0) {
+        for (size_t chunk_idx = 0; chunk_idx < chunk_count; chunk_idx++) {
+            chunk_frames[chunk_idx] = server_encode_keyframe_chunk(snapshot, lod, chunk_idx,
+                                                                   chunk_idx + 1u == chunk_count);
+            if (!chunk_frames[chunk_idx]) {
+                break;
+            }
+        }
+    }
+    for (size_t chunk_idx = 0; chunk_idx < chunk_count; chunk_idx++) {
+        if (!chunk_frames[chunk_idx]) {
+            for (size_t free_idx = 0; free_idx < chunk_count; free_idx++) {
+                proto_frame_release(chunk_frames[free_idx]);
+            }
+            free(chunk_frames);
+            return -1;
+        }
+    }
+
+    *out_frames = chunk_frames;
+    *out_count = chunk_count;
+    return 0;
+}
+
+#define SERVER_DELTA_CACHE_SLOTS 8
+
+typedef struct {
+    uint32_t base_tick;
+    uint32_t level;
+    ServerGridRect rect;
+    int status;          // Result of server_encode_world_delta
+    ProtoFrame* frame;
+} DeltaCacheEntry;
+
+// Keyframe chunks of one pyramid level, built on first use during a broadcast
+typedef struct {
+    bool built;
+    size_t count;
+    ProtoFrame** chunks;
+    ProtoFrame** final_chunks;  // chunks[i] re-encoded with final_chunk set
+} KeyframeChunkSet;
+
+// MSG_COLONY_DELTA for one base tick (or the whole table)
+typedef struct {
+    bool full;
+    uint32_t base_tick;
+    ProtoFrame* frame;   // NULL if encoding failed
+} ColonyDeltaCacheEntry;
+
+static void server_note_colony_info_sent(ClientSession* client, const ProtoFrame* info) {
+    if (info->payload_len != COLONY_DETAIL_SERIALIZED_SIZE) {
+        client->has_sent_colony_info = false;
+        return;
+    }
+    memcpy(client->sent_colony_info, info->payload, COLONY_DETAIL_SERIALIZED_SIZE);
+    client->has_sent_colony_info = true;
+}
+
+// Queue MSG_COLONY_INFO unless the client already has the same detail. The
+// tick right after the base record changes every broadcast and is not compared.
+static void server_push_colony_info(ClientSession* client, ProtoFrame* info) {
+    const size_t tick_offset = COLONY_SERIALIZED_SIZE;
+    if (client->has_sent_colony_info && info->payload_len == COLONY_DETAIL_SERIALIZED_SIZE &&
+        memcmp(client->sent_colony_info, info->payload, tick_offset) == 0 &&
+        memcmp(client->sent_colony_info + tick_offset + 4, info->payload + tick_offset + 4,
+               COLONY_DETAIL_SERIALIZED_SIZE - tick_offset - 4) == 0) {
+        return;
+    }
+    if (send_queue_push_control(&client->send_queue, info) < 0) {
+        client->send_failed = true;
+        return;
+    }
+    server_note_colony_info_sent(client, info);
+}
+
+// Keep colony_track current while some client takes colony deltas; the
+// history is dropped otherwise and restarts with the next such client.
+static bool server_track_colony_changes(Server* server, const ProtoWorld* proto_world, uint32_t tick) {
+    bool wanted = false;
+    for (ClientSession* client = server->clients; client && !wanted; client = client->next) {
+        wanted = (client->capabilities & PROTO_CAP_COLONY_DELTA) != 0;
+    }
+    if (!wanted) {
+        colony_track_invalidate(&server->colony_track);
+        return false;
+    }
+    return colony_track_update(&server->colony_track, proto_world, tick, server->delta_max_gap) == 0;
+}
+
+static ProtoFrame* server_encode_colony_delta(const Server* server, bool full, uint32_t base_tick) {
+    ProtoColonyDelta delta;
+    if (colony_track_build_delta(&server->colony_track, full, base_tick, &delta) < 0) {
+        return NULL;
+    }
+    uint8_t* buffer = NULL;
+    size_t len = 0;
+    ProtoFrame* frame = NULL;
+    if (protocol_serialize_colony_delta(&delta, &buffer, &len) == 0) {
+        frame = proto_frame_create(MSG_COLONY_DELTA, buffer, len);
+    }
+    proto_colony_delta_free(&delta);
+    return frame;
+}
+
+// MSG_WORLD_STATE without the inline grid or the colony table
+static ProtoFrame* server_build_slim_state(ProtoWorld* proto_world) {
+    uint32_t colony_count = proto_world->colony_count;
+    bool has_grid = proto_world->has_grid;
+    proto_world->colony_count = 0;
+    proto_world->has_grid = false;
+    uint8_t* buffer = NULL;
+    size_t len = 0;
+    int result = protocol_serialize_world_state(proto_world, &buffer, &len);
+    proto_world->colony_count = colony_count;
+    proto_world->has_grid = has_grid;
+    return result == 0 ? proto_frame_create(MSG_WORLD_STATE, buffer, len) : NULL;
+}
+
+void server_note_world_ack(Server* server, ClientSession* client, uint32_t tick) {
+    if (!server || !client || !client->keyframe_sent) {
+        return;
+    }
+    if (tick < client->keyframe_tick || tick > server->delta_tick) {
+        return;
+    }
+    if (!client->has_baseline || tick > client->baseline_tick) {
+        client->baseline_tick = tick;
+        client->has_baseline = true;
+    }
+}
+
+// Apply MSG_ACKs queued by the I/O thread. Runs on the broadcasting thread,
+// which owns delta_tick; caller holds clients_mutex.
+static void server_apply_world_acks(Server* server) {
+    MpscNode* node;
+    while ((node = mpsc_queue_pop(&server->acks)) != NULL) {
+        ServerInboundEvent* event = (ServerInboundEvent*)node;
+        ClientSession* client = server_find_client(server, event->client_id);
+        if (client && client->active) {
+            server_note_world_ack(server, client, event->ack_tick);
+        }
+        free(event);
+    }
+}
+
+// Frames and caches shared by every client of one broadcast. Each message is
+// encoded at most once into a shared frame; clients only take references, so
+// per-client cost is the send itself.
+typedef struct {
+    Server* server;
+    const WorldSnapshot* snapshot;
+    ProtoWorld proto_world;          // Shares the snapshot's arrays; never freed here
+    uint32_t tick;
+    bool deltas_enabled;
+    bool colony_deltas;
+    GridPyramidLevel base_grid;
+    ProtoFrame* keyframe_state;      // Carries the inline grid when the world is small enough
+    ProtoFrame* delta_state;         // The same state without the grid
+    // Colony table entries past MAX_COLONIES, for clients that page them in
+    ProtoFrame** colony_pages;
+    ProtoFrame** compressed_colony_pages;  // Borrowed twins of colony_pages
+    size_t colony_page_count;
+    KeyframeChunkSet keyframe_sets[PROTO_GRID_MAX_LEVEL + 1];
+    ProtoFrame** keyframe_group;     // keyframe_state followed by the level-0 chunks
+    ProtoFrame** compressed_keyframe_group;  // Borrowed twins of keyframe_group
+    bool keyframe_group_built;
+    ProtoFrame** view_group;         // Per-client scratch for viewport and pyramid keyframes
+    size_t view_group_capacity;
+    DeltaCacheEntry delta_cache[SERVER_DELTA_CACHE_SLOTS];
+    int delta_cache_count;
+    ColonyDeltaCacheEntry colony_cache[SERVER_DELTA_CACHE_SLOTS];
+    int colony_cache_count;
+    ProtoFrame* slim_state;          // For colony delta clients, built on first use
+    bool slim_state_built;
+} BroadcastFrames;
+
+// What one client is sent this broadcast
+typedef struct {
+    uint32_t level;                  // Pyramid level actually served
+    const GridPyramidLevel* lod;     // NULL for full resolution
+    ServerGridRect rect;             // Viewport at that level
+    uint32_t base_tick;
+    bool have_base;
+    bool grid_readable;
+    bool compress;
+} ClientStream;
+
+static int broadcast_frames_init(BroadcastFrames* frames, Server* server, const WorldSnapshot* snapshot) {
+    memset(frames, 0, sizeof(*frames));
+    frames->server = server;
+    frames->snapshot = snapshot;
+    frames->proto_world = snapshot->world;
+    frames->tick = snapshot->world.tick;
+
+    ProtoWorld* proto_world = &frames->proto_world;
+    uint8_t* buffer = NULL;
+    size_t len = 0;
+    if (protocol_serialize_world_state(proto_world, &buffer, &len) < 0) {
+        return -1;
+    }
+    frames->keyframe_state = proto_frame_create(MSG_WORLD_STATE, buffer, len);
+    if (!frames->keyframe_state) {
+        return -1;
+    }
+
+    if (proto_world->has_grid) {
+        proto_world->has_grid = false;
+        int result = protocol_serialize_world_state(proto_world, &buffer, &len);
+        proto_world->has_grid = true;
+        if (result == 0) {
+            frames->delta_state = proto_frame_create(MSG_WORLD_STATE, buffer, len);
+        }
+        if (!frames->delta_state) {
+            proto_frame_release(frames->keyframe_state);
+            return -1;
+        }
+    } else {
+        frames->delta_state = proto_frame_retain(frames->keyframe_state);
+    }
+
+    if (proto_world->extra_colony_count > 0) {
+        size_t page_total = (proto_world->extra_colony_count + PROTO_COLONY_PAGE_SIZE - 1u) / PROTO_COLONY_PAGE_SIZE;
+        frames->colony_pages = (ProtoFrame**)calloc(page_total, sizeof(ProtoFrame*));
+        for (size_t p = 0; frames->colony_pages && p < page_total; p++) {
+            uint32_t first = (uint32_t)(p * PROTO_COLONY_PAGE_SIZE);
+            uint32_t remaining = proto_world->extra_colony_count - first;
+            ProtoColonyPage page = {
+                .tick = frames->tick,
+                .total_count = proto_world_colony_total(proto_world),
+                .start = MAX_COLONIES + first,
+                .count = remaining < PROTO_COLONY_PAGE_SIZE ? remaining : PROTO_COLONY_PAGE_SIZE,
+                .colonies = &proto_world->extra_colonies[first],
+            };
+            if (protocol_serialize_colony_page(&page, &buffer, &len) < 0 ||
+                !(frames->colony_pages[p] = proto_frame_create(MSG_COLONY_PAGE, buffer, len))) {
+                break;
+            }
+            frames->colony_page_count++;
+        }
+    }
+    return 0;
+}
+
+static void broadcast_frames_release(BroadcastFrames* frames) {
+    for (int d = 0; d < frames->delta_cache_count; d++) {
+        proto_frame_release(frames->delta_cache[d].frame);
+    }
+    for (int c = 0; c < frames->colony_cache_count; c++) {
+        proto_frame_release(frames->colony_cache[c].frame);
+    }
+    proto_frame_release(frames->slim_state);
+    for (uint32_t level = 0; level <= PROTO_GRID_MAX_LEVEL; level++) {
+        KeyframeChunkSet* set = &frames->keyframe_sets[level];
+        for (size_t chunk_idx = 0; chunk_idx < set->count; chunk_idx++) {
+            proto_frame_release(set->chunks[chunk_idx]);
+            if (set->final_chunks) {
+                proto_frame_release(set->final_chunks[chunk_idx]);
+            }
+        }
+        free(set->chunks);
+        free(set->final_chunks);
+    }
+    for (size_t p = 0; p < frames->colony_page_count; p++) {
+        proto_frame_release(frames->colony_pages[p]);
+    }
+    free(frames->colony_pages);
+    free(frames->compressed_colony_pages);
+    free(frames->keyframe_group);
+    free(frames->compressed_keyframe_group);
+    free(frames->view_group);
+
+    proto_frame_release(frames->delta_state);
+    proto_frame_release(frames->keyframe_state);
+}
+
+// Pick the pyramid level, viewport, baseline and grid format for a client.
+static void server_choose_client_stream(const BroadcastFrames* frames, const ClientSession* client,
+                                        ClientStream* stream) {
+    const Server* server = frames->server;
+    stream->have_base = (client->capabilities & PROTO_CAP_SPAN_DELTA) &&
+                        (client->has_baseline || client->keyframe_sent);
+    stream->base_tick = client->has_baseline ? client->baseline_tick : client->keyframe_tick;
+    // Zoomed-out clients read a pyramid level; fall back to full resolution
+    // while the pyramid is not available.
+    stream->level = client->viewport.level;
+    stream->lod = frames->deltas_enabled ? grid_pyramid_level(&server->delta_pyramid, stream->level) : NULL;
+    if (!stream->lod) {
+        stream->level = 0;
+    }
+    stream->rect = server_grid_rect_at_level(server_client_grid_rect(server, client), stream->level);
+    // Clients that did not negotiate wide ids or large grids get the colony
+    // table alone rather than a grid they would misread. Legacy clients cannot
+    // tell ids past 16 bits apart.
+    const WorldSnapshot* snapshot = frames->snapshot;
+    uint32_t grid_cells = stream->lod ? stream->lod->width * stream->lod->height
+                                      : snapshot->width * snapshot->height;
+    stream->grid_readable = (!snapshot->wide_ids || (client->capabilities & PROTO_CAP_WIDE_IDS)) &&
+                            (grid_cells <= PROTO_LEGACY_MAX_GRID_SIZE ||
+                             (client->capabilities & PROTO_CAP_LARGE_GRID));
+    stream->compress = client->compress && server->compress_min_bytes > 0;
+}
+
+// Grid delta against the client's baseline, shared by clients with the same
+// base, level and viewport. NULL when the client needs a keyframe instead.
+// Past the cache the delta is encoded into *uncached, which the caller
+// releases once the client has been served.
+static const DeltaCacheEntry* server_world_delta_for(BroadcastFrames* frames, const ClientStream* stream,
+                                                     DeltaCacheEntry* uncached) {
+    Server* server = frames->server;
+    uint32_t floor_tick = stream->lod ? server->delta_pyramid.floor_tick : server->delta_floor_tick;
+    if (!stream->grid_readable || !frames->deltas_enabled || !stream->have_base ||
+        stream->base_tick < floor_tick || stream->base_tick > frames->tick ||
+        frames->tick - stream->base_tick > server->delta_max_gap) {
+        return NULL;
+    }
+
+    for (int d = 0; d < frames->delta_cache_count; d++) {
+        const DeltaCacheEntry* cached = &frames->delta_cache[d];
+        if (cached->base_tick == stream->base_tick && cached->level == stream->level &&
+            server_grid_rect_equal(&cached->rect, &stream->rect)) {
+            return cached->status == 0 ? cached : NULL;
+        }
+    }
+
+    // Viewports make cache misses common; past the cache, encode per client
+    DeltaCacheEntry* entry = frames->delta_cache_count < SERVER_DELTA_CACHE_SLOTS ?
+                             &frames->delta_cache[frames->delta_cache_count++] : uncached;
+    uint8_t* delta_buffer = NULL;
+    size_t delta_len = 0;
+    entry->base_tick = stream->base_tick;
+    entry->level = stream->level;
+    entry->rect = stream->rect;
+    entry->frame = NULL;
+    entry->status = server_encode_world_delta(server, stream->lod ? stream->lod : &frames->base_grid,
+                                              stream->base_tick, &stream->rect, &delta_buffer, &delta_len);
+    if (entry->status == 0) {
+        entry->frame = proto_frame_create(MSG_WORLD_DELTA, delta_buffer, delta_len);
+        if (!entry->frame) {
+            entry->status = -1;
+        }
+    }
+    return entry->status == 0 ? entry : NULL;
+}
+
+// MSG_COLONY_DELTA for a base tick (or the whole table), from the cache when
+// another client already needed it. Past the cache the frame goes to
+// *uncached, which the caller releases.
+static ProtoFrame* server_colony_delta_for(BroadcastFrames* frames, bool full, uint32_t colony_base,
+                                           ProtoFrame** uncached) {
+    for (int c = 0; c < frames->colony_cache_count; c++) {
+        if (frames->colony_cache[c].full == full && frames->colony_cache[c].base_tick == colony_base) {
+            return frames->colony_cache[c].frame;
+        }
+    }
+    ProtoFrame* frame = server_encode_colony_delta(frames->server, full, colony_base);
+    if (frames->colony_cache_count < SERVER_DELTA_CACHE_SLOTS) {
+        ColonyDeltaCacheEntry* entry = &frames->colony_cache[frames->colony_cache_count++];
+        entry->full = full;
+        entry->base_tick = colony_base;
+        entry->frame = frame;
+    } else if (frame) {
+        proto_frame_release(*uncached);
+        *uncached = frame;
+    }
+    return frame;
+}
+
+// Colony delta clients get the table ahead of a state without it: against the
+// grid baseline when a grid delta follows, else whole. Returns true when the
+// table was queued, so the slim state can follow.
+static bool server_enqueue_colony_delta(BroadcastFrames* frames, ClientSession* client,
+                                        const ClientStream* stream, bool grid_delta,
+                                        ProtoFrame** uncached) {
+    ProtoFrame* colony_frame = NULL;
+    bool full = !stream->grid_readable || !grid_delta;
+    // A base the colony history does not reach falls back to the whole table
+    for (int attempt = 0; attempt < 2 && !colony_frame; attempt++) {
+        full = full || attempt > 0;
+        colony_frame = server_colony_delta_for(frames, full, full ? 0u : stream->base_tick, uncached);
+        if (full) {
+            break;
+        }
+    }
+    if (colony_frame && !frames->slim_state_built) {
+        frames->slim_state_built = true;
+        frames->slim_state = server_build_slim_state(&frames->proto_world);
+    }
+    // Without either frame the client gets the full-table state
+    ProtoFrame* table = colony_frame && frames->slim_state ? colony_frame : NULL;
+    if (table && stream->compress) {
+        table = proto_frame_compressed(colony_frame, frames->server->compress_min_bytes);
+    }
+    if (table && send_queue_push_world(&client->send_queue, &table, 1, false) == 0) {
+        client->world_bytes_sent += table->payload_len;
+        return true;
+    }
+    return false;
+}
+
+// State alone, for clients that cannot read this grid
+static void server_enqueue_state(const BroadcastFrames* frames, ClientSession* client,
+                                 const ClientStream* stream, ProtoFrame* plain_state) {
+    ProtoFrame* state = stream->compress ? proto_frame_compressed(plain_state, frames->server->compress_min_bytes)
+                                         : plain_state;
+    if (send_queue_push_world(&client->send_queue, &state, 1, false) == 0) {
+        client->world_bytes_sent += state->payload_len;
+    }
+    client->keyframe_sent = false;
+    client->has_baseline = false;
+}
+
+static void server_enqueue_world_delta(const BroadcastFrames* frames, ClientSession* client,
+                                       const ClientStream* stream, ProtoFrame* plain_state,
+                                       const DeltaCacheEntry* delta) {
+    ProtoFrame* group[2] = { plain_state, delta->frame };
+    if (stream->compress) {
+        group[0] = proto_frame_compressed(plain_state, frames->server->compress_min_bytes);
+        group[1] = proto_frame_compressed(delta->frame, frames->server->compress_min_bytes);
+    }
+    if (send_queue_push_world(&client->send_queue, group, 2, false) == 0) {
+        client->deltas_sent++;
+        client->world_bytes_sent += group[0]->payload_len + group[1]->payload_len;
+    }
+}
+
+// Keyframe chunks for a level, built on first use; level 0 also gets the
+// shared group of keyframe_state followed by every chunk.
+static KeyframeChunkSet* broadcast_keyframe_set(BroadcastFrames* frames, const ClientStream* stream) {
+    KeyframeChunkSet* set = &frames->keyframe_sets[stream->level];
+    if (!set->built) {
+        set->built = true;
+        if (server_build_keyframe_chunks(frames->server->encode_pool, frames->snapshot, stream->lod,
+                                         &set->chunks, &set->count) < 0) {
+            set->count = 0;
+        }
+    }
+    if (stream->level == 0 && !frames->keyframe_group_built) {
+        frames->keyframe_group_built = true;
+        frames->keyframe_group = (ProtoFrame**)malloc((set->count + 1) * sizeof(ProtoFrame*));
+        if (frames->keyframe_group) {
+            frames->keyframe_group[0] = frames->keyframe_state;
+            for (size_t chunk_idx = 0; chunk_idx < set->count; chunk_idx++) {
+                frames->keyframe_group[chunk_idx + 1] = set->chunks[chunk_idx];
+            }
+        }
+    }
+    return set;
+}
+
+// head followed by chunks [first_chunk, last_chunk] of a level, in the
+// shared scratch group. The last one must carry final_chunk so the client
+// completes the grid. NULL if a frame could not be built.
+static ProtoFrame** server_keyframe_view_group(BroadcastFrames* frames, KeyframeChunkSet* set,
+                                               const ClientStream* stream, ProtoFrame* head,
+                                               size_t first_chunk, size_t last_chunk, size_t group_count) {
+    size_t chunk_count = set->count;
+    if (frames->view_group_capacity < group_count) {
+        ProtoFrame** grown = (ProtoFrame**)realloc(frames->view_group, group_count * sizeof(ProtoFrame*));
+        if (grown) {
+            frames->view_group = grown;
+            frames->view_group_capacity = group_count;
+        }
+    }
+    if (!set->final_chunks && chunk_count > 0) {
+        set->final_chunks = (ProtoFrame**)calloc(chunk_count, sizeof(ProtoFrame*));
+    }
+    if (frames->view_group_capacity < group_count || (!set->final_chunks && chunk_count > 0)) {
+        return NULL;
+    }
+
+    ProtoFrame** group = frames->view_group;
+    group[0] = head;
+    for (size_t f = 1; f < group_count; f++) {
+        group[f] = set->chunks[first_chunk + f - 1];
+    }
+    if (group_count > 1 && last_chunk + 1 < chunk_count) {
+        if (!set->final_chunks[last_chunk]) {
+            set->final_chunks[last_chunk] = server_encode_keyframe_chunk(frames->snapshot, stream->lod,
+                                                                         last_chunk, true);
+        }
+        group[group_count - 1] = set->final_chunks[last_chunk];
+    }
+    for (size_t f = 0; f < group_count; f++) {
+        if (!group[f]) {
+            return NULL;
+        }
+    }
+    if (stream->compress) {
+        for (size_t f = 0; f < group_count; f++) {
+            group[f] = proto_frame_compressed(group[f], frames->server->compress_min_bytes);
+        }
+    }
+    return group;
+}
+
+// Full level-0 keyframe group with each frame swapped for its compressed twin
+static ProtoFrame** broadcast_compressed_keyframe_group(BroadcastFrames* frames, size_t group_count) {
+    if (!frames->compressed_keyframe_group) {
+        frames->compressed_keyframe_group = (ProtoFrame**)malloc(group_count * sizeof(ProtoFrame*));
+        for (size_t f = 0; frames->compressed_keyframe_group && f < group_count; f++) {
+            frames->compressed_keyframe_group[f] = proto_frame_compressed(frames->keyframe_group[f],
+                                                                          frames->server->compress_min_bytes);
+        }
+    }
+    return frames->compressed_keyframe_group ? frames->compressed_keyframe_group : frames->keyframe_group;
+}
+
+static void server_enqueue_keyframe(BroadcastFrames* frames, ClientSession* client,
+                                    const ClientStream* stream, ProtoFrame* plain_state) {
+    KeyframeChunkSet* set = broadcast_keyframe_set(frames, stream);
+    size_t chunk_count = set->count;
+
+    // Pyramid levels never carry the inline level-0 grid
+    ProtoFrame* head = stream->level == 0 ? frames->keyframe_state : plain_state;
+    ProtoFrame** group = frames->keyframe_group;
+    size_t group_count = chunk_count + 1;
+    size_t first_chunk = 0;
+    size_t last_chunk = chunk_count > 0 ? chunk_count - 1 : 0;
+    if (chunk_count > 0 && client->has_viewport) {
+        const ServerGridRect* rect = &stream->rect;
+        uint32_t width = stream->lod ? stream->lod->width : frames->snapshot->width;
+        if (rect->x1 > rect->x0 && rect->y1 > rect->y0) {
+            first_chunk = (rect->y0 * width + rect->x0) / MAX_GRID_CHUNK_CELLS;
+            last_chunk = ((rect->y1 - 1) * width + rect->x1 - 1) / MAX_GRID_CHUNK_CELLS;
+            group_count = last_chunk - first_chunk + 2;
+        } else {
+            group_count = 1;
+        }
+    }
+    if (stream->level > 0 || group_count < chunk_count + 1) {
+        // Only the chunks overlapping the viewport
+        group = server_keyframe_view_group(frames, set, stream, head, first_chunk, last_chunk, group_count);
+    } else if (stream->compress && group) {
+        group = broadcast_compressed_keyframe_group(frames, group_count);
+    }
+    if (!group || send_queue_push_world(&client->send_queue, group, group_count, true) != 0) {
+        return;
+    }
+
+    size_t sent_bytes = 0;
+    for (size_t f = 0; f < group_count; f++) {
+        sent_bytes += group[f]->payload_len;
+    }
+    if (frames->deltas_enabled) {
+        client->keyframe_sent = true;
+        client->keyframe_tick = frames->tick;
+        client->has_baseline = false;
+    }
+    client->keyframes_sent++;
+    client->world_bytes_sent += sent_bytes;
+}
+
+// A group of their own, after the state they extend; newer broadcasts
+// coalesce them like any other world update.
+static void server_enqueue_colony_pages(BroadcastFrames* frames, ClientSession* client, bool compress) {
+    ProtoFrame** pages = frames->colony_pages;
+    if (compress) {
+        if (!frames->compressed_colony_pages) {
+            frames->compressed_colony_pages = (ProtoFrame**)malloc(frames->colony_page_count * sizeof(ProtoFrame*));
+            for (size_t p = 0; frames->compressed_colony_pages && p < frames->colony_page_count; p++) {
+                frames->compressed_colony_pages[p] = proto_frame_compressed(frames->colony_pages[p],
+                                                                            frames->server->compress_min_bytes);
+            }
+        }
+        pages = frames->compressed_colony_pages;
+    }
+    if (pages && send_queue_push_world(&client->send_queue, pages, frames->colony_page_count, false) == 0) {
+        for (size_t p = 0; p < frames->colony_page_count; p++) {
+            client->world_bytes_sent += pages[p]->payload_len;
+        }
+    }
+}
+
+// Queue this broadcast's world update for one socket client: a grid delta
+// when its baseline allows, else a (viewport-trimmed) keyframe, plus the
+// colony table in whichever form it negotiated.
+static void server_enqueue_world_update(BroadcastFrames* frames, ClientSession* client) {
+    // Newer state supersedes world updates still waiting in the queue
+    bool dropped_keyframe = false;
+    send_queue_drop_pending_world(&client->send_queue, &dropped_keyframe);
+    if (dropped_keyframe) {
+        client->keyframe_sent = false;
+    }
+
+    ClientStream stream;
+    server_choose_client_stream(frames, client, &stream);
+    DeltaCacheEntry uncached = { .frame = NULL };
+    const DeltaCacheEntry* delta = server_world_delta_for(frames, &stream, &uncached);
+
+    ProtoFrame* uncached_colony = NULL;
+    bool colony_sent = frames->colony_deltas && (client->capabilities & PROTO_CAP_COLONY_DELTA) &&
+                       server_enqueue_colony_delta(frames, client, &stream, delta != NULL, &uncached_colony);
+    ProtoFrame* plain_state = colony_sent ? frames->slim_state : frames->delta_state;
+
+    if (!stream.grid_readable) {
+        server_enqueue_state(frames, client, &stream, plain_state);
+    } else if (delta) {
+        server_enqueue_world_delta(frames, client, &stream, plain_state, delta);
+    } else {
+        server_enqueue_keyframe(frames, client, &stream, plain_state);
+    }
+    proto_frame_release(uncached.frame);
+    proto_frame_release(uncached_colony);
+
+    if (frames->colony_page_count > 0 && (client->capabilities & PROTO_CAP_COLONY_PAGES) && !colony_sent) {
+        server_enqueue_colony_pages(frames, client, stream.compress);
+    }
+}
+
+// Encode a published snapshot for every client. Reads nothing of the live
+// world, so it may run while the simulation computes the next tick.
+static void server_broadcast_snapshot(Server* server, const WorldSnapshot* snapshot) {
+    BroadcastFrames frames;
+    if (broadcast_frames_init(&frames, server, snapshot) < 0) {
+        return;
+    }
+
+    // One copy for every same-host viewer, however many there are
+    if (server->shm_world) {
+        shm_world_writer_publish(server->shm_world, &frames.proto_world, snapshot->cells,
+                                 snapshot->width, snapshot->height);
+    }
+
     // Broadcast to all clients
     pthread_mutex_lock(&server->clients_mutex);
+    server_apply_world_acks(server);
+    frames.deltas_enabled = server_track_world_changes(server, snapshot);
+    frames.colony_deltas = server_track_colony_changes(server, &frames.proto_world, frames.tick);
+    frames.base_grid = (GridPyramidLevel){
+        .width = snapshot->width,
+        .height = snapshot->height,
+        .cells = server->delta_grid,
+        .changed_tick = server->delta_changed_tick,
+    };
     ClientSession* client = server->clients;
     ClientSession* prev = NULL;
     
@@ -915,20 +2383,24 @@ void server_broadcast_world_state(Server* server) {
         ClientSession* next = client->next;
         
         if (client->active && client->socket && client->socket->connected) {
-            int result = protocol_send_message(client->socket->fd, MSG_WORLD_STATE, buffer, len);
-            if (result == 0) {
-                for (size_t chunk_idx = 0; chunk_idx < chunk_count; chunk_idx++) {
-                    result = protocol_send_message(client->socket->fd, MSG_WORLD_DELTA,
-                                                   chunk_buffers[chunk_idx], chunk_lengths[chunk_idx]);
-                    if (result < 0) {
-                        break;
-                    }
-                }
+            // Shared memory clients read the world from server->shm_world;
+            // their connection carries only replies and colony details.
+            if (!(client->capabilities & PROTO_CAP_SHARED_WORLD)) {
+                server_enqueue_world_update(&frames, client);
             }
-            if (result == 0 && client->selected_colony != 0) {
-                server_send_colony_info(server, client, client->selected_colony);
+            if (client->selected_colony != 0) {
+                // Selections made after this snapshot got their detail from the command
+                ProtoFrame* info = world_snapshot_colony_info(snapshot, client->selected_colony);
+                if (info) {
+                    server_push_colony_info(client, info);
+                }
             }
-            if (result < 0) {
+            int result = server_flush_client(server, client);
+            if (result < 0 && server->io_thread_running) {
+                // The I/O thread owns the socket and frees the session
+                client->send_failed = true;
+                server_wake_io(server);
+            } else if (result < 0) {
                 // Client disconnected
                 printf("Client %u disconnected\n", client->id);
                 client->active = false;
@@ -940,8 +2412,7 @@ void server_broadcast_world_state(Server* server) {
                     server->clients = next;
                 }
                 
-                net_socket_close(client->socket);
-                free(client);
+                server_free_client(client);
                 server->client_count--;
                 
                 client = next;
@@ -954,38 +2425,154 @@ void server_broadcast_world_state(Server* server) {
     }
     pthread_mutex_unlock(&server->clients_mutex);
 
-    for (size_t chunk_idx = 0; chunk_idx < chunk_count; chunk_idx++) {
-        free(chunk_buffers[chunk_idx]);
+    broadcast_frames_release(&frames);
+}
+
+void server_broadcast_world_state(Server* server) {
+    if (!server) return;
+
+    if (server->broadcast_thread_running) {
+        // Publishing under broadcast_mutex pairs each hand-off with its snapshot
+        pthread_mutex_lock(&server->broadcast_mutex);
+        if (server_publish_world_snapshot(server) == 0) {
+            server->broadcast_published++;
+            pthread_cond_signal(&server->broadcast_cond);
+        }
+        pthread_mutex_unlock(&server->broadcast_mutex);
+        return;
     }
-    free(chunk_buffers);
-    free(chunk_lengths);
-    
-    free(buffer);
-    proto_world_free(&proto_world);
+
+    if (server_publish_world_snapshot(server) < 0) {
+        return;
+    }
+    WorldSnapshot* snapshot = world_snapshot_acquire(&server->snapshots);
+    if (!snapshot) {
+        return;
+    }
+    server_broadcast_snapshot(server, snapshot);
+    world_snapshot_release(snapshot);
 }
 
-void server_send_colony_info(Server* server, ClientSession* client, uint32_t colony_id) {
-    if (!server || !client || !client->socket || colony_id == 0) return;
+static void* broadcast_thread_func(void* arg) {
+    Server* server = (Server*)arg;
+    uint64_t handled = 0;
 
-    ProtoColonyDetail detail;
-    memset(&detail, 0, sizeof(detail));
-    detail.base.id = colony_id;
-    detail.tick = (uint32_t)server->world->tick;
-    
-    // Find colony index in internal world
-    size_t colony_idx = 0;
-    bool found = false;
-    for (size_t i = 0; i < server->world->colony_count; i++) {
-        if (server->world->colonies[i].id == colony_id && server->world->colonies[i].active) {
-            colony_idx = i;
-            found = true;
+    pthread_mutex_lock(&server->broadcast_mutex);
+    for (;;) {
+        while (server->broadcast_published == handled && !server->broadcast_stopping) {
+            pthread_cond_wait(&server->broadcast_cond, &server->broadcast_mutex);
+        }
+        if (server->broadcast_published == handled) {
+            break;  // Stopping with nothing left to send
+        }
+        // Only the newest snapshot is encoded; earlier hand-offs are superseded
+        handled = server->broadcast_published;
+        WorldSnapshot* snapshot = world_snapshot_acquire(&server->snapshots);
+        pthread_mutex_unlock(&server->broadcast_mutex);
+
+        if (snapshot) {
+            server_broadcast_snapshot(server, snapshot);
+            world_snapshot_release(snapshot);
+        }
+
+        pthread_mutex_lock(&server->broadcast_mutex);
+        server->broadcast_encoded++;
+    }
+    pthread_mutex_unlock(&server->broadcast_mutex);
+
+    return NULL;
+}
+
+int server_start_broadcast_thread(Server* server) {
+    if (!server) return -1;
+    if (server->broadcast_thread_running) return 0;
+
+    if (pthread_mutex_init(&server->broadcast_mutex, NULL) != 0) {
+        return -1;
+    }
+    if (pthread_cond_init(&server->broadcast_cond, NULL) != 0) {
+        pthread_mutex_destroy(&server->broadcast_mutex);
+        return -1;
+    }
+    server->broadcast_stopping = false;
+    server->broadcast_published = 0;
+    server->broadcast_encoded = 0;
+    if (pthread_create(&server->broadcast_thread, NULL, broadcast_thread_func, server) != 0) {
+        pthread_cond_destroy(&server->broadcast_cond);
+        pthread_mutex_destroy(&server->broadcast_mutex);
+        return -1;
+    }
+    server->broadcast_thread_running = true;
+    return 0;
+}
+
+void server_stop_broadcast_thread(Server* server) {
+    if (!server || !server->broadcast_thread_running) return;
+
+    pthread_mutex_lock(&server->broadcast_mutex);
+    server->broadcast_stopping = true;
+    pthread_cond_signal(&server->broadcast_cond);
+    pthread_mutex_unlock(&server->broadcast_mutex);
+    pthread_join(server->broadcast_thread, NULL);
+
+    server->broadcast_thread_running = false;
+    pthread_cond_destroy(&server->broadcast_cond);
+    pthread_mutex_destroy(&server->broadcast_mutex);
+}
+
+// Link and trait fields for a colony, from the cache while its genome and
+// behavior sensors/drives are unchanged
+static const ProtoColonyDetail* server_colony_detail_derived(Server* server, const Colony* colony) {
+    ServerColonyDetailCache* slot = NULL;
+    for (int i = 0; i < SERVER_COLONY_DETAIL_CACHE_SLOTS; i++) {
+        ServerColonyDetailCache* entry = &server->colony_detail_cache[i];
+        if (entry->colony_id == colony->id) {
+            slot = entry;
             break;
         }
+        if (!slot || entry->last_used < slot->last_used) {
+            slot = entry;
+        }
     }
-    
-    if (found) {
-        Colony* colony = &server->world->colonies[colony_idx];
-        fill_proto_colony_detail_base(server->world, colony, &detail.base);
+    slot->last_used = ++server->colony_detail_clock;
+
+    if (slot->colony_id == colony->id &&
+        memcmp(&slot->genome, &colony->genome, sizeof(Genome)) == 0 &&
+        memcmp(slot->behavior_sensors, colony->behavior_sensors, sizeof(slot->behavior_sensors)) == 0 &&
+        memcmp(slot->behavior_drives, colony->behavior_drives, sizeof(slot->behavior_drives)) == 0) {
+        return &slot->derived;
+    }
+
+    slot->colony_id = colony->id;
+    memcpy(&slot->genome, &colony->genome, sizeof(Genome));
+    memcpy(slot->behavior_sensors, colony->behavior_sensors, sizeof(slot->behavior_sensors));
+    memcpy(slot->behavior_drives, colony->behavior_drives, sizeof(slot->behavior_drives));
+    ProtoColonyDetail* derived = &slot->derived;
+    memset(derived, 0, sizeof(*derived));
+    fill_proto_colony_graph_links(colony, derived);
+    derived->trait_expansion = summarize_trait_expansion(&colony->genome);
+    derived->trait_aggression = summarize_trait_aggression(&colony->genome);
+    derived->trait_resilience = summarize_trait_resilience(&colony->genome);
+    derived->trait_cooperation = summarize_trait_cooperation(&colony->genome);
+    derived->trait_efficiency = summarize_trait_efficiency(&colony->genome);
+    derived->trait_learning = summarize_trait_learning(&colony->genome);
+    return derived;
+}
+
+// snapshot_colony, if given, supplies the base record (centroid included)
+static ProtoFrame* server_build_colony_info_frame(Server* server, uint32_t colony_id,
+                                                  const ProtoColony* snapshot_colony) {
+    ProtoColonyDetail detail;
+    memset(&detail, 0, sizeof(detail));
+
+    Colony* colony = world_get_colony(server->world, colony_id);
+    if (colony) {
+        detail = *server_colony_detail_derived(server, colony);
+        if (snapshot_colony && snapshot_colony->id == colony_id) {
+            detail.base = *snapshot_colony;
+        } else {
+            fill_proto_colony_detail_base(server->world, colony, &detail.base);
+        }
         detail.age = colony->age > UINT32_MAX ? UINT32_MAX : (uint32_t)colony->age;
         detail.parent_id = colony->parent_id;
         detail.state = (uint8_t)colony->state;
@@ -1014,19 +2601,26 @@ void server_send_colony_info(Server* server, ClientSession* client, uint32_t col
         detail.action_transfer = colony->behavior_actions[COLONY_ACTION_TRANSFER];
         detail.action_dormancy = colony->behavior_actions[COLONY_ACTION_DORMANCY];
         detail.action_motility = colony->behavior_actions[COLONY_ACTION_MOTILITY];
-        fill_proto_colony_graph_links(colony, &detail);
-        detail.trait_expansion = summarize_trait_expansion(&colony->genome);
-        detail.trait_aggression = summarize_trait_aggression(&colony->genome);
-        detail.trait_resilience = summarize_trait_resilience(&colony->genome);
-        detail.trait_cooperation = summarize_trait_cooperation(&colony->genome);
-        detail.trait_efficiency = summarize_trait_efficiency(&colony->genome);
-        detail.trait_learning = summarize_trait_learning(&colony->genome);
     }
+    detail.base.id = colony_id;
+    detail.tick = (uint32_t)server->world->tick;
 
     uint8_t buffer[COLONY_DETAIL_SERIALIZED_SIZE];
     int len = protocol_serialize_colony_detail(&detail, buffer);
-    if (len > 0) {
-        protocol_send_message(client->socket->fd, MSG_COLONY_INFO, buffer, (size_t)len);
+    if (len <= 0) {
+        return NULL;
+    }
+    return proto_frame_copy(MSG_COLONY_INFO, buffer, (size_t)len);
+}
+
+void server_send_colony_info(Server* server, ClientSession* client, uint32_t colony_id) {
+    if (!server || !client || !client->socket || colony_id == 0) return;
+
+    ProtoFrame* frame = server_build_colony_info_frame(server, colony_id, NULL);
+    if (frame) {
+        server_note_colony_info_sent(client, frame);
+        server_enqueue_control(server, client, frame);
+        proto_frame_release(frame);
     }
 }
 
@@ -1108,6 +2702,69 @@ void server_handle_command(Server* server, ClientSession* client, CommandType cm
                 }
             }
             break;
+
+        case CMD_SET_VIEWPORT:
+            // The whole grid keeps going to clients that did not negotiate viewports
+            if (data && (client->capabilities & PROTO_CAP_VIEWPORT)) {
+                CommandSetViewport view = *(const CommandSetViewport*)data;
+                bool has_viewport = view.width > 0 && view.height > 0;
+                if (!has_viewport) {
+                    view.x = view.y = view.width = view.height = 0;
+                }
+                if (view.level > PROTO_GRID_MAX_LEVEL) {
+                    view.level = PROTO_GRID_MAX_LEVEL;
+                }
+                if (view.level > 0) {
+                    server->pyramid_wanted = true;
+                }
+                if (memcmp(&view, &client->viewport, sizeof(view)) != 0) {
+                    // Cells entering the view may be stale on the client: resend a keyframe
+                    client->has_viewport = has_viewport;
+                    client->viewport = view;
+                    client->keyframe_sent = false;
+                    client->has_baseline = false;
+                }
+            }
+            break;
+    }
+
+    if (cmd == CMD_SELECT_COLONY || cmd == CMD_RESET) {
+        server_collect_selected_colonies(server);
+    }
+}
+
+void server_negotiate_client(Server* server, ClientSession* client, const ProtoConnect* offer) {
+    if (!server || !client || !offer) return;
+
+    ProtoConnect agreed;
+    if (protocol_negotiate_connect(offer, server->capabilities, &agreed) < 0) {
+        return;
+    }
+    uint32_t dropped = client->capabilities & ~agreed.capabilities;
+    client->protocol_version = agreed.version;
+    client->capabilities = agreed.capabilities;
+    client->compress = (agreed.capabilities & PROTO_CAP_COMPRESSION) != 0;
+    if (dropped & PROTO_CAP_SPAN_DELTA) {
+        // Its acks no longer count; the next grid is a keyframe
+        client->has_baseline = false;
+        client->keyframe_sent = false;
+    }
+    if ((dropped & PROTO_CAP_VIEWPORT) && client->has_viewport) {
+        memset(&client->viewport, 0, sizeof(client->viewport));
+        client->has_viewport = false;
+        client->has_baseline = false;
+        client->keyframe_sent = false;
+    }
+
+    // Version 1 clients would not recognise the reply
+    if (agreed.version >= 2u) {
+        uint8_t buffer[CONNECT_SERIALIZED_SIZE];
+        int len = protocol_serialize_connect(&agreed, buffer);
+        ProtoFrame* frame = len > 0 ? proto_frame_copy(MSG_CONNECT_ACK, buffer, (size_t)len) : NULL;
+        if (frame) {
+            server_enqueue_control(server, client, frame);
+            proto_frame_release(frame);
+        }
     }
 }
 
@@ -1120,6 +2777,22 @@ ClientSession* server_add_client(Server* server, NetSocket* socket) {
     session->socket = socket;
     session->active = true;
     session->selected_colony = 0;
+    // Clients that never send MSG_CONNECT are treated as version 1
+    session->protocol_version = 1;
+    session->capabilities = PROTO_CAP_LEGACY_DEFAULT & server->capabilities;
+    if (send_queue_init(&session->send_queue, 0, 0) < 0) {
+        free(session);
+        return NULL;
+    }
+    if (server->send_zerocopy_min > 0) {
+        // Unsupported sockets silently keep copying sends
+        send_queue_enable_zerocopy(&session->send_queue, socket->fd, server->send_zerocopy_min);
+    }
+    if (proto_frame_reader_init(&session->reader, SERVER_RECV_RING_SIZE, &server->recv_pool) < 0) {
+        send_queue_destroy(&session->send_queue);
+        free(session);
+        return NULL;
+    }
     
     pthread_mutex_lock(&server->clients_mutex);
     session->id = server->next_client_id++;
@@ -1147,10 +2820,7 @@ void server_remove_client(Server* server, ClientSession* client) {
                 server->clients = curr->next;
             }
             
-            if (curr->socket) {
-                net_socket_close(curr->socket);
-            }
-            free(curr);
+            server_free_client(curr);
             server->client_count--;
             break;
         }
@@ -1164,60 +2834,64 @@ void server_remove_client(Server* server, ClientSession* client) {
 void server_process_clients(Server* server) {
     if (!server) return;
     
-    pthread_mutex_lock(&server->clients_mutex);
-    ClientSession* client = server->clients;
-    
-    while (client) {
-        ClientSession* next = client->next;
-        
-        if (!client->active || !client->socket || !client->socket->connected) {
-            client = next;
-            continue;
+    MpscNode* node;
+    if (server->io_thread_running) {
+        // Most ticks bring nothing; leave clients_mutex to the broadcast then
+        if ((node = mpsc_queue_pop(&server->inbound)) == NULL) {
+            return;
         }
-        
-        // Check for incoming data
-        if (net_has_data(client->socket)) {
-            MessageHeader header;
-            uint8_t* payload = NULL;
-            
-            // Set socket to blocking temporarily for complete message read
-            net_set_nonblocking(client->socket, false);
-            int result = protocol_recv_message(client->socket->fd, &header, &payload);
-            net_set_nonblocking(client->socket, true);
-            
-            if (result < 0) {
-                // Client disconnected or error
-                printf("Client %u disconnected\n", client->id);
-                client->active = false;
-            } else {
-                // Process message
-                switch (header.type) {
-                    case MSG_COMMAND: {
-                        CommandType cmd;
-                        uint8_t cmd_data[256];
-                        if (protocol_deserialize_command(payload, &cmd, cmd_data) > 0) {
-                            server_handle_command(server, client, cmd, cmd_data);
-                        }
-                        break;
-                    }
-                    case MSG_DISCONNECT:
-                        printf("Client %u requested disconnect\n", client->id);
-                        client->active = false;
-                        break;
-                    default:
-                        break;
-                }
-                
-                if (payload) free(payload);
+        pthread_mutex_lock(&server->clients_mutex);
+    } else {
+        pthread_mutex_lock(&server->clients_mutex);
+        // No I/O thread (tests, embedding): read whatever has arrived, without blocking
+        for (ClientSession* client = server->clients; client; client = client->next) {
+            server_read_client(server, client);
+        }
+        node = mpsc_queue_pop(&server->inbound);
+    }
+    
+    bool retired = false;
+    for (; node != NULL; node = mpsc_queue_pop(&server->inbound)) {
+        ServerInboundEvent* event = (ServerInboundEvent*)node;
+        ClientSession* client = server_find_client(server, event->client_id);
+        if (client && client->active) {
+            switch (event->kind) {
+                case SERVER_INBOUND_COMMAND:
+                    server_handle_command(server, client, event->command, event->data);
+                    break;
+                case SERVER_INBOUND_ACK:
+                    // Queued on server->acks for the broadcast instead
+                    break;
+                case SERVER_INBOUND_DISCONNECT:
+                    printf("Client %u disconnected\n", client->id);
+                    client->active = false;
+                    retired = true;
+                    break;
             }
         }
-        
-        client = next;
+        free(event);
+    }
+    if (retired) {
+        server_collect_selected_colonies(server);
+        if (server->io_thread_running) {
+            server_wake_io(server);
+        }
     }
     
     pthread_mutex_unlock(&server->clients_mutex);
 }
 
+int server_get_client_send_stats(Server* server, ClientSession* client, SendQueueStats* stats) {
+    if (!server || !client || !stats) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&server->clients_mutex);
+    send_queue_get_stats(&client->send_queue, stats);
+    pthread_mutex_unlock(&server->clients_mutex);
+    return 0;
+}
+
 uint16_t server_get_port(Server* server) {
     if (!server || !server->listener) return 0;
     return server->listener->port;
@@ -12,16 +12,57 @@
 
 #include "../shared/network.h"
 #include "../shared/protocol.h"
+#include "../shared/frame_reader.h"
+#include "../shared/shm_world.h"
 #include "world.h"
 #include "threadpool.h"
 #include "parallel.h"
 #include "atomic_sim.h"
+#include "send_queue.h"
+#include "mpsc_queue.h"
+#include "io_poller.h"
+#include "grid_pyramid.h"
+#include "colony_track.h"
+#include "world_snapshot.h"
 
 // Default tick rate (10 ticks per second)
 #define DEFAULT_WORLD_WIDTH 400
 #define DEFAULT_WORLD_HEIGHT 200
 #define DEFAULT_INITIAL_COLONY_COUNT 50
 #define DEFAULT_TICK_RATE_MS 100
+// Frames per second sent to clients, however fast the simulation ticks
+#define DEFAULT_BROADCAST_HZ 30
+
+// Clients whose acknowledged grid is older than this get a keyframe instead of a delta
+#define SERVER_DELTA_MAX_GAP_TICKS 64
+// Unchanged cells bridged inside one delta span (a span header costs 3 cells)
+#define SERVER_DELTA_SPAN_MERGE_GAP 3
+// Cells streamed around a client viewport so small pans stay covered
+#define SERVER_VIEWPORT_MARGIN 16
+
+// Colonies whose genome-derived MSG_COLONY_INFO fields are kept between ticks
+#define SERVER_COLONY_DETAIL_CACHE_SLOTS 16
+
+// Initial receive ring per client; grows only for frames larger than this
+#define SERVER_RECV_RING_SIZE 4096
+#define SERVER_INBOUND_DATA_SIZE 256
+
+typedef enum {
+    SERVER_INBOUND_COMMAND = 0,
+    SERVER_INBOUND_ACK,
+    SERVER_INBOUND_DISCONNECT
+} ServerInboundKind;
+
+// Decoded client message handed from the I/O thread to the simulation thread
+// (acks go to whichever thread broadcasts)
+typedef struct {
+    MpscNode node;  // Must stay first
+    uint32_t client_id;
+    ServerInboundKind kind;
+    CommandType command;
+    uint32_t ack_tick;
+    uint8_t data[SERVER_INBOUND_DATA_SIZE];
+} ServerInboundEvent;
 
 // Client session represents a connected client
 typedef struct ClientSession {
@@ -29,9 +70,38 @@ typedef struct ClientSession {
     uint32_t id;
     bool active;
     uint32_t selected_colony;  // Colony selected for detailed view
+    bool has_sent_colony_info; // sent_colony_info holds the last MSG_COLONY_INFO queued
+    uint8_t sent_colony_info[COLONY_DETAIL_SERIALIZED_SIZE];
+    bool keyframe_sent;        // keyframe_tick is valid
+    uint32_t keyframe_tick;    // Tick of the last full grid sent; older acks are stale
+    bool has_baseline;         // baseline_tick was acknowledged by the client
+    uint32_t baseline_tick;    // Newest grid tick the client confirmed via MSG_ACK
+    uint64_t keyframes_sent;
+    uint64_t deltas_sent;
+    uint64_t world_bytes_sent; // World state + grid payload bytes, headers excluded
+    ClientSendQueue send_queue; // Outbound frames, guarded by clients_mutex
+    bool send_failed;          // Socket error seen while draining send_queue
+    ProtoFrameReader reader;   // Bytes read but not yet framed
+    bool recv_closed;          // EOF, read error or bad frame; no more reads
+    uint32_t protocol_version; // Negotiated from MSG_CONNECT; 1 until then
+    uint32_t capabilities;     // PROTO_CAP_* negotiated from MSG_CONNECT
+    bool compress;             // PROTO_CAP_COMPRESSION was negotiated
+    bool has_viewport;         // Grid updates limited to viewport (CMD_SET_VIEWPORT)
+    CommandSetViewport viewport; // Requested rectangle (before margin and clamping) and level
     struct ClientSession* next;
 } ClientSession;
 
+// Behavior graph links and trait summaries of one colony, with the inputs
+// they were computed from; recomputed only when those inputs change
+typedef struct {
+    uint32_t colony_id;            // 0 = free slot
+    uint64_t last_used;            // Server colony_detail_clock at last lookup
+    Genome genome;
+    float behavior_sensors[COLONY_SENSOR_COUNT];
+    float behavior_drives[COLONY_DRIVE_COUNT];
+    ProtoColonyDetail derived;     // Only the link and trait fields are set
+} ServerColonyDetailCache;
+
 // Server structure
 typedef struct Server {
     NetServer* listener;
@@ -39,6 +109,7 @@ typedef struct Server {
     int client_count;
     World* world;
     ThreadPool* pool;
+    ThreadPool* encode_pool;      // FEROX_ENCODE_HELPERS; keyframe chunk encoders, NULL = none
     ParallelContext* parallel_ctx;
     AtomicWorld* atomic_world;    // Atomic simulation engine
     int world_width;
@@ -46,12 +117,59 @@ typedef struct Server {
     int default_colonies;
     bool running;
     bool paused;
-    int tick_rate_ms;  // Milliseconds between ticks
+    int tick_rate_ms;  // Milliseconds between ticks at speed 1; 0 = as fast as possible
+    int broadcast_hz;  // FEROX_BROADCAST_HZ; world frames per second, 0 = every tick
     float speed_multiplier;
     pthread_mutex_t clients_mutex;
-    pthread_t accept_thread;
     pthread_t simulation_thread;
+    pthread_t io_thread;
+    bool io_thread_running;       // Sockets are owned by io_thread, not the caller
+    IoPoller io_poller;           // Listener and client sockets, edge-triggered
+    atomic_bool io_wake_pending;  // Set once per wake so producers skip redundant writes
+    MpscQueue inbound;            // ServerInboundEvent from io_thread to the simulation
+    MpscQueue acks;               // SERVER_INBOUND_ACK events for the broadcasting thread
+    ProtoBufferPool recv_pool;    // Wrapped inbound payloads, guarded by clients_mutex
+    size_t send_zerocopy_min;     // FEROX_SEND_ZEROCOPY_MIN; 0 disables MSG_ZEROCOPY
+    size_t compress_min_bytes;    // FEROX_COMPRESS_MIN_BYTES; 0 disables compression
+    uint32_t capabilities;        // FEROX_SERVER_CAPS; PROTO_CAP_* offered to clients
     uint32_t next_client_id;
+    ShmWorldWriter* shm_world;    // FEROX_SHM_NAME; world frames for PROTO_CAP_SHARED_WORLD clients
+
+    // Latest world copy for the encoders; published by the simulation thread
+    WorldSnapshotPublisher snapshots;
+    // Colonies some client has selected; their MSG_COLONY_INFO is built into
+    // each snapshot (simulation thread only)
+    uint32_t* watched_colonies;
+    uint32_t watched_colony_count;
+    uint32_t watched_colony_capacity;
+
+    // Encode/send stage, run on broadcast_thread so the next tick overlaps it
+    bool pipeline;                 // FEROX_PIPELINE; false broadcasts on the simulation thread
+    pthread_t broadcast_thread;
+    bool broadcast_thread_running;
+    pthread_mutex_t broadcast_mutex;
+    pthread_cond_t broadcast_cond;
+    bool broadcast_stopping;       // Guarded by broadcast_mutex, like the counters below
+    uint64_t broadcast_published;  // Snapshots handed to broadcast_thread
+    uint64_t broadcast_encoded;    // Snapshots it broadcast; the rest were superseded first
+
+    // Incremental grid tracking for MSG_WORLD_DELTA (owned by the broadcasting thread)
+    uint32_t* delta_grid;          // Cell ids as of the last broadcast
+    uint32_t* delta_changed_tick;  // Tick at which each cell last changed
+    uint32_t delta_cells;          // 0 until tracking starts or after invalidation
+    uint32_t delta_floor_tick;     // Oldest base tick a delta can be built from
+    uint32_t delta_tick;           // Tick of the last tracked broadcast
+    uint32_t delta_max_gap;        // Max ticks between base and current tick
+    uint64_t delta_generation;     // Snapshot history delta_grid was tracked from
+    ProtoGridSpan* delta_span_scratch;
+    uint32_t* delta_cell_scratch;
+    size_t delta_span_capacity;
+    size_t delta_cell_capacity;
+    GridPyramid delta_pyramid;     // Downsampled delta_grid for zoomed-out clients
+    bool pyramid_wanted;           // A client asked for a pyramid level; keep it updated
+    ColonyTrack colony_track;      // Colony table history for MSG_COLONY_DELTA clients
+    ServerColonyDetailCache colony_detail_cache[SERVER_COLONY_DETAIL_CACHE_SLOTS];
+    uint64_t colony_detail_clock;
 } Server;
 
 /**
@@ -109,13 +227,78 @@ int server_build_protocol_world_snapshot(const World* world,
                                          ProtoWorld* proto_world);
 
 /**
- * Broadcast world state to all connected clients.
+ * Publish the world as an immutable snapshot for the encoders: grid plane
+ * (rewriting only tiles that changed), colony table, tick, and
+ * MSG_COLONY_INFO for every selected colony. The previous snapshot stays
+ * valid for readers that still hold it.
+ * @param server The server
+ * @return 0 on success, -1 on failure
+ */
+int server_publish_world_snapshot(Server* server);
+
+/**
+ * Publish a snapshot of the world and broadcast it to all connected clients.
+ * Encoding reads only the snapshot. While the broadcast thread runs this
+ * just hands the snapshot over and returns; the thread encodes the newest
+ * snapshot it has been handed and skips any that were superseded meanwhile.
+ * Every client gets MSG_WORLD_STATE. Clients that negotiated
+ * PROTO_CAP_SPAN_DELTA and have a usable baseline (acked
+ * tick or in-flight keyframe within delta_max_gap ticks) then get a single
+ * MSG_WORLD_DELTA span message with the cells changed since that baseline;
+ * the rest, or any delta larger than half a raw grid, get a keyframe (inline
+ * grid or full-grid chunks).
+ * Clients that advertised PROTO_CAP_COLONY_DELTA get the colony table as a
+ * MSG_COLONY_DELTA against the same baseline (the whole table with a
+ * keyframe) ahead of a state that omits it.
+ * Clients with a viewport only get spans inside it (plus
+ * SERVER_VIEWPORT_MARGIN cells) and, for chunked worlds, only the keyframe
+ * chunks overlapping it; cells outside keep whatever the client last saw.
+ * Frames are appended to each client's send queue; world updates that have
+ * not started sending are replaced by the new one. While server_run is active
+ * the queues are drained by the I/O thread, otherwise they are flushed
+ * before this returns.
  * @param server The server
  */
 void server_broadcast_world_state(Server* server);
 
 /**
- * Send detailed colony info to a specific client.
+ * Start the encode/send stage on its own thread, so broadcasting tick N
+ * overlaps simulating tick N+1. server_run does this unless FEROX_PIPELINE=0.
+ * @param server The server
+ * @return 0 on success (or already running), -1 on failure
+ */
+int server_start_broadcast_thread(Server* server);
+
+/**
+ * Broadcast the last snapshot handed over, if the thread has not yet, then
+ * stop the broadcast thread. Later broadcasts happen on the calling thread.
+ * @param server The server
+ */
+void server_stop_broadcast_thread(Server* server);
+
+/**
+ * Record a client's MSG_ACK for a world tick.
+ * Acks older than the client's last keyframe or newer than the last broadcast
+ * tick are ignored; otherwise later broadcasts encode deltas against it.
+ * @param server The server
+ * @param client The client session
+ * @param tick Tick whose grid the client has fully applied
+ */
+void server_note_world_ack(Server* server, ClientSession* client, uint32_t tick);
+
+/**
+ * Copy a client's send queue counters (backlog, coalesced and dropped groups).
+ * @param server The server
+ * @param client The client session
+ * @param stats Output counters
+ * @return 0 on success, -1 on invalid arguments
+ */
+int server_get_client_send_stats(Server* server, ClientSession* client, SendQueueStats* stats);
+
+/**
+ * Send detailed colony info to a specific client, whether or not it changed.
+ * Broadcasts resend it to clients with a selection only when the detail
+ * (apart from its tick) differs from what the client last received.
  * @param server The server
  * @param client The client session
  * @param colony_id ID of the colony to send info for
@@ -131,6 +314,16 @@ void server_send_colony_info(Server* server, ClientSession* client, uint32_t col
  */
 void server_handle_command(Server* server, ClientSession* client, CommandType cmd, void* data);
 
+/**
+ * Settle a client's MSG_CONNECT against server->capabilities and answer
+ * version 2+ clients with MSG_CONNECT_ACK. Until this runs a session has the
+ * version 1 defaults (PROTO_CAP_LEGACY_DEFAULT).
+ * @param server The server
+ * @param client The client session
+ * @param offer The client's advertised version and capabilities
+ */
+void server_negotiate_client(Server* server, ClientSession* client, const ProtoConnect* offer);
+
 /**
  * Add a new client to the server.
  * @param server The server
@@ -147,7 +340,11 @@ ClientSession* server_add_client(Server* server, NetSocket* socket);
 void server_remove_client(Server* server, ClientSession* client);
 
 /**
- * Process incoming data from all clients.
+ * Apply client commands and disconnects decoded since the last call, in
+ * arrival order. Acks are left to the next broadcast. While server_run is
+ * active the I/O thread does all socket reads and this makes no network
+ * syscalls, and takes clients_mutex only if something arrived; otherwise
+ * pending bytes are read here without blocking first.
  * @param server The server
  */
 void server_process_clients(Server* server);
@@ -6,6 +6,7 @@
 #include "threadpool.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <unistd.h>
 
 #define TASK_FREELIST_LIMIT 4096
 
@@ -121,6 +122,27 @@ static void threadpool_execute_local_tasks(ThreadPool* pool, WorkerLocalState* s
     }
 }
 
+static int threadpool_default_gang_spins(int participants) {
+    // Spinning only pays off when every participant owns a core; on an
+    // oversubscribed host it just steals the slice the releaser needs.
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online > 0 && participants > (int)online) {
+        return 0;
+    }
+    return PHASE_BARRIER_DEFAULT_SPINS;
+}
+
+// Poll for the next gang briefly after finishing one, since gangs tend to
+// arrive in bursts (one per simulation phase).
+static void threadpool_spin_for_next_gang(ThreadPool* pool, unsigned int seen) {
+    for (int i = 0; i < pool->gang_barrier.spin_limit; i++) {
+        if (atomic_load_explicit(&pool->gang_generation, memory_order_relaxed) != seen) {
+            return;
+        }
+        phase_cpu_relax();
+    }
+}
+
 // Worker thread function
 static void* worker_thread(void* arg) {
     ThreadPool* pool = (ThreadPool*)arg;
@@ -132,14 +154,36 @@ static void* worker_thread(void* arg) {
         .free_count = 0,
     };
     threadpool_set_worker_state(&local_state);
+
+    pthread_mutex_lock(&pool->queue_mutex);
+    int worker_id = pool->gang_next_worker_id++;
+    pthread_mutex_unlock(&pool->queue_mutex);
+    // Start from the creation-time generation, not the current one: a gang
+    // may already have been published before this worker got scheduled.
+    unsigned int gang_seen = 0;
+    int gang_sense = 0;
     
     while (1) {
         pthread_mutex_lock(&pool->queue_mutex);
         
-        // Wait for a task or shutdown signal
-        while (pool->task_queue_head == NULL && !pool->counters.shutdown) {
+        // Wait for a task, a gang job, or shutdown signal
+        while (pool->task_queue_head == NULL && !pool->counters.shutdown &&
+               atomic_load_explicit(&pool->gang_generation, memory_order_relaxed) == gang_seen) {
             pthread_cond_wait(&pool->queue_cond, &pool->queue_mutex);
         }
+
+        unsigned int gang_now = atomic_load_explicit(&pool->gang_generation, memory_order_relaxed);
+        if (gang_now != gang_seen) {
+            gang_func function = pool->gang_function;
+            void* gang_arg = pool->gang_arg;
+            gang_seen = gang_now;
+            pthread_mutex_unlock(&pool->queue_mutex);
+
+            function(gang_arg, worker_id, pool->thread_count + 1);
+            phase_barrier_wait(&pool->gang_barrier, &gang_sense);
+            threadpool_spin_for_next_gang(pool, gang_seen);
+            continue;
+        }
         
         // Check for shutdown
         if (pool->counters.shutdown && pool->task_queue_head == NULL) {
@@ -206,15 +250,32 @@ ThreadPool* threadpool_create(int num_threads) {
     pool->counters.pending_tasks = 0;
     pool->counters.task_free_count = 0;
     pool->counters.shutdown = false;
+    pool->gang_function = NULL;
+    pool->gang_arg = NULL;
+    atomic_init(&pool->gang_generation, 0);
+    pool->gang_next_worker_id = 0;
+    pool->gang_dispatch_sense = 0;
+    if (phase_barrier_init(&pool->gang_barrier, num_threads + 1,
+                           threadpool_default_gang_spins(num_threads + 1)) != 0) {
+        free(pool);
+        return NULL;
+    }
     
     // Initialize synchronization primitives
+    if (pthread_mutex_init(&pool->gang_mutex, NULL) != 0) {
+        free(pool);
+        return NULL;
+    }
+
     if (pthread_mutex_init(&pool->queue_mutex, NULL) != 0) {
+        pthread_mutex_destroy(&pool->gang_mutex);
         free(pool);
         return NULL;
     }
     
     if (pthread_cond_init(&pool->queue_cond, NULL) != 0) {
         pthread_mutex_destroy(&pool->queue_mutex);
+        pthread_mutex_destroy(&pool->gang_mutex);
         free(pool);
         return NULL;
     }
@@ -222,6 +283,7 @@ ThreadPool* threadpool_create(int num_threads) {
     if (pthread_cond_init(&pool->done_cond, NULL) != 0) {
         pthread_cond_destroy(&pool->queue_cond);
         pthread_mutex_destroy(&pool->queue_mutex);
+        pthread_mutex_destroy(&pool->gang_mutex);
         free(pool);
         return NULL;
     }
@@ -232,6 +294,7 @@ ThreadPool* threadpool_create(int num_threads) {
         pthread_cond_destroy(&pool->done_cond);
         pthread_cond_destroy(&pool->queue_cond);
         pthread_mutex_destroy(&pool->queue_mutex);
+        pthread_mutex_destroy(&pool->gang_mutex);
         free(pool);
         return NULL;
     }
@@ -251,6 +314,7 @@ ThreadPool* threadpool_create(int num_threads) {
             pthread_cond_destroy(&pool->done_cond);
             pthread_cond_destroy(&pool->queue_cond);
             pthread_mutex_destroy(&pool->queue_mutex);
+            pthread_mutex_destroy(&pool->gang_mutex);
             free(pool);
             return NULL;
         }
@@ -297,6 +361,7 @@ void threadpool_destroy(ThreadPool* pool) {
     pthread_cond_destroy(&pool->done_cond);
     pthread_cond_destroy(&pool->queue_cond);
     pthread_mutex_destroy(&pool->queue_mutex);
+    pthread_mutex_destroy(&pool->gang_mutex);
     free(pool);
 }
 
@@ -450,6 +515,60 @@ void threadpool_submit_batch(ThreadPool* pool, task_func func, void* const* args
     pthread_mutex_unlock(&pool->queue_mutex);
 }
 
+void threadpool_run_gang(ThreadPool* pool, gang_func func, void* arg) {
+    if (pool == NULL || func == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->gang_mutex);
+
+    pthread_mutex_lock(&pool->queue_mutex);
+    if (pool->counters.shutdown) {
+        pthread_mutex_unlock(&pool->queue_mutex);
+        pthread_mutex_unlock(&pool->gang_mutex);
+        return;
+    }
+    pool->gang_function = func;
+    pool->gang_arg = arg;
+    atomic_fetch_add_explicit(&pool->gang_generation, 1, memory_order_relaxed);
+    pthread_cond_broadcast(&pool->queue_cond);
+    pthread_mutex_unlock(&pool->queue_mutex);
+
+    // The dispatcher is the last gang member rather than a spare runnable
+    // thread spinning at the barrier.
+    func(arg, pool->thread_count, pool->thread_count + 1);
+
+    // Done episode: every worker's gang writes are visible once we pass.
+    phase_barrier_wait(&pool->gang_barrier, &pool->gang_dispatch_sense);
+    // Workers count their wait on the way out; returning only once they have
+    // leaves no gang in flight, so callers can read or retune the barrier.
+    phase_barrier_quiesce(&pool->gang_barrier);
+
+    pthread_mutex_unlock(&pool->gang_mutex);
+}
+
+int threadpool_gang_width(const ThreadPool* pool) {
+    return pool ? pool->thread_count + 1 : 0;
+}
+
+void threadpool_set_gang_spin_limit(ThreadPool* pool, int spin_limit) {
+    if (pool == NULL || spin_limit < 0) {
+        return;
+    }
+    pool->gang_barrier.spin_limit = spin_limit;
+}
+
+void threadpool_get_gang_stats(ThreadPool* pool, PhaseBarrierStats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    if (pool == NULL) {
+        *stats = (PhaseBarrierStats){0};
+        return;
+    }
+    phase_barrier_get_stats(&pool->gang_barrier, stats);
+}
+
 void threadpool_wait(ThreadPool* pool) {
     if (pool == NULL) {
         return;
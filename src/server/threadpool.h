@@ -7,13 +7,19 @@
 #define THREADPOOL_H
 
 #include "../shared/cacheline.h"
+#include "phase_wait.h"
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 
 // Task function type
 typedef void (*task_func)(void* arg);
 
+// Gang function type: runs once on every gang member, worker_id in
+// [0, worker_count); the dispatching thread is the last member
+typedef void (*gang_func)(void* arg, int worker_id, int worker_count);
+
 // Task structure
 typedef struct Task {
     task_func function;
@@ -45,9 +51,21 @@ typedef struct ThreadPool {
     pthread_cond_t queue_cond;
     pthread_cond_t done_cond;
     FEROX_CACHELINE_ALIGN ThreadPoolHotCounters counters;
+
+    // Gang dispatch: function/arg/generation are published under queue_mutex;
+    // the generation is also polled lock-free by workers that just finished a
+    // gang job. gang_mutex serializes dispatchers.
+    gang_func gang_function;
+    void* gang_arg;
+    atomic_uint gang_generation;
+    int gang_next_worker_id;
+    int gang_dispatch_sense;
+    pthread_mutex_t gang_mutex;
+    PhaseBarrier gang_barrier;  // thread_count workers + the dispatcher, all running the gang
 } ThreadPool;
 
 FEROX_CACHELINE_ASSERT_MEMBER_ALIGNED(ThreadPool, counters);
+FEROX_CACHELINE_ASSERT_MEMBER_ALIGNED(ThreadPool, gang_barrier);
 
 /**
  * Create a new thread pool with the specified number of worker threads.
@@ -82,6 +100,39 @@ void threadpool_submit(ThreadPool* pool, task_func func, void* arg);
  */
 void threadpool_submit_batch(ThreadPool* pool, task_func func, void* const* args, int count);
 
+/**
+ * Run func(arg, worker_id, threadpool_gang_width(pool)) once on every worker
+ * thread and once on the calling thread (worker_id thread_count), and block
+ * until all of them have returned. The caller does a share of the work
+ * rather than waiting idle, so a gang occupies thread_count + 1 cores.
+ * Gang jobs take priority over queued tasks; a worker busy with a task joins
+ * once that task finishes. Completion goes through the pool's spin-then-park
+ * barrier, so back-to-back gangs avoid a kernel round trip per phase. The
+ * call returns only after every worker has also left the barrier, so the
+ * gang stats already count this gang's waits.
+ * Must not be called from a worker thread of the same pool.
+ * @param pool The thread pool
+ * @param func The function every worker runs
+ * @param arg Argument passed to every invocation
+ */
+void threadpool_run_gang(ThreadPool* pool, gang_func func, void* arg);
+
+/**
+ * Members of a gang: the pool's workers plus the dispatching thread.
+ */
+int threadpool_gang_width(const ThreadPool* pool);
+
+/**
+ * Override how long gang waiters spin before parking (0 = park immediately).
+ * Only safe while no gang is in flight.
+ */
+void threadpool_set_gang_spin_limit(ThreadPool* pool, int spin_limit);
+
+/**
+ * Snapshot the gang barrier's spin/park counters.
+ */
+void threadpool_get_gang_stats(ThreadPool* pool, PhaseBarrierStats* stats);
+
 /**
  * Wait for all submitted tasks to complete.
  * Blocks until both active_tasks and pending_tasks are zero.
@@ -1,5 +1,6 @@
 #include "world.h"
 #include "genetics.h"
+#include "grid_alloc.h"
 #include "../shared/utils.h"
 #include "../shared/names.h"
 #include "../shared/colors.h"
@@ -155,7 +156,7 @@ World* world_create(int width, int height) {
     memset(&world->hgt_metrics, 0, sizeof(world->hgt_metrics));
     
     // Allocate cells as flat array
-    world->cells = (Cell*)calloc(grid_size, sizeof(Cell));
+    world->cells = (Cell*)ferox_grid_calloc(grid_size, sizeof(Cell));
     if (!world->cells) {
         goto fail;
     }
@@ -166,67 +167,67 @@ World* world_create(int width, int height) {
     }
     
     // Allocate environmental layers
-    world->nutrients = (float*)malloc(grid_size * sizeof(float));
+    world->nutrients = (float*)ferox_grid_calloc(grid_size, sizeof(float));
     if (!world->nutrients) {
         goto fail;
     }
     
-    world->toxins = (float*)calloc(grid_size, sizeof(float));
+    world->toxins = (float*)ferox_grid_calloc(grid_size, sizeof(float));
     if (!world->toxins) {
         goto fail;
     }
     
-    world->signals = (float*)calloc(grid_size, sizeof(float));
+    world->signals = (float*)ferox_grid_calloc(grid_size, sizeof(float));
     if (!world->signals) {
         goto fail;
     }
     
-    world->alarm_signals = (float*)calloc(grid_size, sizeof(float));
+    world->alarm_signals = (float*)ferox_grid_calloc(grid_size, sizeof(float));
     if (!world->alarm_signals) {
         goto fail;
     }
     
-    world->signal_source = (uint32_t*)calloc(grid_size, sizeof(uint32_t));
+    world->signal_source = (uint32_t*)ferox_grid_calloc(grid_size, sizeof(uint32_t));
     if (!world->signal_source) {
         goto fail;
     }
     
-    world->alarm_source = (uint32_t*)calloc(grid_size, sizeof(uint32_t));
+    world->alarm_source = (uint32_t*)ferox_grid_calloc(grid_size, sizeof(uint32_t));
     if (!world->alarm_source) {
         goto fail;
     }
     
-    world->scratch_signals = (float*)calloc(grid_size, sizeof(float));
+    world->scratch_signals = (float*)ferox_grid_calloc(grid_size, sizeof(float));
     if (!world->scratch_signals) {
         goto fail;
     }
 
-    world->scratch_alarm_signals = (float*)calloc(grid_size, sizeof(float));
+    world->scratch_alarm_signals = (float*)ferox_grid_calloc(grid_size, sizeof(float));
     if (!world->scratch_alarm_signals) {
         goto fail;
     }
 
-    world->scratch_nutrients = (float*)calloc(grid_size, sizeof(float));
+    world->scratch_nutrients = (float*)ferox_grid_calloc(grid_size, sizeof(float));
     if (!world->scratch_nutrients) {
         goto fail;
     }
 
-    world->scratch_toxins = (float*)calloc(grid_size, sizeof(float));
+    world->scratch_toxins = (float*)ferox_grid_calloc(grid_size, sizeof(float));
     if (!world->scratch_toxins) {
         goto fail;
     }
 
-    world->scratch_eps = (float*)calloc(grid_size, sizeof(float));
+    world->scratch_eps = (float*)ferox_grid_calloc(grid_size, sizeof(float));
     if (!world->scratch_eps) {
         goto fail;
     }
     
-    world->scratch_sources = (uint32_t*)calloc(grid_size, sizeof(uint32_t));
+    world->scratch_sources = (uint32_t*)ferox_grid_calloc(grid_size, sizeof(uint32_t));
     if (!world->scratch_sources) {
         goto fail;
     }
 
-    world->scratch_alarm_sources = (uint32_t*)calloc(grid_size, sizeof(uint32_t));
+    world->scratch_alarm_sources = (uint32_t*)ferox_grid_calloc(grid_size, sizeof(uint32_t));
     if (!world->scratch_alarm_sources) {
         goto fail;
     }
@@ -259,20 +260,20 @@ fail:
     free(world->colony_index_map);
     free(world->colony_by_id);
     free(world->colonies);
-    free(world->scratch_alarm_sources);
-    free(world->scratch_sources);
-    free(world->scratch_eps);
-    free(world->scratch_toxins);
-    free(world->scratch_nutrients);
-    free(world->scratch_alarm_signals);
-    free(world->scratch_signals);
-    free(world->alarm_source);
-    free(world->signal_source);
-    free(world->alarm_signals);
-    free(world->signals);
-    free(world->toxins);
-    free(world->nutrients);
-    free(world->cells);
+    ferox_grid_free(world->scratch_alarm_sources);
+    ferox_grid_free(world->scratch_sources);
+    ferox_grid_free(world->scratch_eps);
+    ferox_grid_free(world->scratch_toxins);
+    ferox_grid_free(world->scratch_nutrients);
+    ferox_grid_free(world->scratch_alarm_signals);
+    ferox_grid_free(world->scratch_signals);
+    ferox_grid_free(world->alarm_source);
+    ferox_grid_free(world->signal_source);
+    ferox_grid_free(world->alarm_signals);
+    ferox_grid_free(world->signals);
+    ferox_grid_free(world->toxins);
+    ferox_grid_free(world->nutrients);
+    ferox_grid_free(world->cells);
     free(world);
     return NULL;
 }
@@ -325,22 +326,22 @@ void world_destroy(World* world) {
         }
         free(world->colonies);
     }
-    if (world->cells) free(world->cells);
+    ferox_grid_free(world->cells);
     if (world->colony_index_map) free(world->colony_index_map);
     if (world->colony_by_id) free(world->colony_by_id);
-    if (world->nutrients) free(world->nutrients);
-    if (world->toxins) free(world->toxins);
-    if (world->signals) free(world->signals);
-    if (world->alarm_signals) free(world->alarm_signals);
-    if (world->signal_source) free(world->signal_source);
-    if (world->alarm_source) free(world->alarm_source);
-    if (world->scratch_signals) free(world->scratch_signals);
-    if (world->scratch_alarm_signals) free(world->scratch_alarm_signals);
-    if (world->scratch_nutrients) free(world->scratch_nutrients);
-    if (world->scratch_toxins) free(world->scratch_toxins);
-    if (world->scratch_eps) free(world->scratch_eps);
-    if (world->scratch_sources) free(world->scratch_sources);
-    if (world->scratch_alarm_sources) free(world->scratch_alarm_sources);
+    ferox_grid_free(world->nutrients);
+    ferox_grid_free(world->toxins);
+    ferox_grid_free(world->signals);
+    ferox_grid_free(world->alarm_signals);
+    ferox_grid_free(world->signal_source);
+    ferox_grid_free(world->alarm_source);
+    ferox_grid_free(world->scratch_signals);
+    ferox_grid_free(world->scratch_alarm_signals);
+    ferox_grid_free(world->scratch_nutrients);
+    ferox_grid_free(world->scratch_toxins);
+    ferox_grid_free(world->scratch_eps);
+    ferox_grid_free(world->scratch_sources);
+    ferox_grid_free(world->scratch_alarm_sources);
     free(world);
 }
 
@@ -0,0 +1,221 @@
+#include "world_snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void world_snapshot_clear_world(WorldSnapshot* snapshot) {
+    // The inline grid belongs to cells
+    snapshot->world.grid = NULL;
+    proto_world_free(&snapshot->world);
+    for (uint32_t i = 0; i < snapshot->colony_info_count; i++) {
+        proto_frame_release(snapshot->colony_info[i].frame);
+    }
+    snapshot->colony_info_count = 0;
+}
+
+static int world_snapshot_reserve(WorldSnapshot* snapshot, uint32_t cells, uint32_t tiles) {
+    if (cells > snapshot->cell_capacity) {
+        uint32_t* grown = (uint32_t*)realloc(snapshot->cells, (size_t)cells * sizeof(uint32_t));
+        if (!grown) {
+            return -1;
+        }
+        snapshot->cells = grown;
+        snapshot->cell_capacity = cells;
+        // Whatever the buffer held no longer lines up
+        snapshot->generation = 0;
+    }
+    if (tiles > snapshot->tile_capacity) {
+        uint32_t* grown = (uint32_t*)realloc(snapshot->tile_tick, (size_t)tiles * sizeof(uint32_t));
+        if (!grown) {
+            return -1;
+        }
+        snapshot->tile_tick = grown;
+        snapshot->tile_capacity = tiles;
+    }
+    return 0;
+}
+
+// A buffer no reader holds, or a new one
+static WorldSnapshot* world_snapshot_claim(WorldSnapshotPublisher* publisher) {
+    for (uint32_t i = 0; i < publisher->slot_count; i++) {
+        unsigned int expected = 0;
+        if (atomic_compare_exchange_strong(&publisher->slots[i]->refs, &expected, 1u)) {
+            return publisher->slots[i];
+        }
+    }
+
+    WorldSnapshot** slots = (WorldSnapshot**)realloc(publisher->slots,
+                                                     (size_t)(publisher->slot_count + 1u) * sizeof(WorldSnapshot*));
+    if (!slots) {
+        return NULL;
+    }
+    publisher->slots = slots;
+    WorldSnapshot* snapshot = (WorldSnapshot*)calloc(1, sizeof(WorldSnapshot));
+    if (!snapshot) {
+        return NULL;
+    }
+    atomic_init(&snapshot->refs, 1u);
+    proto_world_init(&snapshot->world);
+    publisher->slots[publisher->slot_count++] = snapshot;
+    return snapshot;
+}
+
+void world_snapshot_publisher_init(WorldSnapshotPublisher* publisher) {
+    if (!publisher) return;
+    memset(publisher, 0, sizeof(*publisher));
+    atomic_init(&publisher->current, NULL);
+}
+
+void world_snapshot_publisher_destroy(WorldSnapshotPublisher* publisher) {
+    if (!publisher) return;
+    for (uint32_t i = 0; i < publisher->slot_count; i++) {
+        WorldSnapshot* snapshot = publisher->slots[i];
+        world_snapshot_clear_world(snapshot);
+        free(snapshot->cells);
+        free(snapshot->tile_tick);
+        free(snapshot->colony_info);
+        free(snapshot);
+    }
+    free(publisher->slots);
+    world_snapshot_publisher_init(publisher);
+}
+
+WorldSnapshot* world_snapshot_begin(WorldSnapshotPublisher* publisher, const World* world) {
+    if (!publisher || !world || world->width <= 0 || world->height <= 0) {
+        return NULL;
+    }
+
+    uint32_t width = (uint32_t)world->width;
+    uint32_t height = (uint32_t)world->height;
+    uint32_t cell_count = width * height;
+    uint32_t tile_count = (cell_count + WORLD_SNAPSHOT_TILE_CELLS - 1u) / WORLD_SNAPSHOT_TILE_CELLS;
+    uint32_t tick = (uint32_t)world->tick;
+
+    WorldSnapshot* snapshot = world_snapshot_claim(publisher);
+    if (!snapshot) {
+        return NULL;
+    }
+    if (world_snapshot_reserve(snapshot, cell_count, tile_count) < 0) {
+        // A reader may be probing it; give the claim back rather than reset the count
+        world_snapshot_release(snapshot);
+        return NULL;
+    }
+    world_snapshot_clear_world(snapshot);
+
+    // The publisher's own reference keeps the current snapshot alive
+    const WorldSnapshot* previous = atomic_load(&publisher->current);
+    bool continues = previous && previous->width == width && previous->height == height &&
+                     tick > previous->tick;
+    if (!continues) {
+        publisher->generation++;
+    }
+    // The buffer already holds this history as of its own, older tick
+    bool recycled = continues && snapshot->generation == publisher->generation &&
+                    snapshot->width == width && snapshot->height == height;
+    uint32_t held_tick = snapshot->tick;
+
+    for (uint32_t tile = 0; tile < tile_count; tile++) {
+        uint32_t start = tile * WORLD_SNAPSHOT_TILE_CELLS;
+        uint32_t end = start + WORLD_SNAPSHOT_TILE_CELLS < cell_count ? start + WORLD_SNAPSHOT_TILE_CELLS
+                                                                      : cell_count;
+        const Cell* source = world->cells;
+        if (continues) {
+            const uint32_t* before = previous->cells;
+            uint32_t i = start;
+            while (i < end && source[i].colony_id == before[i]) {
+                i++;
+            }
+            if (i == end) {
+                snapshot->tile_tick[tile] = previous->tile_tick[tile];
+                if (recycled && previous->tile_tick[tile] <= held_tick) {
+                    publisher->tiles_reused++;
+                } else {
+                    memcpy(&snapshot->cells[start], &before[start], (size_t)(end - start) * sizeof(uint32_t));
+                    publisher->tiles_written++;
+                }
+                continue;
+            }
+        }
+        snapshot->tile_tick[tile] = tick;
+        for (uint32_t i = start; i < end; i++) {
+            snapshot->cells[i] = source[i].colony_id;
+        }
+        publisher->tiles_written++;
+    }
+
+    snapshot->generation = publisher->generation;
+    snapshot->tick = tick;
+    snapshot->width = width;
+    snapshot->height = height;
+    snapshot->tile_count = tile_count;
+    snapshot->wide_ids = atomic_load_explicit(&world->next_colony_id, memory_order_relaxed) >
+                         (uint32_t)UINT16_MAX + 1u;
+    return snapshot;
+}
+
+int world_snapshot_add_colony_info(WorldSnapshot* snapshot, uint32_t colony_id, ProtoFrame* frame) {
+    if (!snapshot || !frame) {
+        return -1;
+    }
+    if (snapshot->colony_info_count == snapshot->colony_info_capacity) {
+        uint32_t capacity = snapshot->colony_info_capacity ? snapshot->colony_info_capacity * 2u : 8u;
+        WorldSnapshotColonyInfo* grown = (WorldSnapshotColonyInfo*)realloc(
+            snapshot->colony_info, (size_t)capacity * sizeof(WorldSnapshotColonyInfo));
+        if (!grown) {
+            return -1;
+        }
+        snapshot->colony_info = grown;
+        snapshot->colony_info_capacity = capacity;
+    }
+    snapshot->colony_info[snapshot->colony_info_count].colony_id = colony_id;
+    snapshot->colony_info[snapshot->colony_info_count].frame = frame;
+    snapshot->colony_info_count++;
+    return 0;
+}
+
+ProtoFrame* world_snapshot_colony_info(const WorldSnapshot* snapshot, uint32_t colony_id) {
+    if (!snapshot) return NULL;
+    for (uint32_t i = 0; i < snapshot->colony_info_count; i++) {
+        if (snapshot->colony_info[i].colony_id == colony_id) {
+            return snapshot->colony_info[i].frame;
+        }
+    }
+    return NULL;
+}
+
+void world_snapshot_publish(WorldSnapshotPublisher* publisher, WorldSnapshot* snapshot) {
+    if (!publisher || !snapshot) return;
+    WorldSnapshot* previous = atomic_exchange(&publisher->current, snapshot);
+    if (previous) {
+        world_snapshot_release(previous);
+    }
+}
+
+void world_snapshot_abandon(WorldSnapshotPublisher* publisher, WorldSnapshot* snapshot) {
+    if (!publisher || !snapshot) return;
+    world_snapshot_clear_world(snapshot);
+    // Part of the buffer may be from this attempt; do not trust it later
+    snapshot->generation = 0;
+    world_snapshot_release(snapshot);
+}
+
+WorldSnapshot* world_snapshot_acquire(WorldSnapshotPublisher* publisher) {
+    if (!publisher) return NULL;
+    for (;;) {
+        WorldSnapshot* snapshot = atomic_load(&publisher->current);
+        if (!snapshot) {
+            return NULL;
+        }
+        atomic_fetch_add(&snapshot->refs, 1u);
+        // Still current: the publisher cannot have claimed it for rewriting
+        if (atomic_load(&publisher->current) == snapshot) {
+            return snapshot;
+        }
+        world_snapshot_release(snapshot);
+    }
+}
+
+void world_snapshot_release(WorldSnapshot* snapshot) {
+    if (!snapshot) return;
+    atomic_fetch_sub(&snapshot->refs, 1u);
+}
@@ -0,0 +1,102 @@
+#ifndef FEROX_WORLD_SNAPSHOT_H
+#define FEROX_WORLD_SNAPSHOT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../shared/protocol.h"
+#include "world.h"
+
+/**
+ * Immutable, refcounted copies of the world for the network encoders.
+ *
+ * The simulation thread fills one at the end of a tick and publishes it;
+ * readers take the latest with world_snapshot_acquire() without a lock and
+ * keep it, unchanged, until they release it, while the simulation goes on
+ * writing the world and later snapshots.
+ *
+ * Buffers are recycled: a new snapshot goes into a buffer nobody holds, and
+ * only the tiles that changed since that buffer was last filled are written.
+ * Every tile carries the tick at which it last changed, so consumers that
+ * track changes (span deltas) can skip the rest.
+ *
+ * Buffers are never freed before world_snapshot_publisher_destroy(), which
+ * is what lets a reader bump the count of a snapshot that was just replaced
+ * and retry instead of touching freed memory.
+ */
+#define WORLD_SNAPSHOT_TILE_CELLS 4096u
+
+// MSG_COLONY_INFO for a colony some client had selected when the snapshot was taken
+typedef struct {
+    uint32_t colony_id;
+    ProtoFrame* frame;
+} WorldSnapshotColonyInfo;
+
+typedef struct WorldSnapshot {
+    atomic_uint refs;        // The publisher's while current, plus one per reader; 0 = free
+    uint64_t generation;     // History the tile stamps belong to
+    uint32_t tick;
+    uint32_t width;
+    uint32_t height;
+    uint32_t* cells;         // Colony id per cell
+    uint32_t* tile_tick;     // Tick at which each tile last changed
+    uint32_t tile_count;
+    uint32_t cell_capacity;
+    uint32_t tile_capacity;
+    bool wide_ids;           // Some colony id needs more than 16 bits
+    ProtoWorld world;        // Colony table and playback state; an inline grid aliases cells
+    WorldSnapshotColonyInfo* colony_info;
+    uint32_t colony_info_count;
+    uint32_t colony_info_capacity;
+} WorldSnapshot;
+
+typedef struct {
+    _Atomic(WorldSnapshot*) current;
+    WorldSnapshot** slots;   // Every buffer; only the publishing thread touches this
+    uint32_t slot_count;
+    uint64_t generation;
+    uint64_t tiles_written;  // Tiles copied into recycled buffers
+    uint64_t tiles_reused;   // Tiles a recycled buffer already held
+} WorldSnapshotPublisher;
+
+void world_snapshot_publisher_init(WorldSnapshotPublisher* publisher);
+
+// No reader may still hold a snapshot.
+void world_snapshot_publisher_destroy(WorldSnapshotPublisher* publisher);
+
+/**
+ * Claim a free buffer and copy the world's grid into it. Stamps continue the
+ * current snapshot's history when the dimensions match and the tick advances;
+ * otherwise a new history starts and every tile is stamped with this tick.
+ * The caller fills snapshot->world and then publishes or abandons it.
+ * Publishing thread only.
+ * @return the snapshot, or NULL on allocation failure
+ */
+WorldSnapshot* world_snapshot_begin(WorldSnapshotPublisher* publisher, const World* world);
+
+/**
+ * Attach a colony detail frame to a begun snapshot. Takes over the caller's
+ * reference on success. Publishing thread only.
+ * @return 0 on success, -1 on allocation failure
+ */
+int world_snapshot_add_colony_info(WorldSnapshot* snapshot, uint32_t colony_id, ProtoFrame* frame);
+
+// The detail frame attached for a colony, or NULL. Borrowed for as long as the snapshot is held.
+ProtoFrame* world_snapshot_colony_info(const WorldSnapshot* snapshot, uint32_t colony_id);
+
+// Make a begun snapshot current and drop the publisher's hold on the previous one.
+void world_snapshot_publish(WorldSnapshotPublisher* publisher, WorldSnapshot* snapshot);
+
+// Hand a begun snapshot back without publishing it.
+void world_snapshot_abandon(WorldSnapshotPublisher* publisher, WorldSnapshot* snapshot);
+
+/**
+ * Take a reference to the current snapshot. Lock-free; safe from any thread.
+ * @return the snapshot, or NULL if none was published yet
+ */
+WorldSnapshot* world_snapshot_acquire(WorldSnapshotPublisher* publisher);
+
+void world_snapshot_release(WorldSnapshot* snapshot);
+
+#endif // FEROX_WORLD_SNAPSHOT_H
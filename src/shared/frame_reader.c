@@ -0,0 +1,300 @@
+#include "frame_reader.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#define PROTO_FRAME_READER_MIN_CAPACITY 1024
+
+static int pool_class_for(size_t size) {
+    size_t class_size = PROTO_BUFFER_POOL_MIN_SIZE;
+    int index = 0;
+    while (class_size < size && index < PROTO_BUFFER_POOL_CLASSES - 1) {
+        class_size <<= 1;
+        index++;
+    }
+    return class_size >= size ? index : -1;
+}
+
+static int pool_class_keep(int index) {
+    return (PROTO_BUFFER_POOL_MIN_SIZE << index) >= 64 * 1024 ? PROTO_BUFFER_POOL_KEEP_LARGE
+                                                              : PROTO_BUFFER_POOL_KEEP;
+}
+
+void proto_buffer_pool_init(ProtoBufferPool* pool) {
+    if (pool) {
+        memset(pool, 0, sizeof(*pool));
+    }
+}
+
+void proto_buffer_pool_destroy(ProtoBufferPool* pool) {
+    if (!pool) {
+        return;
+    }
+    for (int c = 0; c < PROTO_BUFFER_POOL_CLASSES; c++) {
+        for (int i = 0; i < pool->free_count[c]; i++) {
+            free(pool->free_list[c][i]);
+        }
+        pool->free_count[c] = 0;
+    }
+}
+
+uint8_t* proto_buffer_pool_acquire(ProtoBufferPool* pool, size_t size) {
+    int index = pool_class_for(size > 0 ? size : 1);
+    if (!pool || index < 0) {
+        return NULL;
+    }
+    if (pool->free_count[index] > 0) {
+        pool->hits++;
+        return (uint8_t*)pool->free_list[index][--pool->free_count[index]];
+    }
+    pool->misses++;
+    return (uint8_t*)malloc((size_t)PROTO_BUFFER_POOL_MIN_SIZE << index);
+}
+
+void proto_buffer_pool_release(ProtoBufferPool* pool, uint8_t* buffer, size_t size) {
+    if (!buffer) {
+        return;
+    }
+    int index = pool_class_for(size > 0 ? size : 1);
+    if (!pool || index < 0 || pool->free_count[index] >= pool_class_keep(index)) {
+        free(buffer);
+        return;
+    }
+    pool->free_list[index][pool->free_count[index]++] = buffer;
+}
+
+static size_t reader_max_capacity(void) {
+    size_t capacity = PROTO_FRAME_READER_MIN_CAPACITY;
+    while (capacity < MESSAGE_HEADER_SIZE + (size_t)MAX_PAYLOAD_SIZE) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+int proto_frame_reader_init(ProtoFrameReader* reader, size_t initial_capacity, ProtoBufferPool* pool) {
+    if (!reader) {
+        return -1;
+    }
+    memset(reader, 0, sizeof(*reader));
+
+    size_t capacity = PROTO_FRAME_READER_MIN_CAPACITY;
+    size_t max_capacity = reader_max_capacity();
+    while (capacity < initial_capacity && capacity < max_capacity) {
+        capacity <<= 1;
+    }
+    reader->ring = (uint8_t*)malloc(capacity);
+    if (!reader->ring) {
+        return -1;
+    }
+    reader->capacity = capacity;
+    reader->pool = pool;
+    return 0;
+}
+
+void proto_frame_reader_free(ProtoFrameReader* reader) {
+    if (!reader) {
+        return;
+    }
+    free(reader->ring);
+    memset(reader, 0, sizeof(*reader));
+}
+
+static void reader_copy_out(const ProtoFrameReader* reader, size_t offset, uint8_t* dst, size_t n) {
+    size_t start = (reader->head + offset) & (reader->capacity - 1);
+    size_t first = reader->capacity - start;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(dst, reader->ring + start, first);
+    memcpy(dst + first, reader->ring, n - first);
+}
+
+static int reader_grow(ProtoFrameReader* reader, size_t needed) {
+    size_t capacity = reader->capacity;
+    while (capacity < needed) {
+        capacity <<= 1;
+    }
+    if (capacity > reader_max_capacity()) {
+        return -1;
+    }
+    if (capacity == reader->capacity) {
+        return 0;
+    }
+
+    uint8_t* ring = (uint8_t*)malloc(capacity);
+    if (!ring) {
+        return -1;
+    }
+    reader_copy_out(reader, 0, ring, reader->len);
+    free(reader->ring);
+    reader->ring = ring;
+    reader->capacity = capacity;
+    reader->head = 0;
+    return 0;
+}
+
+// Wire size of the frame at the head, or 0 if its header is incomplete or invalid.
+static size_t reader_pending_frame_size(const ProtoFrameReader* reader) {
+    if (reader->len < MESSAGE_HEADER_SIZE) {
+        return 0;
+    }
+    uint8_t header_buf[MESSAGE_HEADER_SIZE];
+    MessageHeader header;
+    reader_copy_out(reader, 0, header_buf, MESSAGE_HEADER_SIZE);
+    if (protocol_deserialize_header(header_buf, &header) < 0 || header.payload_len > MAX_PAYLOAD_SIZE) {
+        return 0;
+    }
+    return MESSAGE_HEADER_SIZE + (size_t)header.payload_len;
+}
+
+// Make room when the ring is full and the head frame cannot complete in it.
+static int reader_make_room(ProtoFrameReader* reader) {
+    if (reader->len < reader->capacity) {
+        return 1;
+    }
+    size_t needed = reader_pending_frame_size(reader);
+    if (needed <= reader->capacity) {
+        return 0;  // Caller must pop frames first
+    }
+    return reader_grow(reader, needed) == 0 ? 1 : -1;
+}
+
+ssize_t proto_frame_reader_fill(ProtoFrameReader* reader, int fd, bool* drained) {
+    if (drained) {
+        *drained = false;
+    }
+    if (!reader || !reader->ring || fd < 0 || reader->closed) {
+        return -1;
+    }
+
+    ssize_t total = 0;
+    for (;;) {
+        int room = reader_make_room(reader);
+        if (room < 0) {
+            return -1;
+        }
+        if (room == 0) {
+            break;
+        }
+
+        size_t mask = reader->capacity - 1;
+        size_t tail = (reader->head + reader->len) & mask;
+        size_t space = reader->capacity - reader->len;
+        size_t first = reader->capacity - tail;
+        if (first > space) {
+            first = space;
+        }
+        struct iovec iov[2];
+        iov[0].iov_base = reader->ring + tail;
+        iov[0].iov_len = first;
+        iov[1].iov_base = reader->ring;
+        iov[1].iov_len = space - first;
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iov[1].iov_len > 0 ? 2 : 1;
+
+        ssize_t n = recvmsg(fd, &msg, MSG_DONTWAIT);
+        if (n > 0) {
+            reader->len += (size_t)n;
+            total += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (drained) {
+                *drained = true;
+            }
+            break;
+        }
+        reader->closed = true;
+        return total > 0 ? total : -1;
+    }
+    return total;
+}
+
+int proto_frame_reader_append(ProtoFrameReader* reader, const uint8_t* data, size_t len) {
+    if (!reader || !reader->ring || (!data && len > 0)) {
+        return -1;
+    }
+    if (reader->len + len > reader->capacity && reader_grow(reader, reader->len + len) < 0) {
+        return -1;
+    }
+
+    size_t tail = (reader->head + reader->len) & (reader->capacity - 1);
+    size_t first = reader->capacity - tail;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(reader->ring + tail, data, first);
+    memcpy(reader->ring, data + first, len - first);
+    reader->len += len;
+    return 0;
+}
+
+int proto_frame_reader_next(ProtoFrameReader* reader, MessageHeader* header, ProtoPayloadView* payload) {
+    if (!reader || !header || !payload) {
+        return -1;
+    }
+    payload->data = NULL;
+    payload->len = 0;
+    payload->pooled = NULL;
+
+    if (reader->len < MESSAGE_HEADER_SIZE) {
+        return 0;
+    }
+    uint8_t header_buf[MESSAGE_HEADER_SIZE];
+    reader_copy_out(reader, 0, header_buf, MESSAGE_HEADER_SIZE);
+    if (protocol_deserialize_header(header_buf, header) < 0 || header->payload_len > MAX_PAYLOAD_SIZE) {
+        return -1;
+    }
+    size_t frame_size = MESSAGE_HEADER_SIZE + (size_t)header->payload_len;
+    if (reader->len < frame_size) {
+        return 0;
+    }
+
+    size_t start = (reader->head + MESSAGE_HEADER_SIZE) & (reader->capacity - 1);
+    payload->len = header->payload_len;
+    if (payload->len > 0 && start + payload->len <= reader->capacity) {
+        payload->data = reader->ring + start;
+    } else if (payload->len > 0) {
+        // Straddles the ring end: copy into one contiguous buffer
+        uint8_t* buffer = reader->pool ? proto_buffer_pool_acquire(reader->pool, payload->len)
+                                       : (uint8_t*)malloc(payload->len);
+        if (!buffer) {
+            return -1;
+        }
+        reader_copy_out(reader, MESSAGE_HEADER_SIZE, buffer, payload->len);
+        payload->data = buffer;
+        payload->pooled = buffer;
+    }
+
+    reader->head = (reader->head + frame_size) & (reader->capacity - 1);
+    reader->len -= frame_size;
+    if (reader->len == 0) {
+        reader->head = 0;
+    }
+    return 1;
+}
+
+void proto_frame_reader_release(ProtoFrameReader* reader, ProtoPayloadView* payload) {
+    if (!payload) {
+        return;
+    }
+    if (payload->pooled) {
+        if (reader && reader->pool) {
+            proto_buffer_pool_release(reader->pool, payload->pooled, payload->len);
+        } else {
+            free(payload->pooled);
+        }
+    }
+    payload->data = NULL;
+    payload->len = 0;
+    payload->pooled = NULL;
+}
@@ -0,0 +1,103 @@
+#ifndef FEROX_FRAME_READER_H
+#define FEROX_FRAME_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "protocol.h"
+
+/**
+ * Size-classed payload buffers.
+ *
+ * Buffers are rounded up to the next class (64 B ... MAX_PAYLOAD_SIZE) and
+ * returned to a short per-class free list instead of the heap, so steady
+ * message traffic stops allocating. Not thread-safe: a pool belongs to the
+ * thread that reads the connections using it.
+ */
+#define PROTO_BUFFER_POOL_CLASSES 15   // 64 B << 0 .. 64 B << 14 (1 MB)
+#define PROTO_BUFFER_POOL_MIN_SIZE 64
+#define PROTO_BUFFER_POOL_KEEP 8       // Cached buffers per class
+#define PROTO_BUFFER_POOL_KEEP_LARGE 2 // Classes of 64 KB and up
+
+typedef struct {
+    void* free_list[PROTO_BUFFER_POOL_CLASSES][PROTO_BUFFER_POOL_KEEP];
+    int free_count[PROTO_BUFFER_POOL_CLASSES];
+    uint64_t hits;    // Acquires served from a free list
+    uint64_t misses;  // Acquires that had to allocate
+} ProtoBufferPool;
+
+void proto_buffer_pool_init(ProtoBufferPool* pool);
+void proto_buffer_pool_destroy(ProtoBufferPool* pool);
+
+/**
+ * @param size Bytes needed (at most MAX_PAYLOAD_SIZE)
+ * @return buffer of at least `size` bytes, or NULL on failure
+ */
+uint8_t* proto_buffer_pool_acquire(ProtoBufferPool* pool, size_t size);
+
+// Return a buffer obtained with the same `size`.
+void proto_buffer_pool_release(ProtoBufferPool* pool, uint8_t* buffer, size_t size);
+
+/**
+ * Payload of a message yielded by proto_frame_reader_next().
+ * `data` either points into the reader's ring (valid until the next fill or
+ * append) or, when the payload wrapped around the ring end, into a pooled
+ * buffer. Pass it to proto_frame_reader_release() when done either way.
+ */
+typedef struct {
+    const uint8_t* data;
+    size_t len;
+    uint8_t* pooled;  // Non-NULL when data lives in a pool buffer
+} ProtoPayloadView;
+
+/**
+ * Per-connection incremental framer over a power-of-two ring buffer.
+ * Bytes arrive through non-blocking fills; complete messages are popped
+ * without copying unless they straddle the ring end. The ring grows only
+ * when a single frame is larger than it.
+ */
+typedef struct {
+    uint8_t* ring;
+    size_t capacity;  // Power of two
+    size_t head;      // Offset of the first unread byte
+    size_t len;       // Buffered bytes
+    bool closed;      // Peer closed or read failed; reported after buffered bytes
+    ProtoBufferPool* pool;
+} ProtoFrameReader;
+
+/**
+ * @param initial_capacity Ring size hint, rounded up to a power of two
+ * @param pool Pool for wrapped payloads (may be NULL: such payloads are malloc'd)
+ * @return 0 on success, -1 on allocation failure
+ */
+int proto_frame_reader_init(ProtoFrameReader* reader, size_t initial_capacity, ProtoBufferPool* pool);
+void proto_frame_reader_free(ProtoFrameReader* reader);
+
+/**
+ * Read from a socket (MSG_DONTWAIT) until it would block or the ring is full.
+ * EOF is reported on the call after the last bytes, so a final frame is
+ * never lost.
+ * @param drained Set to true when the socket reported EAGAIN (may be NULL)
+ * @return bytes read (0 if the ring was full or nothing was ready), -1 on EOF or error
+ */
+ssize_t proto_frame_reader_fill(ProtoFrameReader* reader, int fd, bool* drained);
+
+/**
+ * Copy bytes in from memory (tests, non-socket transports).
+ * @return 0 on success, -1 if they do not fit even after growing
+ */
+int proto_frame_reader_append(ProtoFrameReader* reader, const uint8_t* data, size_t len);
+
+/**
+ * Pop the next complete message.
+ * @return 1 when a message was produced, 0 if more bytes are needed, -1 on a
+ *         bad magic or oversized payload (the stream cannot be resynchronised)
+ *         or when a wrapped payload could not be copied out
+ */
+int proto_frame_reader_next(ProtoFrameReader* reader, MessageHeader* header, ProtoPayloadView* payload);
+
+void proto_frame_reader_release(ProtoFrameReader* reader, ProtoPayloadView* payload);
+
+#endif // FEROX_FRAME_READER_H
@@ -0,0 +1,188 @@
+#include "lz.h"
+
+#include <string.h>
+
+#define LZ_HASH_LOG 12
+#define LZ_LAST_LITERALS 5   // Block always ends with at least this many literals
+#define LZ_MFLIMIT 12        // No match may start in the last 12 bytes
+#define LZ_SKIP_TRIGGER 6    // Probe stride grows every 64 bytes without a match
+
+static inline uint32_t lz_read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t lz_hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_LOG);
+}
+
+static inline uint8_t* lz_write_length(uint8_t* op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+size_t lz_compress_bound(size_t len) {
+    return len + len / 255 + 16;
+}
+
+size_t lz_compress(const uint8_t* src, size_t len, uint8_t* dst, size_t capacity) {
+    if (!src || !dst) {
+        return 0;
+    }
+
+    uint32_t table[1u << LZ_HASH_LOG];
+    memset(table, 0, sizeof(table));
+
+    uint8_t* op = dst;
+    uint8_t* const op_end = dst + capacity;
+    size_t anchor = 0;
+    size_t ip = 0;
+
+    if (len > LZ_MFLIMIT) {
+        const size_t match_limit = len - LZ_MFLIMIT;
+        const size_t match_end = len - LZ_LAST_LITERALS;
+        size_t search = 1u << LZ_SKIP_TRIGGER;
+
+        while (ip < match_limit) {
+            uint32_t sequence = lz_read32(src + ip);
+            uint32_t h = lz_hash(sequence);
+            size_t ref = table[h];
+            table[h] = (uint32_t)ip;
+
+            if (ref >= ip || ip - ref > LZ_MAX_OFFSET || lz_read32(src + ref) != sequence) {
+                ip += search++ >> LZ_SKIP_TRIGGER;
+                continue;
+            }
+            search = 1u << LZ_SKIP_TRIGGER;
+
+            // Extend backwards over literals, then forwards
+            while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+                ip--;
+                ref--;
+            }
+            size_t match_len = LZ_MIN_MATCH;
+            while (ip + match_len < match_end && src[ip + match_len] == src[ref + match_len]) {
+                match_len++;
+            }
+
+            size_t literals = ip - anchor;
+            size_t needed = 1 + literals / 255 + 1 + literals + 2 + (match_len - LZ_MIN_MATCH) / 255 + 1;
+            if ((size_t)(op_end - op) < needed) {
+                return 0;
+            }
+
+            size_t match_code = match_len - LZ_MIN_MATCH;
+            uint8_t* token = op++;
+            *token = (uint8_t)(((literals < 15 ? literals : 15) << 4) | (match_code < 15 ? match_code : 15));
+            if (literals >= 15) {
+                op = lz_write_length(op, literals - 15);
+            }
+            memcpy(op, src + anchor, literals);
+            op += literals;
+
+            size_t offset = ip - ref;
+            *op++ = (uint8_t)(offset & 0xFFu);
+            *op++ = (uint8_t)(offset >> 8);
+            if (match_code >= 15) {
+                op = lz_write_length(op, match_code - 15);
+            }
+
+            ip += match_len;
+            anchor = ip;
+            if (ip < match_limit) {
+                table[lz_hash(lz_read32(src + ip - 2))] = (uint32_t)(ip - 2);
+            }
+        }
+    }
+
+    size_t literals = len - anchor;
+    if ((size_t)(op_end - op) < 1 + literals / 255 + 1 + literals) {
+        return 0;
+    }
+    uint8_t* token = op++;
+    *token = (uint8_t)((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15) {
+        op = lz_write_length(op, literals - 15);
+    }
+    memcpy(op, src + anchor, literals);
+    op += literals;
+
+    return (size_t)(op - dst);
+}
+
+// @return 0 on success, -1 if the length runs past the input
+static inline int lz_read_length(const uint8_t* src, size_t len, size_t* ip, size_t* length) {
+    uint8_t byte;
+    do {
+        if (*ip >= len) {
+            return -1;
+        }
+        byte = src[(*ip)++];
+        *length += byte;
+    } while (byte == 255);
+    return 0;
+}
+
+int lz_decompress(const uint8_t* src, size_t len, uint8_t* dst, size_t dst_len) {
+    if (!src || (!dst && dst_len > 0)) {
+        return -1;
+    }
+
+    size_t ip = 0;
+    size_t op = 0;
+    for (;;) {
+        if (ip >= len) {
+            return -1;
+        }
+        uint8_t token = src[ip++];
+
+        size_t literals = token >> 4;
+        if (literals == 15 && lz_read_length(src, len, &ip, &literals) < 0) {
+            return -1;
+        }
+        if (literals > len - ip || literals > dst_len - op) {
+            return -1;
+        }
+        memcpy(dst + op, src + ip, literals);
+        ip += literals;
+        op += literals;
+
+        if (ip == len) {
+            return op == dst_len ? 0 : -1;
+        }
+
+        if (len - ip < 2) {
+            return -1;
+        }
+        size_t offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return -1;
+        }
+
+        size_t match_len = token & 15u;
+        if (match_len == 15 && lz_read_length(src, len, &ip, &match_len) < 0) {
+            return -1;
+        }
+        match_len += LZ_MIN_MATCH;
+        if (match_len > dst_len - op) {
+            return -1;
+        }
+
+        const uint8_t* match = dst + op - offset;
+        if (offset >= match_len) {
+            memcpy(dst + op, match, match_len);
+        } else {
+            // Overlapping copy repeats the last `offset` bytes
+            for (size_t i = 0; i < match_len; i++) {
+                dst[op + i] = match[i];
+            }
+        }
+        op += match_len;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef FEROX_LZ_H
+#define FEROX_LZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Self-contained LZ77 block codec in the LZ4 block format.
+ *
+ * Each sequence is a token (literal length << 4 | match length - 4), extended
+ * lengths as 255-continued bytes, the literals, and a 2-byte little-endian
+ * match offset. The block ends with literals only. Greedy single-probe
+ * matching with a 4 K-entry hash table favours speed over ratio. The
+ * compressor keeps its table on the stack, so both sides are reentrant.
+ */
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535u
+
+// Worst-case compressed size for `len` input bytes.
+size_t lz_compress_bound(size_t len);
+
+/**
+ * @return compressed size, or 0 if the output would not fit in `capacity`
+ */
+size_t lz_compress(const uint8_t* src, size_t len, uint8_t* dst, size_t capacity);
+
+/**
+ * Decode a block that must expand to exactly `dst_len` bytes.
+ * Rejects truncated input, offsets before the output start and overruns.
+ * @return 0 on success, -1 on malformed input
+ */
+int lz_decompress(const uint8_t* src, size_t len, uint8_t* dst, size_t dst_len);
+
+#endif // FEROX_LZ_H
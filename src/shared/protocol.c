@@ -1,11 +1,22 @@
 #include "protocol.h"
+#include "lz.h"
 #include <stdlib.h>
 #include <string.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <errno.h>
 
+// Grid cell kernels use the baseline vector ISA of the target, if any
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PROTOCOL_HAVE_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PROTOCOL_HAVE_NEON 1
+#endif
+
 // Helper to write uint32_t in network byte order
 static void write_u32(uint8_t* buf, uint32_t val) {
     uint32_t net = htonl(val);
@@ -47,88 +58,405 @@ static float read_float(const uint8_t* buf) {
     return val;
 }
 
+// Cells are uint32 in memory and big-endian uint16 on the wire, so no host
+// layout can be copied as is; these kernels narrow and swap in one pass.
+// Callers guarantee every id fits 16 bits.
+static inline void protocol_store_cells_u16(uint8_t* dst, const uint32_t* cells, uint32_t count) {
+    uint32_t i = 0;
+#if defined(PROTOCOL_HAVE_SSE2)
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    const __m128i unbias = _mm_set1_epi16((short)0x8000);
+    for (; i + 8u <= count; i += 8u) {
+        // packs saturates signed values; bias the ids into int16 range first
+        __m128i lo = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(cells + i)), bias);
+        __m128i hi = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(cells + i + 4u)), bias);
+        __m128i ids = _mm_xor_si128(_mm_packs_epi32(lo, hi), unbias);
+        ids = _mm_or_si128(_mm_slli_epi16(ids, 8), _mm_srli_epi16(ids, 8));
+        _mm_storeu_si128((__m128i*)(dst + (size_t)i * 2u), ids);
+    }
+#elif defined(PROTOCOL_HAVE_NEON)
+    for (; i + 8u <= count; i += 8u) {
+        uint16x8_t ids = vcombine_u16(vmovn_u32(vld1q_u32(cells + i)), vmovn_u32(vld1q_u32(cells + i + 4u)));
+        vst1q_u8(dst + (size_t)i * 2u, vrev16q_u8(vreinterpretq_u8_u16(ids)));
+    }
+#endif
+    for (; i < count; i++) {
+        write_u16(dst + (size_t)i * 2u, (uint16_t)cells[i]);
+    }
+}
+
+static inline void protocol_load_cells_u16(uint32_t* cells, const uint8_t* src, uint32_t count) {
+    uint32_t i = 0;
+#if defined(PROTOCOL_HAVE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8u <= count; i += 8u) {
+        __m128i ids = _mm_loadu_si128((const __m128i*)(src + (size_t)i * 2u));
+        ids = _mm_or_si128(_mm_slli_epi16(ids, 8), _mm_srli_epi16(ids, 8));
+        _mm_storeu_si128((__m128i*)(cells + i), _mm_unpacklo_epi16(ids, zero));
+        _mm_storeu_si128((__m128i*)(cells + i + 4u), _mm_unpackhi_epi16(ids, zero));
+    }
+#elif defined(PROTOCOL_HAVE_NEON)
+    for (; i + 8u <= count; i += 8u) {
+        uint16x8_t ids = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(src + (size_t)i * 2u)));
+        vst1q_u32(cells + i, vmovl_u16(vget_low_u16(ids)));
+        vst1q_u32(cells + i + 4u, vmovl_u16(vget_high_u16(ids)));
+    }
+#endif
+    for (; i < count; i++) {
+        cells[i] = read_u16(src + (size_t)i * 2u);
+    }
+}
+
+static inline void protocol_fill_cells(uint32_t* cells, uint32_t value, uint32_t count) {
+    uint32_t i = 0;
+#if defined(PROTOCOL_HAVE_SSE2)
+    const __m128i fill = _mm_set1_epi32((int)value);
+    for (; i + 4u <= count; i += 4u) {
+        _mm_storeu_si128((__m128i*)(cells + i), fill);
+    }
+#elif defined(PROTOCOL_HAVE_NEON)
+    const uint32x4_t fill = vdupq_n_u32(value);
+    for (; i + 4u <= count; i += 4u) {
+        vst1q_u32(cells + i, fill);
+    }
+#endif
+    for (; i < count; i++) {
+        cells[i] = value;
+    }
+}
+
+// @return length of the run of grid[start] starting there, at most limit
+static inline uint32_t protocol_grid_run_length(const uint32_t* grid, uint32_t start, uint32_t size,
+                                                uint32_t limit) {
+    uint32_t value = grid[start];
+    uint32_t end = size - start > limit ? start + limit : size;
+    uint32_t i = start + 1u;
+    // Most runs in busy grids are short; settle those before vector setup
+    while (i < end && i - start < 4u) {
+        if (grid[i] != value) {
+            return i - start;
+        }
+        i++;
+    }
+#if defined(PROTOCOL_HAVE_SSE2)
+    const __m128i match = _mm_set1_epi32((int)value);
+    for (; i + 4u <= end; i += 4u) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(grid + i)), match);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        if (mask != 0xF) {
+            return i - start + (uint32_t)__builtin_ctz((unsigned)~mask);
+        }
+    }
+#elif defined(PROTOCOL_HAVE_NEON)
+    const uint32x4_t match = vdupq_n_u32(value);
+    for (; i + 4u <= end; i += 4u) {
+        if (vminvq_u32(vceqq_u32(vld1q_u32(grid + i), match)) != UINT32_MAX) {
+            break;
+        }
+    }
+#endif
+    while (i < end && grid[i] == value) {
+        i++;
+    }
+    return i - start;
+}
+
 static inline size_t protocol_grid_raw_serialized_size(uint32_t size) {
     return 5 + ((size_t)size * sizeof(uint16_t));
 }
 
-static inline size_t protocol_grid_rle_max_useful_size(uint32_t size) {
-    return protocol_grid_raw_serialized_size(size);
+// Largest encoding the codec ever picks: raw cells, as uint16 or, for grids
+// holding wide ids, as varints of at most 5 bytes.
+static inline size_t protocol_grid_rle_max_useful_size(uint32_t size, bool wide) {
+    return wide ? 5 + (size_t)size * 5u : protocol_grid_raw_serialized_size(size);
+}
+
+static inline bool protocol_grid_is_wide(const uint32_t* grid, uint32_t size) {
+    for (uint32_t i = 0; i < size; i++) {
+        if (grid[i] > UINT16_MAX) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline size_t protocol_varint_size(uint32_t value) {
+    return proto_grid_id_varint_size(value);
+}
+
+static inline size_t protocol_write_varint(uint8_t* buf, uint32_t value) {
+    size_t offset = 0;
+    while (value >= 0x80u) {
+        buf[offset++] = (uint8_t)(value | 0x80u);
+        value >>= 7;
+    }
+    buf[offset++] = (uint8_t)value;
+    return offset;
+}
+
+// @return bytes consumed, or 0 if the varint is truncated or overlong
+static inline size_t protocol_read_varint(const uint8_t* buf, size_t len, uint32_t* value) {
+    uint32_t result = 0;
+    for (size_t i = 0; i < len && i < 5; i++) {
+        result |= (uint32_t)(buf[i] & 0x7Fu) << (7 * i);
+        if ((buf[i] & 0x80u) == 0) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// Ids are uint16 unless the encoding is wide, then varints
+static inline size_t protocol_write_grid_id(uint8_t* buf, uint32_t id, bool wide) {
+    if (wide) {
+        return protocol_write_varint(buf, id);
+    }
+    write_u16(buf, (uint16_t)id);
+    return 2;
+}
+
+// @return bytes consumed, or 0 if the id runs past len
+static inline size_t protocol_read_grid_id(const uint8_t* buf, size_t len, bool wide, uint32_t* id) {
+    if (wide) {
+        return protocol_read_varint(buf, len, id);
+    }
+    if (len < 2) {
+        return 0;
+    }
+    *id = read_u16(buf);
+    return 2;
 }
 
-static inline size_t protocol_write_grid_raw_payload(const uint16_t* grid, uint32_t size, uint8_t* buffer) {
+static inline size_t protocol_write_grid_raw_payload(const uint32_t* grid, uint32_t size, bool wide,
+                                                     uint8_t* buffer) {
     size_t offset = 0;
     write_u32(buffer + offset, size);
     offset += 4;
-    buffer[offset++] = 1;
+    buffer[offset++] = (uint8_t)(PROTO_GRID_MODE_RAW | (wide ? PROTO_GRID_MODE_WIDE : 0u));
 
+    if (!wide) {
+        protocol_store_cells_u16(buffer + offset, grid, size);
+        return offset + (size_t)size * 2u;
+    }
     for (uint32_t i = 0; i < size; i++) {
-        write_u16(buffer + offset, grid[i]);
-        offset += sizeof(uint16_t);
+        offset += protocol_write_varint(buffer + offset, grid[i]);
     }
 
     return offset;
 }
 
-static inline int protocol_serialize_grid_rle_into(const uint16_t* grid,
-                                                   uint32_t size,
-                                                   uint8_t* buffer,
-                                                   size_t capacity,
-                                                   size_t* len) {
-    if (!grid || !buffer || !len || size == 0) return -1;
+// Open-addressed id -> index map for the grid codec palette modes.
+// Slots hold index + 1, 0 = empty.
+#define PROTO_GRID_PALETTE_SLOTS 512u
+
+typedef struct {
+    uint16_t slots[PROTO_GRID_PALETTE_SLOTS];
+    uint32_t ids[PROTO_GRID_PALETTE_MAX];
+    uint32_t count;
+} ProtoGridPalette;
+
+// @return palette index of id, inserting it if new; -1 once the palette is full
+static inline int protocol_grid_palette_index(ProtoGridPalette* palette, uint32_t id) {
+    uint32_t slot = (id * 0x9E3779B1u) >> (32 - 9);
+    for (;;) {
+        uint32_t entry = palette->slots[slot];
+        if (entry == 0) {
+            if (palette->count == PROTO_GRID_PALETTE_MAX) {
+                return -1;
+            }
+            uint32_t index = palette->count++;
+            palette->ids[index] = id;
+            palette->slots[slot] = (uint16_t)(index + 1u);
+            return (int)index;
+        }
+        if (palette->ids[entry - 1u] == id) {
+            return (int)(entry - 1u);
+        }
+        slot = (slot + 1u) & (PROTO_GRID_PALETTE_SLOTS - 1u);
+    }
+}
 
-    size_t raw_len = protocol_grid_rle_max_useful_size(size);
-    if (capacity < raw_len) {
-        return -1;
+static inline uint32_t protocol_grid_palette_bits(uint32_t palette_count) {
+    uint32_t bits = 0;
+    while ((1u << bits) < palette_count) {
+        bits++;
     }
+    return bits;
+}
 
-    uint32_t sample_limit = size < 4096u ? size : 4096u;
-    if (sample_limit > 1u) {
-        uint32_t run_breaks = 0;
-        uint16_t prev = grid[0];
-        for (uint32_t i = 1; i < sample_limit; i++) {
-            uint16_t cur = grid[i];
-            if (cur != prev) {
-                run_breaks++;
-                prev = cur;
-            }
-        }
+static inline size_t protocol_write_grid_rle_payload(const uint32_t* grid, uint32_t size, bool wide,
+                                                     uint8_t* buffer) {
+    size_t offset = 0;
+    write_u32(buffer + offset, size);
+    offset += 4;
+    buffer[offset++] = (uint8_t)(PROTO_GRID_MODE_RLE | (wide ? PROTO_GRID_MODE_WIDE : 0u));
 
-        if (run_breaks * 10u >= sample_limit * 9u) {
-            *len = protocol_write_grid_raw_payload(grid, size, buffer);
-            return 0;
-        }
+    uint32_t i = 0;
+    while (i < size) {
+        uint32_t value = grid[i];
+        uint16_t count = (uint16_t)protocol_grid_run_length(grid, i, size, 65535u);
+        write_u16(buffer + offset, count);
+        offset += 2;
+        offset += protocol_write_grid_id(buffer + offset, value, wide);
+        i += count;
     }
+    return offset;
+}
 
+static inline size_t protocol_write_grid_palette_header(const ProtoGridPalette* palette,
+                                                        uint32_t size,
+                                                        uint8_t mode,
+                                                        bool wide,
+                                                        uint8_t* buffer) {
     size_t offset = 0;
     write_u32(buffer + offset, size);
     offset += 4;
+    buffer[offset++] = (uint8_t)(mode | (wide ? PROTO_GRID_MODE_WIDE : 0u));
+    write_u16(buffer + offset, (uint16_t)palette->count);
+    offset += 2;
+    for (uint32_t i = 0; i < palette->count; i++) {
+        offset += protocol_write_grid_id(buffer + offset, palette->ids[i], wide);
+    }
+    return offset;
+}
 
-    size_t mode_offset = offset;
-    buffer[offset++] = 0;
+// Indices are packed LSB-first at `bits` per cell. Each group of eight cells
+// fills exactly `bits` bytes, so groups pack independently of each other.
+static inline size_t protocol_write_grid_palette_payload(const uint32_t* grid,
+                                                         uint32_t size,
+                                                         ProtoGridPalette* palette,
+                                                         bool wide,
+                                                         uint8_t* buffer) {
+    size_t offset = protocol_write_grid_palette_header(palette, size, PROTO_GRID_MODE_PALETTE, wide, buffer);
+    uint32_t bits = protocol_grid_palette_bits(palette->count);
+    if (bits == 0) {
+        return offset;
+    }
+
+    uint32_t last_id = grid[0];
+    uint32_t last_index = (uint32_t)protocol_grid_palette_index(palette, last_id);
+    for (uint32_t i = 0; i < size; i += 8) {
+        uint32_t group = size - i < 8u ? size - i : 8u;
+        uint64_t packed = 0;
+        for (uint32_t k = 0; k < group; k++) {
+            uint32_t id = grid[i + k];
+            if (id != last_id) {
+                last_id = id;
+                last_index = (uint32_t)protocol_grid_palette_index(palette, id);
+            }
+            packed |= (uint64_t)last_index << (k * bits);
+        }
+        size_t group_bytes = ((size_t)group * bits + 7u) / 8u;
+        for (size_t b = 0; b < group_bytes; b++) {
+            buffer[offset++] = (uint8_t)(packed >> (8 * b));
+        }
+    }
+    return offset;
+}
 
+static inline size_t protocol_write_grid_palette_rle_payload(const uint32_t* grid,
+                                                             uint32_t size,
+                                                             ProtoGridPalette* palette,
+                                                             bool wide,
+                                                             uint8_t* buffer) {
+    size_t offset = protocol_write_grid_palette_header(palette, size, PROTO_GRID_MODE_PALETTE_RLE, wide, buffer);
     uint32_t i = 0;
     while (i < size) {
-        uint16_t value = grid[i];
-        uint16_t count = 1;
+        uint32_t value = grid[i];
+        uint32_t run = protocol_grid_run_length(grid, i, size, UINT32_MAX);
+        buffer[offset++] = (uint8_t)protocol_grid_palette_index(palette, value);
+        offset += protocol_write_varint(buffer + offset, run);
+        i += run;
+    }
+    return offset;
+}
 
-        while (i + count < size && grid[i + count] == value && count < 65535) {
-            count++;
-        }
+// Measures every mode exactly in one pass over the runs, then writes the
+// smallest. Ties keep the cheaper-to-decode mode (raw, RLE, palette). Ids
+// are written as uint16 unless one needs more bits, so grids of small ids
+// encode exactly as before PROTO_GRID_MODE_WIDE existed.
+// @return 0 on success, -1 on bad arguments or if the result exceeds capacity
+static inline int protocol_serialize_grid_rle_into(const uint32_t* grid,
+                                                   uint32_t size,
+                                                   uint8_t* buffer,
+                                                   size_t capacity,
+                                                   size_t* len) {
+    if (!grid || !buffer || !len || size == 0) return -1;
+
+    ProtoGridPalette palette;
+    memset(palette.slots, 0, sizeof(palette.slots));
+    palette.count = 0;
+    bool palette_ok = true;
+    bool wide = false;
+    size_t rle_runs = 0;
+    size_t rle_wide_bytes = 0;
+    size_t raw_wide_bytes = 0;
+    size_t index_run_bytes = 0;
 
-        if (offset + 4 > raw_len) {
-            *len = protocol_write_grid_raw_payload(grid, size, buffer);
-            return 0;
+    uint32_t i = 0;
+    while (i < size) {
+        uint32_t value = grid[i];
+        uint32_t run = protocol_grid_run_length(grid, i, size, UINT32_MAX);
+        size_t value_runs = (run + 65534u) / 65535u;
+        size_t value_varint = protocol_varint_size(value);
+        wide = wide || value > UINT16_MAX;
+        rle_runs += value_runs;
+        rle_wide_bytes += value_runs * (2 + value_varint);
+        raw_wide_bytes += (size_t)run * value_varint;
+        if (palette_ok) {
+            palette_ok = protocol_grid_palette_index(&palette, value) >= 0;
+            index_run_bytes += 1 + protocol_varint_size(run);
         }
+        i += run;
+    }
 
-        write_u16(buffer + offset, count);
-        offset += 2;
-        write_u16(buffer + offset, value);
-        offset += 2;
-        i += count;
+    size_t best_len = wide ? 5 + raw_wide_bytes : protocol_grid_raw_serialized_size(size);
+    uint8_t best_mode = PROTO_GRID_MODE_RAW;
+    size_t rle_len = 5 + (wide ? rle_wide_bytes : rle_runs * 4);
+    if (rle_len < best_len) {
+        best_len = rle_len;
+        best_mode = PROTO_GRID_MODE_RLE;
+    }
+    if (palette_ok) {
+        size_t palette_bytes = (size_t)palette.count * 2;
+        if (wide) {
+            palette_bytes = 0;
+            for (uint32_t p = 0; p < palette.count; p++) {
+                palette_bytes += protocol_varint_size(palette.ids[p]);
+            }
+        }
+        size_t header_len = 5 + 2 + palette_bytes;
+        size_t packed_len = header_len +
+                            ((size_t)size * protocol_grid_palette_bits(palette.count) + 7u) / 8u;
+        if (packed_len < best_len) {
+            best_len = packed_len;
+            best_mode = PROTO_GRID_MODE_PALETTE;
+        }
+        size_t runs_len = header_len + index_run_bytes;
+        if (runs_len < best_len) {
+            best_len = runs_len;
+            best_mode = PROTO_GRID_MODE_PALETTE_RLE;
+        }
+    }
+    if (best_len > capacity) {
+        return -1;
     }
 
-    buffer[mode_offset] = 0;
-    *len = offset;
+    switch (best_mode) {
+        case PROTO_GRID_MODE_RLE:
+            *len = protocol_write_grid_rle_payload(grid, size, wide, buffer);
+            break;
+        case PROTO_GRID_MODE_PALETTE:
+            *len = protocol_write_grid_palette_payload(grid, size, &palette, wide, buffer);
+            break;
+        case PROTO_GRID_MODE_PALETTE_RLE:
+            *len = protocol_write_grid_palette_rle_payload(grid, size, &palette, wide, buffer);
+            break;
+        default:
+            *len = protocol_write_grid_raw_payload(grid, size, wide, buffer);
+            break;
+    }
     return 0;
 }
 
@@ -440,7 +768,8 @@ int protocol_serialize_world_state(const ProtoWorld* world, uint8_t** buffer, si
     size_t colonies_size = world->colony_count * COLONY_SERIALIZED_SIZE;
     size_t grid_capacity = 0;
     if (world->has_grid && world->grid && world->grid_size > 0) {
-        grid_capacity = protocol_grid_rle_max_useful_size(world->grid_size);
+        grid_capacity = protocol_grid_rle_max_useful_size(world->grid_size,
+                                                          protocol_grid_is_wide(world->grid, world->grid_size));
     }
     size_t total_size = header_size + colonies_size + grid_capacity;
 
@@ -548,6 +877,7 @@ int protocol_deserialize_world_state(const uint8_t* buffer, size_t len, ProtoWor
         uint32_t grid_size = world->width * world->height;
         if (grid_size > 0 && grid_size <= MAX_GRID_SIZE) {
             proto_world_alloc_grid(world, world->width, world->height);
+            world->grid_level = 0;
             if (world->grid) {
                 if (protocol_deserialize_grid_rle(buffer + offset, grid_len, world->grid, grid_size) < 0) {
                     // Grid decompression failed, but continue without grid
@@ -579,18 +909,33 @@ int protocol_serialize_world_delta_grid_chunk(const ProtoWorldDeltaGridChunk* ch
         return -1;
     }
 
-    size_t total_size = 1 + (6 * 4) + 1 + ((size_t)chunk->cell_count * sizeof(uint16_t));
-    if (total_size > MAX_PAYLOAD_SIZE) {
+    const size_t header_size = 1 + (6 * 4) + 1;
+    size_t raw_cells_size = (size_t)chunk->cell_count * sizeof(uint16_t);
+    if (header_size + raw_cells_size > MAX_PAYLOAD_SIZE) {
         return -1;
     }
 
-    *buffer = (uint8_t*)malloc(total_size);
+    // Sized for the codec's worst case so it can be tried in place. Raw
+    // cells are uint16, so chunks holding wide ids are always packed.
+    bool wide = protocol_grid_is_wide(chunk->cells, chunk->cell_count);
+    size_t codec_capacity = protocol_grid_rle_max_useful_size(chunk->cell_count, wide);
+    *buffer = (uint8_t*)malloc(header_size + codec_capacity);
     if (!*buffer) {
         return -1;
     }
 
+    size_t codec_len = 0;
+    bool packed = protocol_serialize_grid_rle_into(chunk->cells, chunk->cell_count, *buffer + header_size,
+                                                   codec_capacity, &codec_len) == 0 &&
+                  (wide || codec_len < raw_cells_size);
+    if (wide && (!packed || header_size + codec_len > MAX_PAYLOAD_SIZE)) {
+        free(*buffer);
+        *buffer = NULL;
+        return -1;
+    }
+
     int offset = 0;
-    (*buffer)[offset++] = (uint8_t)PROTO_WORLD_DELTA_GRID_CHUNK;
+    (*buffer)[offset++] = (uint8_t)(packed ? PROTO_WORLD_DELTA_GRID_CHUNK_PACKED : PROTO_WORLD_DELTA_GRID_CHUNK);
     write_u32(*buffer + offset, chunk->tick);
     offset += 4;
     write_u32(*buffer + offset, chunk->width);
@@ -605,11 +950,14 @@ int protocol_serialize_world_delta_grid_chunk(const ProtoWorldDeltaGridChunk* ch
     offset += 4;
     (*buffer)[offset++] = chunk->final_chunk ? 1 : 0;
 
-    for (uint32_t i = 0; i < chunk->cell_count; i++) {
-        write_u16(*buffer + offset, chunk->cells[i]);
-        offset += 2;
+    if (packed) {
+        *len = header_size + codec_len;
+        return 0;
     }
 
+    protocol_store_cells_u16(*buffer + offset, chunk->cells, chunk->cell_count);
+    offset += (int)(chunk->cell_count * 2u);
+
     *len = (size_t)offset;
     return 0;
 }
@@ -621,7 +969,7 @@ int protocol_deserialize_world_delta_grid_chunk(const uint8_t* buffer, size_t le
 
     int offset = 0;
     uint8_t kind = buffer[offset++];
-    if (kind != (uint8_t)PROTO_WORLD_DELTA_GRID_CHUNK) {
+    if (kind != (uint8_t)PROTO_WORLD_DELTA_GRID_CHUNK && kind != (uint8_t)PROTO_WORLD_DELTA_GRID_CHUNK_PACKED) {
         return -1;
     }
 
@@ -648,82 +996,717 @@ int protocol_deserialize_world_delta_grid_chunk(const uint8_t* buffer, size_t le
     if (chunk->start_index >= chunk->total_cells || chunk->start_index + chunk->cell_count > chunk->total_cells) {
         return -1;
     }
+    if (kind == (uint8_t)PROTO_WORLD_DELTA_GRID_CHUNK_PACKED) {
+        if (len - (size_t)offset < 5 || read_u32(buffer + offset) != chunk->cell_count) {
+            return -1;
+        }
+        chunk->cells = (uint32_t*)malloc((size_t)chunk->cell_count * sizeof(uint32_t));
+        if (!chunk->cells) {
+            return -1;
+        }
+        if (protocol_deserialize_grid_rle(buffer + offset, len - (size_t)offset, chunk->cells, chunk->cell_count) < 0) {
+            free(chunk->cells);
+            chunk->cells = NULL;
+            return -1;
+        }
+        return 0;
+    }
+
     if ((size_t)offset + ((size_t)chunk->cell_count * sizeof(uint16_t)) > len) {
         return -1;
     }
 
-    chunk->cells = (uint16_t*)malloc((size_t)chunk->cell_count * sizeof(uint16_t));
+    chunk->cells = (uint32_t*)malloc((size_t)chunk->cell_count * sizeof(uint32_t));
     if (!chunk->cells) {
         return -1;
     }
 
-    for (uint32_t i = 0; i < chunk->cell_count; i++) {
-        chunk->cells[i] = read_u16(buffer + offset);
-        offset += 2;
-    }
+    protocol_load_cells_u16(chunk->cells, buffer + offset, chunk->cell_count);
 
     return 0;
 }
 
-int protocol_serialize_command_status(const ProtoCommandStatus* status, uint8_t* buffer) {
-    if (!status || !buffer) return -1;
+size_t protocol_world_delta_spans_size(uint32_t span_count, uint32_t cell_count) {
+    return WORLD_DELTA_SPANS_HEADER_SIZE +
+           ((size_t)span_count * GRID_SPAN_HEADER_SIZE) +
+           ((size_t)cell_count * sizeof(uint16_t));
+}
 
-    int offset = 0;
-    write_u32(buffer + offset, status->command);
+// World delta span format:
+// [kind:uint8=2][tick][base_tick][width][height][span_count][cell_count]
+// then span_count * ([start:uint32][length:uint16][ids:uint16 * length])
+// Kind 4 is identical except that ids are varints; it is only written when
+// some id does not fit 16 bits.
+int protocol_serialize_world_delta_spans(const ProtoWorldDeltaSpans* delta, uint8_t** buffer, size_t* len) {
+    if (!delta || !buffer || !len) {
+        return -1;
+    }
+    if (delta->span_count > 0 && (!delta->spans || !delta->cells)) {
+        return -1;
+    }
+
+    uint32_t total_cells = delta->width * delta->height;
+    if (total_cells == 0 || total_cells > MAX_GRID_SIZE || delta->cell_count > total_cells) {
+        return -1;
+    }
+
+    size_t total_size = protocol_world_delta_spans_size(delta->span_count, delta->cell_count);
+    bool wide = delta->span_count > 0 && protocol_grid_is_wide(delta->cells, delta->cell_count);
+    if (wide) {
+        total_size = WORLD_DELTA_SPANS_HEADER_SIZE + (size_t)delta->span_count * GRID_SPAN_HEADER_SIZE;
+        for (uint32_t i = 0; i < delta->cell_count; i++) {
+            total_size += protocol_varint_size(delta->cells[i]);
+        }
+    }
+    if (total_size > MAX_PAYLOAD_SIZE) {
+        return -1;
+    }
+
+    *buffer = (uint8_t*)malloc(total_size);
+    if (!*buffer) {
+        return -1;
+    }
+
+    size_t offset = 0;
+    (*buffer)[offset++] = (uint8_t)(wide ? PROTO_WORLD_DELTA_GRID_SPANS_WIDE : PROTO_WORLD_DELTA_GRID_SPANS);
+    write_u32(*buffer + offset, delta->tick);
     offset += 4;
-    write_u32(buffer + offset, status->status_code);
+    write_u32(*buffer + offset, delta->base_tick);
     offset += 4;
-    write_u32(buffer + offset, status->entity_id);
+    write_u32(*buffer + offset, delta->width);
     offset += 4;
-    memcpy(buffer + offset, status->message, COMMAND_STATUS_MESSAGE_SIZE);
-    offset += COMMAND_STATUS_MESSAGE_SIZE;
-    return offset;
+    write_u32(*buffer + offset, delta->height);
+    offset += 4;
+    write_u32(*buffer + offset, delta->span_count);
+    offset += 4;
+    write_u32(*buffer + offset, delta->cell_count);
+    offset += 4;
+
+    uint32_t cell_cursor = 0;
+    for (uint32_t s = 0; s < delta->span_count; s++) {
+        const ProtoGridSpan* span = &delta->spans[s];
+        if (span->length == 0 ||
+            (uint64_t)span->start + span->length > total_cells ||
+            cell_cursor + span->length > delta->cell_count) {
+            free(*buffer);
+            *buffer = NULL;
+            return -1;
+        }
+
+        write_u32(*buffer + offset, span->start);
+        offset += 4;
+        write_u16(*buffer + offset, span->length);
+        offset += 2;
+        if (!wide) {
+            protocol_store_cells_u16(*buffer + offset, delta->cells + cell_cursor, span->length);
+            offset += (size_t)span->length * 2u;
+            cell_cursor += span->length;
+            continue;
+        }
+        for (uint16_t i = 0; i < span->length; i++) {
+            offset += protocol_write_varint(*buffer + offset, delta->cells[cell_cursor++]);
+        }
+    }
+
+    if (cell_cursor != delta->cell_count) {
+        free(*buffer);
+        *buffer = NULL;
+        return -1;
+    }
+
+    *len = offset;
+    return 0;
 }
 
-int protocol_deserialize_command_status(const uint8_t* buffer, ProtoCommandStatus* status) {
-    if (!buffer || !status) return -1;
+int protocol_deserialize_world_delta_spans(const uint8_t* buffer, size_t len, ProtoWorldDeltaSpans* delta) {
+    if (!buffer || !delta || len < WORLD_DELTA_SPANS_HEADER_SIZE) {
+        return -1;
+    }
 
-    int offset = 0;
-    status->command = read_u32(buffer + offset);
+    size_t offset = 0;
+    uint8_t kind = buffer[offset++];
+    if (kind != (uint8_t)PROTO_WORLD_DELTA_GRID_SPANS && kind != (uint8_t)PROTO_WORLD_DELTA_GRID_SPANS_WIDE) {
+        return -1;
+    }
+    bool wide = kind == (uint8_t)PROTO_WORLD_DELTA_GRID_SPANS_WIDE;
+
+    delta->tick = read_u32(buffer + offset);
     offset += 4;
-    status->status_code = read_u32(buffer + offset);
+    delta->base_tick = read_u32(buffer + offset);
     offset += 4;
-    status->entity_id = read_u32(buffer + offset);
+    delta->width = read_u32(buffer + offset);
     offset += 4;
-    memcpy(status->message, buffer + offset, COMMAND_STATUS_MESSAGE_SIZE);
-    status->message[COMMAND_STATUS_MESSAGE_SIZE - 1] = '\0';
-    offset += COMMAND_STATUS_MESSAGE_SIZE;
-    return offset;
-}
-
-int protocol_serialize_command(CommandType cmd, const void* data, uint8_t* buffer) {
-    if (!buffer) return -1;
-    
-    int offset = 0;
-    
-    write_u32(buffer + offset, (uint32_t)cmd);
+    delta->height = read_u32(buffer + offset);
     offset += 4;
-    
-    switch (cmd) {
-        case CMD_SELECT_COLONY:
-            if (data) {
-                const CommandSelectColony* sel = (const CommandSelectColony*)data;
-                write_u32(buffer + offset, sel->colony_id);
-                offset += 4;
+    delta->span_count = read_u32(buffer + offset);
+    offset += 4;
+    delta->cell_count = read_u32(buffer + offset);
+    offset += 4;
+    delta->spans = NULL;
+    delta->cells = NULL;
+
+    uint32_t total_cells = delta->width * delta->height;
+    if (total_cells == 0 || total_cells > MAX_GRID_SIZE ||
+        delta->cell_count > total_cells || delta->span_count > delta->cell_count ||
+        delta->base_tick > delta->tick) {
+        return -1;
+    }
+    // Varint ids take at least a byte each, so the length still bounds the counts
+    size_t min_size = wide ? WORLD_DELTA_SPANS_HEADER_SIZE + (size_t)delta->span_count * GRID_SPAN_HEADER_SIZE +
+                                 delta->cell_count
+                           : protocol_world_delta_spans_size(delta->span_count, delta->cell_count);
+    if (wide ? min_size > len : min_size != len) {
+        return -1;
+    }
+    if (delta->span_count == 0) {
+        return wide && len != min_size ? -1 : 0;
+    }
+
+    delta->spans = (ProtoGridSpan*)malloc((size_t)delta->span_count * sizeof(ProtoGridSpan));
+    delta->cells = (uint32_t*)malloc((size_t)delta->cell_count * sizeof(uint32_t));
+    if (!delta->spans || !delta->cells) {
+        proto_world_delta_spans_free(delta);
+        return -1;
+    }
+
+    uint32_t cell_cursor = 0;
+    for (uint32_t s = 0; s < delta->span_count; s++) {
+        ProtoGridSpan* span = &delta->spans[s];
+        if (len - offset < GRID_SPAN_HEADER_SIZE) {
+            proto_world_delta_spans_free(delta);
+            return -1;
+        }
+        span->start = read_u32(buffer + offset);
+        offset += 4;
+        span->length = read_u16(buffer + offset);
+        offset += 2;
+        if (span->length == 0 ||
+            (uint64_t)span->start + span->length > total_cells ||
+            cell_cursor + span->length > delta->cell_count) {
+            proto_world_delta_spans_free(delta);
+            return -1;
+        }
+        if (!wide) {
+            if (len - offset < (size_t)span->length * 2u) {
+                proto_world_delta_spans_free(delta);
+                return -1;
             }
-            break;
-            
-        case CMD_SPAWN_COLONY:
-            if (data) {
-                const CommandSpawnColony* spawn = (const CommandSpawnColony*)data;
-                write_float(buffer + offset, spawn->x);
-                offset += 4;
-                write_float(buffer + offset, spawn->y);
-                offset += 4;
-                memcpy(buffer + offset, spawn->name, MAX_COLONY_NAME);
-                offset += MAX_COLONY_NAME;
+            protocol_load_cells_u16(delta->cells + cell_cursor, buffer + offset, span->length);
+            offset += (size_t)span->length * 2u;
+            cell_cursor += span->length;
+            continue;
+        }
+        for (uint16_t i = 0; i < span->length; i++) {
+            size_t used = protocol_read_grid_id(buffer + offset, len - offset, wide, &delta->cells[cell_cursor]);
+            if (used == 0) {
+                proto_world_delta_spans_free(delta);
+                return -1;
             }
-            break;
+            offset += used;
+            cell_cursor++;
+        }
+    }
+
+    if (cell_cursor != delta->cell_count || offset != len) {
+        proto_world_delta_spans_free(delta);
+        return -1;
+    }
+
+    return 0;
+}
+
+int protocol_serialize_world_ack(const ProtoWorldAck* ack, uint8_t* buffer) {
+    if (!ack || !buffer) return -1;
+    write_u32(buffer, ack->tick);
+    return WORLD_ACK_SERIALIZED_SIZE;
+}
+
+int protocol_deserialize_world_ack(const uint8_t* buffer, size_t len, ProtoWorldAck* ack) {
+    if (!buffer || !ack || len != WORLD_ACK_SERIALIZED_SIZE) return -1;
+    ack->tick = read_u32(buffer);
+    return WORLD_ACK_SERIALIZED_SIZE;
+}
+
+int protocol_serialize_connect(const ProtoConnect* connect, uint8_t* buffer) {
+    if (!connect || !buffer) return -1;
+    write_u32(buffer, connect->capabilities);
+    write_u32(buffer + 4, connect->version);
+    return CONNECT_SERIALIZED_SIZE;
+}
+
+int protocol_deserialize_connect(const uint8_t* buffer, size_t len, ProtoConnect* connect) {
+    if (!connect || (len > 0 && !buffer)) return -1;
+    // Version 1 clients send only the capabilities, or no payload at all
+    connect->capabilities = len >= CONNECT_LEGACY_SERIALIZED_SIZE ? read_u32(buffer) : 0;
+    connect->version = len >= CONNECT_SERIALIZED_SIZE ? read_u32(buffer + 4) : 1u;
+    if (connect->version == 0) {
+        connect->version = 1u;
+    }
+    return 0;
+}
+
+int protocol_negotiate_connect(const ProtoConnect* offer, uint32_t supported, ProtoConnect* result) {
+    if (!offer || !result) return -1;
+    uint32_t version = offer->version > 1u ? offer->version : 1u;
+    uint32_t capabilities = offer->capabilities;
+    if (version < 2u) {
+        capabilities |= PROTO_CAP_LEGACY_DEFAULT;
+    }
+    result->version = version < PROTOCOL_VERSION ? version : PROTOCOL_VERSION;
+    result->capabilities = capabilities & supported & PROTO_CAP_ALL;
+    return 0;
+}
+
+int protocol_serialize_colony_page(const ProtoColonyPage* page, uint8_t** buffer, size_t* len) {
+    if (!page || !buffer || !len || (page->count > 0 && !page->colonies)) return -1;
+    if (page->count > PROTO_COLONY_PAGE_SIZE || page->start < MAX_COLONIES ||
+        (uint64_t)page->start + page->count > page->total_count) {
+        return -1;
+    }
+
+    size_t total_size = COLONY_PAGE_HEADER_SIZE + (size_t)page->count * COLONY_SERIALIZED_SIZE;
+    *buffer = (uint8_t*)malloc(total_size);
+    if (!*buffer) {
+        return -1;
+    }
+
+    size_t offset = 0;
+    write_u32(*buffer + offset, page->tick);
+    offset += 4;
+    write_u32(*buffer + offset, page->total_count);
+    offset += 4;
+    write_u32(*buffer + offset, page->start);
+    offset += 4;
+    write_u32(*buffer + offset, page->count);
+    offset += 4;
+    for (uint32_t i = 0; i < page->count; i++) {
+        offset += (size_t)protocol_serialize_colony(&page->colonies[i], *buffer + offset);
+    }
+
+    *len = offset;
+    return 0;
+}
+
+int protocol_deserialize_colony_page(const uint8_t* buffer, size_t len, ProtoColonyPage* page) {
+    if (!buffer || !page || len < COLONY_PAGE_HEADER_SIZE) return -1;
+
+    page->tick = read_u32(buffer);
+    page->total_count = read_u32(buffer + 4);
+    page->start = read_u32(buffer + 8);
+    page->count = read_u32(buffer + 12);
+    page->colonies = NULL;
+    if (page->count == 0 || page->count > PROTO_COLONY_PAGE_SIZE || page->start < MAX_COLONIES ||
+        (uint64_t)page->start + page->count > page->total_count ||
+        len != COLONY_PAGE_HEADER_SIZE + (size_t)page->count * COLONY_SERIALIZED_SIZE) {
+        return -1;
+    }
+
+    page->colonies = (ProtoColony*)malloc((size_t)page->count * sizeof(ProtoColony));
+    if (!page->colonies) {
+        return -1;
+    }
+    size_t offset = COLONY_PAGE_HEADER_SIZE;
+    for (uint32_t i = 0; i < page->count; i++) {
+        offset += (size_t)protocol_deserialize_colony(buffer + offset, &page->colonies[i]);
+    }
+    return 0;
+}
+
+void proto_colony_page_free(ProtoColonyPage* page) {
+    if (!page) return;
+    free(page->colonies);
+    page->colonies = NULL;
+    page->count = 0;
+}
+
+#define PROTO_COLONY_WOBBLE_SCALE (256.0f / 6.28318530718f)
+#define COLONY_DESCRIPTOR_MIN_SIZE 9   // gap(1) + name_len(1) + colors(3) + shape_seed(4)
+#define COLONY_DYNAMIC_MIN_SIZE 15     // gap(1) + flags(1) + 3 * uint16 + 2 * varint(1) + 5
+
+static uint16_t proto_quantize_u16(float value, float scale) {
+    float scaled = value * scale + 0.5f;
+    if (!(scaled > 0.0f)) {
+        return 0;  // Negative or NaN
+    }
+    return scaled >= 65535.0f ? 65535u : (uint16_t)scaled;
+}
+
+static int16_t proto_quantize_i16(float value, float scale) {
+    float scaled = value * scale;
+    if (!(scaled > -32768.0f)) {
+        return scaled < 0.0f ? INT16_MIN : 0;
+    }
+    if (scaled >= 32767.0f) {
+        return INT16_MAX;
+    }
+    return (int16_t)(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+}
+
+// Trailing NUL bytes of a name are not sent
+static size_t proto_colony_name_length(const char name[MAX_COLONY_NAME]) {
+    size_t length = MAX_COLONY_NAME;
+    while (length > 0 && name[length - 1] == '\0') {
+        length--;
+    }
+    return length;
+}
+
+void proto_colony_quantize(const ProtoColony* colony, ProtoColonyDescriptor* descriptor,
+                           ProtoColonyDynamic* dynamic) {
+    if (!colony) return;
+
+    // Zeroed first so records compare with memcmp
+    if (descriptor) {
+        memset(descriptor, 0, sizeof(*descriptor));
+        descriptor->id = colony->id;
+        memcpy(descriptor->name, colony->name, MAX_COLONY_NAME);
+        descriptor->color_r = colony->color_r;
+        descriptor->color_g = colony->color_g;
+        descriptor->color_b = colony->color_b;
+        descriptor->shape_seed = colony->shape_seed;
+    }
+    if (dynamic) {
+        memset(dynamic, 0, sizeof(*dynamic));
+        dynamic->id = colony->id;
+        dynamic->alive = colony->alive;
+        dynamic->x = proto_quantize_u16(colony->x, PROTO_COLONY_POS_SCALE);
+        dynamic->y = proto_quantize_u16(colony->y, PROTO_COLONY_POS_SCALE);
+        dynamic->radius = proto_quantize_u16(colony->radius, PROTO_COLONY_POS_SCALE);
+        dynamic->population = colony->population;
+        dynamic->max_population = colony->max_population;
+        dynamic->growth_rate = proto_quantize_i16(colony->growth_rate, PROTO_COLONY_RATE_SCALE);
+        // The phase only matters modulo a full turn
+        dynamic->wobble_phase = (uint8_t)((uint16_t)proto_quantize_i16(colony->wobble_phase,
+                                                                       PROTO_COLONY_WOBBLE_SCALE) & 0xFFu);
+        dynamic->shape_evolution = proto_quantize_u16(colony->shape_evolution, PROTO_COLONY_EVOLUTION_SCALE);
+    }
+}
+
+static void proto_colony_apply_descriptor(ProtoColony* colony, const ProtoColonyDescriptor* descriptor) {
+    memcpy(colony->name, descriptor->name, MAX_COLONY_NAME);
+    colony->color_r = descriptor->color_r;
+    colony->color_g = descriptor->color_g;
+    colony->color_b = descriptor->color_b;
+    colony->shape_seed = descriptor->shape_seed;
+}
+
+static void proto_colony_apply_dynamic(ProtoColony* colony, const ProtoColonyDynamic* dynamic) {
+    colony->alive = dynamic->alive;
+    colony->x = (float)dynamic->x / PROTO_COLONY_POS_SCALE;
+    colony->y = (float)dynamic->y / PROTO_COLONY_POS_SCALE;
+    colony->radius = (float)dynamic->radius / PROTO_COLONY_POS_SCALE;
+    colony->population = dynamic->population;
+    colony->max_population = dynamic->max_population;
+    colony->growth_rate = (float)dynamic->growth_rate / PROTO_COLONY_RATE_SCALE;
+    colony->wobble_phase = (float)dynamic->wobble_phase / PROTO_COLONY_WOBBLE_SCALE;
+    colony->shape_evolution = (float)dynamic->shape_evolution / PROTO_COLONY_EVOLUTION_SCALE;
+}
+
+void proto_colony_delta_init(ProtoColonyDelta* delta) {
+    if (!delta) return;
+    memset(delta, 0, sizeof(*delta));
+}
+
+void proto_colony_delta_free(ProtoColonyDelta* delta) {
+    if (!delta) return;
+    free(delta->removed);
+    free(delta->descriptors);
+    free(delta->dynamics);
+    delta->removed = NULL;
+    delta->descriptors = NULL;
+    delta->dynamics = NULL;
+    delta->removed_count = 0;
+    delta->descriptor_count = 0;
+    delta->dynamic_count = 0;
+}
+
+// Id gaps must be positive after the first entry of a list
+static inline bool proto_colony_id_follows(uint32_t id, uint32_t index, uint32_t prev) {
+    return index == 0 || id > prev;
+}
+
+int protocol_serialize_colony_delta(const ProtoColonyDelta* delta, uint8_t** buffer, size_t* len) {
+    if (!delta || !buffer || !len) return -1;
+    if ((delta->removed_count > 0 && !delta->removed) ||
+        (delta->descriptor_count > 0 && !delta->descriptors) ||
+        (delta->dynamic_count > 0 && !delta->dynamics)) {
+        return -1;
+    }
+
+    // Size pass, which also checks that every list is sorted by id
+    size_t total_size = COLONY_DELTA_HEADER_SIZE;
+    uint32_t prev = 0;
+    for (uint32_t i = 0; i < delta->removed_count; i++) {
+        uint32_t id = delta->removed[i];
+        if (!proto_colony_id_follows(id, i, prev)) return -1;
+        total_size += protocol_varint_size(id - prev);
+        prev = id;
+    }
+    prev = 0;
+    for (uint32_t i = 0; i < delta->descriptor_count; i++) {
+        const ProtoColonyDescriptor* descriptor = &delta->descriptors[i];
+        if (!proto_colony_id_follows(descriptor->id, i, prev)) return -1;
+        total_size += protocol_varint_size(descriptor->id - prev) + 1 +
+                      proto_colony_name_length(descriptor->name) + 3 + 4;
+        prev = descriptor->id;
+    }
+    prev = 0;
+    for (uint32_t i = 0; i < delta->dynamic_count; i++) {
+        const ProtoColonyDynamic* dynamic = &delta->dynamics[i];
+        if (!proto_colony_id_follows(dynamic->id, i, prev)) return -1;
+        total_size += protocol_varint_size(dynamic->id - prev) + 1 + 6 +
+                      protocol_varint_size(dynamic->population) +
+                      protocol_varint_size(dynamic->max_population) + 2 + 1 + 2;
+        prev = dynamic->id;
+    }
+    if (total_size > MAX_PAYLOAD_SIZE) {
+        return -1;
+    }
+
+    *buffer = (uint8_t*)malloc(total_size);
+    if (!*buffer) {
+        return -1;
+    }
+    uint8_t* out = *buffer;
+    size_t offset = 0;
+    write_u32(out + offset, delta->tick);
+    offset += 4;
+    write_u32(out + offset, delta->full ? 0u : delta->base_tick);
+    offset += 4;
+    out[offset++] = delta->full ? COLONY_DELTA_FLAG_FULL : 0u;
+    write_u32(out + offset, delta->total_count);
+    offset += 4;
+    write_u32(out + offset, delta->removed_count);
+    offset += 4;
+    write_u32(out + offset, delta->descriptor_count);
+    offset += 4;
+    write_u32(out + offset, delta->dynamic_count);
+    offset += 4;
+
+    prev = 0;
+    for (uint32_t i = 0; i < delta->removed_count; i++) {
+        offset += protocol_write_varint(out + offset, delta->removed[i] - prev);
+        prev = delta->removed[i];
+    }
+    prev = 0;
+    for (uint32_t i = 0; i < delta->descriptor_count; i++) {
+        const ProtoColonyDescriptor* descriptor = &delta->descriptors[i];
+        size_t name_length = proto_colony_name_length(descriptor->name);
+        offset += protocol_write_varint(out + offset, descriptor->id - prev);
+        out[offset++] = (uint8_t)name_length;
+        memcpy(out + offset, descriptor->name, name_length);
+        offset += name_length;
+        out[offset++] = descriptor->color_r;
+        out[offset++] = descriptor->color_g;
+        out[offset++] = descriptor->color_b;
+        write_u32(out + offset, descriptor->shape_seed);
+        offset += 4;
+        prev = descriptor->id;
+    }
+    prev = 0;
+    for (uint32_t i = 0; i < delta->dynamic_count; i++) {
+        const ProtoColonyDynamic* dynamic = &delta->dynamics[i];
+        offset += protocol_write_varint(out + offset, dynamic->id - prev);
+        out[offset++] = dynamic->alive ? 1u : 0u;
+        write_u16(out + offset, dynamic->x);
+        offset += 2;
+        write_u16(out + offset, dynamic->y);
+        offset += 2;
+        write_u16(out + offset, dynamic->radius);
+        offset += 2;
+        offset += protocol_write_varint(out + offset, dynamic->population);
+        offset += protocol_write_varint(out + offset, dynamic->max_population);
+        write_u16(out + offset, (uint16_t)dynamic->growth_rate);
+        offset += 2;
+        out[offset++] = dynamic->wobble_phase;
+        write_u16(out + offset, dynamic->shape_evolution);
+        offset += 2;
+        prev = dynamic->id;
+    }
+
+    *len = offset;
+    return 0;
+}
+
+// @return bytes consumed, or 0 if the gap is truncated, zero after the first
+//         entry, or overflows the id
+static size_t proto_read_colony_id(const uint8_t* buffer, size_t len, uint32_t index,
+                                   uint32_t prev, uint32_t* id) {
+    uint32_t gap = 0;
+    size_t used = protocol_read_varint(buffer, len, &gap);
+    if (used == 0 || (index > 0 && gap == 0) || gap > UINT32_MAX - prev) {
+        return 0;
+    }
+    *id = prev + gap;
+    return used;
+}
+
+// Parses the id lists after the header into delta's allocated arrays
+static int protocol_read_colony_delta_lists(const uint8_t* buffer, size_t len, ProtoColonyDelta* delta) {
+    size_t offset = COLONY_DELTA_HEADER_SIZE;
+    uint32_t prev = 0;
+    for (uint32_t i = 0; i < delta->removed_count; i++) {
+        size_t used = proto_read_colony_id(buffer + offset, len - offset, i, prev, &delta->removed[i]);
+        if (used == 0) return -1;
+        offset += used;
+        prev = delta->removed[i];
+    }
+    prev = 0;
+    for (uint32_t i = 0; i < delta->descriptor_count; i++) {
+        ProtoColonyDescriptor* descriptor = &delta->descriptors[i];
+        size_t used = proto_read_colony_id(buffer + offset, len - offset, i, prev, &descriptor->id);
+        if (used == 0 || len - offset - used < 1) return -1;
+        offset += used;
+        size_t name_length = buffer[offset++];
+        if (name_length > MAX_COLONY_NAME || len - offset < name_length + 3 + 4) return -1;
+        memcpy(descriptor->name, buffer + offset, name_length);
+        offset += name_length;
+        descriptor->color_r = buffer[offset++];
+        descriptor->color_g = buffer[offset++];
+        descriptor->color_b = buffer[offset++];
+        descriptor->shape_seed = read_u32(buffer + offset);
+        offset += 4;
+        prev = descriptor->id;
+    }
+    prev = 0;
+    for (uint32_t i = 0; i < delta->dynamic_count; i++) {
+        ProtoColonyDynamic* dynamic = &delta->dynamics[i];
+        size_t used = proto_read_colony_id(buffer + offset, len - offset, i, prev, &dynamic->id);
+        if (used == 0 || len - offset - used < 1 + 6) return -1;
+        offset += used;
+        dynamic->alive = (buffer[offset++] & 1u) != 0;
+        dynamic->x = read_u16(buffer + offset);
+        dynamic->y = read_u16(buffer + offset + 2);
+        dynamic->radius = read_u16(buffer + offset + 4);
+        offset += 6;
+        used = protocol_read_varint(buffer + offset, len - offset, &dynamic->population);
+        if (used == 0) return -1;
+        offset += used;
+        used = protocol_read_varint(buffer + offset, len - offset, &dynamic->max_population);
+        if (used == 0 || len - offset - used < 2 + 1 + 2) return -1;
+        offset += used;
+        dynamic->growth_rate = (int16_t)read_u16(buffer + offset);
+        offset += 2;
+        dynamic->wobble_phase = buffer[offset++];
+        dynamic->shape_evolution = read_u16(buffer + offset);
+        offset += 2;
+        prev = dynamic->id;
+    }
+    return offset == len ? 0 : -1;
+}
+
+int protocol_deserialize_colony_delta(const uint8_t* buffer, size_t len, ProtoColonyDelta* delta) {
+    if (!buffer || !delta) return -1;
+    proto_colony_delta_init(delta);
+    if (len < COLONY_DELTA_HEADER_SIZE) return -1;
+
+    delta->tick = read_u32(buffer);
+    delta->base_tick = read_u32(buffer + 4);
+    uint8_t flags = buffer[8];
+    delta->full = (flags & COLONY_DELTA_FLAG_FULL) != 0;
+    delta->total_count = read_u32(buffer + 9);
+    uint32_t removed_count = read_u32(buffer + 13);
+    uint32_t descriptor_count = read_u32(buffer + 17);
+    uint32_t dynamic_count = read_u32(buffer + 21);
+    // Reject counts the payload cannot hold before allocating for them
+    size_t body = len - COLONY_DELTA_HEADER_SIZE;
+    if ((flags & ~COLONY_DELTA_FLAG_FULL) != 0 ||
+        (uint64_t)removed_count + (uint64_t)descriptor_count * COLONY_DESCRIPTOR_MIN_SIZE +
+        (uint64_t)dynamic_count * COLONY_DYNAMIC_MIN_SIZE > body) {
+        return -1;
+    }
+
+    if ((removed_count > 0 &&
+         !(delta->removed = (uint32_t*)malloc((size_t)removed_count * sizeof(uint32_t)))) ||
+        (descriptor_count > 0 &&
+         !(delta->descriptors = (ProtoColonyDescriptor*)calloc(descriptor_count, sizeof(ProtoColonyDescriptor)))) ||
+        (dynamic_count > 0 &&
+         !(delta->dynamics = (ProtoColonyDynamic*)calloc(dynamic_count, sizeof(ProtoColonyDynamic))))) {
+        proto_colony_delta_free(delta);
+        return -1;
+    }
+    delta->removed_count = removed_count;
+    delta->descriptor_count = descriptor_count;
+    delta->dynamic_count = dynamic_count;
+
+    if (protocol_read_colony_delta_lists(buffer, len, delta) < 0) {
+        proto_colony_delta_free(delta);
+        return -1;
+    }
+    return 0;
+}
+
+int protocol_serialize_command_status(const ProtoCommandStatus* status, uint8_t* buffer) {
+    if (!status || !buffer) return -1;
+
+    int offset = 0;
+    write_u32(buffer + offset, status->command);
+    offset += 4;
+    write_u32(buffer + offset, status->status_code);
+    offset += 4;
+    write_u32(buffer + offset, status->entity_id);
+    offset += 4;
+    memcpy(buffer + offset, status->message, COMMAND_STATUS_MESSAGE_SIZE);
+    offset += COMMAND_STATUS_MESSAGE_SIZE;
+    return offset;
+}
+
+int protocol_deserialize_command_status(const uint8_t* buffer, ProtoCommandStatus* status) {
+    if (!buffer || !status) return -1;
+
+    int offset = 0;
+    status->command = read_u32(buffer + offset);
+    offset += 4;
+    status->status_code = read_u32(buffer + offset);
+    offset += 4;
+    status->entity_id = read_u32(buffer + offset);
+    offset += 4;
+    memcpy(status->message, buffer + offset, COMMAND_STATUS_MESSAGE_SIZE);
+    status->message[COMMAND_STATUS_MESSAGE_SIZE - 1] = '\0';
+    offset += COMMAND_STATUS_MESSAGE_SIZE;
+    return offset;
+}
+
+int protocol_serialize_command(CommandType cmd, const void* data, uint8_t* buffer) {
+    if (!buffer) return -1;
+    
+    int offset = 0;
+    
+    write_u32(buffer + offset, (uint32_t)cmd);
+    offset += 4;
+    
+    switch (cmd) {
+        case CMD_SELECT_COLONY:
+            if (data) {
+                const CommandSelectColony* sel = (const CommandSelectColony*)data;
+                write_u32(buffer + offset, sel->colony_id);
+                offset += 4;
+            }
+            break;
+            
+        case CMD_SPAWN_COLONY:
+            if (data) {
+                const CommandSpawnColony* spawn = (const CommandSpawnColony*)data;
+                write_float(buffer + offset, spawn->x);
+                offset += 4;
+                write_float(buffer + offset, spawn->y);
+                offset += 4;
+                memcpy(buffer + offset, spawn->name, MAX_COLONY_NAME);
+                offset += MAX_COLONY_NAME;
+            }
+            break;
+            
+        case CMD_SET_VIEWPORT:
+            if (data) {
+                const CommandSetViewport* view = (const CommandSetViewport*)data;
+                write_u32(buffer + offset, view->x);
+                write_u32(buffer + offset + 4, view->y);
+                write_u32(buffer + offset + 8, view->width);
+                write_u32(buffer + offset + 12, view->height);
+                write_u32(buffer + offset + 16, view->level);
+                offset += 20;
+            }
+            break;
             
         case CMD_PAUSE:
         case CMD_RESUME:
@@ -767,6 +1750,18 @@ int protocol_deserialize_command(const uint8_t* buffer, CommandType* cmd, void*
             }
             break;
             
+        case CMD_SET_VIEWPORT:
+            if (data) {
+                CommandSetViewport* view = (CommandSetViewport*)data;
+                view->x = read_u32(buffer + offset);
+                view->y = read_u32(buffer + offset + 4);
+                view->width = read_u32(buffer + offset + 8);
+                view->height = read_u32(buffer + offset + 12);
+                view->level = read_u32(buffer + offset + 16);
+                offset += 20;
+            }
+            break;
+            
         case CMD_PAUSE:
         case CMD_RESUME:
         case CMD_SPEED_UP:
@@ -779,16 +1774,33 @@ int protocol_deserialize_command(const uint8_t* buffer, CommandType* cmd, void*
     return offset;
 }
 
-// Send all bytes, handling partial sends
-static int send_all(int socket, const uint8_t* data, size_t len) {
-    size_t sent = 0;
-    while (sent < len) {
-        ssize_t n = send(socket, data + sent, len - sent, 0);
+// Send every byte described by iov with as few sendmsg calls as the socket allows.
+// The iovec array is consumed in place.
+static int send_iov_all(int socket, struct iovec* iov, int iov_count) {
+    while (iov_count > 0 && iov->iov_len == 0) {
+        iov++;
+        iov_count--;
+    }
+    while (iov_count > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iov_count;
+        ssize_t n = sendmsg(socket, &msg, 0);
         if (n <= 0) {
             if (n < 0 && errno == EINTR) continue;
             return -1;
         }
-        sent += n;
+        size_t sent = (size_t)n;
+        while (iov_count > 0 && sent >= iov->iov_len) {
+            sent -= iov->iov_len;
+            iov++;
+            iov_count--;
+        }
+        if (iov_count > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + sent;
+            iov->iov_len -= sent;
+        }
     }
     return 0;
 }
@@ -807,14 +1819,15 @@ static int recv_all(int socket, uint8_t* buffer, size_t len) {
     return 0;
 }
 
+// Shared by direct sends and frames so sequence numbers stay unique per process
+static atomic_uint protocol_sequence = 0;
+
 int protocol_send_message(int socket, MessageType type, const uint8_t* payload, size_t len) {
-    static uint32_t sequence = 0;
-    
     MessageHeader header = {
         .magic = PROTOCOL_MAGIC,
         .type = type,
         .payload_len = (uint32_t)len,
-        .sequence = sequence++
+        .sequence = atomic_fetch_add_explicit(&protocol_sequence, 1u, memory_order_relaxed)
     };
     
     uint8_t header_buf[MESSAGE_HEADER_SIZE];
@@ -822,17 +1835,13 @@ int protocol_send_message(int socket, MessageType type, const uint8_t* payload,
         return -1;
     }
     
-    if (send_all(socket, header_buf, MESSAGE_HEADER_SIZE) < 0) {
-        return -1;
-    }
-    
-    if (len > 0 && payload) {
-        if (send_all(socket, payload, len) < 0) {
-            return -1;
-        }
-    }
-    
-    return 0;
+    // Header and payload leave in one sendmsg
+    struct iovec iov[2];
+    iov[0].iov_base = header_buf;
+    iov[0].iov_len = MESSAGE_HEADER_SIZE;
+    iov[1].iov_base = (void*)payload;
+    iov[1].iov_len = (len > 0 && payload) ? len : 0;
+    return send_iov_all(socket, iov, 2);
 }
 
 int protocol_recv_message(int socket, MessageHeader* header, uint8_t** payload) {
@@ -865,10 +1874,157 @@ int protocol_recv_message(int socket, MessageHeader* header, uint8_t** payload)
     } else if (payload) {
         *payload = NULL;
     }
+
+    if (payload && (header->type & MSG_FLAG_COMPRESSED) && protocol_unpack_payload(header, payload) < 0) {
+        free(*payload);
+        *payload = NULL;
+        return -1;
+    }
     
     return 0;
 }
 
+int protocol_unpack_payload(MessageHeader* header, uint8_t** payload) {
+    if (!header || !payload) return -1;
+    if (!(header->type & MSG_FLAG_COMPRESSED)) {
+        return 0;
+    }
+    if (!*payload || header->payload_len < 4) {
+        return -1;
+    }
+
+    uint32_t raw_len = read_u32(*payload);
+    if (raw_len == 0 || raw_len > MAX_PAYLOAD_SIZE) {
+        return -1;
+    }
+    uint8_t* raw = (uint8_t*)malloc(raw_len);
+    if (!raw) {
+        return -1;
+    }
+    if (lz_decompress(*payload + 4, header->payload_len - 4, raw, raw_len) < 0) {
+        free(raw);
+        return -1;
+    }
+
+    free(*payload);
+    *payload = raw;
+    header->type &= (uint16_t)~MSG_FLAG_COMPRESSED;
+    header->payload_len = raw_len;
+    return 0;
+}
+
+ProtoFrame* proto_frame_create(MessageType type, uint8_t* payload, size_t len) {
+    if (len > MAX_PAYLOAD_SIZE || (len > 0 && !payload)) {
+        free(payload);
+        return NULL;
+    }
+
+    ProtoFrame* frame = (ProtoFrame*)malloc(sizeof(ProtoFrame));
+    if (!frame) {
+        free(payload);
+        return NULL;
+    }
+
+    MessageHeader header = {
+        .magic = PROTOCOL_MAGIC,
+        .type = type,
+        .payload_len = (uint32_t)len,
+        .sequence = atomic_fetch_add_explicit(&protocol_sequence, 1u, memory_order_relaxed)
+    };
+    protocol_serialize_header(&header, frame->header);
+    atomic_init(&frame->refcount, 1);
+    frame->type = type;
+    frame->payload = len > 0 ? payload : NULL;
+    frame->payload_len = len;
+    frame->compressed = NULL;
+    frame->compress_tried = false;
+    if (len == 0) {
+        free(payload);
+    }
+    return frame;
+}
+
+ProtoFrame* proto_frame_copy(MessageType type, const uint8_t* payload, size_t len) {
+    uint8_t* owned = NULL;
+    if (len > 0) {
+        if (!payload || len > MAX_PAYLOAD_SIZE) {
+            return NULL;
+        }
+        owned = (uint8_t*)malloc(len);
+        if (!owned) {
+            return NULL;
+        }
+        memcpy(owned, payload, len);
+    }
+    return proto_frame_create(type, owned, len);
+}
+
+ProtoFrame* proto_frame_retain(ProtoFrame* frame) {
+    if (frame) {
+        atomic_fetch_add_explicit(&frame->refcount, 1, memory_order_relaxed);
+    }
+    return frame;
+}
+
+void proto_frame_release(ProtoFrame* frame) {
+    if (!frame) return;
+    if (atomic_fetch_sub_explicit(&frame->refcount, 1, memory_order_acq_rel) == 1) {
+        proto_frame_release(frame->compressed);
+        free(frame->payload);
+        free(frame);
+    }
+}
+
+ProtoFrame* proto_frame_compressed(ProtoFrame* frame, size_t min_bytes) {
+    if (!frame) return NULL;
+    if (frame->compress_tried) {
+        return frame->compressed ? frame->compressed : frame;
+    }
+    frame->compress_tried = true;
+    if (frame->payload_len < min_bytes || frame->payload_len <= 4) {
+        return frame;
+    }
+
+    // Only worth sending if it saves more than the length prefix
+    size_t capacity = frame->payload_len - 1;
+    uint8_t* packed = (uint8_t*)malloc(capacity);
+    if (!packed) {
+        return frame;
+    }
+    size_t packed_len = lz_compress(frame->payload, frame->payload_len, packed + 4, capacity - 4);
+    if (packed_len == 0) {
+        free(packed);
+        return frame;
+    }
+    write_u32(packed, (uint32_t)frame->payload_len);
+
+    ProtoFrame* twin = proto_frame_create(frame->type, packed, packed_len + 4);
+    if (!twin) {
+        return frame;
+    }
+    // Same sequence as the original; only the type flag and length differ
+    memcpy(twin->header + 10, frame->header + 10, 4);
+    write_u16(twin->header + 4, (uint16_t)(frame->type | MSG_FLAG_COMPRESSED));
+    twin->compress_tried = true;
+    frame->compressed = twin;
+    return twin;
+}
+
+size_t proto_frame_wire_size(const ProtoFrame* frame) {
+    return frame ? MESSAGE_HEADER_SIZE + frame->payload_len : 0;
+}
+
+int protocol_send_frame(int socket, const ProtoFrame* frame) {
+    if (!frame) return -1;
+
+    struct iovec iov[2];
+    iov[0].iov_base = (void*)frame->header;
+    iov[0].iov_len = MESSAGE_HEADER_SIZE;
+    iov[1].iov_base = frame->payload;
+    iov[1].iov_len = frame->payload_len;
+    return send_iov_all(socket, iov, 2);
+}
+
 // ProtoWorld grid memory management
 void proto_world_init(ProtoWorld* world) {
     if (!world) return;
@@ -886,6 +2042,21 @@ void proto_world_free(ProtoWorld* world) {
     }
     world->grid_size = 0;
     world->has_grid = false;
+    world->grid_level = 0;
+    free(world->extra_colonies);
+    world->extra_colonies = NULL;
+    world->extra_colony_count = 0;
+}
+
+int proto_grid_level_for_dims(uint32_t world_width, uint32_t world_height,
+                              uint32_t grid_width, uint32_t grid_height) {
+    for (uint32_t level = 0; level <= PROTO_GRID_MAX_LEVEL; level++) {
+        if (proto_grid_level_dim(world_width, level) == grid_width &&
+            proto_grid_level_dim(world_height, level) == grid_height) {
+            return (int)level;
+        }
+    }
+    return -1;
 }
 
 void proto_world_alloc_grid(ProtoWorld* world, uint32_t width, uint32_t height) {
@@ -896,14 +2067,174 @@ void proto_world_alloc_grid(ProtoWorld* world, uint32_t width, uint32_t height)
     
     if (world->grid) free(world->grid);
     
-    world->grid = (uint16_t*)malloc(size * sizeof(uint16_t));
+    world->grid = (uint32_t*)malloc((size_t)size * sizeof(uint32_t));
     if (world->grid) {
-        memset(world->grid, 0, size * sizeof(uint16_t));
+        memset(world->grid, 0, (size_t)size * sizeof(uint32_t));
         world->grid_size = size;
         world->has_grid = true;
     }
 }
 
+int proto_world_apply_colony_page(ProtoWorld* world, const ProtoColonyPage* page) {
+    if (!world || !page || (page->count > 0 && !page->colonies)) return -1;
+    if (page->tick != world->tick || world->colony_count != MAX_COLONIES ||
+        page->start != MAX_COLONIES + world->extra_colony_count ||
+        (uint64_t)page->start + page->count > page->total_count) {
+        return 1;
+    }
+
+    ProtoColony* extra = (ProtoColony*)realloc(world->extra_colonies,
+                                               (size_t)(world->extra_colony_count + page->count) *
+                                               sizeof(ProtoColony));
+    if (!extra) {
+        return -1;
+    }
+    world->extra_colonies = extra;
+    memcpy(&world->extra_colonies[world->extra_colony_count], page->colonies,
+           (size_t)page->count * sizeof(ProtoColony));
+    world->extra_colony_count += page->count;
+    return 0;
+}
+
+// Merges the sorted table (its first `current` colonies) with the delta's
+// sorted lists into merged, which holds delta->total_count colonies
+static int proto_colony_table_merge(const ProtoWorld* world, uint32_t current,
+                                    const ProtoColonyDelta* delta, ProtoColony* merged) {
+    uint32_t count = 0;
+    uint32_t table_index = 0;
+    uint32_t removed_index = 0;
+    uint32_t descriptor_index = 0;
+    uint32_t dynamic_index = 0;
+    while (table_index < current || descriptor_index < delta->descriptor_count) {
+        const ProtoColony* existing = table_index < current ? proto_world_colony_at(world, table_index) : NULL;
+        const ProtoColonyDescriptor* descriptor = descriptor_index < delta->descriptor_count ?
+                                                  &delta->descriptors[descriptor_index] : NULL;
+        ProtoColony colony;
+        bool added = !existing || (descriptor && descriptor->id < existing->id);
+        if (added) {
+            memset(&colony, 0, sizeof(colony));
+            colony.id = descriptor->id;
+        } else {
+            colony = *existing;
+            table_index++;
+        }
+        if (count > 0 && colony.id <= merged[count - 1].id) {
+            return -1;  // Table not sorted by id
+        }
+
+        while (removed_index < delta->removed_count && delta->removed[removed_index] < colony.id) {
+            removed_index++;  // Already gone from this table
+        }
+        bool removed = removed_index < delta->removed_count && delta->removed[removed_index] == colony.id;
+        if (descriptor && descriptor->id == colony.id) {
+            if (removed) return -1;
+            proto_colony_apply_descriptor(&colony, descriptor);
+            descriptor_index++;
+        }
+        if (dynamic_index < delta->dynamic_count && delta->dynamics[dynamic_index].id < colony.id) {
+            return -1;  // Record for a colony the table does not have
+        }
+        if (dynamic_index < delta->dynamic_count && delta->dynamics[dynamic_index].id == colony.id) {
+            if (removed) return -1;
+            proto_colony_apply_dynamic(&colony, &delta->dynamics[dynamic_index]);
+            dynamic_index++;
+        } else if (added) {
+            return -1;
+        }
+        if (removed) {
+            continue;
+        }
+        if (count >= delta->total_count) return -1;
+        merged[count++] = colony;
+    }
+    return dynamic_index == delta->dynamic_count && count == delta->total_count ? 0 : -1;
+}
+
+int proto_world_apply_colony_delta(ProtoWorld* world, const ProtoColonyDelta* delta) {
+    if (!world || !delta) return -1;
+    if ((delta->removed_count > 0 && !delta->removed) ||
+        (delta->descriptor_count > 0 && !delta->descriptors) ||
+        (delta->dynamic_count > 0 && !delta->dynamics)) {
+        return -1;
+    }
+
+    uint32_t current = delta->full ? 0u : proto_world_colony_total(world);
+    if ((uint64_t)delta->total_count > (uint64_t)current + delta->descriptor_count) {
+        return -1;
+    }
+    ProtoColony* merged = NULL;
+    if (delta->total_count > 0) {
+        merged = (ProtoColony*)malloc((size_t)delta->total_count * sizeof(ProtoColony));
+        if (!merged) {
+            return -1;
+        }
+    }
+
+    if (proto_colony_table_merge(world, current, delta, merged) < 0) {
+        free(merged);
+        return -1;
+    }
+
+    uint32_t count = delta->total_count;
+    uint32_t inline_count = count < MAX_COLONIES ? count : MAX_COLONIES;
+    if (inline_count > 0) {
+        memcpy(world->colonies, merged, (size_t)inline_count * sizeof(ProtoColony));
+    }
+    free(world->extra_colonies);
+    world->extra_colonies = NULL;
+    world->colony_count = inline_count;
+    world->extra_colony_count = count - inline_count;
+    if (world->extra_colony_count > 0) {
+        memmove(merged, merged + MAX_COLONIES, (size_t)world->extra_colony_count * sizeof(ProtoColony));
+        ProtoColony* shrunk = (ProtoColony*)realloc(merged, (size_t)world->extra_colony_count * sizeof(ProtoColony));
+        world->extra_colonies = shrunk ? shrunk : merged;
+    } else {
+        free(merged);
+    }
+    return 0;
+}
+
+const ProtoColony* proto_world_colony_at(const ProtoWorld* world, uint32_t index) {
+    if (!world) return NULL;
+    if (index < world->colony_count) {
+        return &world->colonies[index];
+    }
+    index -= world->colony_count;
+    return index < world->extra_colony_count ? &world->extra_colonies[index] : NULL;
+}
+
+// Binary search, then a scan in case the table is not sorted by id
+static const ProtoColony* proto_colony_table_find(const ProtoColony* table, uint32_t count, uint32_t id) {
+    uint32_t left = 0;
+    uint32_t right = count;
+    while (left < right) {
+        uint32_t mid = left + (right - left) / 2u;
+        if (table[mid].id == id) {
+            return &table[mid];
+        }
+        if (table[mid].id < id) {
+            left = mid + 1u;
+        } else {
+            right = mid;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (table[i].id == id) {
+            return &table[i];
+        }
+    }
+    return NULL;
+}
+
+const ProtoColony* proto_world_find_colony(const ProtoWorld* world, uint32_t id) {
+    if (!world) return NULL;
+    const ProtoColony* colony = proto_colony_table_find(world->colonies, world->colony_count, id);
+    if (!colony && world->extra_colonies) {
+        colony = proto_colony_table_find(world->extra_colonies, world->extra_colony_count, id);
+    }
+    return colony;
+}
+
 void proto_world_delta_grid_chunk_init(ProtoWorldDeltaGridChunk* chunk) {
     if (!chunk) return;
     memset(chunk, 0, sizeof(*chunk));
@@ -916,14 +2247,53 @@ void proto_world_delta_grid_chunk_free(ProtoWorldDeltaGridChunk* chunk) {
     chunk->cell_count = 0;
 }
 
+void proto_world_delta_spans_init(ProtoWorldDeltaSpans* delta) {
+    if (!delta) return;
+    memset(delta, 0, sizeof(*delta));
+}
+
+void proto_world_delta_spans_free(ProtoWorldDeltaSpans* delta) {
+    if (!delta) return;
+    free(delta->spans);
+    free(delta->cells);
+    delta->spans = NULL;
+    delta->cells = NULL;
+    delta->span_count = 0;
+    delta->cell_count = 0;
+}
+
+int proto_world_delta_spans_apply(const ProtoWorldDeltaSpans* delta, uint32_t* grid, uint32_t grid_size) {
+    if (!delta || !grid) return -1;
+
+    for (uint32_t s = 0; s < delta->span_count; s++) {
+        const ProtoGridSpan* span = &delta->spans[s];
+        if ((uint64_t)span->start + span->length > grid_size) {
+            return -1;
+        }
+    }
+
+    uint32_t cell_cursor = 0;
+    for (uint32_t s = 0; s < delta->span_count; s++) {
+        const ProtoGridSpan* span = &delta->spans[s];
+        memcpy(&grid[span->start], &delta->cells[cell_cursor], (size_t)span->length * sizeof(uint32_t));
+        cell_cursor += span->length;
+    }
+    return 0;
+}
+
 // Grid compression format:
 // [uncompressed_size:uint32][mode:uint8][payload...]
 // mode 0: RLE payload as [count:uint16][value:uint16] pairs
 // mode 1: Raw payload as [value:uint16] * uncompressed_size
-int protocol_serialize_grid_rle(const uint16_t* grid, uint32_t size, uint8_t** buffer, size_t* len) {
+// mode 2: [palette_count:uint16][id:uint16 * palette_count] then indices
+//         packed LSB-first at ceil(log2(palette_count)) bits per cell
+// mode 3: same palette, then [index:uint8][run:varint] pairs
+// PROTO_GRID_MODE_WIDE or'd into the mode turns every value and palette id
+// above into a varint.
+int protocol_serialize_grid_rle(const uint32_t* grid, uint32_t size, uint8_t** buffer, size_t* len) {
     if (!grid || !buffer || !len || size == 0) return -1;
 
-    size_t max_useful_size = protocol_grid_rle_max_useful_size(size);
+    size_t max_useful_size = protocol_grid_rle_max_useful_size(size, protocol_grid_is_wide(grid, size));
     *buffer = (uint8_t*)malloc(max_useful_size);
     if (!*buffer) return -1;
 
@@ -936,10 +2306,73 @@ int protocol_serialize_grid_rle(const uint16_t* grid, uint32_t size, uint8_t** b
     return 0;
 }
 
-int protocol_deserialize_grid_rle(const uint8_t* buffer, size_t len, uint16_t* grid, uint32_t max_size) {
+static int protocol_decode_grid_palette(const uint8_t* buffer, size_t len, uint8_t mode, bool wide,
+                                        uint32_t* grid, uint32_t size) {
+    if (len < 2) return -1;
+    uint32_t palette_count = read_u16(buffer);
+    size_t offset = 2;
+    if (palette_count == 0 || palette_count > PROTO_GRID_PALETTE_MAX) {
+        return -1;
+    }
+    uint32_t ids[PROTO_GRID_PALETTE_MAX];
+    for (uint32_t i = 0; i < palette_count; i++) {
+        size_t used = protocol_read_grid_id(buffer + offset, len - offset, wide, &ids[i]);
+        if (used == 0) {
+            return -1;
+        }
+        offset += used;
+    }
+
+    if (mode == PROTO_GRID_MODE_PALETTE_RLE) {
+        uint32_t cells = 0;
+        while (cells < size) {
+            if (offset >= len) return -1;
+            uint32_t index = buffer[offset++];
+            uint32_t run = 0;
+            size_t used = protocol_read_varint(buffer + offset, len - offset, &run);
+            if (used == 0 || index >= palette_count || run == 0 || run > size - cells) {
+                return -1;
+            }
+            offset += used;
+            protocol_fill_cells(grid + cells, ids[index], run);
+            cells += run;
+        }
+        return 0;
+    }
+
+    uint32_t bits = protocol_grid_palette_bits(palette_count);
+    if (bits == 0) {
+        protocol_fill_cells(grid, ids[0], size);
+        return 0;
+    }
+    if (offset + ((size_t)size * bits + 7u) / 8u > len) {
+        return -1;
+    }
+
+    // Indices past palette_count are possible for non-power-of-two palettes
+    uint64_t mask = (1u << bits) - 1u;
+    for (uint32_t i = 0; i < size; i += 8) {
+        uint32_t group = size - i < 8u ? size - i : 8u;
+        size_t group_bytes = ((size_t)group * bits + 7u) / 8u;
+        uint64_t packed = 0;
+        for (size_t b = 0; b < group_bytes; b++) {
+            packed |= (uint64_t)buffer[offset++] << (8 * b);
+        }
+        for (uint32_t k = 0; k < group; k++) {
+            uint32_t index = (uint32_t)((packed >> (k * bits)) & mask);
+            if (index >= palette_count) {
+                return -1;
+            }
+            grid[i + k] = ids[index];
+        }
+    }
+    return 0;
+}
+
+int protocol_deserialize_grid_rle(const uint8_t* buffer, size_t len, uint32_t* grid, uint32_t max_size) {
     if (!buffer || !grid || len < 5) return -1;
     
-    int offset = 0;
+    size_t offset = 0;
     
     // Read uncompressed size
     uint32_t total_size = read_u32(buffer + offset);
@@ -948,52 +2381,62 @@ int protocol_deserialize_grid_rle(const uint8_t* buffer, size_t len, uint16_t* g
     if (total_size > max_size) return -1;
 
     uint8_t mode = buffer[offset++];
+    bool wide = (mode & PROTO_GRID_MODE_WIDE) != 0;
+    mode &= (uint8_t)~PROTO_GRID_MODE_WIDE;
 
-    if (mode == 1) {
-        if ((size_t)offset + ((size_t)total_size * 2) > len) {
+    if (mode == PROTO_GRID_MODE_RAW) {
+        if (!wide && offset + ((size_t)total_size * 2) > len) {
             return -1;
         }
 
-        for (uint32_t i = 0; i < total_size; i++) {
-            grid[i] = read_u16(buffer + offset);
-            offset += 2;
+        if (!wide) {
+            protocol_load_cells_u16(grid, buffer + offset, total_size);
+        } else {
+            for (uint32_t i = 0; i < total_size; i++) {
+                size_t used = protocol_read_varint(buffer + offset, len - offset, &grid[i]);
+                if (used == 0) {
+                    return -1;
+                }
+                offset += used;
+            }
         }
 
-        for (uint32_t i = total_size; i < max_size; i++) {
-            grid[i] = 0;
-        }
+        protocol_fill_cells(grid + total_size, 0, max_size - total_size);
+        return 0;
+    }
 
+    if (mode == PROTO_GRID_MODE_PALETTE || mode == PROTO_GRID_MODE_PALETTE_RLE) {
+        if (protocol_decode_grid_palette(buffer + offset, len - offset, mode, wide, grid, total_size) < 0) {
+            return -1;
+        }
+        protocol_fill_cells(grid + total_size, 0, max_size - total_size);
         return 0;
     }
 
-    if (mode != 0) {
+    if (mode != PROTO_GRID_MODE_RLE) {
         return -1;
     }
     
     uint32_t cells_written = 0;
     
-    while (offset + 4 <= (int)len && cells_written < total_size) {
+    while (offset + (wide ? 3u : 4u) <= len && cells_written < total_size) {
         uint16_t count = read_u16(buffer + offset);
         offset += 2;
-        uint16_t value = read_u16(buffer + offset);
-        offset += 2;
+        uint32_t value = 0;
+        size_t used = protocol_read_grid_id(buffer + offset, len - offset, wide, &value);
+        if (used == 0) break;
+        offset += used;
         
         if (count == 0) break;  // End marker
         
         // Write 'count' copies of 'value'
-        for (uint16_t j = 0; j < count && cells_written < total_size; j++) {
-            grid[cells_written++] = value;
-        }
+        uint32_t run = count < total_size - cells_written ? count : total_size - cells_written;
+        protocol_fill_cells(grid + cells_written, value, run);
+        cells_written += run;
     }
     
-    // Fill remaining with 0 if needed
-    while (cells_written < total_size) {
-        grid[cells_written++] = 0;
-    }
-
-    for (uint32_t i = total_size; i < max_size; i++) {
-        grid[i] = 0;
-    }
+    // Fill remaining (and everything past total_size) with 0
+    protocol_fill_cells(grid + cells_written, 0, max_size - cells_written);
 
     return 0;
 }
@@ -4,9 +4,10 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 
 #define PROTOCOL_MAGIC 0xBACF
-#define PROTOCOL_VERSION 1  // Current documented wire generation; not serialized in headers yet.
+#define PROTOCOL_VERSION 2  // Exchanged in MSG_CONNECT / MSG_CONNECT_ACK; peers that omit it are version 1
 #define MAX_COLONY_NAME 32
 #define MAX_COLONIES 256
 #define MAX_PAYLOAD_SIZE (1024 * 1024)  // 1MB max payload
@@ -64,7 +65,10 @@ typedef enum MessageType {
     MSG_COLONY_INFO,    // Server -> Client: detailed colony info
     MSG_COMMAND,        // Client -> Server: user command
     MSG_ACK,            // Acknowledgment
-    MSG_ERROR           // Error response
+    MSG_ERROR,          // Error response
+    MSG_COLONY_PAGE,    // Server -> Client: colony table entries past MAX_COLONIES
+    MSG_COLONY_DELTA,   // Server -> Client: colony table changes since a base tick
+    MSG_CONNECT_ACK     // Server -> Client: negotiated version and capabilities
 } MessageType;
 
 // Command types
@@ -75,13 +79,14 @@ typedef enum CommandType {
     CMD_SLOW_DOWN,
     CMD_RESET,
     CMD_SELECT_COLONY,  // Select colony for detailed view
-    CMD_SPAWN_COLONY    // Manually spawn a colony at position
+    CMD_SPAWN_COLONY,   // Manually spawn a colony at position
+    CMD_SET_VIEWPORT    // Limit grid updates to a world rectangle
 } CommandType;
 
 // Message header (14 bytes on the wire)
 typedef struct MessageHeader {
     uint32_t magic;      // 0xBACF (bacteria ferox)
-    uint16_t type;       // MessageType
+    uint16_t type;       // MessageType, plus MSG_FLAG_COMPRESSED
     uint32_t payload_len;
     uint32_t sequence;   // For ordering
 } MessageHeader;
@@ -166,16 +171,57 @@ typedef struct ProtoColonyDetail {
 
 // Grid cell for transmission (just colony ownership)
 typedef struct ProtoCell {
-    uint16_t colony_id;  // 0 = empty
+    uint32_t colony_id;  // 0 = empty
 } ProtoCell;
 
 // Maximum client-side grid size supported for chunked assembly
-#define MAX_GRID_SIZE (1024 * 1024)  // 1,048,576 cells max
+#define MAX_GRID_SIZE (8192 * 8192)  // 67,108,864 cells max
+// Grids past this many cells only go to clients with PROTO_CAP_LARGE_GRID
+#define PROTO_LEGACY_MAX_GRID_SIZE (1024 * 1024)
+
+// Bytes an id takes in the wide (varint) grid encodings
+static inline size_t proto_grid_id_varint_size(uint32_t id) {
+    return id < (1u << 7) ? 1u : id < (1u << 14) ? 2u : id < (1u << 21) ? 3u : id < (1u << 28) ? 4u : 5u;
+}
+
+// Grid pyramid: level L halves each axis L times, one cell per 2^L x 2^L block
+// holding the block's majority colony. Grid messages for level L carry the
+// level's width and height, which is how receivers tell the level apart.
+#define PROTO_GRID_MAX_LEVEL 6
+
+static inline uint32_t proto_grid_level_dim(uint32_t cells, uint32_t level) {
+    return (uint32_t)(((uint64_t)cells + (1u << level) - 1u) >> level);
+}
+
+/**
+ * Find the pyramid level whose dimensions are grid_width x grid_height.
+ * @return level in [0, PROTO_GRID_MAX_LEVEL], or -1 if none matches
+ */
+int proto_grid_level_for_dims(uint32_t world_width, uint32_t world_height,
+                              uint32_t grid_width, uint32_t grid_height);
 
 typedef enum ProtoWorldDeltaKind {
-    PROTO_WORLD_DELTA_GRID_CHUNK = 1,
+    PROTO_WORLD_DELTA_GRID_CHUNK = 1,   // Keyframe piece: raw cells [start, start + count)
+    PROTO_WORLD_DELTA_GRID_SPANS = 2,   // Changed cells since base_tick as (start, length, ids) runs
+    PROTO_WORLD_DELTA_GRID_CHUNK_PACKED = 3,  // Keyframe piece: cells as a grid codec blob
+    PROTO_WORLD_DELTA_GRID_SPANS_WIDE = 4,    // Kind 2 with ids as varints (some id > 65535)
 } ProtoWorldDeltaKind;
 
+// Grid codec modes ([uncompressed_size:uint32][mode:uint8][payload])
+typedef enum ProtoGridMode {
+    PROTO_GRID_MODE_RLE = 0,          // [count:uint16][value:uint16] pairs
+    PROTO_GRID_MODE_RAW = 1,          // [value:uint16] per cell
+    PROTO_GRID_MODE_PALETTE = 2,      // Palette, then indices bit-packed at ceil(log2(palette)) bits
+    PROTO_GRID_MODE_PALETTE_RLE = 3,  // Palette, then [index:uint8][run:varint] pairs
+} ProtoGridMode;
+
+// Mode bit: every id (values, palette entries) is a varint instead of a
+// uint16. Encoders set it only when some id does not fit 16 bits.
+#define PROTO_GRID_MODE_WIDE 0x80u
+
+#define PROTO_GRID_PALETTE_MAX 256u
+
+// Serialized as kind 3 when the grid codec beats raw cells, otherwise kind 1.
 typedef struct ProtoWorldDeltaGridChunk {
     uint32_t tick;
     uint32_t width;
@@ -184,9 +230,65 @@ typedef struct ProtoWorldDeltaGridChunk {
     uint32_t start_index;
     uint32_t cell_count;
     bool final_chunk;
-    uint16_t* cells;
+    uint32_t* cells;
 } ProtoWorldDeltaGridChunk;
 
+typedef struct ProtoGridSpan {
+    uint32_t start;
+    uint16_t length;
+} ProtoGridSpan;
+
+#define GRID_SPAN_HEADER_SIZE 6             // start(4) + length(2)
+#define WORLD_DELTA_SPANS_HEADER_SIZE 25    // kind(1) + 6 * uint32
+
+// Incremental grid update. Applying it to a grid that reflects any tick in
+// [base_tick, tick] yields the grid at `tick`; cells[] holds the ids of all
+// spans back to back, in span order. Serialized as kind 4 only when an id
+// needs more than 16 bits.
+typedef struct ProtoWorldDeltaSpans {
+    uint32_t tick;
+    uint32_t base_tick;
+    uint32_t width;
+    uint32_t height;
+    uint32_t span_count;
+    uint32_t cell_count;
+    ProtoGridSpan* spans;
+    uint32_t* cells;
+} ProtoWorldDeltaSpans;
+
+// Client -> Server MSG_ACK payload: the newest tick whose grid was fully applied.
+typedef struct ProtoWorldAck {
+    uint32_t tick;
+} ProtoWorldAck;
+
+#define WORLD_ACK_SERIALIZED_SIZE 4
+
+// Client -> Server MSG_CONNECT payload, echoed as MSG_CONNECT_ACK with the
+// negotiated set. Version 1 clients send only the capabilities, or nothing.
+#define PROTO_CAP_COMPRESSION 0x1u   // Client accepts MSG_FLAG_COMPRESSED frames
+#define PROTO_CAP_WIDE_IDS 0x2u      // Client decodes PROTO_GRID_MODE_WIDE and kind 4 spans
+#define PROTO_CAP_COLONY_PAGES 0x4u  // Client accepts MSG_COLONY_PAGE
+#define PROTO_CAP_LARGE_GRID 0x8u    // Client assembles grids up to MAX_GRID_SIZE cells
+#define PROTO_CAP_COLONY_DELTA 0x10u // Client keeps its colony table from MSG_COLONY_DELTA
+#define PROTO_CAP_SPAN_DELTA 0x20u   // Client applies span deltas and acks grids with MSG_ACK
+#define PROTO_CAP_VIEWPORT 0x40u     // Client subscribes to a viewport with CMD_SET_VIEWPORT
+#define PROTO_CAP_SHARED_WORLD 0x80u // Client reads world frames from the server's shm segment
+#define PROTO_CAP_ALL 0xFFu
+// Version 1 clients got span deltas and viewports without asking
+#define PROTO_CAP_LEGACY_DEFAULT (PROTO_CAP_SPAN_DELTA | PROTO_CAP_VIEWPORT)
+
+typedef struct ProtoConnect {
+    uint32_t capabilities;
+    uint32_t version;        // 1 when the payload carries no version
+} ProtoConnect;
+
+#define CONNECT_SERIALIZED_SIZE 8
+#define CONNECT_LEGACY_SERIALIZED_SIZE 4
+
+// Header type bit: payload is [raw_len:uint32][LZ block] (see lz.h)
+#define MSG_FLAG_COMPRESSED 0x8000u
+#define PROTO_COMPRESS_DEFAULT_MIN_BYTES 512
+
 // World data structure for serialization (prefixed to avoid conflict with types.h)
 typedef struct ProtoWorld {
     uint32_t width;
@@ -194,15 +296,84 @@ typedef struct ProtoWorld {
     uint32_t tick;
     uint32_t colony_count;
     ProtoColony colonies[MAX_COLONIES];
+    ProtoColony* extra_colonies;   // Table entries past MAX_COLONIES (MSG_COLONY_PAGE); owned
+    uint32_t extra_colony_count;
     bool paused;
     float speed_multiplier;
     
     // Grid data - actual cell ownership
-    uint16_t* grid;           // Dynamically allocated [width * height]
-    uint32_t grid_size;       // width * height
+    uint32_t* grid;           // Dynamically allocated, row-major at grid_level
+    uint32_t grid_size;       // Cells at grid_level (width * height at level 0)
     bool has_grid;            // Whether grid data is included
+    uint32_t grid_level;      // Pyramid level of grid (see proto_grid_level_dim)
 } ProtoWorld;
 
+// Server -> Client MSG_COLONY_PAGE payload: colony table entries that do not
+// fit the MAX_COLONIES carried in MSG_WORLD_STATE. Pages follow the state of
+// the same tick in table order.
+// [tick][total_count][start][count] (uint32 each), then count colonies
+typedef struct ProtoColonyPage {
+    uint32_t tick;
+    uint32_t total_count;  // Whole table, including the MSG_WORLD_STATE part
+    uint32_t start;        // Table index of colonies[0]; >= MAX_COLONIES
+    uint32_t count;        // At most PROTO_COLONY_PAGE_SIZE
+    ProtoColony* colonies;
+} ProtoColonyPage;
+
+#define PROTO_COLONY_PAGE_SIZE MAX_COLONIES
+#define COLONY_PAGE_HEADER_SIZE 16
+
+// Colony fields that are set at birth and almost never change
+typedef struct ProtoColonyDescriptor {
+    uint32_t id;
+    char name[MAX_COLONY_NAME];
+    uint8_t color_r, color_g, color_b;
+    uint32_t shape_seed;
+} ProtoColonyDescriptor;
+
+// Per-tick colony fields, quantized; only changes of the quantized values
+// are sent.
+#define PROTO_COLONY_POS_SCALE 4.0f          // x, y, radius in 1/4 cells
+#define PROTO_COLONY_RATE_SCALE 4096.0f      // growth_rate fixed point
+#define PROTO_COLONY_EVOLUTION_SCALE 512.0f  // shape_evolution fixed point
+typedef struct ProtoColonyDynamic {
+    uint32_t id;
+    bool alive;
+    uint16_t x, y;
+    uint16_t radius;
+    uint32_t population;
+    uint32_t max_population;
+    int16_t growth_rate;
+    uint8_t wobble_phase;       // 1/256 turn
+    uint16_t shape_evolution;
+} ProtoColonyDynamic;
+
+// Server -> Client MSG_COLONY_DELTA payload: the colony table as changes
+// since base_tick, or the whole table when full is set. Like span deltas,
+// records carry values at tick, so a delta applies to any table in
+// [base_tick, tick]. Every list is sorted by id and ids are written as
+// varint gaps from the previous entry.
+// [tick][base_tick][flags:uint8][total_count][removed_count][descriptor_count][dynamic_count]
+// removed:     [id gap]
+// descriptors: [id gap][name_len:uint8][name][r][g][b][shape_seed:uint32]
+// dynamics:    [id gap][flags:uint8][x][y][radius] (uint16), [population][max_population] (varint),
+//              [growth_rate:int16][wobble_phase:uint8][shape_evolution:uint16]
+typedef struct ProtoColonyDelta {
+    uint32_t tick;
+    uint32_t base_tick;
+    bool full;                  // Replaces the table; base_tick is ignored
+    uint32_t total_count;       // Colonies in the table once applied
+    uint32_t removed_count;
+    uint32_t descriptor_count;
+    uint32_t dynamic_count;
+    uint32_t* removed;                   // Ids that left the table
+    ProtoColonyDescriptor* descriptors;  // New colonies and changed descriptors
+    ProtoColonyDynamic* dynamics;        // New colonies and changed dynamic records
+} ProtoColonyDelta;
+
+#define COLONY_DELTA_HEADER_SIZE 25
+#define COLONY_DELTA_FLAG_FULL 0x01u
+
 typedef ProtoWorld proto_world;
 typedef ProtoColony proto_colony;
 typedef ProtoWorldDeltaGridChunk proto_world_delta_grid_chunk;
@@ -217,6 +388,14 @@ typedef struct CommandSpawnColony {
     char name[MAX_COLONY_NAME];
 } CommandSpawnColony;
 
+// Cell rectangle the client displays; width or height 0 subscribes to the whole grid.
+// level picks the grid pyramid level (0 = full resolution) for zoomed-out views.
+typedef struct CommandSetViewport {
+    uint32_t x, y;
+    uint32_t width, height;
+    uint32_t level;
+} CommandSetViewport;
+
 #define COMMAND_STATUS_MESSAGE_SIZE 64
 
 typedef enum ProtoCommandStatusCode {
@@ -244,6 +423,37 @@ int protocol_serialize_world_state(const ProtoWorld* world, uint8_t** buffer, si
 int protocol_deserialize_world_state(const uint8_t* buffer, size_t len, ProtoWorld* world);
 int protocol_serialize_world_delta_grid_chunk(const ProtoWorldDeltaGridChunk* chunk, uint8_t** buffer, size_t* len);
 int protocol_deserialize_world_delta_grid_chunk(const uint8_t* buffer, size_t len, ProtoWorldDeltaGridChunk* chunk);
+int protocol_serialize_world_delta_spans(const ProtoWorldDeltaSpans* delta, uint8_t** buffer, size_t* len);
+int protocol_deserialize_world_delta_spans(const uint8_t* buffer, size_t len, ProtoWorldDeltaSpans* delta);
+size_t protocol_world_delta_spans_size(uint32_t span_count, uint32_t cell_count);
+int protocol_serialize_world_ack(const ProtoWorldAck* ack, uint8_t* buffer);
+int protocol_deserialize_world_ack(const uint8_t* buffer, size_t len, ProtoWorldAck* ack);
+int protocol_serialize_connect(const ProtoConnect* connect, uint8_t* buffer);
+int protocol_deserialize_connect(const uint8_t* buffer, size_t len, ProtoConnect* connect);
+
+/**
+ * Settle what a session uses: the lower of the two versions, and the offered
+ * capabilities (plus PROTO_CAP_LEGACY_DEFAULT from version 1 clients) that the
+ * server supports.
+ * @param offer Client's MSG_CONNECT
+ * @param supported PROTO_CAP_* the server is willing to use
+ * @param result Output, suitable for MSG_CONNECT_ACK
+ * @return 0 on success, -1 on invalid arguments
+ */
+int protocol_negotiate_connect(const ProtoConnect* offer, uint32_t supported, ProtoConnect* result);
+int protocol_serialize_colony_page(const ProtoColonyPage* page, uint8_t** buffer, size_t* len);
+// Allocates page->colonies; free with proto_colony_page_free
+int protocol_deserialize_colony_page(const uint8_t* buffer, size_t len, ProtoColonyPage* page);
+void proto_colony_page_free(ProtoColonyPage* page);
+// @return -1 if lists are not sorted by id or the payload exceeds MAX_PAYLOAD_SIZE
+int protocol_serialize_colony_delta(const ProtoColonyDelta* delta, uint8_t** buffer, size_t* len);
+// Allocates the delta's lists; free with proto_colony_delta_free
+int protocol_deserialize_colony_delta(const uint8_t* buffer, size_t len, ProtoColonyDelta* delta);
+void proto_colony_delta_init(ProtoColonyDelta* delta);
+void proto_colony_delta_free(ProtoColonyDelta* delta);
+// Split a colony into its descriptor and quantized dynamic record
+void proto_colony_quantize(const ProtoColony* colony, ProtoColonyDescriptor* descriptor,
+                           ProtoColonyDynamic* dynamic);
 
 int protocol_serialize_colony(const ProtoColony* colony, uint8_t* buffer);
 int protocol_deserialize_colony(const uint8_t* buffer, ProtoColony* colony);
@@ -255,19 +465,113 @@ int protocol_deserialize_command_status(const uint8_t* buffer, ProtoCommandStatu
 int protocol_serialize_command(CommandType cmd, const void* data, uint8_t* buffer);
 int protocol_deserialize_command(const uint8_t* buffer, CommandType* cmd, void* data);
 
-// Grid serialization with RLE compression
-int protocol_serialize_grid_rle(const uint16_t* grid, uint32_t size, uint8_t** buffer, size_t* len);
-int protocol_deserialize_grid_rle(const uint8_t* buffer, size_t len, uint16_t* grid, uint32_t max_size);
+// Grid serialization: writes whichever ProtoGridMode encoding is smallest
+int protocol_serialize_grid_rle(const uint32_t* grid, uint32_t size, uint8_t** buffer, size_t* len);
+int protocol_deserialize_grid_rle(const uint8_t* buffer, size_t len, uint32_t* grid, uint32_t max_size);
 
 // ProtoWorld grid memory management
 void proto_world_init(ProtoWorld* world);
 void proto_world_free(ProtoWorld* world);
 void proto_world_alloc_grid(ProtoWorld* world, uint32_t width, uint32_t height);
+
+/**
+ * Append a colony page to the world's table.
+ * Pages must match world->tick and arrive in order after a full
+ * MSG_WORLD_STATE table.
+ * @return 0 if applied, 1 if stale or out of order, -1 on allocation failure
+ */
+int proto_world_apply_colony_page(ProtoWorld* world, const ProtoColonyPage* page);
+
+/**
+ * Apply a colony delta to the world's table (inline and paged), which must be
+ * sorted by id unless the delta is full. The result is sorted by id.
+ * The caller checks that the table is in [base_tick, tick].
+ * @return 0 on success, -1 if the delta does not fit the table (unknown ids,
+ *         a new colony without a dynamic record, a wrong total) or on
+ *         allocation failure; the table is unchanged then
+ */
+int proto_world_apply_colony_delta(ProtoWorld* world, const ProtoColonyDelta* delta);
+
+// Colonies in the world's table, inline and paged
+static inline uint32_t proto_world_colony_total(const ProtoWorld* world) {
+    return world->colony_count + world->extra_colony_count;
+}
+
+// @return table entry index (see proto_world_colony_total), or NULL past the end
+const ProtoColony* proto_world_colony_at(const ProtoWorld* world, uint32_t index);
+
+// @return the colony with this id, or NULL; tables sorted by id are searched in O(log n)
+const ProtoColony* proto_world_find_colony(const ProtoWorld* world, uint32_t id);
 void proto_world_delta_grid_chunk_init(ProtoWorldDeltaGridChunk* chunk);
 void proto_world_delta_grid_chunk_free(ProtoWorldDeltaGridChunk* chunk);
+void proto_world_delta_spans_init(ProtoWorldDeltaSpans* delta);
+void proto_world_delta_spans_free(ProtoWorldDeltaSpans* delta);
+
+/**
+ * Apply a span delta to a grid of grid_size cells.
+ * @return 0 on success, -1 if a span falls outside the grid
+ */
+int proto_world_delta_spans_apply(const ProtoWorldDeltaSpans* delta, uint32_t* grid, uint32_t grid_size);
 
 // Helper to send/receive complete messages
 int protocol_send_message(int socket, MessageType type, const uint8_t* payload, size_t len);
+// Receives one message; compressed payloads are expanded and the flag cleared.
 int protocol_recv_message(int socket, MessageHeader* header, uint8_t** payload);
 
+/**
+ * Expand a MSG_FLAG_COMPRESSED payload in place of the original.
+ * No-op for uncompressed messages.
+ * @return 0 on success, -1 on malformed input (payload is left untouched)
+ */
+int protocol_unpack_payload(MessageHeader* header, uint8_t** payload);
+
+/**
+ * An encoded message (serialized header + payload) shared by every recipient.
+ *
+ * Frames are immutable after creation and reference counted, so a broadcast
+ * encodes each distinct message once and hands the same frame to any number
+ * of clients. The count is atomic; frames may be released from other threads.
+ */
+typedef struct ProtoFrame {
+    atomic_int refcount;
+    MessageType type;
+    uint8_t header[MESSAGE_HEADER_SIZE];
+    uint8_t* payload;      // Owned; freed with the last reference
+    size_t payload_len;
+    struct ProtoFrame* compressed;  // Cached by proto_frame_compressed; owned
+    bool compress_tried;
+} ProtoFrame;
+
+/**
+ * Create a frame that takes ownership of a malloc'd payload (NULL when len is 0).
+ * The payload is freed on failure as well.
+ * @return frame with one reference, or NULL on failure
+ */
+ProtoFrame* proto_frame_create(MessageType type, uint8_t* payload, size_t len);
+
+/**
+ * Create a frame holding a copy of payload.
+ * @return frame with one reference, or NULL on failure
+ */
+ProtoFrame* proto_frame_copy(MessageType type, const uint8_t* payload, size_t len);
+
+ProtoFrame* proto_frame_retain(ProtoFrame* frame);
+void proto_frame_release(ProtoFrame* frame);
+
+/**
+ * Compressed twin of a frame for clients that negotiated PROTO_CAP_COMPRESSION.
+ * Built on first call and cached in the frame. Payloads under `min_bytes`,
+ * or that do not shrink, return the frame itself.
+ * Not thread-safe: call only from the thread that built the frame, while it
+ * still holds its reference.
+ * @return borrowed pointer that lives as long as `frame`
+ */
+ProtoFrame* proto_frame_compressed(ProtoFrame* frame, size_t min_bytes);
+
+// Header plus payload bytes
+size_t proto_frame_wire_size(const ProtoFrame* frame);
+
+// Blocking send of a whole frame; 0 on success, -1 on error
+int protocol_send_frame(int socket, const ProtoFrame* frame);
+
 #endif // PROTOCOL_H
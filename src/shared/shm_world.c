@@ -0,0 +1,339 @@
+#include "shm_world.h"
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHM_WORLD_ALIGN 64u
+
+// First bytes of the segment; fixed once the writer has set magic
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t max_cells;
+    uint32_t max_colonies;
+    uint32_t colony_size;   // sizeof(ProtoColony) in the writer's build
+    uint32_t port;
+    uint32_t reserved;
+    uint64_t slot_size;
+    uint64_t slots_offset;
+    _Alignas(SHM_WORLD_ALIGN) _Atomic uint64_t latest;  // Newest complete frame; 0 = none yet
+} ShmWorldHeader;
+
+// Slot header, followed by max_colonies ProtoColony and max_cells uint32 cells
+typedef struct {
+    _Atomic uint64_t seq;   // Odd while being written
+    uint64_t frame;
+    uint32_t tick;
+    uint32_t width;
+    uint32_t height;
+    uint32_t colony_count;
+    uint32_t paused;
+    float speed_multiplier;
+} ShmWorldSlot;
+
+struct ShmWorldWriter {
+    char* name;
+    uint8_t* base;
+    size_t size;
+    uint64_t frame;
+    dev_t dev;   // Identity of our object, so destroy leaves a successor's alone
+    ino_t ino;
+};
+
+struct ShmWorldReader {
+    const uint8_t* base;
+    size_t size;
+    uint64_t frame;        // Last frame copied out
+    uint32_t* cells;       // Scratch grid, swapped with the world's on success
+    uint32_t cell_capacity;
+    ProtoColony* colonies; // Scratch table
+    uint32_t colony_capacity;
+};
+
+static uint64_t shm_world_align(uint64_t value) {
+    return (value + SHM_WORLD_ALIGN - 1u) & ~(uint64_t)(SHM_WORLD_ALIGN - 1u);
+}
+
+static uint64_t shm_world_colonies_offset(void) {
+    return shm_world_align(sizeof(ShmWorldSlot));
+}
+
+static uint64_t shm_world_cells_offset(uint32_t max_colonies) {
+    return shm_world_align(shm_world_colonies_offset() + (uint64_t)max_colonies * sizeof(ProtoColony));
+}
+
+static ShmWorldSlot* shm_world_slot(uint8_t* base, uint64_t frame) {
+    const ShmWorldHeader* header = (const ShmWorldHeader*)base;
+    return (ShmWorldSlot*)(base + header->slots_offset + (frame % header->slot_count) * header->slot_size);
+}
+
+ShmWorldWriter* shm_world_writer_create(const char* name, uint32_t max_cells, uint32_t max_colonies,
+                                        uint16_t port) {
+    if (!name || name[0] != '/' || max_cells == 0 || max_cells > MAX_GRID_SIZE) {
+        return NULL;
+    }
+
+    uint64_t slot_size = shm_world_align(shm_world_cells_offset(max_colonies) +
+                                         (uint64_t)max_cells * sizeof(uint32_t));
+    uint64_t slots_offset = shm_world_align(sizeof(ShmWorldHeader));
+    uint64_t size = slots_offset + slot_size * SHM_WORLD_SLOTS;
+    if (size > (uint64_t)SIZE_MAX || size > (uint64_t)INT64_MAX) {
+        return NULL;
+    }
+
+    ShmWorldWriter* writer = (ShmWorldWriter*)calloc(1, sizeof(ShmWorldWriter));
+    if (!writer) return NULL;
+    writer->name = strdup(name);
+    if (!writer->name) {
+        free(writer);
+        return NULL;
+    }
+
+    // A previous server's segment is unlinked rather than truncated: clients
+    // still mapping it would fault on the vanished pages, whereas an unlinked
+    // object lives on until they unmap it and they reopen the new one
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        free(writer->name);
+        free(writer);
+        return NULL;
+    }
+    void* base = MAP_FAILED;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && ftruncate(fd, (off_t)size) == 0) {
+        base = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name);
+        free(writer->name);
+        free(writer);
+        return NULL;
+    }
+    writer->dev = st.st_dev;
+    writer->ino = st.st_ino;
+    writer->base = (uint8_t*)base;
+    writer->size = (size_t)size;
+
+    ShmWorldHeader* header = (ShmWorldHeader*)writer->base;
+    header->version = SHM_WORLD_VERSION;
+    header->slot_count = SHM_WORLD_SLOTS;
+    header->max_cells = max_cells;
+    header->max_colonies = max_colonies;
+    header->colony_size = (uint32_t)sizeof(ProtoColony);
+    header->port = port;
+    header->slot_size = slot_size;
+    header->slots_offset = slots_offset;
+    atomic_store_explicit(&header->latest, 0, memory_order_relaxed);
+    // Readers check magic before anything else
+    atomic_thread_fence(memory_order_release);
+    header->magic = SHM_WORLD_MAGIC;
+    return writer;
+}
+
+void shm_world_writer_destroy(ShmWorldWriter* writer) {
+    if (!writer) return;
+    munmap(writer->base, writer->size);
+    int fd = shm_open(writer->name, O_RDONLY, 0);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_dev == writer->dev && st.st_ino == writer->ino) {
+            shm_unlink(writer->name);
+        }
+        close(fd);
+    }
+    free(writer->name);
+    free(writer);
+}
+
+int shm_world_writer_publish(ShmWorldWriter* writer, const ProtoWorld* world,
+                             const uint32_t* cells, uint32_t width, uint32_t height) {
+    if (!writer || !world || !cells) return -1;
+    ShmWorldHeader* header = (ShmWorldHeader*)writer->base;
+    uint64_t cell_count = (uint64_t)width * height;
+    if (cell_count > header->max_cells) {
+        return -1;
+    }
+
+    uint64_t frame = writer->frame + 1u;
+    ShmWorldSlot* slot = shm_world_slot(writer->base, frame);
+    uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, seq + 1u, memory_order_relaxed);
+    // The odd sequence must be visible before any of the slot changes
+    atomic_thread_fence(memory_order_release);
+
+    uint32_t colony_count = proto_world_colony_total(world);
+    if (colony_count > header->max_colonies) {
+        colony_count = header->max_colonies;
+    }
+    ProtoColony* colonies = (ProtoColony*)((uint8_t*)slot + shm_world_colonies_offset());
+    uint32_t inline_count = colony_count < world->colony_count ? colony_count : world->colony_count;
+    memcpy(colonies, world->colonies, (size_t)inline_count * sizeof(ProtoColony));
+    if (colony_count > inline_count) {
+        memcpy(colonies + inline_count, world->extra_colonies,
+               (size_t)(colony_count - inline_count) * sizeof(ProtoColony));
+    }
+    memcpy((uint8_t*)slot + shm_world_cells_offset(header->max_colonies), cells,
+           (size_t)cell_count * sizeof(uint32_t));
+    slot->frame = frame;
+    slot->tick = world->tick;
+    slot->width = width;
+    slot->height = height;
+    slot->colony_count = colony_count;
+    slot->paused = world->paused ? 1u : 0u;
+    slot->speed_multiplier = world->speed_multiplier;
+
+    atomic_store_explicit(&slot->seq, seq + 2u, memory_order_release);
+    atomic_store_explicit(&header->latest, frame, memory_order_release);
+    writer->frame = frame;
+    return 0;
+}
+
+uint64_t shm_world_writer_frames(const ShmWorldWriter* writer) {
+    return writer ? writer->frame : 0;
+}
+
+ShmWorldReader* shm_world_reader_open(const char* name) {
+    if (!name) return NULL;
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (uint64_t)st.st_size >= sizeof(ShmWorldHeader)) {
+        base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    const ShmWorldHeader* header = (const ShmWorldHeader*)base;
+    bool valid = header->magic == SHM_WORLD_MAGIC;
+    atomic_thread_fence(memory_order_acquire);
+    valid = valid && header->version == SHM_WORLD_VERSION &&
+            header->colony_size == sizeof(ProtoColony) &&
+            header->slot_count > 0 && header->max_cells > 0 && header->max_cells <= MAX_GRID_SIZE &&
+            header->slots_offset >= sizeof(ShmWorldHeader) &&
+            header->slot_size >= shm_world_cells_offset(header->max_colonies) +
+                                 (uint64_t)header->max_cells * sizeof(uint32_t) &&
+            header->slots_offset + header->slot_size * header->slot_count <= (uint64_t)st.st_size;
+    ShmWorldReader* reader = valid ? (ShmWorldReader*)calloc(1, sizeof(ShmWorldReader)) : NULL;
+    if (!reader) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    reader->base = (const uint8_t*)base;
+    reader->size = (size_t)st.st_size;
+    return reader;
+}
+
+void shm_world_reader_close(ShmWorldReader* reader) {
+    if (!reader) return;
+    munmap((void*)reader->base, reader->size);
+    free(reader->cells);
+    free(reader->colonies);
+    free(reader);
+}
+
+uint16_t shm_world_reader_port(const ShmWorldReader* reader) {
+    return reader ? (uint16_t)((const ShmWorldHeader*)reader->base)->port : 0;
+}
+
+// Grow a scratch buffer; contents are not kept
+static bool shm_world_reserve(void** buffer, uint32_t* capacity, uint32_t count, size_t item_size) {
+    if (count <= *capacity && *buffer) {
+        return true;
+    }
+    void* grown = malloc((size_t)(count > 0 ? count : 1u) * item_size);
+    if (!grown) {
+        return false;
+    }
+    free(*buffer);
+    *buffer = grown;
+    *capacity = count;
+    return true;
+}
+
+int shm_world_reader_read(ShmWorldReader* reader, ProtoWorld* world) {
+    if (!reader || !world) return -1;
+    const ShmWorldHeader* header = (const ShmWorldHeader*)reader->base;
+    uint8_t* base = (uint8_t*)reader->base;  // Only read through
+
+    for (int attempt = 0; attempt < SHM_WORLD_READ_RETRIES; attempt++) {
+        uint64_t frame = atomic_load_explicit(&((ShmWorldHeader*)base)->latest, memory_order_acquire);
+        if (frame == 0 || frame == reader->frame) {
+            return 0;
+        }
+        ShmWorldSlot* slot = shm_world_slot(base, frame);
+        uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq & 1u) {
+            continue;  // Lapped by the writer; take the newer frame
+        }
+        ShmWorldSlot copy;
+        memcpy(&copy, slot, sizeof(copy));
+        uint64_t cell_count = (uint64_t)copy.width * copy.height;
+        // Fields copied mid-write can be anything; never size buffers from them unchecked
+        if (copy.frame != frame || cell_count > header->max_cells || copy.colony_count > header->max_colonies) {
+            continue;
+        }
+        if (!shm_world_reserve((void**)&reader->cells, &reader->cell_capacity,
+                               (uint32_t)cell_count, sizeof(uint32_t)) ||
+            !shm_world_reserve((void**)&reader->colonies, &reader->colony_capacity,
+                               copy.colony_count, sizeof(ProtoColony))) {
+            return 0;
+        }
+        memcpy(reader->colonies, (const uint8_t*)slot + shm_world_colonies_offset(),
+               (size_t)copy.colony_count * sizeof(ProtoColony));
+        memcpy(reader->cells, (const uint8_t*)slot + shm_world_cells_offset(header->max_colonies),
+               (size_t)cell_count * sizeof(uint32_t));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->seq, memory_order_relaxed) != seq) {
+            continue;
+        }
+
+        uint32_t inline_count = copy.colony_count < MAX_COLONIES ? copy.colony_count : MAX_COLONIES;
+        uint32_t extra_count = copy.colony_count - inline_count;
+        ProtoColony* extra = NULL;
+        if (extra_count > 0) {
+            extra = (ProtoColony*)malloc((size_t)extra_count * sizeof(ProtoColony));
+            if (!extra) {
+                return 0;
+            }
+            memcpy(extra, reader->colonies + inline_count, (size_t)extra_count * sizeof(ProtoColony));
+        }
+        memcpy(world->colonies, reader->colonies, (size_t)inline_count * sizeof(ProtoColony));
+        free(world->extra_colonies);
+        world->extra_colonies = extra;
+        world->extra_colony_count = extra_count;
+        world->colony_count = inline_count;
+
+        // The copied grid becomes the world's; its old one is the next scratch
+        uint32_t* old_grid = world->grid;
+        uint32_t old_size = world->grid_size;
+        world->grid = reader->cells;
+        world->grid_size = (uint32_t)cell_count;
+        world->grid_level = 0;
+        world->has_grid = true;
+        reader->cells = old_grid;
+        reader->cell_capacity = old_grid ? old_size : 0;
+
+        world->width = copy.width;
+        world->height = copy.height;
+        world->tick = copy.tick;
+        world->paused = copy.paused != 0;
+        world->speed_multiplier = copy.speed_multiplier;
+        reader->frame = frame;
+        return 1;
+    }
+    return 0;
+}
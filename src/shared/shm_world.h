@@ -0,0 +1,82 @@
+#ifndef FEROX_SHM_WORLD_H
+#define FEROX_SHM_WORLD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "protocol.h"
+
+/**
+ * World frames in POSIX shared memory for viewers on the server's host.
+ *
+ * The server copies each broadcast frame (grid plane, colony table and
+ * playback state) once into a small ring of slots; any number of local
+ * clients map the segment read-only and copy the newest slot out, so the
+ * server's cost does not grow with them. Commands and replies still go over
+ * TCP.
+ *
+ * Each slot is a seqlock: its sequence is odd while the writer is inside it,
+ * and a reader keeps a copy only if the sequence was even and unchanged
+ * around it. With SHM_WORLD_SLOTS slots a reader copying the newest one is
+ * only disturbed when the writer laps it, after which it retries with the
+ * then newest slot.
+ *
+ * Slots hold ProtoColony as laid out by the writer's build; readers refuse
+ * segments from a build with a different layout.
+ */
+#define SHM_WORLD_MAGIC 0x46455753u  // "FEWS"
+#define SHM_WORLD_VERSION 1u
+#define SHM_WORLD_SLOTS 3u
+#define SHM_WORLD_DEFAULT_COLONIES 4096u
+#define SHM_WORLD_READ_RETRIES 4
+
+typedef struct ShmWorldWriter ShmWorldWriter;
+typedef struct ShmWorldReader ShmWorldReader;
+
+/**
+ * Create the segment `name` ("/ferox" style) with room for max_cells grid
+ * cells and max_colonies table entries per slot. A segment left by an earlier
+ * writer is unlinked first; readers still mapping it keep the old frames and
+ * must reopen the name to see the new ones.
+ * @param port TCP port of the writing server, so clients can tell it is theirs
+ * @return the writer, or NULL on failure
+ */
+ShmWorldWriter* shm_world_writer_create(const char* name, uint32_t max_cells, uint32_t max_colonies,
+                                        uint16_t port);
+
+// Unmap the segment and unlink it, unless a later writer has replaced it.
+void shm_world_writer_destroy(ShmWorldWriter* writer);
+
+/**
+ * Copy a frame into the next slot and make it the newest. The colony table
+ * comes from `world`; entries past the segment's max_colonies are left out.
+ * Single writer thread at a time.
+ * @return 0 on success, -1 if the grid does not fit
+ */
+int shm_world_writer_publish(ShmWorldWriter* writer, const ProtoWorld* world,
+                             const uint32_t* cells, uint32_t width, uint32_t height);
+
+// Frames published so far.
+uint64_t shm_world_writer_frames(const ShmWorldWriter* writer);
+
+/**
+ * Map an existing segment read-only.
+ * @return the reader, or NULL if it does not exist or was written by an
+ *         incompatible build
+ */
+ShmWorldReader* shm_world_reader_open(const char* name);
+
+void shm_world_reader_close(ShmWorldReader* reader);
+
+// TCP port the writing server recorded; 0 if it did not say.
+uint16_t shm_world_reader_port(const ShmWorldReader* reader);
+
+/**
+ * Copy the newest frame into `world`: its state, colony table and a full
+ * level-0 grid. `world` is left unchanged unless a whole frame was copied.
+ * @return 1 if a newer frame was copied, 0 if there was none (or the writer
+ *         kept lapping the reader), -1 on bad arguments
+ */
+int shm_world_reader_read(ShmWorldReader* reader, ProtoWorld* world);
+
+#endif // FEROX_SHM_WORLD_H
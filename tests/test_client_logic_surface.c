@@ -50,9 +50,20 @@ typedef struct {
     ProtoCommandStatus next_command_status;
 } protocol_stub_state;
 
+typedef struct {
+    int open_calls;
+    int close_calls;
+    int read_calls;
+    bool open_succeeds;
+    uint16_t port;
+    int read_return;
+    uint32_t read_tick;
+} shm_stub_state;
+
 static renderer_stub_state g_renderer;
 static network_stub_state g_network;
 static protocol_stub_state g_protocol;
+static shm_stub_state g_shm;
 static InputAction g_next_action = INPUT_NONE;
 static int g_tests_run = 0;
 
@@ -60,6 +71,7 @@ static void reset_stubs(void) {
     memset(&g_renderer, 0, sizeof(g_renderer));
     memset(&g_network, 0, sizeof(g_network));
     memset(&g_protocol, 0, sizeof(g_protocol));
+    memset(&g_shm, 0, sizeof(g_shm));
     g_protocol.send_return = 0;
     g_protocol.recv_return = 1;
     g_protocol.serialize_return = 1;
@@ -224,6 +236,115 @@ int protocol_deserialize_world_delta_grid_chunk(const uint8_t* buffer, size_t le
     return -1;
 }
 
+int protocol_deserialize_world_delta_spans(const uint8_t* buffer, size_t len, ProtoWorldDeltaSpans* delta) {
+    (void)buffer;
+    (void)len;
+    (void)delta;
+    return -1;
+}
+
+int protocol_serialize_world_ack(const ProtoWorldAck* ack, uint8_t* buffer) {
+    if (!ack || !buffer) {
+        return -1;
+    }
+    memcpy(buffer, &ack->tick, sizeof(ack->tick));
+    return WORLD_ACK_SERIALIZED_SIZE;
+}
+
+int protocol_serialize_connect(const ProtoConnect* connect, uint8_t* buffer) {
+    if (!connect || !buffer) {
+        return -1;
+    }
+    memcpy(buffer, &connect->capabilities, sizeof(connect->capabilities));
+    memcpy(buffer + sizeof(connect->capabilities), &connect->version, sizeof(connect->version));
+    return CONNECT_SERIALIZED_SIZE;
+}
+
+int protocol_deserialize_connect(const uint8_t* buffer, size_t len, ProtoConnect* connect) {
+    if (!connect || len < CONNECT_SERIALIZED_SIZE || !buffer) {
+        return -1;
+    }
+    memcpy(&connect->capabilities, buffer, sizeof(connect->capabilities));
+    memcpy(&connect->version, buffer + sizeof(connect->capabilities), sizeof(connect->version));
+    return 0;
+}
+
+void proto_world_delta_spans_init(ProtoWorldDeltaSpans* delta) {
+    if (delta) {
+        memset(delta, 0, sizeof(*delta));
+    }
+}
+
+void proto_world_delta_spans_free(ProtoWorldDeltaSpans* delta) {
+    if (delta) {
+        free(delta->spans);
+        free(delta->cells);
+        delta->spans = NULL;
+        delta->cells = NULL;
+    }
+}
+
+int proto_world_delta_spans_apply(const ProtoWorldDeltaSpans* delta, uint32_t* grid, uint32_t grid_size) {
+    (void)delta;
+    (void)grid;
+    (void)grid_size;
+    return -1;
+}
+
+int protocol_deserialize_colony_page(const uint8_t* buffer, size_t len, ProtoColonyPage* page) {
+    (void)buffer;
+    (void)len;
+    if (page) {
+        memset(page, 0, sizeof(*page));
+    }
+    return -1;
+}
+
+int protocol_deserialize_colony_delta(const uint8_t* buffer, size_t len, ProtoColonyDelta* delta) {
+    (void)buffer;
+    (void)len;
+    if (delta) {
+        memset(delta, 0, sizeof(*delta));
+    }
+    return -1;
+}
+
+int proto_world_apply_colony_delta(ProtoWorld* world, const ProtoColonyDelta* delta) {
+    (void)world;
+    (void)delta;
+    return -1;
+}
+
+void proto_colony_delta_free(ProtoColonyDelta* delta) {
+    (void)delta;
+}
+
+void proto_colony_page_free(ProtoColonyPage* page) {
+    if (page) {
+        free(page->colonies);
+        page->colonies = NULL;
+    }
+}
+
+int proto_world_apply_colony_page(proto_world* world, const ProtoColonyPage* page) {
+    (void)world;
+    (void)page;
+    return 1;
+}
+
+const ProtoColony* proto_world_colony_at(const proto_world* world, uint32_t index) {
+    return world && index < world->colony_count ? &world->colonies[index] : NULL;
+}
+
+const ProtoColony* proto_world_find_colony(const proto_world* world, uint32_t id) {
+    for (uint32_t i = 0; world && i < world->colony_count; i++) {
+        if (world->colonies[i].id == id) {
+            return &world->colonies[i];
+        }
+    }
+    return NULL;
+}
+
 void proto_world_free(proto_world* world) {
     if (!world) {
         return;
@@ -241,10 +362,21 @@ void proto_world_alloc_grid(proto_world* world, uint32_t width, uint32_t height)
     world->width = width;
     world->height = height;
     world->grid_size = width * height;
-    world->grid = (uint16_t*)calloc(world->grid_size, sizeof(uint16_t));
+    world->grid = (uint32_t*)calloc(world->grid_size, sizeof(uint32_t));
     world->has_grid = (world->grid != NULL);
 }
 
+int proto_grid_level_for_dims(uint32_t world_width, uint32_t world_height,
+                              uint32_t grid_width, uint32_t grid_height) {
+    for (uint32_t level = 0; level <= PROTO_GRID_MAX_LEVEL; level++) {
+        if (proto_grid_level_dim(world_width, level) == grid_width &&
+            proto_grid_level_dim(world_height, level) == grid_height) {
+            return (int)level;
+        }
+    }
+    return -1;
+}
+
 void proto_world_delta_grid_chunk_init(ProtoWorldDeltaGridChunk* chunk) {
     if (chunk) {
         memset(chunk, 0, sizeof(*chunk));
@@ -267,6 +399,32 @@ InputAction input_poll(void) {
     return g_next_action;
 }
 
+ShmWorldReader* shm_world_reader_open(const char* name) {
+    (void)name;
+    g_shm.open_calls++;
+    return g_shm.open_succeeds ? (ShmWorldReader*)&g_shm : NULL;
+}
+
+void shm_world_reader_close(ShmWorldReader* reader) {
+    if (reader) {
+        g_shm.close_calls++;
+    }
+}
+
+uint16_t shm_world_reader_port(const ShmWorldReader* reader) {
+    (void)reader;
+    return g_shm.port;
+}
+
+int shm_world_reader_read(ShmWorldReader* reader, ProtoWorld* world) {
+    (void)reader;
+    g_shm.read_calls++;
+    if (g_shm.read_return > 0) {
+        world->tick = g_shm.read_tick;
+    }
+    return g_shm.read_return;
+}
+
 #include "../src/client/client.c"
 
 static Client make_client_with_renderer(void) {
@@ -417,6 +575,94 @@ static void test_handle_message_updates_selection_status(void) {
     assert(client.has_selected_detail == false);
 }
 
+static void test_connect_ack_limits_viewport_subscription(void) {
+    g_tests_run++;
+    reset_stubs();
+    Client client = make_client_with_renderer();
+    NetSocket socket = {.fd = 5};
+    client.connected = true;
+    client.socket = &socket;
+    client.server_version = 1;
+    client.capabilities = PROTO_CAP_LEGACY_DEFAULT;
+    client.renderer->view_width = 40;
+    client.renderer->view_height = 20;
+
+    client_sync_viewport(&client);
+    assert(g_protocol.serialize_calls == 1);
+    assert(g_protocol.last_serialized_cmd == CMD_SET_VIEWPORT);
+
+    // A server that declines viewports keeps streaming the whole grid
+    ProtoConnect agreed = { .capabilities = PROTO_CAP_SPAN_DELTA, .version = 2 };
+    uint8_t payload[CONNECT_SERIALIZED_SIZE];
+    protocol_serialize_connect(&agreed, payload);
+    client_handle_message(&client, MSG_CONNECT_ACK, payload, sizeof(payload));
+    assert(client.server_version == 2);
+    assert(client.capabilities == PROTO_CAP_SPAN_DELTA);
+
+    client.renderer->view_x = 8;
+    client_sync_viewport(&client);
+    assert(g_protocol.serialize_calls == 1);
+
+    renderer_destroy(client.renderer);
+}
+
+static void test_connect_maps_shared_world_of_same_server(void) {
+    g_tests_run++;
+    reset_stubs();
+    setenv("FEROX_SHM_NAME", "/ferox-test", 1);
+    NetSocket socket = {.fd = 6};
+    g_network.connect_result = &socket;
+    g_shm.open_succeeds = true;
+
+    // A segment written by a server on another port is not ours
+    Client client = make_client_with_renderer();
+    g_shm.port = 7001;
+    assert(client_connect(&client, "127.0.0.1", 7000));
+    assert(client.shared_world == NULL);
+    assert(g_shm.close_calls == 1);
+
+    memset(&client.local_world, 0, sizeof(client.local_world));
+    client.shared_world = NULL;
+    g_shm.port = 7000;
+    assert(client_connect(&client, "127.0.0.1", 7000));
+    assert(client.shared_world != NULL);
+    // Not in effect until the server agrees
+    assert(!(client.capabilities & PROTO_CAP_SHARED_WORLD));
+    g_shm.read_return = 1;
+    g_shm.read_tick = 42;
+    assert(!client_read_shared_world(&client));
+    assert(g_shm.read_calls == 0);
+
+    ProtoConnect agreed = { .capabilities = PROTO_CAP_SHARED_WORLD | PROTO_CAP_VIEWPORT, .version = 2 };
+    uint8_t payload[CONNECT_SERIALIZED_SIZE];
+    protocol_serialize_connect(&agreed, payload);
+    client_handle_message(&client, MSG_CONNECT_ACK, payload, sizeof(payload));
+    client.has_colony_table = true;
+    assert(client_read_shared_world(&client));
+    assert(client.local_world.tick == 42);
+    assert(client.grid_tick == 42);
+    assert(!client.has_colony_table);
+    g_shm.read_return = 0;
+    assert(!client_read_shared_world(&client));
+
+    // Reconnecting maps the segment afresh, as a restarted server replaces it
+    g_shm.open_calls = 0;
+    assert(client_connect(&client, "127.0.0.1", 7000));
+    assert(g_shm.close_calls == 2);
+    assert(g_shm.open_calls == 1);
+    assert(client.shared_world != NULL);
+
+    // A server without the segment leaves the client on TCP
+    agreed.capabilities = PROTO_CAP_VIEWPORT;
+    protocol_serialize_connect(&agreed, payload);
+    client_handle_message(&client, MSG_CONNECT_ACK, payload, sizeof(payload));
+    assert(client.shared_world == NULL);
+    assert(g_shm.close_calls == 3);
+
+    unsetenv("FEROX_SHM_NAME");
+    renderer_destroy(client.renderer);
+}
+
 static void test_update_world_guards_and_failures(void) {
     g_tests_run++;
     reset_stubs();
@@ -532,6 +778,8 @@ int main(void) {
     test_get_selected_colony_filters_dead_and_missing();
     test_handle_message_dispatches_world_messages();
     test_handle_message_updates_selection_status();
+    test_connect_ack_limits_viewport_subscription();
+    test_connect_maps_shared_world_of_same_server();
     test_update_world_guards_and_failures();
     test_process_input_pause_speed_scroll_select_reset();
     test_process_input_quit_sets_running_false();
@@ -0,0 +1,169 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/server/grid_alloc.h"
+#include "../src/shared/cacheline.h"
+
+#define TEST_START(name) printf("  Testing %s... ", name)
+#define TEST_PASS() printf("PASSED\n")
+#define TEST_FAIL(msg) do { printf("FAILED: %s\n", msg); return 1; } while(0)
+
+#define ASSERT_TRUE(cond) do { if (!(cond)) TEST_FAIL(#cond " is false"); } while(0)
+#define ASSERT_FALSE(cond) do { if (cond) TEST_FAIL(#cond " is true"); } while(0)
+#define ASSERT_EQ(a, b) do { if ((a) != (b)) TEST_FAIL(#a " != " #b); } while(0)
+
+static bool all_zero(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int test_parse_hugepage_mode(void) {
+    TEST_START("hugepage mode parsing");
+
+    FeroxHugePageMode mode;
+    ASSERT_TRUE(ferox_hugepage_mode_from_string("off", &mode));
+    ASSERT_EQ(mode, FEROX_HUGEPAGE_OFF);
+    ASSERT_TRUE(ferox_hugepage_mode_from_string("THP", &mode));
+    ASSERT_EQ(mode, FEROX_HUGEPAGE_THP);
+    ASSERT_TRUE(ferox_hugepage_mode_from_string("hugetlb", &mode));
+    ASSERT_EQ(mode, FEROX_HUGEPAGE_HUGETLB);
+    ASSERT_FALSE(ferox_hugepage_mode_from_string("bogus", &mode));
+
+    TEST_PASS();
+    return 0;
+}
+
+static int test_small_allocations_use_heap(void) {
+    TEST_START("small allocations stay on the heap");
+
+    ferox_grid_alloc_set_mode(FEROX_HUGEPAGE_THP);
+    FeroxGridAllocStats before;
+    ferox_grid_alloc_get_stats(&before);
+
+    uint8_t* ptr = (uint8_t*)ferox_grid_calloc(1000, sizeof(float));
+    ASSERT_TRUE(ptr != NULL);
+    ASSERT_EQ((uintptr_t)ptr % FEROX_CACHELINE_SIZE, 0);
+    ASSERT_TRUE(all_zero(ptr, 1000 * sizeof(float)));
+
+    FeroxGridAllocStats during;
+    ferox_grid_alloc_get_stats(&during);
+    ASSERT_EQ(during.heap_bytes - before.heap_bytes, 1000 * sizeof(float));
+
+    ferox_grid_free(ptr);
+    FeroxGridAllocStats after;
+    ferox_grid_alloc_get_stats(&after);
+    ASSERT_EQ(after.heap_bytes, before.heap_bytes);
+
+    TEST_PASS();
+    return 0;
+}
+
+static int test_large_allocations_are_zeroed_and_tracked(void) {
+    TEST_START("large allocations per mode");
+
+    const FeroxHugePageMode modes[] = {FEROX_HUGEPAGE_OFF, FEROX_HUGEPAGE_THP, FEROX_HUGEPAGE_HUGETLB};
+    const size_t count = (size_t)3 * 1024 * 1024 + 17;  // Not a multiple of 2 MB
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        ferox_grid_alloc_set_mode(modes[m]);
+        FeroxGridAllocStats before;
+        ferox_grid_alloc_get_stats(&before);
+
+        uint8_t* ptr = (uint8_t*)ferox_grid_calloc(count, 1);
+        ASSERT_TRUE(ptr != NULL);
+        ASSERT_EQ((uintptr_t)ptr % FEROX_CACHELINE_SIZE, 0);
+        ASSERT_TRUE(all_zero(ptr, count));
+        memset(ptr, 0xAB, count);
+
+        FeroxGridAllocStats during;
+        ferox_grid_alloc_get_stats(&during);
+        uint64_t live_before = before.heap_bytes + before.mmap_bytes + before.thp_bytes + before.hugetlb_bytes;
+        uint64_t live_during = during.heap_bytes + during.mmap_bytes + during.thp_bytes + during.hugetlb_bytes;
+        ASSERT_EQ(live_during - live_before, count);
+        if (modes[m] == FEROX_HUGEPAGE_OFF) {
+            ASSERT_EQ(during.heap_bytes - before.heap_bytes, count);
+        }
+
+        ferox_grid_free(ptr);
+        FeroxGridAllocStats after;
+        ferox_grid_alloc_get_stats(&after);
+        ASSERT_EQ(after.heap_bytes + after.mmap_bytes + after.thp_bytes + after.hugetlb_bytes, live_before);
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+static int test_page_size_follows_backing(void) {
+    TEST_START("page size and backing per block");
+
+    ferox_grid_alloc_set_mode(FEROX_HUGEPAGE_THP);
+    uint8_t* small = (uint8_t*)ferox_grid_calloc(64, 1);
+    ASSERT_TRUE(small != NULL);
+    ASSERT_EQ(strcmp(ferox_grid_backing_name(small), "heap"), 0);
+    size_t base_page = ferox_grid_page_size(small);
+    ASSERT_TRUE(base_page >= 4096);
+    ASSERT_EQ(base_page & (base_page - 1), 0);
+    ferox_grid_free(small);
+
+    const size_t count = (size_t)5 * 1024 * 1024;
+    uint8_t* large = (uint8_t*)ferox_grid_calloc(count, 1);
+    ASSERT_TRUE(large != NULL);
+    const char* backing = ferox_grid_backing_name(large);
+    if (strcmp(backing, "thp") == 0 || strcmp(backing, "hugetlb") == 0) {
+        ASSERT_EQ(ferox_grid_page_size(large), FEROX_GRID_ALLOC_HUGE_MIN);
+    } else {
+        ASSERT_EQ(ferox_grid_page_size(large), base_page);
+    }
+    ferox_grid_free(large);
+
+    // Heap blocks are not memset up front; reused memory must still come back zeroed.
+    ferox_grid_alloc_set_mode(FEROX_HUGEPAGE_OFF);
+    for (int round = 0; round < 3; round++) {
+        uint8_t* ptr = (uint8_t*)ferox_grid_calloc(count, 1);
+        ASSERT_TRUE(ptr != NULL);
+        ASSERT_EQ(strcmp(ferox_grid_backing_name(ptr), "heap"), 0);
+        ASSERT_EQ((uintptr_t)ptr % FEROX_CACHELINE_SIZE, 0);
+        ASSERT_TRUE(all_zero(ptr, count));
+        memset(ptr, 0xCD, count);
+        ferox_grid_free(ptr);
+    }
+
+    ASSERT_EQ(strcmp(ferox_grid_backing_name(NULL), "unknown"), 0);
+    ferox_grid_alloc_set_mode(FEROX_HUGEPAGE_THP);
+
+    TEST_PASS();
+    return 0;
+}
+
+static int test_zero_and_overflow_requests_fail(void) {
+    TEST_START("zero and overflowing requests");
+
+    ASSERT_TRUE(ferox_grid_calloc(0, 4) == NULL);
+    ASSERT_TRUE(ferox_grid_calloc(4, 0) == NULL);
+    ASSERT_TRUE(ferox_grid_calloc(SIZE_MAX / 2, 4) == NULL);
+    ferox_grid_free(NULL);
+
+    TEST_PASS();
+    return 0;
+}
+
+int main(void) {
+    printf("Running grid allocator tests...\n\n");
+
+    if (test_parse_hugepage_mode() != 0) return 1;
+    if (test_small_allocations_use_heap() != 0) return 1;
+    if (test_large_allocations_are_zeroed_and_tracked() != 0) return 1;
+    if (test_page_size_follows_backing() != 0) return 1;
+    if (test_zero_and_overflow_requests_fail() != 0) return 1;
+
+    printf("\n");
+    ferox_grid_alloc_print_report(stdout);
+    printf("\nAll grid allocator tests passed!\n");
+    return 0;
+}
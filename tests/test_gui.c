@@ -79,7 +79,7 @@ void mock_screen_to_world(MockRenderer* r, int sx, int sy, float* wx, float* wy)
 
 void mock_set_zoom(MockRenderer* r, float zoom) {
     r->zoom = zoom;
-    if (r->zoom < 1.0f) r->zoom = 1.0f;
+    if (r->zoom < 0.0625f) r->zoom = 0.0625f;
     if (r->zoom > 50.0f) r->zoom = 50.0f;
 }
 
@@ -98,7 +98,7 @@ void mock_zoom_at(MockRenderer* r, int screen_x, int screen_y, float factor) {
     mock_screen_to_world(r, screen_x, screen_y, &world_x, &world_y);
     
     float new_zoom = r->zoom * factor;
-    if (new_zoom < 1.0f) new_zoom = 1.0f;
+    if (new_zoom < 0.0625f) new_zoom = 0.0625f;
     if (new_zoom > 50.0f) new_zoom = 50.0f;
     r->zoom = new_zoom;
     
@@ -304,10 +304,10 @@ TEST(test_zoom_set_accepts_valid_values) {
     ASSERT_FLOAT_EQ(r.zoom, 12.0f, 0.01f);
 }
 
-TEST(test_zoom_clamps_to_minimum_one) {
+TEST(test_zoom_clamps_to_minimum_sixteenth) {
     MockRenderer r = {.zoom = 6.0f};
-    mock_set_zoom(&r, 0.1f);
-    ASSERT_FLOAT_EQ(r.zoom, 1.0f, 0.01f);
+    mock_set_zoom(&r, 0.01f);
+    ASSERT_FLOAT_EQ(r.zoom, 0.0625f, 0.001f);
 }
 
 TEST(test_zoom_clamps_to_maximum_fifty) {
@@ -720,7 +720,7 @@ int main(int argc, char** argv) {
     
     printf("\nZoom Tests:\n");
     RUN_TEST(test_zoom_set_accepts_valid_values);
-    RUN_TEST(test_zoom_clamps_to_minimum_one);
+    RUN_TEST(test_zoom_clamps_to_minimum_sixteenth);
     RUN_TEST(test_zoom_clamps_to_maximum_fifty);
     RUN_TEST(test_zoom_at_keeps_point_stable);
     RUN_TEST(test_zoom_at_center_does_not_pan);
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "../src/server/cpu_topology.h"
 #include "../src/server/hardware_profile.h"
 
 #define TEST_START(name) printf("  Testing %s... ", name)
@@ -106,6 +107,79 @@ static int test_cpu_defaults_keep_at_least_one_thread(void) {
     return 0;
 }
 
+static int test_core_budget_reserves_io_core(void) {
+    TEST_START("core budget io reservation");
+
+    FeroxHardwareInfo info = make_info(8);
+    FeroxRuntimeTuning tuning;
+    ferox_runtime_tuning_init(&info, FEROX_ACCELERATOR_PREFERENCE_CPU, &tuning);
+    ASSERT_EQ(tuning.core_budget, 8);
+    ASSERT_EQ(tuning.io_reserved_cores, 1);
+    ASSERT_EQ(tuning.encode_helpers, 1);
+    // Less the simulation and broadcast threads
+    ASSERT_EQ(tuning.recommended_threads, 4);
+
+    // IO, simulation, broadcast, encode helpers and pool fill the budget
+    for (int cpus = 4; cpus <= 64; cpus++) {
+        info = make_info(cpus);
+        ferox_runtime_tuning_init(&info, FEROX_ACCELERATOR_PREFERENCE_CPU, &tuning);
+        ASSERT_TRUE(tuning.recommended_threads >= 1);
+        ASSERT_EQ(tuning.io_reserved_cores + 2 + tuning.encode_helpers + tuning.recommended_threads,
+                  tuning.core_budget);
+    }
+
+    info = make_info(2);
+    ferox_runtime_tuning_init(&info, FEROX_ACCELERATOR_PREFERENCE_CPU, &tuning);
+    ASSERT_EQ(tuning.io_reserved_cores, 0);
+    ASSERT_EQ(tuning.encode_helpers, 0);
+    ASSERT_EQ(tuning.recommended_threads, 1);
+
+    TEST_PASS();
+    return 0;
+}
+
+static int test_cpu_topology_detects_usable_cpus(void) {
+    TEST_START("cpu topology detection");
+
+    FeroxCpuTopology topo;
+    ASSERT_EQ(ferox_cpu_topology_detect(&topo), 0);
+    ASSERT_TRUE(topo.cpu_count >= 1);
+    ASSERT_TRUE(topo.node_count >= 1);
+    for (int i = 1; i < topo.cpu_count; i++) {
+        // Node-major ordering
+        ASSERT_TRUE(topo.cpu_node[i] >= topo.cpu_node[i - 1]);
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+static int test_cpu_topology_workers_fill_nodes_in_blocks(void) {
+    TEST_START("cpu topology worker placement");
+
+    FeroxCpuTopology topo;
+    memset(&topo, 0, sizeof(topo));
+    topo.cpu_count = 8;
+    topo.node_count = 2;
+    for (int i = 0; i < 8; i++) {
+        topo.cpus[i] = i;
+        topo.cpu_node[i] = (short)(i / 4);
+    }
+
+    // 4 workers over 2 nodes: two per node, lower ids first.
+    ASSERT_EQ(ferox_cpu_topology_node_for_worker(&topo, 0, 4), 0);
+    ASSERT_EQ(ferox_cpu_topology_node_for_worker(&topo, 1, 4), 0);
+    ASSERT_EQ(ferox_cpu_topology_node_for_worker(&topo, 2, 4), 1);
+    ASSERT_EQ(ferox_cpu_topology_node_for_worker(&topo, 3, 4), 1);
+    ASSERT_EQ(ferox_cpu_topology_slot_for_worker(&topo, 3, 4), 6);
+
+    // Oversubscribed pools wrap around the CPU list.
+    ASSERT_EQ(ferox_cpu_topology_slot_for_worker(&topo, 9, 12), 1);
+
+    TEST_PASS();
+    return 0;
+}
+
 int main(void) {
     printf("Running hardware profile tests...\n\n");
 
@@ -114,6 +188,9 @@ int main(void) {
     if (test_auto_selects_amd_target_when_available() != 0) return 1;
     if (test_requested_amd_falls_back_to_cpu_when_unavailable() != 0) return 1;
     if (test_cpu_defaults_keep_at_least_one_thread() != 0) return 1;
+    if (test_core_budget_reserves_io_core() != 0) return 1;
+    if (test_cpu_topology_detects_usable_cpus() != 0) return 1;
+    if (test_cpu_topology_workers_fill_nodes_in_blocks() != 0) return 1;
 
     printf("\nAll hardware profile tests passed!\n");
     return 0;
@@ -5,6 +5,11 @@
 #include <time.h>
 
 #include "../src/shared/protocol.h"
+#include "../src/shared/lz.h"
+#include "../src/shared/utils.h"
+#include "../src/server/server.h"
+#include "../src/server/simulation.h"
+#include "../src/server/world.h"
 
 static uint64_t now_ns(void) {
     struct timespec ts;
@@ -12,24 +17,31 @@ static uint64_t now_ns(void) {
     return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
-static void fill_sparse(uint16_t* grid, uint32_t n) {
+static void fill_sparse(uint32_t* grid, uint32_t n) {
     for (uint32_t i = 0; i < n; i++) {
         grid[i] = (i % 97u == 0u) ? 7u : 0u;
     }
 }
 
-static void fill_noisy(uint16_t* grid, uint32_t n) {
+static void fill_noisy(uint32_t* grid, uint32_t n) {
     for (uint32_t i = 0; i < n; i++) {
-        grid[i] = (uint16_t)((i * 131u) & 0x00FFu);
+        grid[i] = (uint32_t)((i * 131u) & 0x00FFu);
     }
 }
 
-static int benchmark_case(const char* kind, uint16_t* grid, uint32_t size, int repeats) {
+// More distinct ids than a palette holds, so the codec falls back to raw cells
+static void fill_distinct(uint32_t* grid, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        grid[i] = 1u + (uint32_t)((i * 2654435761u) >> 20);
+    }
+}
+
+static int benchmark_case(const char* kind, uint32_t* grid, uint32_t size, int repeats) {
     uint64_t ser_ns = 0;
     uint64_t de_ns = 0;
     size_t bytes_total = 0;
 
-    uint16_t* decoded = (uint16_t*)calloc(size, sizeof(uint16_t));
+    uint32_t* decoded = (uint32_t*)calloc(size, sizeof(uint32_t));
     if (!decoded) return 1;
 
     for (int i = 0; i < repeats; i++) {
@@ -85,17 +97,17 @@ static int benchmark_case(const char* kind, uint16_t* grid, uint32_t size, int r
     return 0;
 }
 
-static int benchmark_chunk_case(const char* kind, uint16_t* grid, uint32_t size, int repeats) {
+static int benchmark_chunk_case(const char* kind, uint32_t* grid, uint32_t size, int repeats) {
     uint64_t ser_ns = 0;
     uint64_t de_ns = 0;
     size_t bytes_total = 0;
 
-    uint16_t* decoded = (uint16_t*)calloc(size, sizeof(uint16_t));
+    uint32_t* decoded = (uint32_t*)calloc(size, sizeof(uint32_t));
     if (!decoded) return 1;
 
     uint32_t chunk_count = (size + MAX_GRID_CHUNK_CELLS - 1u) / MAX_GRID_CHUNK_CELLS;
     for (int r = 0; r < repeats; r++) {
-        memset(decoded, 0, size * sizeof(uint16_t));
+        memset(decoded, 0, size * sizeof(uint32_t));
         for (uint32_t chunk_idx = 0; chunk_idx < chunk_count; chunk_idx++) {
             uint32_t start_index = chunk_idx * MAX_GRID_CHUNK_CELLS;
             uint32_t cell_count = size - start_index;
@@ -133,7 +145,7 @@ static int benchmark_chunk_case(const char* kind, uint16_t* grid, uint32_t size,
             uint64_t t2 = now_ns();
 
             memcpy(&decoded[decoded_chunk.start_index], decoded_chunk.cells,
-                   (size_t)decoded_chunk.cell_count * sizeof(uint16_t));
+                   (size_t)decoded_chunk.cell_count * sizeof(uint32_t));
             proto_world_delta_grid_chunk_free(&decoded_chunk);
             free(buf);
 
@@ -173,15 +185,131 @@ static int benchmark_chunk_case(const char* kind, uint16_t* grid, uint32_t size,
     return 0;
 }
 
+#define LZ_RECORDED_FRAMES 12
+
+typedef struct {
+    uint8_t* data;
+    size_t len;
+} RecordedFrame;
+
+// Record world-state and keyframe-chunk payloads from a running simulation.
+static int record_frames(int width, int height, bool chunks, RecordedFrame* frames, int* count) {
+    Server* server = server_create_headless(width, height, 2);
+    if (!server) return 1;
+    rng_seed(4242);
+    world_init_random_colonies(server->world, 48);
+
+    *count = 0;
+    uint32_t cells = (uint32_t)(width * height);
+    for (int tick = 0; *count < LZ_RECORDED_FRAMES; tick++) {
+        simulation_tick(server->world);
+        if (tick < 20 || tick % 4 != 0) {
+            continue;
+        }
+
+        uint8_t* buf = NULL;
+        size_t len = 0;
+        if (chunks) {
+            uint32_t* grid = (uint32_t*)malloc(MAX_GRID_CHUNK_CELLS * sizeof(uint32_t));
+            if (!grid) break;
+            uint32_t start = (uint32_t)(*count % 4) * MAX_GRID_CHUNK_CELLS % cells;
+            for (uint32_t i = 0; i < MAX_GRID_CHUNK_CELLS; i++) {
+                grid[i] = (uint32_t)server->world->cells[(start + i) % cells].colony_id;
+            }
+            ProtoWorldDeltaGridChunk chunk;
+            proto_world_delta_grid_chunk_init(&chunk);
+            chunk.tick = server->world->tick;
+            chunk.width = (uint32_t)width;
+            chunk.height = (uint32_t)height;
+            chunk.total_cells = cells;
+            chunk.start_index = 0;
+            chunk.cell_count = MAX_GRID_CHUNK_CELLS;
+            chunk.final_chunk = false;
+            chunk.cells = grid;
+            int rc = protocol_serialize_world_delta_grid_chunk(&chunk, &buf, &len);
+            free(grid);
+            if (rc != 0) break;
+        } else {
+            ProtoWorld snapshot;
+            if (server_build_protocol_world_snapshot(server->world, false, 1.0f, &snapshot) != 0) break;
+            int rc = protocol_serialize_world_state(&snapshot, &buf, &len);
+            proto_world_free(&snapshot);
+            if (rc != 0) break;
+        }
+        frames[*count].data = buf;
+        frames[*count].len = len;
+        (*count)++;
+    }
+
+    server_destroy(server);
+    return *count == LZ_RECORDED_FRAMES ? 0 : 1;
+}
+
+static int benchmark_lz_case(const char* kind, int width, int height, bool chunks, int repeats) {
+    RecordedFrame frames[LZ_RECORDED_FRAMES];
+    int count = 0;
+    int rc = record_frames(width, height, chunks, frames, &count);
+
+    size_t raw_total = 0;
+    size_t max_len = 0;
+    for (int f = 0; f < count; f++) {
+        raw_total += frames[f].len;
+        if (frames[f].len > max_len) max_len = frames[f].len;
+    }
+    uint8_t* packed = (uint8_t*)malloc(lz_compress_bound(max_len));
+    uint8_t* decoded = (uint8_t*)malloc(max_len);
+    if (rc != 0 || !packed || !decoded) {
+        rc = 1;
+    }
+
+    uint64_t comp_ns = 0;
+    uint64_t decomp_ns = 0;
+    size_t packed_total = 0;
+    for (int r = 0; r < repeats && rc == 0; r++) {
+        for (int f = 0; f < count; f++) {
+            uint64_t t0 = now_ns();
+            size_t packed_len = lz_compress(frames[f].data, frames[f].len, packed, lz_compress_bound(max_len));
+            uint64_t t1 = now_ns();
+            if (packed_len == 0 || lz_decompress(packed, packed_len, decoded, frames[f].len) != 0 ||
+                memcmp(decoded, frames[f].data, frames[f].len) != 0) {
+                rc = 1;
+                break;
+            }
+            uint64_t t2 = now_ns();
+            comp_ns += t1 - t0;
+            decomp_ns += t2 - t1;
+            if (r == 0) packed_total += packed_len;
+        }
+    }
+
+    if (rc == 0) {
+        double mb = (double)raw_total * (double)repeats / (1024.0 * 1024.0);
+        printf("UNIT_PROTOCOL_LZ kind=%s frames=%d avg_bytes=%.0f ratio=%.3f compress_mb_s=%.1f decompress_mb_s=%.1f\n",
+               kind,
+               count,
+               (double)raw_total / (double)count,
+               (double)packed_total / (double)raw_total,
+               comp_ns > 0 ? mb / ((double)comp_ns / 1e9) : 0.0,
+               decomp_ns > 0 ? mb / ((double)decomp_ns / 1e9) : 0.0);
+    }
+
+    for (int f = 0; f < count; f++) {
+        free(frames[f].data);
+    }
+    free(packed);
+    free(decoded);
+    return rc;
+}
+
 int main(void) {
     const uint32_t size_small = 4096;
     const uint32_t size_large = 65536;
     const uint32_t size_chunked = 262144;
     const int repeats = 30;
 
-    uint16_t* small = (uint16_t*)malloc(size_small * sizeof(uint16_t));
-    uint16_t* large = (uint16_t*)malloc(size_large * sizeof(uint16_t));
-    uint16_t* chunked = (uint16_t*)malloc(size_chunked * sizeof(uint16_t));
+    uint32_t* small = (uint32_t*)malloc(size_small * sizeof(uint32_t));
+    uint32_t* large = (uint32_t*)malloc(size_large * sizeof(uint32_t));
+    uint32_t* chunked = (uint32_t*)malloc(size_chunked * sizeof(uint32_t));
     if (!small || !large || !chunked) {
         free(small);
         free(large);
@@ -229,5 +357,29 @@ int main(void) {
     free(small);
     free(large);
     free(chunked);
+
+    // 1M cells in raw and RLE mode: the bulk cell kernels should keep these
+    // near memory bandwidth
+    const uint32_t size_huge = 1024u * 1024u;
+    uint32_t* huge = (uint32_t*)malloc(size_huge * sizeof(uint32_t));
+    if (!huge) {
+        return 1;
+    }
+    fill_distinct(huge, size_huge);
+    if (benchmark_case("distinct_1m", huge, size_huge, 10) != 0) {
+        free(huge);
+        return 1;
+    }
+    fill_sparse(huge, size_huge);
+    if (benchmark_case("sparse_1m", huge, size_huge, 10) != 0) {
+        free(huge);
+        return 1;
+    }
+    free(huge);
+
+    if (benchmark_lz_case("world_state", 400, 200, false, repeats) != 0 ||
+        benchmark_lz_case("grid_chunk", 512, 512, true, repeats) != 0) {
+        return 1;
+    }
     return 0;
 }
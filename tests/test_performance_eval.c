@@ -21,6 +21,8 @@
 #include "../src/server/server.h"
 #include "../src/server/threadpool.h"
 #include "../src/server/atomic_sim.h"
+#include "../src/server/cpu_topology.h"
+#include "../src/server/grid_alloc.h"
 
 // Test framework
 static int tests_passed = 0;
@@ -188,7 +190,7 @@ TEST(protocol_world_serialize_deserialize_throughput) {
     }
 
     for (uint32_t i = 0; i < world.grid_size; i++) {
-        world.grid[i] = (uint16_t)((i % 19 == 0) ? (i % world.colony_count) + 1 : 0);
+        world.grid[i] = (uint32_t)((i % 19 == 0) ? (i % world.colony_count) + 1 : 0);
     }
 
     size_t total_bytes = 0;
@@ -249,7 +251,7 @@ TEST(protocol_world_path_breakdown_eval) {
     }
 
     for (uint32_t i = 0; i < world.grid_size; i++) {
-        world.grid[i] = (uint16_t)((i % 17 == 0) ? (i % world.colony_count) + 1 : 0);
+        world.grid[i] = (uint32_t)((i % 17 == 0) ? (i % world.colony_count) + 1 : 0);
     }
 
     uint8_t* encoded = NULL;
@@ -572,10 +574,22 @@ TEST(atomic_tick_phase_breakdown_eval) {
     double serial_ms = 0.0;
     double sync_from_ms = 0.0;
     double total_ms = 0.0;
+    uint64_t barrier_spins = 0;
+    uint64_t barrier_parks = 0;
+    double worker_busy_ms[ATOMIC_BREAKDOWN_MAX_WORKERS] = {0};
+    double worker_idle_ms[ATOMIC_BREAKDOWN_MAX_WORKERS] = {0};
+    int worker_count = 0;
 
     for (int i = 0; i < ticks; i++) {
         AtomicTickBreakdown breakdown;
         atomic_tick_with_breakdown(aworld, &breakdown);
+        barrier_spins += breakdown.barrier_spin_waits;
+        barrier_parks += breakdown.barrier_park_waits;
+        worker_count = breakdown.worker_count;
+        for (int w = 0; w < breakdown.worker_count; w++) {
+            worker_busy_ms[w] += breakdown.worker_busy_ms[w];
+            worker_idle_ms[w] += breakdown.worker_idle_ms[w];
+        }
         age_ms += breakdown.age_ms;
         spread_ms += breakdown.spread_ms;
         sync_to_ms += breakdown.sync_to_world_ms;
@@ -604,6 +618,28 @@ TEST(atomic_tick_phase_breakdown_eval) {
                sync_from_ms * 100.0 / total_ms,
                overhead_ms * 100.0 / total_ms);
     }
+    if (barrier_spins + barrier_parks > 0) {
+        printf("    [perf] phase barrier waits: spin=%llu park=%llu (%.1f%% spun)\n",
+               (unsigned long long)barrier_spins,
+               (unsigned long long)barrier_parks,
+               (double)barrier_spins * 100.0 / (double)(barrier_spins + barrier_parks));
+    }
+    if (worker_count > 0) {
+        double busy_min = worker_busy_ms[0];
+        double busy_max = worker_busy_ms[0];
+        double idle_sum = 0.0;
+        for (int w = 0; w < worker_count; w++) {
+            if (worker_busy_ms[w] < busy_min) busy_min = worker_busy_ms[w];
+            if (worker_busy_ms[w] > busy_max) busy_max = worker_busy_ms[w];
+            idle_sum += worker_idle_ms[w];
+        }
+        printf("    [perf] phase workers: %d busy min=%.3fms max=%.3fms (imbalance %.2fx) idle avg=%.3fms/tick\n",
+               worker_count,
+               busy_min / (double)ticks,
+               busy_max / (double)ticks,
+               busy_min > 0.0 ? busy_max / busy_min : 0.0,
+               idle_sum / (double)(worker_count * ticks));
+    }
 
     ASSERT(total_ms > 0.0, "atomic phase timing must be positive");
     ASSERT(sync_to_ms > 0.0 && sync_from_ms > 0.0, "atomic sync timings must be positive");
@@ -781,6 +817,101 @@ TEST(threadpool_worker_follow_on_submit_eval) {
     threadpool_destroy(pool);
 }
 
+typedef struct {
+    uint64_t* data;
+    size_t words;
+    int cpu;
+    bool touch;
+    double elapsed_ms;
+    uint64_t checksum;
+} PerfNumaAccessArgs;
+
+static void* perf_numa_access_thread(void* arg) {
+    PerfNumaAccessArgs* args = (PerfNumaAccessArgs*)arg;
+    if (ferox_pin_current_thread(args->cpu) != 0) {
+        args->elapsed_ms = -1.0;
+        return NULL;
+    }
+
+    if (args->touch) {
+        for (size_t i = 0; i < args->words; i++) {
+            args->data[i] = (uint64_t)i;
+        }
+        return NULL;
+    }
+
+    uint64_t sum = 0;
+    double start = now_ms();
+    for (int pass = 0; pass < 4; pass++) {
+        for (size_t i = 0; i < args->words; i += 8) {
+            sum += args->data[i];
+        }
+    }
+    args->elapsed_ms = now_ms() - start;
+    args->checksum = sum;
+    return NULL;
+}
+
+static double perf_numa_run_on(int cpu, uint64_t* data, size_t words, bool touch) {
+    PerfNumaAccessArgs args = {
+        .data = data,
+        .words = words,
+        .cpu = cpu,
+        .touch = touch,
+        .elapsed_ms = 0.0,
+        .checksum = 0,
+    };
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, perf_numa_access_thread, &args) != 0) {
+        return -1.0;
+    }
+    pthread_join(thread, NULL);
+    return args.elapsed_ms;
+}
+
+TEST(numa_local_remote_access_eval) {
+    FeroxCpuTopology topo;
+    ASSERT_EQ(ferox_cpu_topology_detect(&topo), 0);
+
+    if (topo.node_count < 2) {
+        printf("\n    [perf] numa local/remote: skipped (%d node%s, %s topology)\n",
+               topo.node_count, topo.node_count == 1 ? "" : "s",
+               topo.from_sysfs ? "sysfs" : "fallback");
+        return;
+    }
+
+    const int scale = get_perf_scale();
+    size_t words = (size_t)(8u << 20) * (size_t)scale;  // 64 MiB per scale step
+    // Same allocator as the atomic grid, so the line reflects the backing
+    // (and page size) that FEROX_HUGEPAGES actually produced on this host.
+    uint64_t* data = (uint64_t*)ferox_grid_calloc(words, sizeof(uint64_t));
+    ASSERT_NOT_NULL(data);
+    const char* backing = ferox_grid_backing_name(data);
+    size_t page_kib = ferox_grid_page_size(data) / 1024;
+
+    int local_cpu = topo.cpus[0];
+    int remote_cpu = topo.cpus[topo.cpu_count - 1];
+
+    // First touch from node 0, then stream it from node 0 and the last node.
+    perf_numa_run_on(local_cpu, data, words, true);
+    double local_ms = perf_numa_run_on(local_cpu, data, words, false);
+    double remote_ms = perf_numa_run_on(remote_cpu, data, words, false);
+    ferox_grid_free(data);
+
+    if (local_ms < 0.0 || remote_ms < 0.0) {
+        printf("\n    [perf] numa local/remote: skipped (pinning refused)\n");
+        return;
+    }
+
+    // One load per cacheline, so every line of the buffer crosses the bus each pass.
+    double bytes = (double)words * sizeof(uint64_t) * 4.0;
+    printf("\n    [perf] numa stream node%d->node%d (%s, %zu KiB pages): local=%.2f ms (%.2f GB/s) remote=%.2f ms (%.2f GB/s) remote/local=%.2fx\n",
+           topo.cpu_node[0], topo.cpu_node[topo.cpu_count - 1], backing, page_kib,
+           local_ms, local_ms > 0.0 ? bytes / (local_ms * 1.0e6) : 0.0,
+           remote_ms, remote_ms > 0.0 ? bytes / (remote_ms * 1.0e6) : 0.0,
+           local_ms > 0.0 ? remote_ms / local_ms : 0.0);
+}
+
 int run_performance_eval_tests(void) {
     tests_passed = 0;
     tests_failed = 0;
@@ -802,6 +933,7 @@ int run_performance_eval_tests(void) {
     RUN_TEST(threadpool_task_throughput);
     RUN_TEST(threadpool_granularity_eval);
     RUN_TEST(threadpool_worker_follow_on_submit_eval);
+    RUN_TEST(numa_local_remote_access_eval);
 
     printf("\n--- Performance Eval Results ---\n");
     printf("Passed: %d\n", tests_passed);
@@ -501,7 +501,7 @@ static void fill_proto_world_grid(ProtoWorld* world, bool noisy) {
     uint32_t size = world->width * world->height;
     for (uint32_t i = 0; i < size; i++) {
         if (noisy) {
-            world->grid[i] = (uint16_t)((i * 131u) & 0x00FFu);
+            world->grid[i] = (uint32_t)((i * 131u) & 0x00FFu);
         } else {
             world->grid[i] = (i % 80u == 0u) ? 5u : 0u;
         }
@@ -307,6 +307,81 @@ int test_server_accepts_client_connection(void) {
     return 0;
 }
 
+// Client that sends two commands and waits for the status reply
+static void* client_pause_thread(void* arg) {
+    ClientTestData* data = (ClientTestData*)arg;
+
+    usleep(100000);  // 100ms
+    NetSocket* socket = net_client_connect("127.0.0.1", data->port);
+    if (!socket) {
+        return NULL;
+    }
+    data->connected = 1;
+
+    // Clearing the selection is answered with a command status; pause is not
+    uint8_t buffer[64];
+    CommandSelectColony clear = { .colony_id = 0 };
+    int select_len = protocol_serialize_command(CMD_SELECT_COLONY, &clear, buffer);
+    bool sent = select_len > 0 &&
+                protocol_send_message(socket->fd, MSG_COMMAND, buffer, (size_t)select_len) == 0;
+    int len = protocol_serialize_command(CMD_PAUSE, NULL, buffer);
+    if (sent && len > 0 && protocol_send_message(socket->fd, MSG_COMMAND, buffer, (size_t)len) == 0) {
+        // Skip world traffic until the server reacts; the select bounds the wait
+        for (int i = 0; i < 200 && !data->received_world_state; i++) {
+            fd_set readfds;
+            struct timeval tv = { .tv_sec = 1, .tv_usec = 0 };
+            FD_ZERO(&readfds);
+            FD_SET(socket->fd, &readfds);
+            if (select(socket->fd + 1, &readfds, NULL, NULL, &tv) <= 0) {
+                break;
+            }
+            MessageHeader header;
+            uint8_t* payload = NULL;
+            if (protocol_recv_message(socket->fd, &header, &payload) < 0) {
+                break;
+            }
+            if (header.type == MSG_ACK) {
+                data->received_world_state = 1;  // Reused as "reply seen"
+            }
+            free(payload);
+        }
+    }
+
+    net_socket_close(socket);
+    return NULL;
+}
+
+// Test: Commands are read by the I/O thread and applied by the simulation loop
+int test_server_io_thread_delivers_commands(void) {
+    Server* server = server_create(0, 50, 50, 2);
+    TEST_ASSERT(server != NULL, "Server should be created");
+    world_init_random_colonies(server->world, 2);
+
+    ClientTestData client_data = {
+        .port = server_get_port(server),
+        .connected = 0,
+        .received_world_state = 0
+    };
+
+    pthread_t client_thread;
+    pthread_create(&client_thread, NULL, client_pause_thread, &client_data);
+    ServerRunData run_data = { .server = server, .duration_ms = 800 };
+    pthread_t stopper_thread;
+    pthread_create(&stopper_thread, NULL, run_server_briefly, &run_data);
+
+    server_run(server);
+
+    pthread_join(client_thread, NULL);
+    pthread_join(stopper_thread, NULL);
+
+    TEST_ASSERT_EQ(client_data.connected, 1, "Client should have connected");
+    TEST_ASSERT_EQ(server->paused, true, "Pause command should reach the simulation");
+    TEST_ASSERT_EQ(client_data.received_world_state, 1, "Command status should be sent back");
+
+    server_destroy(server);
+    return 0;
+}
+
 // Test: NULL handling for all server functions
 int test_server_functions_handle_null_safely(void) {
     // All these should not crash
@@ -378,6 +453,7 @@ int main(void) {
     // Integration tests
     printf("\n--- Integration Tests ---\n");
     RUN_TEST(test_server_accepts_client_connection);
+    RUN_TEST(test_server_io_thread_delivers_commands);
     
     // Edge case tests
     printf("\n--- Edge Case Tests ---\n");
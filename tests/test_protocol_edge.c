@@ -10,6 +10,11 @@
 #include <math.h>
 
 #include "../src/shared/protocol.h"
+#include "../src/shared/frame_reader.h"
+#include "../src/shared/lz.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
 
 // Test framework
 static int tests_passed = 0;
@@ -290,11 +295,11 @@ TEST(world_delta_grid_chunk_roundtrip) {
     chunk.start_index = 65536u;
     chunk.cell_count = 1024u;
     chunk.final_chunk = false;
-    chunk.cells = (uint16_t*)malloc((size_t)chunk.cell_count * sizeof(uint16_t));
+    chunk.cells = (uint32_t*)malloc((size_t)chunk.cell_count * sizeof(uint32_t));
     ASSERT_NOT_NULL(chunk.cells);
 
     for (uint32_t i = 0; i < chunk.cell_count; i++) {
-        chunk.cells[i] = (uint16_t)((i * 17u) & 0xFFFFu);
+        chunk.cells[i] = (uint32_t)((i * 17u) & 0xFFFFu);
     }
 
     uint8_t* buffer = NULL;
@@ -324,7 +329,7 @@ TEST(world_delta_grid_chunk_roundtrip) {
 }
 
 TEST(world_delta_grid_chunk_wire_format) {
-    uint16_t cells[] = {1u, 256u, 513u};
+    uint32_t cells[] = {1u, 256u, 513u};
     ProtoWorldDeltaGridChunk chunk;
     proto_world_delta_grid_chunk_init(&chunk);
     chunk.tick = 0x01020304u;
@@ -381,7 +386,7 @@ TEST(world_delta_grid_chunk_rejects_invalid_bounds) {
     chunk.start_index = chunk.total_cells - 4u;
     chunk.cell_count = 8u;
     chunk.final_chunk = true;
-    chunk.cells = (uint16_t*)calloc((size_t)chunk.cell_count, sizeof(uint16_t));
+    chunk.cells = (uint32_t*)calloc((size_t)chunk.cell_count, sizeof(uint32_t));
     ASSERT_NOT_NULL(chunk.cells);
 
     uint8_t* buffer = NULL;
@@ -531,6 +536,36 @@ TEST(spawn_colony_command) {
     ASSERT(fabsf(deserialized.y - 789.012f) < 0.001f, "Y should match");
 }
 
+TEST(set_viewport_command_roundtrip) {
+    CommandSetViewport data = { .x = 7, .y = 70000, .width = 320, .height = 0, .level = 3 };
+    uint8_t buffer[64];
+
+    int size = protocol_serialize_command(CMD_SET_VIEWPORT, &data, buffer);
+    ASSERT_EQ(size, 24);
+
+    CommandType cmd;
+    CommandSetViewport deserialized;
+    ASSERT_EQ(protocol_deserialize_command(buffer, &cmd, &deserialized), 24);
+    ASSERT_EQ(cmd, CMD_SET_VIEWPORT);
+    ASSERT_EQ(deserialized.x, 7u);
+    ASSERT_EQ(deserialized.y, 70000u);
+    ASSERT_EQ(deserialized.width, 320u);
+    ASSERT_EQ(deserialized.height, 0u);
+    ASSERT_EQ(deserialized.level, 3u);
+}
+
+TEST(grid_level_dims_round_up_and_identify_level) {
+    ASSERT_EQ(proto_grid_level_dim(400, 0), 400u);
+    ASSERT_EQ(proto_grid_level_dim(400, 3), 50u);
+    ASSERT_EQ(proto_grid_level_dim(401, 3), 51u);
+    ASSERT_EQ(proto_grid_level_dim(1, PROTO_GRID_MAX_LEVEL), 1u);
+
+    ASSERT_EQ(proto_grid_level_for_dims(400, 200, 400, 200), 0);
+    ASSERT_EQ(proto_grid_level_for_dims(400, 201, 100, 51), 2);
+    ASSERT_EQ(proto_grid_level_for_dims(400, 200, 100, 51), -1);
+    ASSERT_EQ(proto_grid_level_for_dims(400, 200, 3, 2), -1);
+}
+
 TEST(command_wire_examples_match_spec) {
     uint8_t pause_buffer[4];
     uint8_t expected_pause[] = {0x00, 0x00, 0x00, 0x00};
@@ -662,7 +697,7 @@ TEST(world_state_without_grid_uses_fixed_prefix) {
 }
 
 TEST(grid_rle_raw_mode_roundtrip) {
-    uint16_t grid[] = {1u, 2u, 3u, 4u, 5u, 6u};
+    uint32_t grid[] = {1u, 2u, 3u, 4u, 5u, 6u};
     uint8_t* buffer = NULL;
     size_t len = 0;
     int result = protocol_serialize_grid_rle(grid, 6u, &buffer, &len);
@@ -670,7 +705,7 @@ TEST(grid_rle_raw_mode_roundtrip) {
     ASSERT_NOT_NULL(buffer);
     ASSERT_EQ(buffer[4], 1);
 
-    uint16_t decoded[6] = {0};
+    uint32_t decoded[6] = {0};
     result = protocol_deserialize_grid_rle(buffer, len, decoded, 6u);
     ASSERT_EQ(result, 0);
     for (size_t i = 0; i < 6; i++) {
@@ -680,16 +715,335 @@ TEST(grid_rle_raw_mode_roundtrip) {
     free(buffer);
 }
 
+TEST(grid_cell_kernels_cover_tails_and_16bit_extremes) {
+    // Raw chunks exercise the vector narrow/swap paths and their scalar tails
+    static const uint32_t extremes[] = {0u, 1u, 0x7FFFu, 0x8000u, 0x8001u, 0xFFFFu, 0x1234u};
+    uint32_t cells[19];
+    for (uint32_t count = 1; count <= 19u; count++) {
+        for (uint32_t i = 0; i < count; i++) {
+            cells[i] = extremes[(i * 3u + count) % 7u];
+        }
+        ProtoWorldDeltaGridChunk chunk = {
+            .tick = 1u, .width = 19u, .height = 1u, .total_cells = 19u,
+            .start_index = 0u, .cell_count = count, .final_chunk = true, .cells = cells,
+        };
+        uint8_t* buffer = NULL;
+        size_t len = 0;
+        ASSERT_EQ(protocol_serialize_world_delta_grid_chunk(&chunk, &buffer, &len), 0);
+        if (buffer[0] == (uint8_t)PROTO_WORLD_DELTA_GRID_CHUNK) {
+            size_t first = len - (size_t)count * 2u;
+            ASSERT_EQ(buffer[first], (uint8_t)(cells[0] >> 8));
+            ASSERT_EQ(buffer[first + 1u], (uint8_t)cells[0]);
+        }
+        ProtoWorldDeltaGridChunk decoded;
+        proto_world_delta_grid_chunk_init(&decoded);
+        ASSERT_EQ(protocol_deserialize_world_delta_grid_chunk(buffer, len, &decoded), 0);
+        ASSERT_EQ(memcmp(decoded.cells, cells, (size_t)count * sizeof(uint32_t)), 0);
+        proto_world_delta_grid_chunk_free(&decoded);
+        free(buffer);
+    }
+
+    // Runs ending at every lane offset, plus one that needs two uint16 RLE counts
+    uint32_t size = 70000u + 37u;
+    uint32_t* grid = (uint32_t*)malloc((size_t)size * sizeof(uint32_t));
+    uint32_t* decoded = (uint32_t*)malloc((size_t)(size + 5u) * sizeof(uint32_t));
+    ASSERT_NOT_NULL(grid);
+    ASSERT_NOT_NULL(decoded);
+    uint32_t i = 0;
+    for (uint32_t run = 1; i < 37u; run++) {
+        for (uint32_t k = 0; k < run && i < 37u; k++) {
+            grid[i++] = 0xFFFFu - run;
+        }
+    }
+    for (; i < size; i++) {
+        grid[i] = 0x8000u;
+    }
+    uint8_t* buffer = NULL;
+    size_t len = 0;
+    ASSERT_EQ(protocol_serialize_grid_rle(grid, size, &buffer, &len), 0);
+    ASSERT_EQ(buffer[4], PROTO_GRID_MODE_RLE);
+    memset(decoded, 0xAB, (size_t)(size + 5u) * sizeof(uint32_t));
+    ASSERT_EQ(protocol_deserialize_grid_rle(buffer, len, decoded, size + 5u), 0);
+    ASSERT_EQ(memcmp(decoded, grid, (size_t)size * sizeof(uint32_t)), 0);
+    for (uint32_t k = size; k < size + 5u; k++) {
+        ASSERT_EQ(decoded[k], 0u);
+    }
+    free(buffer);
+    free(decoded);
+    free(grid);
+}
+
 TEST(grid_rle_rejects_unknown_mode) {
     uint8_t buffer[] = {
         0x00, 0x00, 0x00, 0x04,
-        0x02,
+        0x04,
         0x00, 0x01, 0x00, 0x02,
     };
-    uint16_t decoded[4] = {0};
+    uint32_t decoded[4] = {0};
     ASSERT_EQ(protocol_deserialize_grid_rle(buffer, sizeof(buffer), decoded, 4u), -1);
 }
 
+static int grid_codec_roundtrip(const uint32_t* grid, uint32_t size, uint8_t expected_mode, size_t* encoded_len) {
+    uint8_t* buffer = NULL;
+    size_t len = 0;
+    if (protocol_serialize_grid_rle(grid, size, &buffer, &len) != 0) {
+        return -1;
+    }
+    uint32_t* decoded = (uint32_t*)calloc(size, sizeof(uint32_t));
+    int result = decoded && buffer[4] == expected_mode &&
+                 protocol_deserialize_grid_rle(buffer, len, decoded, size) == 0 &&
+                 memcmp(decoded, grid, (size_t)size * sizeof(uint32_t)) == 0 ? 0 : -1;
+    *encoded_len = len;
+    free(decoded);
+    free(buffer);
+    return result;
+}
+
+TEST(grid_palette_modes_pick_smallest_and_roundtrip) {
+    const uint32_t size = 65536u;
+    uint32_t* grid = (uint32_t*)malloc(size * sizeof(uint32_t));
+    ASSERT_NOT_NULL(grid);
+    size_t len = 0;
+
+    // Five interleaved colonies: 3-bit indices beat both RLE and raw
+    uint32_t state = 12345u;
+    for (uint32_t i = 0; i < size; i++) {
+        state = state * 1103515245u + 12345u;
+        grid[i] = (uint32_t)(100u + ((state >> 16) % 5u));
+    }
+    ASSERT_EQ(grid_codec_roundtrip(grid, size, PROTO_GRID_MODE_PALETTE, &len), 0);
+    ASSERT_EQ(len, (size_t)(5 + 2 + 5 * 2 + (size * 3u) / 8u));
+
+    // Long runs of a few ids: one index byte plus a short varint per run
+    for (uint32_t i = 0; i < size; i++) {
+        grid[i] = (uint32_t)((i / 300u) % 3u == 0 ? 0u : 7u + (i / 300u) % 3u);
+    }
+    ASSERT_EQ(grid_codec_roundtrip(grid, size, PROTO_GRID_MODE_PALETTE_RLE, &len), 0);
+
+    // One colony everywhere needs no index bits at all
+    for (uint32_t i = 0; i < size; i++) {
+        grid[i] = 42u;
+    }
+    ASSERT_EQ(grid_codec_roundtrip(grid, size, PROTO_GRID_MODE_PALETTE, &len), 0);
+    ASSERT_EQ(len, (size_t)9);
+
+    // More distinct ids than the palette holds falls back to raw
+    for (uint32_t i = 0; i < size; i++) {
+        grid[i] = (uint32_t)(i % 1000u);
+    }
+    ASSERT_EQ(grid_codec_roundtrip(grid, size, PROTO_GRID_MODE_RAW, &len), 0);
+
+    free(grid);
+}
+
+TEST(grid_codec_widens_ids_only_when_needed) {
+    const uint32_t size = 4096u;
+    uint32_t* grid = (uint32_t*)malloc(size * sizeof(uint32_t));
+    ASSERT_NOT_NULL(grid);
+    size_t len = 0;
+
+    // Ids past 16 bits: palette entries become varints (70000 takes 3 bytes)
+    uint32_t state = 777u;
+    for (uint32_t i = 0; i < size; i++) {
+        state = state * 1103515245u + 12345u;
+        grid[i] = (state >> 16) % 2u ? 70000u : 5u;
+    }
+    ASSERT_EQ(grid_codec_roundtrip(grid, size, PROTO_GRID_MODE_PALETTE | PROTO_GRID_MODE_WIDE, &len), 0);
+    ASSERT_EQ(len, (size_t)(5 + 2 + 3 + 1 + size / 8u));
+
+    // Long runs of one wide id
+    for (uint32_t i = 0; i < size; i++) {
+        grid[i] = i < size / 2u ? 0u : 0x00FFFFFFu;
+    }
+    ASSERT_EQ(grid_codec_roundtrip(grid, size, PROTO_GRID_MODE_RLE | PROTO_GRID_MODE_WIDE, &len), 0);
+
+    // Too many distinct wide ids for a palette: raw varints
+    for (uint32_t i = 0; i < size; i++) {
+        grid[i] = 65536u + i;
+    }
+    ASSERT_EQ(grid_codec_roundtrip(grid, size, PROTO_GRID_MODE_RAW | PROTO_GRID_MODE_WIDE, &len), 0);
+    ASSERT_EQ(len, (size_t)(5 + size * 3u));
+
+    // The same grid shifted under 16 bits is encoded exactly as before
+    for (uint32_t i = 0; i < size; i++) {
+        grid[i] = i;
+    }
+    ASSERT_EQ(grid_codec_roundtrip(grid, size, PROTO_GRID_MODE_RAW, &len), 0);
+    ASSERT_EQ(len, (size_t)(5 + size * 2u));
+
+    free(grid);
+}
+
+TEST(grid_palette_rejects_out_of_range_indices) {
+    // Three-entry palette (2 bits) whose packed byte holds index 3
+    uint8_t packed[] = {
+        0x00, 0x00, 0x00, 0x02,
+        0x02,
+        0x00, 0x03, 0x00, 0x01, 0x00, 0x02, 0x00, 0x03,
+        0x0F,
+    };
+    uint32_t decoded[2] = {0};
+    ASSERT_EQ(protocol_deserialize_grid_rle(packed, sizeof(packed), decoded, 2u), -1);
+    packed[13] = 0x09;
+    ASSERT_EQ(protocol_deserialize_grid_rle(packed, sizeof(packed), decoded, 2u), 0);
+    ASSERT_EQ(decoded[0], 2u);
+    ASSERT_EQ(decoded[1], 3u);
+
+    // Run past the declared size
+    uint8_t runs[] = {
+        0x00, 0x00, 0x00, 0x04,
+        0x03,
+        0x00, 0x01, 0x00, 0x05,
+        0x00, 0x05,
+    };
+    uint32_t run_decoded[4] = {0};
+    ASSERT_EQ(protocol_deserialize_grid_rle(runs, sizeof(runs), run_decoded, 4u), -1);
+    runs[10] = 0x04;
+    ASSERT_EQ(protocol_deserialize_grid_rle(runs, sizeof(runs), run_decoded, 4u), 0);
+    ASSERT_EQ(run_decoded[3], 5u);
+}
+
+TEST(world_delta_grid_chunk_packs_few_colony_chunks) {
+    ProtoWorldDeltaGridChunk chunk;
+    proto_world_delta_grid_chunk_init(&chunk);
+    chunk.tick = 9;
+    chunk.width = 256;
+    chunk.height = 256;
+    chunk.total_cells = 256u * 256u;
+    chunk.start_index = 0;
+    chunk.cell_count = MAX_GRID_CHUNK_CELLS;
+    chunk.final_chunk = true;
+    chunk.cells = (uint32_t*)malloc((size_t)chunk.cell_count * sizeof(uint32_t));
+    ASSERT_NOT_NULL(chunk.cells);
+    for (uint32_t i = 0; i < chunk.cell_count; i++) {
+        chunk.cells[i] = (uint32_t)((i * 2654435761u) >> 30);
+    }
+
+    uint8_t* buffer = NULL;
+    size_t len = 0;
+    ASSERT_EQ(protocol_serialize_world_delta_grid_chunk(&chunk, &buffer, &len), 0);
+    ASSERT_EQ(buffer[0], (uint8_t)PROTO_WORLD_DELTA_GRID_CHUNK_PACKED);
+    ASSERT_TRUE(len * 7 < (size_t)chunk.cell_count * sizeof(uint16_t));
+
+    ProtoWorldDeltaGridChunk decoded;
+    proto_world_delta_grid_chunk_init(&decoded);
+    ASSERT_EQ(protocol_deserialize_world_delta_grid_chunk(buffer, len, &decoded), 0);
+    ASSERT_EQ(decoded.cell_count, chunk.cell_count);
+    ASSERT_EQ(decoded.final_chunk, true);
+    ASSERT_EQ(memcmp(decoded.cells, chunk.cells, (size_t)chunk.cell_count * sizeof(uint32_t)), 0);
+
+    free(buffer);
+    proto_world_delta_grid_chunk_free(&decoded);
+    proto_world_delta_grid_chunk_free(&chunk);
+}
+
+static int lz_roundtrip(const uint8_t* src, size_t len, size_t* packed_len) {
+    size_t bound = lz_compress_bound(len);
+    uint8_t* packed = (uint8_t*)malloc(bound);
+    uint8_t* decoded = (uint8_t*)malloc(len > 0 ? len : 1);
+    int result = -1;
+    if (packed && decoded) {
+        *packed_len = lz_compress(src, len, packed, bound);
+        if (*packed_len > 0 && lz_decompress(packed, *packed_len, decoded, len) == 0 &&
+            memcmp(decoded, src, len) == 0) {
+            result = 0;
+        }
+    }
+    free(packed);
+    free(decoded);
+    return result;
+}
+
+TEST(lz_roundtrips_literals_runs_and_long_matches) {
+    const size_t len = 70000;
+    uint8_t* data = (uint8_t*)malloc(len);
+    ASSERT_NOT_NULL(data);
+    size_t packed_len = 0;
+
+    ASSERT_EQ(lz_roundtrip(data, 0, &packed_len), 0);
+    ASSERT_EQ(packed_len, (size_t)1);
+
+    // Incompressible input stays within the bound
+    uint32_t state = 99u;
+    for (size_t i = 0; i < len; i++) {
+        state = state * 1664525u + 1013904223u;
+        data[i] = (uint8_t)(state >> 24);
+    }
+    ASSERT_EQ(lz_roundtrip(data, len, &packed_len), 0);
+    ASSERT_LE(packed_len, lz_compress_bound(len));
+
+    // One byte repeated: overlapping offset-1 matches with long length runs
+    memset(data, 0x5A, len);
+    ASSERT_EQ(lz_roundtrip(data, len, &packed_len), 0);
+    ASSERT_TRUE(packed_len < 400);
+
+    // Repeating record stream, like a colony table
+    for (size_t i = 0; i < len; i++) {
+        data[i] = (uint8_t)((i % 83u) * 3u + (i / 4096u));
+    }
+    ASSERT_EQ(lz_roundtrip(data, len, &packed_len), 0);
+    ASSERT_TRUE(packed_len * 10 < len);
+
+    free(data);
+}
+
+TEST(lz_rejects_malformed_blocks) {
+    uint8_t out[32];
+    // Match offset reaches before the start of the output
+    const uint8_t bad_offset[] = { 0x10, 'a', 0x05, 0x00, 0x00 };
+    ASSERT_EQ(lz_decompress(bad_offset, sizeof(bad_offset), out, 5), -1);
+    // Literal count runs past the input
+    const uint8_t truncated[] = { 0x50, 'a', 'b' };
+    ASSERT_EQ(lz_decompress(truncated, sizeof(truncated), out, 5), -1);
+    // Valid block but the wrong expected size
+    const uint8_t literals[] = { 0x30, 'a', 'b', 'c' };
+    ASSERT_EQ(lz_decompress(literals, sizeof(literals), out, 4), -1);
+    ASSERT_EQ(lz_decompress(literals, sizeof(literals), out, 3), 0);
+    // Offset 1 match of 4 after a literal expands to five copies
+    const uint8_t run[] = { 0x10, 'z', 0x01, 0x00, 0x00 };
+    ASSERT_EQ(lz_decompress(run, sizeof(run), out, 5), 0);
+    ASSERT_EQ(memcmp(out, "zzzzz", 5), 0);
+}
+
+TEST(frame_compressed_twin_unpacks_to_original) {
+    const size_t len = 4096;
+    uint8_t* payload = (uint8_t*)malloc(len);
+    ASSERT_NOT_NULL(payload);
+    for (size_t i = 0; i < len; i++) {
+        payload[i] = (uint8_t)(i % 40u);
+    }
+    ProtoFrame* frame = proto_frame_copy(MSG_WORLD_STATE, payload, len);
+    ASSERT_NOT_NULL(frame);
+
+    ProtoFrame* twin = proto_frame_compressed(frame, 512);
+    ASSERT_TRUE(twin != frame);
+    ASSERT_TRUE(twin->payload_len < len / 4);
+    ASSERT_TRUE(proto_frame_compressed(frame, 512) == twin);
+
+    MessageHeader header;
+    ASSERT_EQ(protocol_deserialize_header(twin->header, &header), MESSAGE_HEADER_SIZE);
+    ASSERT_EQ(header.type, (uint16_t)(MSG_WORLD_STATE | MSG_FLAG_COMPRESSED));
+    ASSERT_EQ(header.payload_len, (uint32_t)twin->payload_len);
+
+    uint8_t* unpacked = (uint8_t*)malloc(twin->payload_len);
+    ASSERT_NOT_NULL(unpacked);
+    memcpy(unpacked, twin->payload, twin->payload_len);
+    ASSERT_EQ(protocol_unpack_payload(&header, &unpacked), 0);
+    ASSERT_EQ(header.type, (uint16_t)MSG_WORLD_STATE);
+    ASSERT_EQ(header.payload_len, (uint32_t)len);
+    ASSERT_EQ(memcmp(unpacked, payload, len), 0);
+    free(unpacked);
+
+    // Small payloads are sent as they are
+    ProtoFrame* small = proto_frame_copy(MSG_WORLD_STATE, payload, 100);
+    ASSERT_NOT_NULL(small);
+    ASSERT_TRUE(proto_frame_compressed(small, 512) == small);
+
+    proto_frame_release(small);
+    proto_frame_release(frame);
+    free(payload);
+}
+
 TEST(world_state_with_grid_roundtrip_preserves_cells) {
     ProtoWorld world;
     proto_world_init(&world);
@@ -706,7 +1060,7 @@ TEST(world_state_with_grid_roundtrip_preserves_cells) {
     proto_world_alloc_grid(&world, world.width, world.height);
     ASSERT_NOT_NULL(world.grid);
 
-    uint16_t expected_grid[] = {
+    uint32_t expected_grid[] = {
         0u, 1u, 1u, 0u,
         2u, 2u, 0u, 0u,
         0u, 1u, 2u, 0u,
@@ -751,7 +1105,7 @@ TEST(world_state_with_noisy_grid_roundtrip_preserves_cells) {
     ASSERT_NOT_NULL(world.grid);
 
     for (uint32_t i = 0; i < world.grid_size; i++) {
-        world.grid[i] = (uint16_t)(((i * 131u) & 0x00FFu) + 1u);
+        world.grid[i] = (uint32_t)(((i * 131u) & 0x00FFu) + 1u);
     }
 
     uint8_t* buffer = NULL;
@@ -767,7 +1121,7 @@ TEST(world_state_with_noisy_grid_roundtrip_preserves_cells) {
     ASSERT_EQ(decoded.has_grid, true);
     ASSERT_EQ(decoded.grid_size, world.grid_size);
     ASSERT_NOT_NULL(decoded.grid);
-    ASSERT_BYTES_EQ(decoded.grid, world.grid, world.grid_size * sizeof(uint16_t), "noisy world grid should survive roundtrip");
+    ASSERT_BYTES_EQ(decoded.grid, world.grid, world.grid_size * sizeof(uint32_t), "noisy world grid should survive roundtrip");
 
     free(buffer);
     proto_world_free(&decoded);
@@ -953,6 +1307,484 @@ TEST(colony_detail_roundtrip) {
     ASSERT(fabsf(decoded.trait_learning - detail.trait_learning) < 0.0001f, "learning roundtrip");
 }
 
+TEST(world_delta_spans_wire_format_and_apply) {
+    ProtoGridSpan spans[] = {{4u, 2u}, {30u, 1u}};
+    uint32_t cells[] = {7u, 258u, 3u};
+    ProtoWorldDeltaSpans delta;
+    proto_world_delta_spans_init(&delta);
+    delta.tick = 9u;
+    delta.base_tick = 7u;
+    delta.width = 8u;
+    delta.height = 4u;
+    delta.span_count = 2u;
+    delta.cell_count = 3u;
+    delta.spans = spans;
+    delta.cells = cells;
+
+    uint8_t* buffer = NULL;
+    size_t len = 0;
+    int result = protocol_serialize_world_delta_spans(&delta, &buffer, &len);
+    ASSERT_EQ(result, 0);
+    ASSERT_NOT_NULL(buffer);
+    ASSERT_EQ(len, protocol_world_delta_spans_size(2u, 3u));
+
+    uint8_t expected[] = {
+        0x02,
+        0x00, 0x00, 0x00, 0x09,
+        0x00, 0x00, 0x00, 0x07,
+        0x00, 0x00, 0x00, 0x08,
+        0x00, 0x00, 0x00, 0x04,
+        0x00, 0x00, 0x00, 0x02,
+        0x00, 0x00, 0x00, 0x03,
+        0x00, 0x00, 0x00, 0x04, 0x00, 0x02, 0x00, 0x07, 0x01, 0x02,
+        0x00, 0x00, 0x00, 0x1E, 0x00, 0x01, 0x00, 0x03,
+    };
+    ASSERT_EQ(len, sizeof(expected));
+    ASSERT_BYTES_EQ(buffer, expected, sizeof(expected), "World-delta span bytes should match big-endian wire format");
+
+    ProtoWorldDeltaSpans decoded;
+    proto_world_delta_spans_init(&decoded);
+    result = protocol_deserialize_world_delta_spans(buffer, len, &decoded);
+    ASSERT_EQ(result, 0);
+    ASSERT_EQ(decoded.base_tick, 7u);
+    ASSERT_EQ(decoded.span_count, 2u);
+
+    uint32_t grid[32];
+    memset(grid, 0, sizeof(grid));
+    ASSERT_EQ(proto_world_delta_spans_apply(&decoded, grid, 32u), 0);
+    ASSERT_EQ(grid[4], 7u);
+    ASSERT_EQ(grid[5], 258u);
+    ASSERT_EQ(grid[6], 0u);
+    ASSERT_EQ(grid[30], 3u);
+    ASSERT_EQ(proto_world_delta_spans_apply(&decoded, grid, 16u), -1);
+    proto_world_delta_spans_free(&decoded);
+
+    // Truncated payloads and spans past the grid are rejected
+    ASSERT_EQ(protocol_deserialize_world_delta_spans(buffer, len - 1, &decoded), -1);
+    spans[1].start = 31u;
+    spans[1].length = 2u;
+    delta.cell_count = 4u;
+    uint32_t more_cells[] = {7u, 258u, 3u, 4u};
+    delta.cells = more_cells;
+    uint8_t* bad = NULL;
+    size_t bad_len = 0;
+    ASSERT_EQ(protocol_serialize_world_delta_spans(&delta, &bad, &bad_len), -1);
+
+    free(buffer);
+}
+
+TEST(world_delta_spans_switch_to_varint_ids_for_wide_colonies) {
+    ProtoGridSpan spans[] = {{2u, 3u}};
+    uint32_t cells[] = {1u, 70000u, 300u};
+    ProtoWorldDeltaSpans delta;
+    proto_world_delta_spans_init(&delta);
+    delta.tick = 5u;
+    delta.base_tick = 4u;
+    delta.width = 4u;
+    delta.height = 2u;
+    delta.span_count = 1u;
+    delta.cell_count = 3u;
+    delta.spans = spans;
+    delta.cells = cells;
+
+    uint8_t* buffer = NULL;
+    size_t len = 0;
+    ASSERT_EQ(protocol_serialize_world_delta_spans(&delta, &buffer, &len), 0);
+    uint8_t expected_tail[] = {
+        0x00, 0x00, 0x00, 0x02, 0x00, 0x03,
+        0x01, 0xF0, 0xA2, 0x04, 0xAC, 0x02,
+    };
+    ASSERT_EQ(buffer[0], (uint8_t)PROTO_WORLD_DELTA_GRID_SPANS_WIDE);
+    ASSERT_EQ(len, (size_t)WORLD_DELTA_SPANS_HEADER_SIZE + sizeof(expected_tail));
+    ASSERT_BYTES_EQ(buffer + WORLD_DELTA_SPANS_HEADER_SIZE, expected_tail, sizeof(expected_tail),
+                    "Wide spans carry ids as LEB128 varints");
+
+    ProtoWorldDeltaSpans decoded;
+    proto_world_delta_spans_init(&decoded);
+    ASSERT_EQ(protocol_deserialize_world_delta_spans(buffer, len, &decoded), 0);
+    uint32_t grid[8] = {0};
+    ASSERT_EQ(proto_world_delta_spans_apply(&decoded, grid, 8u), 0);
+    ASSERT_EQ(grid[2], 1u);
+    ASSERT_EQ(grid[3], 70000u);
+    ASSERT_EQ(grid[4], 300u);
+    proto_world_delta_spans_free(&decoded);
+
+    // A varint cut short or a trailing byte is rejected
+    ASSERT_EQ(protocol_deserialize_world_delta_spans(buffer, len - 1, &decoded), -1);
+    uint8_t* padded = (uint8_t*)malloc(len + 1);
+    ASSERT_NOT_NULL(padded);
+    memcpy(padded, buffer, len);
+    padded[len] = 0;
+    ASSERT_EQ(protocol_deserialize_world_delta_spans(padded, len + 1, &decoded), -1);
+    free(padded);
+    free(buffer);
+}
+
+static ProtoColony make_delta_colony(uint32_t id, float x, uint32_t population) {
+    ProtoColony colony;
+    memset(&colony, 0, sizeof(colony));
+    colony.id = id;
+    snprintf(colony.name, sizeof(colony.name), "Colony %u", id);
+    colony.x = x;
+    colony.y = 20.25f;
+    colony.radius = 3.5f;
+    colony.population = population;
+    colony.max_population = 1000u;
+    colony.growth_rate = 0.125f;
+    colony.color_r = 10;
+    colony.color_g = 20;
+    colony.color_b = 30;
+    colony.alive = true;
+    colony.shape_seed = id * 7u;
+    colony.wobble_phase = 1.0f;
+    colony.shape_evolution = 2.5f;
+    return colony;
+}
+
+TEST(colony_delta_roundtrip_and_apply) {
+    ProtoColony colonies[3] = {
+        make_delta_colony(5u, 10.0f, 100u),
+        make_delta_colony(9u, 11.0f, 200u),
+        make_delta_colony(70000u, 12.0f, 300u),
+    };
+    ProtoColonyDescriptor descriptors[3];
+    ProtoColonyDynamic dynamics[3];
+    for (int i = 0; i < 3; i++) {
+        proto_colony_quantize(&colonies[i], &descriptors[i], &dynamics[i]);
+    }
+    ASSERT_EQ(dynamics[0].x, 40u);
+    ASSERT_EQ(dynamics[0].y, 81u);
+    ASSERT_EQ(dynamics[0].growth_rate, 512);
+
+    ProtoColonyDelta full;
+    proto_colony_delta_init(&full);
+    full.tick = 40u;
+    full.full = true;
+    full.total_count = 3u;
+    full.descriptor_count = 3u;
+    full.descriptors = descriptors;
+    full.dynamic_count = 3u;
+    full.dynamics = dynamics;
+
+    uint8_t* buffer = NULL;
+    size_t len = 0;
+    ASSERT_EQ(protocol_serialize_colony_delta(&full, &buffer, &len), 0);
+    ASSERT(len < 3u * COLONY_SERIALIZED_SIZE, "quantized table is smaller than full records");
+    ProtoColonyDelta decoded;
+    ASSERT_EQ(protocol_deserialize_colony_delta(buffer, len, &decoded), 0);
+    ASSERT_TRUE(decoded.full);
+    ASSERT_EQ(decoded.dynamic_count, 3u);
+    ASSERT_EQ(decoded.dynamics[2].id, 70000u);
+    ASSERT_EQ(memcmp(&decoded.dynamics[1], &dynamics[1], sizeof(ProtoColonyDynamic)), 0);
+    ASSERT_EQ(strcmp(decoded.descriptors[2].name, "Colony 70000"), 0);
+    ProtoColonyDelta rejected;
+    ASSERT_EQ(protocol_deserialize_colony_delta(buffer, len - 1, &rejected), -1);
+    proto_colony_delta_free(&rejected);
+    free(buffer);
+
+    ProtoWorld world;
+    proto_world_init(&world);
+    ASSERT_EQ(proto_world_apply_colony_delta(&world, &decoded), 0);
+    proto_colony_delta_free(&decoded);
+    ASSERT_EQ(proto_world_colony_total(&world), 3u);
+    ASSERT_EQ(proto_world_find_colony(&world, 9u)->population, 200u);
+    ASSERT_TRUE(fabsf(proto_world_find_colony(&world, 5u)->y - 20.25f) < 0.001f);
+
+    // Remove 5, move 9, add 12
+    ProtoColony added = make_delta_colony(12u, 13.0f, 50u);
+    colonies[1].population = 250u;
+    ProtoColonyDescriptor new_descriptor;
+    ProtoColonyDynamic changed[2];
+    proto_colony_quantize(&colonies[1], &descriptors[1], &changed[0]);
+    proto_colony_quantize(&added, &new_descriptor, &changed[1]);
+    uint32_t removed = 5u;
+    ProtoColonyDelta step;
+    proto_colony_delta_init(&step);
+    step.tick = 41u;
+    step.base_tick = 40u;
+    step.total_count = 3u;
+    step.removed_count = 1u;
+    step.removed = &removed;
+    step.descriptor_count = 1u;
+    step.descriptors = &new_descriptor;
+    step.dynamic_count = 2u;
+    step.dynamics = changed;
+    ASSERT_EQ(protocol_serialize_colony_delta(&step, &buffer, &len), 0);
+    ASSERT_EQ(protocol_deserialize_colony_delta(buffer, len, &decoded), 0);
+    free(buffer);
+    ASSERT_EQ(proto_world_apply_colony_delta(&world, &decoded), 0);
+    proto_colony_delta_free(&decoded);
+    ASSERT_EQ(proto_world_colony_total(&world), 3u);
+    ASSERT(proto_world_find_colony(&world, 5u) == NULL, "removed colony");
+    ASSERT_EQ(proto_world_find_colony(&world, 9u)->population, 250u);
+    ASSERT_EQ(proto_world_find_colony(&world, 12u)->population, 50u);
+    ASSERT_EQ(proto_world_colony_at(&world, 1)->id, 12u);
+
+    // A dynamic record for an unknown colony leaves the table alone
+    changed[0].id = 6u;
+    step.removed_count = 0u;
+    step.descriptor_count = 0u;
+    step.dynamic_count = 1u;
+    ASSERT_EQ(proto_world_apply_colony_delta(&world, &step), -1);
+    ASSERT_EQ(proto_world_colony_total(&world), 3u);
+
+    // Lists must be sorted by id
+    ProtoColonyDynamic unsorted[2] = { dynamics[2], dynamics[1] };
+    step.dynamic_count = 2u;
+    step.dynamics = unsorted;
+    ASSERT_EQ(protocol_serialize_colony_delta(&step, &buffer, &len), -1);
+    proto_world_free(&world);
+}
+
+TEST(colony_pages_extend_world_table_in_order) {
+    ProtoWorld world;
+    proto_world_init(&world);
+    world.tick = 12u;
+    world.colony_count = MAX_COLONIES;
+    for (uint32_t i = 0; i < MAX_COLONIES; i++) {
+        world.colonies[i].id = i + 1u;
+        world.colonies[i].alive = true;
+    }
+
+    ProtoColony extra[3];
+    memset(extra, 0, sizeof(extra));
+    for (uint32_t i = 0; i < 3u; i++) {
+        extra[i].id = 70000u + i;
+        extra[i].alive = true;
+        extra[i].population = 10u + i;
+    }
+    ProtoColonyPage page = {
+        .tick = 12u,
+        .total_count = MAX_COLONIES + 3u,
+        .start = MAX_COLONIES,
+        .count = 2u,
+        .colonies = extra,
+    };
+
+    uint8_t* buffer = NULL;
+    size_t len = 0;
+    ASSERT_EQ(protocol_serialize_colony_page(&page, &buffer, &len), 0);
+    ASSERT_EQ(len, (size_t)COLONY_PAGE_HEADER_SIZE + 2u * COLONY_SERIALIZED_SIZE);
+    ProtoColonyPage decoded;
+    ASSERT_EQ(protocol_deserialize_colony_page(buffer, len, &decoded), 0);
+    ASSERT_EQ(decoded.count, 2u);
+    ASSERT_EQ(decoded.colonies[1].id, 70001u);
+    ASSERT_EQ(protocol_deserialize_colony_page(buffer, len - 1, &page), -1);
+    free(buffer);
+
+    // Pages only apply in order and to the tick they were built for
+    ProtoColonyPage last = page;
+    last.start = MAX_COLONIES + 2u;
+    last.count = 1u;
+    last.colonies = &extra[2];
+    ASSERT_EQ(proto_world_apply_colony_page(&world, &last), 1);
+    ASSERT_EQ(proto_world_apply_colony_page(&world, &decoded), 0);
+    last.tick = 11u;
+    ASSERT_EQ(proto_world_apply_colony_page(&world, &last), 1);
+    last.tick = 12u;
+    ASSERT_EQ(proto_world_apply_colony_page(&world, &last), 0);
+    proto_colony_page_free(&decoded);
+
+    ASSERT_EQ(proto_world_colony_total(&world), MAX_COLONIES + 3u);
+    ASSERT_EQ(proto_world_colony_at(&world, MAX_COLONIES + 2u)->population, 12u);
+    ASSERT(proto_world_colony_at(&world, MAX_COLONIES + 3u) == NULL, "past the table");
+    ASSERT_EQ(proto_world_find_colony(&world, 70001u)->population, 11u);
+    ASSERT_EQ(proto_world_find_colony(&world, 200u)->id, 200u);
+    ASSERT(proto_world_find_colony(&world, 69999u) == NULL, "unknown id");
+
+    proto_world_free(&world);
+    ASSERT_EQ(world.extra_colony_count, 0u);
+    ASSERT(world.extra_colonies == NULL, "free releases paged colonies");
+}
+
+TEST(world_ack_roundtrip) {
+    ProtoWorldAck ack = { .tick = 0x00010203u };
+    uint8_t buffer[WORLD_ACK_SERIALIZED_SIZE];
+    ASSERT_EQ(protocol_serialize_world_ack(&ack, buffer), WORLD_ACK_SERIALIZED_SIZE);
+    ASSERT_EQ(buffer[0], 0x00);
+    ASSERT_EQ(buffer[3], 0x03);
+
+    ProtoWorldAck decoded = {0};
+    ASSERT_EQ(protocol_deserialize_world_ack(buffer, sizeof(buffer), &decoded), WORLD_ACK_SERIALIZED_SIZE);
+    ASSERT_EQ(decoded.tick, ack.tick);
+    ASSERT_EQ(protocol_deserialize_world_ack(buffer, 3, &decoded), -1);
+}
+
+TEST(connect_roundtrip_legacy_payloads_and_negotiation) {
+    ProtoConnect connect = { .capabilities = PROTO_CAP_COMPRESSION | PROTO_CAP_VIEWPORT, .version = PROTOCOL_VERSION };
+    uint8_t buffer[CONNECT_SERIALIZED_SIZE];
+    ASSERT_EQ(protocol_serialize_connect(&connect, buffer), CONNECT_SERIALIZED_SIZE);
+    ASSERT_EQ(buffer[3], 0x41);
+    ASSERT_EQ(buffer[7], (uint8_t)PROTOCOL_VERSION);
+
+    ProtoConnect decoded = {0};
+    ASSERT_EQ(protocol_deserialize_connect(buffer, sizeof(buffer), &decoded), 0);
+    ASSERT_EQ(decoded.capabilities, connect.capabilities);
+    ASSERT_EQ(decoded.version, (uint32_t)PROTOCOL_VERSION);
+
+    // Version 1 clients: capabilities only, or nothing
+    ASSERT_EQ(protocol_deserialize_connect(buffer, CONNECT_LEGACY_SERIALIZED_SIZE, &decoded), 0);
+    ASSERT_EQ(decoded.capabilities, connect.capabilities);
+    ASSERT_EQ(decoded.version, 1u);
+    ASSERT_EQ(protocol_deserialize_connect(NULL, 0, &decoded), 0);
+    ASSERT_EQ(decoded.capabilities, 0u);
+    ASSERT_EQ(decoded.version, 1u);
+
+    ProtoConnect agreed = {0};
+    ASSERT_EQ(protocol_negotiate_connect(&decoded, PROTO_CAP_ALL & ~PROTO_CAP_VIEWPORT, &agreed), 0);
+    ASSERT_EQ(agreed.version, 1u);
+    ASSERT_EQ(agreed.capabilities, PROTO_CAP_SPAN_DELTA);
+
+    // Newer clients get the server's version and only what both sides support
+    ProtoConnect newer = { .capabilities = 0xFFFFFFFFu, .version = PROTOCOL_VERSION + 3u };
+    ASSERT_EQ(protocol_negotiate_connect(&newer, PROTO_CAP_COMPRESSION | PROTO_CAP_WIDE_IDS, &agreed), 0);
+    ASSERT_EQ(agreed.version, (uint32_t)PROTOCOL_VERSION);
+    ASSERT_EQ(agreed.capabilities, PROTO_CAP_COMPRESSION | PROTO_CAP_WIDE_IDS);
+
+    // A versioned client that leaves span deltas out does not get them
+    ASSERT_EQ(protocol_negotiate_connect(&connect, PROTO_CAP_ALL, &agreed), 0);
+    ASSERT_EQ(agreed.capabilities, PROTO_CAP_COMPRESSION | PROTO_CAP_VIEWPORT);
+    ASSERT_EQ(protocol_negotiate_connect(NULL, PROTO_CAP_ALL, &agreed), -1);
+}
+
+TEST(frame_encodes_header_once_and_refcounts) {
+    uint8_t payload[] = {1, 2, 3};
+    ProtoFrame* frame = proto_frame_copy(MSG_COLONY_INFO, payload, sizeof(payload));
+    ASSERT_NOT_NULL(frame);
+    ASSERT_EQ(proto_frame_wire_size(frame), (size_t)(MESSAGE_HEADER_SIZE + 3));
+    ASSERT_BYTES_EQ(frame->payload, payload, sizeof(payload), "Frame should own a copy of the payload");
+
+    MessageHeader header;
+    ASSERT_EQ(protocol_deserialize_header(frame->header, &header), MESSAGE_HEADER_SIZE);
+    ASSERT_EQ(header.type, (uint16_t)MSG_COLONY_INFO);
+    ASSERT_EQ(header.payload_len, 3u);
+
+    ASSERT_EQ(proto_frame_retain(frame), frame);
+    ASSERT_EQ(atomic_load(&frame->refcount), 2);
+    proto_frame_release(frame);
+    ASSERT_EQ(atomic_load(&frame->refcount), 1);
+    proto_frame_release(frame);
+
+    ProtoFrame* empty = proto_frame_create(MSG_DISCONNECT, NULL, 0);
+    ASSERT_NOT_NULL(empty);
+    ASSERT_EQ(proto_frame_wire_size(empty), (size_t)MESSAGE_HEADER_SIZE);
+    proto_frame_release(empty);
+
+    ASSERT_TRUE(proto_frame_create(MSG_WORLD_STATE, NULL, 4) == NULL);
+}
+
+static size_t build_test_frame(uint8_t* out, MessageType type, uint8_t fill, size_t payload_len) {
+    MessageHeader header = {
+        .magic = PROTOCOL_MAGIC,
+        .type = type,
+        .payload_len = (uint32_t)payload_len,
+        .sequence = 7
+    };
+    protocol_serialize_header(&header, out);
+    memset(out + MESSAGE_HEADER_SIZE, fill, payload_len);
+    return MESSAGE_HEADER_SIZE + payload_len;
+}
+
+TEST(frame_reader_yields_frames_fed_in_chunks_across_wrap) {
+    ProtoBufferPool pool;
+    proto_buffer_pool_init(&pool);
+    ProtoFrameReader reader;
+    ASSERT_EQ(proto_frame_reader_init(&reader, 0, &pool), 0);
+    size_t capacity = reader.capacity;
+
+    // 314-byte frames fed 7 bytes at a time: the next frame's first bytes are
+    // always buffered, so frames drift around the 1 KB ring and some wrap
+    enum { FRAME_COUNT = 8, PAYLOAD_LEN = 300 };
+    uint8_t stream[FRAME_COUNT * (MESSAGE_HEADER_SIZE + PAYLOAD_LEN)];
+    size_t stream_len = 0;
+    for (int f = 0; f < FRAME_COUNT; f++) {
+        stream_len += build_test_frame(stream + stream_len, MSG_COMMAND, (uint8_t)(0x10 + f), PAYLOAD_LEN);
+    }
+
+    MessageHeader header;
+    ProtoPayloadView payload;
+    int wrapped = 0;
+    int received = 0;
+    for (size_t offset = 0; offset < stream_len; offset += 7) {
+        size_t chunk = stream_len - offset < 7 ? stream_len - offset : 7;
+        ASSERT_EQ(proto_frame_reader_append(&reader, stream + offset, chunk), 0);
+        while (proto_frame_reader_next(&reader, &header, &payload) == 1) {
+            ASSERT_EQ(header.type, (uint16_t)MSG_COMMAND);
+            ASSERT_EQ(payload.len, (size_t)PAYLOAD_LEN);
+            ASSERT_EQ(payload.data[0], (uint8_t)(0x10 + received));
+            ASSERT_EQ(payload.data[PAYLOAD_LEN - 1], (uint8_t)(0x10 + received));
+            if (payload.pooled) {
+                wrapped++;
+            }
+            proto_frame_reader_release(&reader, &payload);
+            received++;
+        }
+    }
+    ASSERT_EQ(received, FRAME_COUNT);
+    ASSERT_EQ(reader.capacity, capacity);
+    ASSERT_TRUE(wrapped > 0);
+    // Wrapped payloads share one recycled pool buffer
+    ASSERT_EQ(pool.misses, 1u);
+    ASSERT_EQ(pool.hits, (uint64_t)(wrapped - 1));
+
+    proto_frame_reader_free(&reader);
+    proto_buffer_pool_destroy(&pool);
+}
+
+TEST(frame_reader_grows_for_large_frames_and_rejects_bad_magic) {
+    ProtoFrameReader reader;
+    ASSERT_EQ(proto_frame_reader_init(&reader, 0, NULL), 0);
+
+    size_t big_len = 64 * 1024;
+    uint8_t* big = malloc(MESSAGE_HEADER_SIZE + big_len);
+    ASSERT_NOT_NULL(big);
+    size_t len = build_test_frame(big, MSG_WORLD_STATE, 0x5A, big_len);
+    ASSERT_EQ(proto_frame_reader_append(&reader, big, len), 0);
+    ASSERT_GE(reader.capacity, len);
+
+    MessageHeader header;
+    ProtoPayloadView payload;
+    ASSERT_EQ(proto_frame_reader_next(&reader, &header, &payload), 1);
+    ASSERT_EQ(payload.len, big_len);
+    ASSERT_EQ(payload.data[big_len - 1], 0x5A);
+    proto_frame_reader_release(&reader, &payload);
+    free(big);
+
+    uint8_t junk[MESSAGE_HEADER_SIZE] = {0xDE, 0xAD};
+    ASSERT_EQ(proto_frame_reader_append(&reader, junk, sizeof(junk)), 0);
+    ASSERT_EQ(proto_frame_reader_next(&reader, &header, &payload), -1);
+    proto_frame_reader_free(&reader);
+}
+
+TEST(frame_reader_fill_is_non_blocking_and_reports_eof_last) {
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ProtoFrameReader reader;
+    ASSERT_EQ(proto_frame_reader_init(&reader, 0, NULL), 0);
+
+    // Nothing sent: a blocking socket still returns immediately
+    bool drained = false;
+    ASSERT_EQ(proto_frame_reader_fill(&reader, fds[0], &drained), 0);
+    ASSERT_TRUE(drained);
+
+    uint8_t frame[MESSAGE_HEADER_SIZE + 8];
+    size_t len = build_test_frame(frame, MSG_ACK, 0x01, 8);
+    ASSERT_EQ(send(fds[1], frame, len, 0), (ssize_t)len);
+    close(fds[1]);
+
+    ASSERT_EQ(proto_frame_reader_fill(&reader, fds[0], &drained), (ssize_t)len);
+    MessageHeader header;
+    ProtoPayloadView payload;
+    ASSERT_EQ(proto_frame_reader_next(&reader, &header, &payload), 1);
+    ASSERT_EQ(header.type, (uint16_t)MSG_ACK);
+    proto_frame_reader_release(&reader, &payload);
+    ASSERT_TRUE(reader.closed);
+    ASSERT_EQ(proto_frame_reader_fill(&reader, fds[0], &drained), -1);
+
+    proto_frame_reader_free(&reader);
+    close(fds[0]);
+}
+
 // ============================================================================
 // Run Tests
 // ============================================================================
@@ -982,9 +1814,27 @@ int run_protocol_edge_tests(void) {
     RUN_TEST(world_delta_grid_chunk_roundtrip);
     RUN_TEST(world_delta_grid_chunk_wire_format);
     RUN_TEST(world_delta_grid_chunk_rejects_invalid_bounds);
+    RUN_TEST(world_delta_spans_wire_format_and_apply);
+    RUN_TEST(world_delta_spans_switch_to_varint_ids_for_wide_colonies);
+    RUN_TEST(colony_pages_extend_world_table_in_order);
+    RUN_TEST(colony_delta_roundtrip_and_apply);
+    RUN_TEST(world_ack_roundtrip);
+    RUN_TEST(connect_roundtrip_legacy_payloads_and_negotiation);
+    RUN_TEST(frame_encodes_header_once_and_refcounts);
+    RUN_TEST(frame_reader_yields_frames_fed_in_chunks_across_wrap);
+    RUN_TEST(frame_reader_grows_for_large_frames_and_rejects_bad_magic);
+    RUN_TEST(frame_reader_fill_is_non_blocking_and_reports_eof_last);
     RUN_TEST(world_state_without_grid_uses_fixed_prefix);
     RUN_TEST(grid_rle_raw_mode_roundtrip);
+    RUN_TEST(grid_cell_kernels_cover_tails_and_16bit_extremes);
     RUN_TEST(grid_rle_rejects_unknown_mode);
+    RUN_TEST(grid_palette_modes_pick_smallest_and_roundtrip);
+    RUN_TEST(grid_codec_widens_ids_only_when_needed);
+    RUN_TEST(grid_palette_rejects_out_of_range_indices);
+    RUN_TEST(world_delta_grid_chunk_packs_few_colony_chunks);
+    RUN_TEST(lz_roundtrips_literals_runs_and_long_matches);
+    RUN_TEST(lz_rejects_malformed_blocks);
+    RUN_TEST(frame_compressed_twin_unpacks_to_original);
     RUN_TEST(world_state_with_grid_roundtrip_preserves_cells);
     RUN_TEST(world_state_with_noisy_grid_roundtrip_preserves_cells);
     
@@ -998,6 +1848,8 @@ int run_protocol_edge_tests(void) {
     RUN_TEST(all_command_types);
     RUN_TEST(select_colony_command);
     RUN_TEST(spawn_colony_command);
+    RUN_TEST(set_viewport_command_roundtrip);
+    RUN_TEST(grid_level_dims_round_up_and_identify_level);
     RUN_TEST(command_wire_examples_match_spec);
     RUN_TEST(command_status_roundtrip);
     RUN_TEST(command_status_select_clears_roundtrip);
@@ -65,7 +65,7 @@ static void test_draw_world_prefers_grid_path_when_available(void) {
 
     world.has_grid = true;
     world.grid_size = world.width * world.height;
-    world.grid = (uint16_t*)calloc(world.grid_size, sizeof(uint16_t));
+    world.grid = (uint32_t*)calloc(world.grid_size, sizeof(uint32_t));
     assert(world.grid != NULL);
 
     renderer_clear(&renderer);
@@ -117,7 +117,7 @@ static void test_draw_world_grid_skips_unknown_and_dead_colonies(void) {
     proto_world world = make_world(4, 4);
     world.has_grid = true;
     world.grid_size = world.width * world.height;
-    world.grid = (uint16_t*)calloc(world.grid_size, sizeof(uint16_t));
+    world.grid = (uint32_t*)calloc(world.grid_size, sizeof(uint32_t));
     assert(world.grid != NULL);
 
     world.colony_count = 1;
@@ -147,7 +147,7 @@ static void test_draw_world_grid_border_detection_and_highlight(void) {
     proto_world world = make_world(3, 3);
     world.has_grid = true;
     world.grid_size = world.width * world.height;
-    world.grid = (uint16_t*)calloc(world.grid_size, sizeof(uint16_t));
+    world.grid = (uint32_t*)calloc(world.grid_size, sizeof(uint32_t));
     assert(world.grid != NULL);
 
     world.colony_count = 1;
@@ -2,10 +2,15 @@
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <dirent.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
 #include "../src/server/server.h"
+#include "../src/server/frame_schedule.h"
+#include "../src/server/hardware_profile.h"
 
 static int tests_passed = 0;
 static int tests_failed = 0;
@@ -235,6 +240,1252 @@ TEST(server_handle_command_data_branches_for_select_and_spawn) {
     close(fds[1]);
 }
 
+static int read_world_message(int fd, MessageType* type, uint8_t** payload, size_t* len) {
+    MessageHeader header;
+    if (protocol_recv_message(fd, &header, payload) < 0) {
+        return -1;
+    }
+    *type = (MessageType)header.type;
+    *len = header.payload_len;
+    return 0;
+}
+
+TEST(server_broadcast_sends_span_delta_against_acked_tick) {
+    Server* server = server_create(0, 64, 32, 2);
+    ASSERT_TRUE(server != NULL);
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    NetSocket* socket = make_mock_socket(true, fds[0]);
+    ASSERT_TRUE(socket != NULL);
+    ClientSession* client = server_add_client(server, socket);
+    ASSERT_TRUE(client != NULL);
+
+    for (int i = 0; i < 200; i++) {
+        server->world->cells[(i * 7) % (64 * 32)].colony_id = (uint32_t)(1 + i % 5);
+    }
+    server->world->tick = 10;
+    server_broadcast_world_state(server);
+
+    // First contact is a keyframe with the grid inline
+    MessageType type;
+    uint8_t* payload = NULL;
+    size_t len = 0;
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    ProtoWorld local;
+    proto_world_init(&local);
+    ASSERT_EQ(protocol_deserialize_world_state(payload, len, &local), 0);
+    free(payload);
+    ASSERT_TRUE(local.has_grid);
+    ASSERT_EQ(client->keyframes_sent, 1u);
+    server_note_world_ack(server, client, local.tick);
+    ASSERT_TRUE(client->has_baseline);
+
+    server->world->cells[3].colony_id = 4;
+    server->world->cells[4].colony_id = 4;
+    server->world->cells[64 * 20 + 9].colony_id = 2;
+    server->world->tick = 11;
+    server_broadcast_world_state(server);
+
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    ProtoWorld state;
+    proto_world_init(&state);
+    ASSERT_EQ(protocol_deserialize_world_state(payload, len, &state), 0);
+    free(payload);
+    ASSERT_TRUE(!state.has_grid);
+
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_DELTA);
+    ProtoWorldDeltaSpans delta;
+    proto_world_delta_spans_init(&delta);
+    ASSERT_EQ(protocol_deserialize_world_delta_spans(payload, len, &delta), 0);
+    free(payload);
+    ASSERT_EQ(delta.base_tick, 10u);
+    ASSERT_EQ(delta.tick, 11u);
+    ASSERT_EQ(delta.span_count, 2u);
+    ASSERT_EQ(proto_world_delta_spans_apply(&delta, local.grid, local.grid_size), 0);
+    proto_world_delta_spans_free(&delta);
+    for (uint32_t i = 0; i < local.grid_size; i++) {
+        ASSERT_EQ(local.grid[i], (uint32_t)server->world->cells[i].colony_id);
+    }
+    ASSERT_EQ(client->deltas_sent, 1u);
+
+    // Stale acks are ignored; a baseline beyond the gap limit forces a keyframe
+    server_note_world_ack(server, client, 5);
+    ASSERT_EQ(client->baseline_tick, 10u);
+    server->delta_max_gap = 1;
+    server->world->tick = 13;
+    server_broadcast_world_state(server);
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    proto_world_free(&state);
+    proto_world_init(&state);
+    ASSERT_EQ(protocol_deserialize_world_state(payload, len, &state), 0);
+    free(payload);
+    ASSERT_TRUE(state.has_grid);
+    ASSERT_EQ(client->keyframes_sent, 2u);
+    ASSERT_TRUE(!client->has_baseline);
+    ASSERT_EQ(client->keyframe_tick, 13u);
+
+    proto_world_free(&state);
+    proto_world_free(&local);
+    server_destroy(server);
+    close(fds[1]);
+}
+
+TEST(server_broadcast_shares_encoded_frames_across_clients) {
+    Server* server = server_create(0, 32, 16, 2);
+    ASSERT_TRUE(server != NULL);
+
+    int fds_a[2] = {-1, -1};
+    int fds_b[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_a), 0);
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_b), 0);
+    ClientSession* a = server_add_client(server, make_mock_socket(true, fds_a[0]));
+    ClientSession* b = server_add_client(server, make_mock_socket(true, fds_b[0]));
+    ASSERT_TRUE(a != NULL && b != NULL);
+
+    server->world->tick = 3;
+    server_broadcast_world_state(server);
+
+    // One frame per message: both clients see the same sequence number
+    MessageHeader header_a;
+    MessageHeader header_b;
+    uint8_t* payload_a = NULL;
+    uint8_t* payload_b = NULL;
+    ASSERT_EQ(protocol_recv_message(fds_a[1], &header_a, &payload_a), 0);
+    ASSERT_EQ(protocol_recv_message(fds_b[1], &header_b, &payload_b), 0);
+    ASSERT_EQ(header_a.type, (uint16_t)MSG_WORLD_STATE);
+    ASSERT_EQ(header_a.sequence, header_b.sequence);
+    ASSERT_EQ(header_a.payload_len, header_b.payload_len);
+    ASSERT_TRUE(memcmp(payload_a, payload_b, header_a.payload_len) == 0);
+    free(payload_a);
+    free(payload_b);
+
+    server_destroy(server);
+    close(fds_a[1]);
+    close(fds_b[1]);
+}
+
+TEST(server_broadcast_coalesces_unsent_world_updates) {
+    Server* server = server_create(0, 32, 16, 2);
+    ASSERT_TRUE(server != NULL);
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ClientSession* client = server_add_client(server, make_mock_socket(true, fds[0]));
+    ASSERT_TRUE(client != NULL);
+
+    // Pretend a send thread owns the queues so nothing is flushed inline
+    server->io_thread_running = true;
+
+    CommandSelectColony clear = {.colony_id = 0};
+    server_handle_command(server, client, CMD_SELECT_COLONY, &clear);
+    for (uint64_t tick = 3; tick <= 5; tick++) {
+        server->world->tick = tick;
+        server_broadcast_world_state(server);
+    }
+
+    // Only the newest world group is left, behind the command status
+    SendQueueStats stats;
+    ASSERT_EQ(server_get_client_send_stats(server, client, &stats), 0);
+    ASSERT_EQ(stats.world_groups_coalesced, 2u);
+    ASSERT_EQ(stats.queued_frames, 2u);
+    ASSERT_EQ(stats.frames_sent, 0u);
+    ASSERT_TRUE(!client->keyframe_sent || client->keyframe_tick == 5u);
+
+    ASSERT_EQ(send_queue_flush(&client->send_queue, fds[0], true), 0);
+    MessageType type;
+    ProtoCommandStatus status;
+    ASSERT_EQ(read_command_status_message(fds[1], &type, &status), 0);
+    ASSERT_EQ(type, MSG_ACK);
+    ASSERT_EQ(status.command, (uint32_t)CMD_SELECT_COLONY);
+
+    uint8_t* payload = NULL;
+    size_t len = 0;
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    ProtoWorld state;
+    proto_world_init(&state);
+    ASSERT_EQ(protocol_deserialize_world_state(payload, len, &state), 0);
+    free(payload);
+    ASSERT_EQ(state.tick, 5u);
+    ASSERT_TRUE(state.has_grid);
+    proto_world_free(&state);
+
+    server->io_thread_running = false;
+    server_destroy(server);
+    close(fds[1]);
+}
+
+static ProtoFrame* make_filled_frame(size_t len, uint8_t fill) {
+    uint8_t* payload = (uint8_t*)malloc(len);
+    if (!payload) {
+        return NULL;
+    }
+    memset(payload, fill, len);
+    return proto_frame_create(MSG_WORLD_DELTA, payload, len);
+}
+
+TEST(send_queue_keeps_partially_sent_group_when_coalescing) {
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    int small = 4096;
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+
+    ClientSendQueue queue;
+    ASSERT_EQ(send_queue_init(&queue, 8, 0), 0);
+    const size_t frame_len = 512 * 1024;
+    ProtoFrame* a = make_filled_frame(frame_len, 0xA1);
+    ProtoFrame* b = make_filled_frame(frame_len, 0xB2);
+    ProtoFrame* c = make_filled_frame(frame_len, 0xC3);
+    ASSERT_TRUE(a && b && c);
+
+    ASSERT_EQ(send_queue_push_world(&queue, &a, 1, false), 0);
+    ASSERT_EQ(send_queue_flush(&queue, fds[0], false), 0);
+    ASSERT_TRUE(send_queue_has_pending(&queue));
+    ASSERT_TRUE(queue.head_offset > 0);
+
+    // b never started, so it is replaced; the half-written a must finish
+    ASSERT_EQ(send_queue_push_world(&queue, &b, 1, false), 0);
+    bool dropped_keyframe = true;
+    ASSERT_EQ(send_queue_drop_pending_world(&queue, &dropped_keyframe), 1u);
+    ASSERT_TRUE(!dropped_keyframe);
+    ASSERT_EQ(send_queue_push_world(&queue, &c, 1, false), 0);
+    proto_frame_release(a);
+    proto_frame_release(b);
+    proto_frame_release(c);
+
+    size_t expected = 2 * (MESSAGE_HEADER_SIZE + frame_len);
+    uint8_t* received = (uint8_t*)malloc(expected + 1);
+    ASSERT_TRUE(received != NULL);
+    size_t total = 0;
+    while (total < expected) {
+        ASSERT_EQ(send_queue_flush(&queue, fds[0], false), 0);
+        ssize_t n = recv(fds[1], received + total, expected + 1 - total, MSG_DONTWAIT);
+        if (n > 0) {
+            total += (size_t)n;
+        }
+    }
+    ASSERT_TRUE(!send_queue_has_pending(&queue));
+    ASSERT_EQ(total, expected);
+    ASSERT_EQ(received[MESSAGE_HEADER_SIZE + frame_len - 1], 0xA1);
+    ASSERT_EQ(received[2 * MESSAGE_HEADER_SIZE + frame_len], 0xC3);
+
+    SendQueueStats stats;
+    send_queue_get_stats(&queue, &stats);
+    ASSERT_EQ(stats.frames_sent, 2u);
+    ASSERT_EQ(stats.world_groups_coalesced, 1u);
+    ASSERT_EQ(stats.queued_bytes, 0u);
+    ASSERT_TRUE(stats.peak_queued_bytes >= MESSAGE_HEADER_SIZE + frame_len);
+
+    free(received);
+    send_queue_destroy(&queue);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(send_queue_batches_frames_into_one_sendmsg) {
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    ClientSendQueue queue;
+    ASSERT_EQ(send_queue_init(&queue, 16, 0), 0);
+    const size_t frame_len = 100;
+    const size_t frame_count = 10;
+    for (size_t i = 0; i < frame_count; i++) {
+        ProtoFrame* frame = make_filled_frame(frame_len, (uint8_t)(0x10 + i));
+        ASSERT_TRUE(frame != NULL);
+        ASSERT_EQ(send_queue_push_control(&queue, frame), 0);
+        proto_frame_release(frame);
+    }
+
+    ASSERT_EQ(send_queue_flush(&queue, fds[0], false), 0);
+    ASSERT_TRUE(!send_queue_has_pending(&queue));
+
+    SendQueueStats stats;
+    send_queue_get_stats(&queue, &stats);
+    ASSERT_EQ(stats.frames_sent, frame_count);
+    ASSERT_EQ(stats.send_calls, 1u);
+
+    size_t expected = frame_count * (MESSAGE_HEADER_SIZE + frame_len);
+    uint8_t received[2048];
+    size_t total = 0;
+    while (total < expected) {
+        ssize_t n = recv(fds[1], received + total, sizeof(received) - total, 0);
+        ASSERT_TRUE(n > 0);
+        total += (size_t)n;
+    }
+    for (size_t i = 0; i < frame_count; i++) {
+        const uint8_t* frame = received + i * (MESSAGE_HEADER_SIZE + frame_len);
+        MessageHeader header;
+        ASSERT_EQ(protocol_deserialize_header(frame, &header), MESSAGE_HEADER_SIZE);
+        ASSERT_EQ(header.payload_len, frame_len);
+        ASSERT_EQ(frame[MESSAGE_HEADER_SIZE], (uint8_t)(0x10 + i));
+        ASSERT_EQ(frame[MESSAGE_HEADER_SIZE + frame_len - 1], (uint8_t)(0x10 + i));
+    }
+
+    send_queue_destroy(&queue);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(send_queue_zerocopy_releases_frames_on_completion) {
+    NetServer* listener = net_server_create(0);
+    ASSERT_TRUE(listener != NULL);
+    NetSocket* client = net_client_connect("127.0.0.1", listener->port);
+    ASSERT_TRUE(client != NULL);
+    NetSocket* peer = net_server_accept(listener);
+    ASSERT_TRUE(peer != NULL);
+
+    ClientSendQueue queue;
+    ASSERT_EQ(send_queue_init(&queue, 8, 0), 0);
+    if (send_queue_enable_zerocopy(&queue, peer->fd, 16 * 1024) < 0) {
+        // MSG_ZEROCOPY is Linux-only; the copying path is covered above
+        send_queue_destroy(&queue);
+        net_socket_close(peer);
+        net_socket_close(client);
+        net_server_destroy(listener);
+        return;
+    }
+
+    const size_t frame_len = 64 * 1024;
+    const size_t frame_count = 4;
+    for (size_t i = 0; i < frame_count; i++) {
+        ProtoFrame* frame = make_filled_frame(frame_len, (uint8_t)(0x40 + i));
+        ASSERT_TRUE(frame != NULL);
+        ASSERT_EQ(send_queue_push_control(&queue, frame), 0);
+        proto_frame_release(frame);
+    }
+
+    size_t expected = frame_count * (MESSAGE_HEADER_SIZE + frame_len);
+    uint8_t* received = (uint8_t*)malloc(expected);
+    ASSERT_TRUE(received != NULL);
+    size_t total = 0;
+    while (total < expected) {
+        ASSERT_EQ(send_queue_flush(&queue, peer->fd, false), 0);
+        ssize_t n = recv(client->fd, received + total, expected - total, 0);
+        ASSERT_TRUE(n > 0);
+        total += (size_t)n;
+    }
+    ASSERT_EQ(received[expected - 1], (uint8_t)(0x40 + frame_count - 1));
+
+    // Completions arrive asynchronously on the error queue
+    SendQueueStats stats;
+    for (int spin = 0; spin < 200; spin++) {
+        ASSERT_EQ(send_queue_flush(&queue, peer->fd, false), 0);
+        send_queue_get_stats(&queue, &stats);
+        if (stats.zerocopy_pending == 0) {
+            break;
+        }
+        usleep(5000);
+    }
+    ASSERT_TRUE(stats.zerocopy_sends > 0);
+    ASSERT_EQ(stats.zerocopy_pending, 0u);
+    ASSERT_EQ(stats.frames_sent, frame_count);
+
+    free(received);
+    send_queue_destroy(&queue);
+    net_socket_close(peer);
+    net_socket_close(client);
+    net_server_destroy(listener);
+}
+
+// Version 1 MSG_CONNECT: capabilities without a version
+static int send_connect_caps(int fd, uint32_t capabilities) {
+    ProtoConnect connect = { .capabilities = capabilities };
+    uint8_t buffer[CONNECT_SERIALIZED_SIZE];
+    protocol_serialize_connect(&connect, buffer);
+    return protocol_send_message(fd, MSG_CONNECT, buffer, CONNECT_LEGACY_SERIALIZED_SIZE);
+}
+
+static int send_connect(int fd, bool compress) {
+    return send_connect_caps(fd, compress ? PROTO_CAP_COMPRESSION : 0u);
+}
+
+static int send_connect_version(int fd, uint32_t capabilities, uint32_t version) {
+    ProtoConnect connect = { .capabilities = capabilities, .version = version };
+    uint8_t buffer[CONNECT_SERIALIZED_SIZE];
+    protocol_serialize_connect(&connect, buffer);
+    return protocol_send_message(fd, MSG_CONNECT, buffer, sizeof(buffer));
+}
+
+TEST(server_negotiates_version_and_capabilities) {
+    Server* server = server_create(0, 64, 32, 2);
+    ASSERT_TRUE(server != NULL);
+    server->capabilities = PROTO_CAP_ALL & ~PROTO_CAP_COMPRESSION;
+
+    int fds_a[2] = {-1, -1};
+    int fds_b[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_a), 0);
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_b), 0);
+    ClientSession* keyframes = server_add_client(server, make_mock_socket(true, fds_a[0]));
+    ClientSession* legacy = server_add_client(server, make_mock_socket(true, fds_b[0]));
+    ASSERT_TRUE(keyframes != NULL && legacy != NULL);
+    ASSERT_EQ(legacy->protocol_version, 1u);
+    ASSERT_EQ(legacy->capabilities, PROTO_CAP_LEGACY_DEFAULT);
+
+    ASSERT_EQ(send_connect_version(fds_a[1], PROTO_CAP_COMPRESSION | PROTO_CAP_VIEWPORT, PROTOCOL_VERSION), 0);
+    ASSERT_EQ(send_connect_caps(fds_b[1], PROTO_CAP_WIDE_IDS), 0);
+    server_process_clients(server);
+    ASSERT_EQ(keyframes->protocol_version, (uint32_t)PROTOCOL_VERSION);
+    ASSERT_EQ(keyframes->capabilities, PROTO_CAP_VIEWPORT);
+    ASSERT_TRUE(!keyframes->compress);
+    ASSERT_EQ(legacy->capabilities, PROTO_CAP_WIDE_IDS | PROTO_CAP_LEGACY_DEFAULT);
+
+    // Only the versioned client is told what was agreed
+    MessageType type;
+    uint8_t* payload = NULL;
+    size_t len = 0;
+    ASSERT_EQ(read_world_message(fds_a[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_CONNECT_ACK);
+    ProtoConnect agreed;
+    ASSERT_EQ(protocol_deserialize_connect(payload, len, &agreed), 0);
+    free(payload);
+    ASSERT_EQ(agreed.version, (uint32_t)PROTOCOL_VERSION);
+    ASSERT_EQ(agreed.capabilities, PROTO_CAP_VIEWPORT);
+
+    for (int i = 0; i < 200; i++) {
+        server->world->cells[(i * 7) % (64 * 32)].colony_id = (uint32_t)(1 + i % 5);
+    }
+    server->world->tick = 10;
+    server_broadcast_world_state(server);
+    ASSERT_EQ(read_world_message(fds_b[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    free(payload);
+    ASSERT_EQ(read_world_message(fds_a[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    free(payload);
+    server_note_world_ack(server, keyframes, 10);
+    server_note_world_ack(server, legacy, 10);
+
+    // Without PROTO_CAP_SPAN_DELTA every grid is a keyframe, acked or not
+    server->world->cells[3].colony_id = 4;
+    server->world->tick = 11;
+    server_broadcast_world_state(server);
+    ASSERT_EQ(read_world_message(fds_a[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    ProtoWorld state;
+    proto_world_init(&state);
+    ASSERT_EQ(protocol_deserialize_world_state(payload, len, &state), 0);
+    free(payload);
+    ASSERT_TRUE(state.has_grid);
+    proto_world_free(&state);
+    ASSERT_EQ(keyframes->keyframes_sent, 2u);
+    ASSERT_EQ(keyframes->deltas_sent, 0u);
+    ASSERT_EQ(legacy->deltas_sent, 1u);
+
+    server_destroy(server);
+    close(fds_a[1]);
+    close(fds_b[1]);
+}
+
+TEST(server_shares_world_through_shm_with_same_host_clients) {
+    char name[64];
+    snprintf(name, sizeof(name), "/ferox-test-%d", (int)getpid());
+    setenv("FEROX_SHM_NAME", name, 1);
+    Server* server = server_create(0, 64, 32, 2);
+    unsetenv("FEROX_SHM_NAME");
+    ASSERT_TRUE(server != NULL);
+    ASSERT_TRUE(server->shm_world != NULL);
+    ASSERT_TRUE(server->capabilities & PROTO_CAP_SHARED_WORLD);
+    ASSERT_TRUE(shm_world_reader_open("/ferox-test-missing") == NULL);
+
+    ShmWorldReader* reader = shm_world_reader_open(name);
+    ASSERT_TRUE(reader != NULL);
+    ASSERT_EQ(shm_world_reader_port(reader), server->listener->port);
+    ProtoWorld world;
+    proto_world_init(&world);
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 0);
+
+    int fds_a[2] = {-1, -1};
+    int fds_b[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_a), 0);
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_b), 0);
+    ClientSession* local = server_add_client(server, make_mock_socket(true, fds_a[0]));
+    ClientSession* remote = server_add_client(server, make_mock_socket(true, fds_b[0]));
+    ASSERT_TRUE(local != NULL && remote != NULL);
+    ASSERT_EQ(send_connect_version(fds_a[1], PROTO_CAP_SHARED_WORLD | PROTO_CAP_VIEWPORT, PROTOCOL_VERSION), 0);
+    ASSERT_EQ(send_connect_version(fds_b[1], PROTO_CAP_VIEWPORT, PROTOCOL_VERSION), 0);
+    server_process_clients(server);
+    ASSERT_EQ(local->capabilities, PROTO_CAP_SHARED_WORLD | PROTO_CAP_VIEWPORT);
+    ASSERT_EQ(remote->capabilities, PROTO_CAP_VIEWPORT);
+    MessageType type;
+    uint8_t* payload = NULL;
+    size_t len = 0;
+    ASSERT_EQ(read_world_message(fds_a[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_CONNECT_ACK);
+    free(payload);
+    ASSERT_EQ(read_world_message(fds_b[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_CONNECT_ACK);
+    free(payload);
+
+    Colony colony;
+    memset(&colony, 0, sizeof(colony));
+    colony.active = true;
+    colony.cell_count = 3;
+    uint32_t id = world_add_colony(server->world, colony);
+    ASSERT_TRUE(id != 0);
+    for (int i = 0; i < 3; i++) {
+        server->world->cells[100 + i * 64].colony_id = id;
+    }
+    server->world->tick = 5;
+    server_broadcast_world_state(server);
+
+    // The TCP client gets the frame; the shm client's socket stays quiet
+    ASSERT_EQ(read_world_message(fds_b[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    free(payload);
+    uint8_t byte;
+    ASSERT_TRUE(recv(fds_a[1], &byte, 1, MSG_DONTWAIT) < 0);
+
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 1);
+    ASSERT_EQ(world.tick, 5u);
+    ASSERT_EQ(world.width, 64u);
+    ASSERT_EQ(world.height, 32u);
+    ASSERT_TRUE(world.has_grid);
+    ASSERT_EQ(world.grid_size, 64u * 32u);
+    ASSERT_EQ(world.grid[100], id);
+    ASSERT_EQ(world.grid[228], id);
+    ASSERT_EQ(world.grid[0], 0u);
+    ASSERT_EQ(proto_world_colony_total(&world), 1u);
+    ASSERT_EQ(world.colonies[0].id, id);
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 0);
+
+    // A reader that fell behind by more than the ring skips to the newest frame
+    for (uint32_t tick = 6; tick <= 6 + SHM_WORLD_SLOTS; tick++) {
+        server->world->cells[tick].colony_id = id;
+        server->world->tick = tick;
+        server_broadcast_world_state(server);
+        ASSERT_EQ(read_world_message(fds_b[1], &type, &payload, &len), 0);
+        free(payload);
+    }
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 1);
+    ASSERT_EQ(world.tick, 6u + SHM_WORLD_SLOTS);
+    ASSERT_EQ(world.grid[6 + SHM_WORLD_SLOTS], id);
+    ASSERT_EQ(shm_world_writer_frames(server->shm_world), 1u + 1u + SHM_WORLD_SLOTS);
+
+    proto_world_free(&world);
+    shm_world_reader_close(reader);
+    server_destroy(server);
+    ASSERT_TRUE(shm_world_reader_open(name) == NULL);
+    close(fds_a[1]);
+    close(fds_b[1]);
+}
+
+TEST(shm_world_writer_round_trips_frames_to_readers) {
+    char name[64];
+    snprintf(name, sizeof(name), "/ferox-trip-%d", (int)getpid());
+    ShmWorldWriter* writer = shm_world_writer_create(name, 8, 4, 7000);
+    ASSERT_TRUE(writer != NULL);
+    ShmWorldReader* reader = shm_world_reader_open(name);
+    ASSERT_TRUE(reader != NULL);
+    // Clients compare this with the port they dial before offering the cap
+    ASSERT_EQ(shm_world_reader_port(reader), 7000);
+    ASSERT_TRUE(shm_world_reader_port(reader) != 7001);
+
+    ProtoWorld frame;
+    proto_world_init(&frame);
+    ProtoWorld world;
+    proto_world_init(&world);
+    uint32_t cells[16] = {0};
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 0);
+    ASSERT_EQ(shm_world_writer_publish(writer, &frame, cells, 4, 4), -1);
+
+    frame.tick = 1;
+    frame.paused = true;
+    frame.colony_count = 1;
+    frame.colonies[0].id = 9;
+    cells[5] = 9;
+    ASSERT_EQ(shm_world_writer_publish(writer, &frame, cells, 4, 2), 0);
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 1);
+    ASSERT_EQ(world.tick, 1u);
+    ASSERT_TRUE(world.paused);
+    ASSERT_EQ(world.width, 4u);
+    ASSERT_EQ(world.height, 2u);
+    ASSERT_EQ(world.grid_size, 8u);
+    ASSERT_EQ(world.grid[5], 9u);
+    ASSERT_EQ(proto_world_colony_total(&world), 1u);
+    ASSERT_EQ(world.colonies[0].id, 9u);
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 0);
+
+    // Lapping the ring leaves the reader with the newest frame only
+    for (uint32_t tick = 2; tick <= 2 + SHM_WORLD_SLOTS; tick++) {
+        frame.tick = tick;
+        cells[0] = tick;
+        ASSERT_EQ(shm_world_writer_publish(writer, &frame, cells, 4, 2), 0);
+    }
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 1);
+    ASSERT_EQ(world.tick, 2u + SHM_WORLD_SLOTS);
+    ASSERT_EQ(world.grid[0], 2u + SHM_WORLD_SLOTS);
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 0);
+
+    // A new writer under the same name leaves mapped readers on the old
+    // segment, intact, and new readers find the new one
+    ShmWorldWriter* successor = shm_world_writer_create(name, 8, 4, 7001);
+    ASSERT_TRUE(successor != NULL);
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 0);
+    ASSERT_EQ(shm_world_reader_port(reader), 7000);
+    ShmWorldReader* fresh = shm_world_reader_open(name);
+    ASSERT_TRUE(fresh != NULL);
+    ASSERT_EQ(shm_world_reader_port(fresh), 7001);
+    frame.tick = 100;
+    ASSERT_EQ(shm_world_writer_publish(successor, &frame, cells, 4, 2), 0);
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 0);
+    ASSERT_EQ(world.tick, 2u + SHM_WORLD_SLOTS);
+    frame.tick = 50;
+    ASSERT_EQ(shm_world_writer_publish(writer, &frame, cells, 4, 2), 0);
+    ASSERT_EQ(shm_world_reader_read(reader, &world), 1);
+    ASSERT_EQ(world.tick, 50u);
+    ASSERT_EQ(shm_world_reader_read(fresh, &world), 1);
+    ASSERT_EQ(world.tick, 100u);
+    ASSERT_EQ(shm_world_reader_read(fresh, &world), 0);
+
+    // Only the writer that owns the name removes it
+    shm_world_writer_destroy(writer);
+    ShmWorldReader* still = shm_world_reader_open(name);
+    ASSERT_TRUE(still != NULL);
+    ASSERT_EQ(shm_world_reader_port(still), 7001);
+    shm_world_reader_close(still);
+    shm_world_writer_destroy(successor);
+    ASSERT_TRUE(shm_world_reader_open(name) == NULL);
+
+    proto_world_free(&frame);
+    proto_world_free(&world);
+    shm_world_reader_close(fresh);
+    shm_world_reader_close(reader);
+}
+
+typedef struct {
+    ShmWorldWriter* writer;
+    atomic_bool stop;
+} ShmWriterArgs;
+
+// Every frame fills the grid with its own tick, so a torn copy shows as a mix
+static void* shm_world_writer_loop(void* arg) {
+    ShmWriterArgs* args = (ShmWriterArgs*)arg;
+    ProtoWorld world;
+    proto_world_init(&world);
+    uint32_t* cells = (uint32_t*)malloc(64u * 64u * sizeof(uint32_t));
+    for (uint32_t tick = 1; cells && !atomic_load(&args->stop); tick++) {
+        for (uint32_t i = 0; i < 64u * 64u; i++) {
+            cells[i] = tick;
+        }
+        world.tick = tick;
+        world.colony_count = 1;
+        world.colonies[0].id = tick;
+        shm_world_writer_publish(args->writer, &world, cells, 64, 64);
+    }
+    free(cells);
+    return NULL;
+}
+
+TEST(shm_world_readers_never_keep_a_torn_frame) {
+    char name[64];
+    snprintf(name, sizeof(name), "/ferox-torn-%d", (int)getpid());
+    ShmWriterArgs args = { .writer = shm_world_writer_create(name, 64u * 64u, 16, 0) };
+    atomic_init(&args.stop, false);
+    ASSERT_TRUE(args.writer != NULL);
+    ASSERT_TRUE(shm_world_writer_create("no-slash", 16, 1, 0) == NULL);
+    ShmWorldReader* reader = shm_world_reader_open(name);
+    ASSERT_TRUE(reader != NULL);
+
+    pthread_t thread;
+    ASSERT_EQ(pthread_create(&thread, NULL, shm_world_writer_loop, &args), 0);
+    ProtoWorld world;
+    proto_world_init(&world);
+    int frames = 0;
+    bool consistent = true;
+    uint32_t last_tick = 0;
+    uint64_t deadline = frame_schedule_now_ns() + 2ull * FRAME_SCHEDULE_NS_PER_SEC;
+    while (frames < 200 && consistent && frame_schedule_now_ns() < deadline) {
+        if (shm_world_reader_read(reader, &world) != 1) {
+            continue;
+        }
+        frames++;
+        consistent = world.tick > last_tick && world.colonies[0].id == world.tick &&
+                     world.grid_size == 64u * 64u;
+        for (uint32_t c = 0; consistent && c < world.grid_size; c++) {
+            consistent = world.grid[c] == world.tick;
+        }
+        last_tick = world.tick;
+    }
+    atomic_store(&args.stop, true);
+    pthread_join(thread, NULL);
+    ASSERT_TRUE(consistent);
+    ASSERT_TRUE(frames > 0);
+
+    proto_world_free(&world);
+    shm_world_reader_close(reader);
+    shm_world_writer_destroy(args.writer);
+}
+
+TEST(server_broadcast_compresses_for_negotiating_clients) {
+    Server* server = server_create(0, 64, 32, 2);
+    ASSERT_TRUE(server != NULL);
+    server->compress_min_bytes = 64;
+
+    int fds_a[2] = {-1, -1};
+    int fds_b[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_a), 0);
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_b), 0);
+    ClientSession* packed = server_add_client(server, make_mock_socket(true, fds_a[0]));
+    ClientSession* plain = server_add_client(server, make_mock_socket(true, fds_b[0]));
+    ASSERT_TRUE(packed != NULL && plain != NULL);
+
+    ASSERT_EQ(send_connect(fds_a[1], true), 0);
+    ASSERT_EQ(send_connect(fds_b[1], false), 0);
+    server_process_clients(server);
+    ASSERT_TRUE(packed->compress);
+    ASSERT_TRUE(!plain->compress);
+
+    for (int i = 0; i < 64 * 32; i++) {
+        server->world->cells[i].colony_id = (uint32_t)((i / 5) % 3);
+    }
+    server->world->tick = 5;
+    server_broadcast_world_state(server);
+
+    // Raw header carries the flag; unpacking restores the plain payload
+    uint8_t header_buf[MESSAGE_HEADER_SIZE];
+    ASSERT_EQ(recv(fds_a[1], header_buf, sizeof(header_buf), MSG_WAITALL), (ssize_t)sizeof(header_buf));
+    MessageHeader header;
+    ASSERT_EQ(protocol_deserialize_header(header_buf, &header), MESSAGE_HEADER_SIZE);
+    ASSERT_EQ(header.type, (uint16_t)(MSG_WORLD_STATE | MSG_FLAG_COMPRESSED));
+    uint8_t* packed_payload = (uint8_t*)malloc(header.payload_len);
+    ASSERT_TRUE(packed_payload != NULL);
+    ASSERT_EQ(recv(fds_a[1], packed_payload, header.payload_len, MSG_WAITALL), (ssize_t)header.payload_len);
+    ASSERT_EQ(protocol_unpack_payload(&header, &packed_payload), 0);
+    ASSERT_EQ(header.type, (uint16_t)MSG_WORLD_STATE);
+
+    MessageType type;
+    uint8_t* plain_payload = NULL;
+    size_t plain_len = 0;
+    ASSERT_EQ(read_world_message(fds_b[1], &type, &plain_payload, &plain_len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    ASSERT_EQ(header.payload_len, plain_len);
+    ASSERT_EQ(memcmp(packed_payload, plain_payload, plain_len), 0);
+    ASSERT_TRUE(packed->world_bytes_sent < plain->world_bytes_sent);
+
+    free(packed_payload);
+    free(plain_payload);
+    server_destroy(server);
+    close(fds_a[1]);
+    close(fds_b[1]);
+}
+
+TEST(server_pages_colonies_and_widens_ids_for_capable_clients) {
+    Server* server = server_create(0, 64, 32, 2);
+    ASSERT_TRUE(server != NULL);
+
+    int fds_a[2] = {-1, -1};
+    int fds_b[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_a), 0);
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_b), 0);
+    ClientSession* wide = server_add_client(server, make_mock_socket(true, fds_a[0]));
+    ClientSession* legacy = server_add_client(server, make_mock_socket(true, fds_b[0]));
+    ASSERT_TRUE(wide != NULL && legacy != NULL);
+    ASSERT_EQ(send_connect_caps(fds_a[1], PROTO_CAP_WIDE_IDS | PROTO_CAP_COLONY_PAGES), 0);
+    server_process_clients(server);
+    ASSERT_EQ(wide->capabilities, PROTO_CAP_WIDE_IDS | PROTO_CAP_COLONY_PAGES | PROTO_CAP_LEGACY_DEFAULT);
+
+    // 300 live colonies, the last one past 16 bits
+    const uint32_t total = MAX_COLONIES + 44u;
+    uint32_t last_id = 0;
+    for (uint32_t i = 0; i < total; i++) {
+        if (i == total - 1u) {
+            atomic_store(&server->world->next_colony_id, 70000u);
+        }
+        Colony colony;
+        memset(&colony, 0, sizeof(colony));
+        colony.active = true;
+        colony.cell_count = 1;
+        last_id = world_add_colony(server->world, colony);
+        ASSERT_TRUE(last_id != 0);
+        server->world->cells[i].colony_id = last_id;
+    }
+    ASSERT_EQ(last_id, 70000u);
+    server->world->tick = 7;
+    server_broadcast_world_state(server);
+
+    MessageType type;
+    uint8_t* payload = NULL;
+    size_t len = 0;
+    ASSERT_EQ(read_world_message(fds_a[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    ProtoWorld local;
+    proto_world_init(&local);
+    ASSERT_EQ(protocol_deserialize_world_state(payload, len, &local), 0);
+    free(payload);
+    ASSERT_EQ(local.colony_count, (uint32_t)MAX_COLONIES);
+    ASSERT_TRUE(!local.has_grid);
+
+    ASSERT_EQ(read_world_message(fds_a[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_DELTA);
+    ProtoWorldDeltaGridChunk chunk;
+    proto_world_delta_grid_chunk_init(&chunk);
+    ASSERT_EQ(protocol_deserialize_world_delta_grid_chunk(payload, len, &chunk), 0);
+    free(payload);
+    ASSERT_TRUE(chunk.final_chunk);
+    ASSERT_EQ(chunk.cells[total - 1u], 70000u);
+    proto_world_delta_grid_chunk_free(&chunk);
+
+    ASSERT_EQ(read_world_message(fds_a[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_COLONY_PAGE);
+    ProtoColonyPage page;
+    ASSERT_EQ(protocol_deserialize_colony_page(payload, len, &page), 0);
+    free(payload);
+    ASSERT_EQ(page.total_count, total);
+    ASSERT_EQ(proto_world_apply_colony_page(&local, &page), 0);
+    proto_colony_page_free(&page);
+    ASSERT_TRUE(proto_world_find_colony(&local, 70000u) != NULL);
+    proto_world_free(&local);
+
+    // Without the capabilities: colony table only, no grid to misread
+    ASSERT_EQ(read_world_message(fds_b[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    free(payload);
+    uint8_t extra;
+    ASSERT_EQ(recv(fds_b[1], &extra, 1, MSG_DONTWAIT), -1);
+    ASSERT_EQ(legacy->keyframes_sent, 0u);
+
+    server_destroy(server);
+    close(fds_a[1]);
+    close(fds_b[1]);
+}
+
+TEST(server_sends_colony_table_deltas_against_acked_tick) {
+    Server* server = server_create(0, 64, 32, 2);
+    ASSERT_TRUE(server != NULL);
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ClientSession* client = server_add_client(server, make_mock_socket(true, fds[0]));
+    ASSERT_TRUE(client != NULL);
+    ASSERT_EQ(send_connect_caps(fds[1], PROTO_CAP_COLONY_DELTA), 0);
+    server_process_clients(server);
+
+    uint32_t ids[3];
+    for (int i = 0; i < 3; i++) {
+        Colony colony;
+        memset(&colony, 0, sizeof(colony));
+        snprintf(colony.name, sizeof(colony.name), "Strain %d", i);
+        colony.active = true;
+        colony.cell_count = 1;
+        ids[i] = world_add_colony(server->world, colony);
+        ASSERT_TRUE(ids[i] != 0);
+        server->world->cells[i * 10].colony_id = ids[i];
+    }
+    server->world->tick = 10;
+    server_broadcast_world_state(server);
+
+    // Whole table first; inline keyframes keep the state shared with other clients
+    MessageType type;
+    uint8_t* payload = NULL;
+    size_t len = 0;
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_COLONY_DELTA);
+    ProtoColonyDelta delta;
+    ASSERT_EQ(protocol_deserialize_colony_delta(payload, len, &delta), 0);
+    free(payload);
+    ASSERT_TRUE(delta.full);
+    ASSERT_EQ(delta.tick, 10u);
+    ASSERT_EQ(delta.total_count, 3u);
+    ProtoWorld local;
+    proto_world_init(&local);
+    ASSERT_EQ(proto_world_apply_colony_delta(&local, &delta), 0);
+    proto_colony_delta_free(&delta);
+
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    ProtoWorld state;
+    proto_world_init(&state);
+    ASSERT_EQ(protocol_deserialize_world_state(payload, len, &state), 0);
+    free(payload);
+    ASSERT_EQ(state.colony_count, 3u);
+    ASSERT_TRUE(state.has_grid);
+    proto_world_free(&state);
+    server_note_world_ack(server, client, 10);
+
+    // One colony grows, one dies: two records instead of the table
+    server->world->colonies[0].cell_count = 5;
+    server->world->colonies[2].active = false;
+    server->world->cells[20].colony_id = 0;
+    server->world->tick = 11;
+    server_broadcast_world_state(server);
+
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_COLONY_DELTA);
+    ASSERT_EQ(protocol_deserialize_colony_delta(payload, len, &delta), 0);
+    free(payload);
+    ASSERT_TRUE(!delta.full);
+    ASSERT_EQ(delta.base_tick, 10u);
+    ASSERT_EQ(delta.removed_count, 1u);
+    ASSERT_EQ(delta.removed[0], ids[2]);
+    ASSERT_EQ(delta.descriptor_count, 0u);
+    ASSERT_EQ(delta.dynamic_count, 1u);
+    ASSERT_EQ(delta.dynamics[0].id, ids[0]);
+    ASSERT_EQ(proto_world_apply_colony_delta(&local, &delta), 0);
+    proto_colony_delta_free(&delta);
+    ASSERT_EQ(proto_world_colony_total(&local), 2u);
+    ASSERT_EQ(proto_world_find_colony(&local, ids[0])->population, 5u);
+    ASSERT_EQ(strcmp(proto_world_find_colony(&local, ids[1])->name, "Strain 1"), 0);
+
+    // The delta's state leaves the table out
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    proto_world_init(&state);
+    ASSERT_EQ(protocol_deserialize_world_state(payload, len, &state), 0);
+    free(payload);
+    ASSERT_EQ(state.colony_count, 0u);
+    ASSERT_EQ(state.tick, 11u);
+    proto_world_free(&state);
+
+    proto_world_free(&local);
+    server_destroy(server);
+    close(fds[1]);
+}
+
+TEST(server_resends_colony_info_only_when_detail_changes) {
+    Server* server = server_create(0, 32, 16, 2);
+    ASSERT_TRUE(server != NULL);
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ClientSession* client = server_add_client(server, make_mock_socket(true, fds[0]));
+    ASSERT_TRUE(client != NULL);
+
+    Colony colony;
+    memset(&colony, 0, sizeof(colony));
+    colony.active = true;
+    colony.cell_count = 2;
+    uint32_t id = world_add_colony(server->world, colony);
+    ASSERT_TRUE(id != 0);
+    server->world->cells[5].colony_id = id;
+    server->world->cells[6].colony_id = id;
+
+    CommandSelectColony select_colony = {.colony_id = id};
+    server_handle_command(server, client, CMD_SELECT_COLONY, &select_colony);
+    MessageType type;
+    ASSERT_EQ(read_command_status_message(fds[1], &type, NULL), 0);
+    ASSERT_EQ(type, MSG_ACK);
+    ASSERT_EQ(read_command_status_message(fds[1], &type, NULL), 0);
+    ASSERT_EQ(type, MSG_COLONY_INFO);
+    ASSERT_TRUE(client->has_sent_colony_info);
+
+    // Only the tick moved: the world state goes out, the detail does not
+    server->world->tick = 1;
+    server_broadcast_world_state(server);
+    uint8_t* payload = NULL;
+    size_t len = 0;
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    free(payload);
+    uint8_t extra;
+    ASSERT_EQ(recv(fds[1], &extra, 1, MSG_DONTWAIT), -1);
+
+    // Growth changes the detail; the genome-derived part comes from the cache
+    uint64_t clock = server->colony_detail_clock;
+    world_get_colony(server->world, id)->cell_count = 3;
+    server->world->cells[7].colony_id = id;
+    server->world->tick = 2;
+    server_broadcast_world_state(server);
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    free(payload);
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_DELTA);
+    free(payload);
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_COLONY_INFO);
+    ProtoColonyDetail detail;
+    ASSERT_TRUE(protocol_deserialize_colony_detail(payload, &detail) >= 0);
+    free(payload);
+    ASSERT_EQ(detail.base.population, 3u);
+    ASSERT_FLOAT_EQ(detail.base.x, 6.0f);
+    ASSERT_EQ(detail.tick, 2u);
+    ASSERT_EQ(server->colony_detail_clock, clock + 1u);
+    int cached = 0;
+    for (int i = 0; i < SERVER_COLONY_DETAIL_CACHE_SLOTS; i++) {
+        cached += server->colony_detail_cache[i].colony_id == id;
+    }
+    ASSERT_EQ(cached, 1);
+
+    server_destroy(server);
+    close(fds[1]);
+}
+
+TEST(server_viewport_limits_keyframe_chunks_and_deltas) {
+    // Too large to inline: 8 keyframe chunks of 64 rows each
+    Server* server = server_create(0, 1024, 512, 2);
+    ASSERT_TRUE(server != NULL);
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ClientSession* client = server_add_client(server, make_mock_socket(true, fds[0]));
+    ASSERT_TRUE(client != NULL);
+
+    // Rows 284..347 with the margin: chunks 4 and 5
+    CommandSetViewport view = { .x = 40, .y = 300, .width = 64, .height = 32 };
+    server_handle_command(server, client, CMD_SET_VIEWPORT, &view);
+    ASSERT_TRUE(client->has_viewport);
+
+    server->world->cells[310 * 1024 + 50].colony_id = 3;
+    server->world->tick = 10;
+    server_broadcast_world_state(server);
+
+    MessageType type;
+    uint8_t* payload = NULL;
+    size_t len = 0;
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    free(payload);
+    uint32_t expected_start[2] = { 4u * MAX_GRID_CHUNK_CELLS, 5u * MAX_GRID_CHUNK_CELLS };
+    for (int c = 0; c < 2; c++) {
+        ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+        ASSERT_EQ(type, MSG_WORLD_DELTA);
+        ProtoWorldDeltaGridChunk chunk;
+        proto_world_delta_grid_chunk_init(&chunk);
+        ASSERT_EQ(protocol_deserialize_world_delta_grid_chunk(payload, len, &chunk), 0);
+        free(payload);
+        ASSERT_EQ(chunk.start_index, expected_start[c]);
+        ASSERT_EQ(chunk.final_chunk, c == 1);
+        if (c == 0) {
+            ASSERT_EQ(chunk.cells[310 * 1024 + 50 - expected_start[0]], 3u);
+        }
+        proto_world_delta_grid_chunk_free(&chunk);
+    }
+    ASSERT_EQ(client->keyframes_sent, 1u);
+    server_note_world_ack(server, client, 10);
+
+    // Inside the view, inside the margin, beside it on the same row, far away
+    server->world->cells[310 * 1024 + 50].colony_id = 1;
+    server->world->cells[290 * 1024 + 30].colony_id = 2;
+    server->world->cells[310 * 1024 + 600].colony_id = 2;
+    server->world->cells[10 * 1024 + 10].colony_id = 2;
+    server->world->tick = 11;
+    server_broadcast_world_state(server);
+
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    free(payload);
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_DELTA);
+    ProtoWorldDeltaSpans delta;
+    proto_world_delta_spans_init(&delta);
+    ASSERT_EQ(protocol_deserialize_world_delta_spans(payload, len, &delta), 0);
+    free(payload);
+    ASSERT_EQ(delta.span_count, 2u);
+    ASSERT_EQ(delta.spans[0].start, 290u * 1024u + 30u);
+    ASSERT_EQ(delta.spans[1].start, 310u * 1024u + 50u);
+    ASSERT_EQ(delta.cells[1], 1u);
+    proto_world_delta_spans_free(&delta);
+
+    // Clearing the viewport resends every chunk
+    CommandSetViewport full = {0};
+    server_handle_command(server, client, CMD_SET_VIEWPORT, &full);
+    ASSERT_TRUE(!client->has_viewport);
+    ASSERT_TRUE(!client->keyframe_sent);
+    server->world->tick = 12;
+    server_broadcast_world_state(server);
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    free(payload);
+    for (uint32_t c = 0; c < 8; c++) {
+        ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+        ASSERT_EQ(type, MSG_WORLD_DELTA);
+        ProtoWorldDeltaGridChunk chunk;
+        proto_world_delta_grid_chunk_init(&chunk);
+        ASSERT_EQ(protocol_deserialize_world_delta_grid_chunk(payload, len, &chunk), 0);
+        free(payload);
+        ASSERT_EQ(chunk.start_index, c * MAX_GRID_CHUNK_CELLS);
+        ASSERT_EQ(chunk.final_chunk, c == 7);
+        proto_world_delta_grid_chunk_free(&chunk);
+    }
+    ASSERT_EQ(client->keyframes_sent, 2u);
+
+    server_destroy(server);
+    close(fds[1]);
+}
+
+TEST(server_encodes_keyframe_chunks_on_the_pool_in_order) {
+    Server* server = server_create(0, 1024, 512, 4);
+    ASSERT_TRUE(server != NULL);
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ClientSession* client = server_add_client(server, make_mock_socket(true, fds[0]));
+    ASSERT_TRUE(client != NULL);
+
+    // Runs of varying length so every chunk encodes differently
+    uint32_t grid_size = 1024u * 512u;
+    for (uint32_t i = 0; i < grid_size; i++) {
+        server->world->cells[i].colony_id = (i / (7u + (i >> 16))) % 5u;
+    }
+    server->world->tick = 3;
+    server_broadcast_world_state(server);
+
+    MessageType type;
+    uint8_t* payload = NULL;
+    size_t len = 0;
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    free(payload);
+    uint32_t chunk_count = (grid_size + MAX_GRID_CHUNK_CELLS - 1u) / MAX_GRID_CHUNK_CELLS;
+    for (uint32_t c = 0; c < chunk_count; c++) {
+        ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+        ASSERT_EQ(type, MSG_WORLD_DELTA);
+        ProtoWorldDeltaGridChunk chunk;
+        proto_world_delta_grid_chunk_init(&chunk);
+        ASSERT_EQ(protocol_deserialize_world_delta_grid_chunk(payload, len, &chunk), 0);
+        free(payload);
+        ASSERT_EQ(chunk.tick, 3u);
+        ASSERT_EQ(chunk.start_index, c * MAX_GRID_CHUNK_CELLS);
+        ASSERT_EQ(chunk.final_chunk, c + 1u == chunk_count);
+        bool same = true;
+        for (uint32_t i = 0; i < chunk.cell_count && same; i++) {
+            same = chunk.cells[i] == server->world->cells[chunk.start_index + i].colony_id;
+        }
+        proto_world_delta_grid_chunk_free(&chunk);
+        ASSERT_TRUE(same);
+    }
+    ASSERT_EQ(client->keyframes_sent, 1u);
+
+    server_destroy(server);
+    close(fds[1]);
+}
+
+TEST(grid_pyramid_tracks_block_majority_incrementally) {
+    // 5x3 base: level 1 is 3x2, level 2 is 2x1, level 3 is 1x1
+    uint32_t base[15] = {
+        1, 1, 2, 0, 4,
+        1, 0, 2, 2, 0,
+        3, 3, 0, 5, 5,
+    };
+    GridPyramid pyramid;
+    grid_pyramid_init(&pyramid);
+    ASSERT_EQ(grid_pyramid_build(&pyramid, base, 5, 3, 10), 0);
+    ASSERT_EQ(pyramid.level_count, 3u);
+
+    const GridPyramidLevel* level1 = grid_pyramid_level(&pyramid, 1);
+    ASSERT_TRUE(level1 != NULL);
+    ASSERT_EQ(level1->width, 3u);
+    ASSERT_EQ(level1->height, 2u);
+    // {1,1,1,0} -> 1; {2,0,2,2} -> 2; {4,0} ties to the colony; {3,3} -> 3; {0,5} -> 5; {5} -> 5
+    uint32_t expected[6] = { 1, 2, 4, 3, 5, 5 };
+    for (int i = 0; i < 6; i++) {
+        ASSERT_EQ(level1->cells[i], expected[i]);
+    }
+    ASSERT_TRUE(grid_pyramid_level(&pyramid, 0) == NULL);
+    ASSERT_TRUE(grid_pyramid_level(&pyramid, 4) == NULL);
+
+    // Flip the top-left block to colony 6; only changed cells get the new tick
+    base[0] = 6;
+    base[1] = 6;
+    base[5] = 6;
+    grid_pyramid_mark(&pyramid, 0);
+    grid_pyramid_mark(&pyramid, 1);
+    grid_pyramid_mark(&pyramid, 5);
+    grid_pyramid_update(&pyramid, base, 11);
+    ASSERT_EQ(level1->cells[0], 6u);
+    ASSERT_EQ(level1->changed_tick[0], 11u);
+    ASSERT_EQ(level1->changed_tick[1], 10u);
+
+    // Incremental result matches a rebuild at every level
+    GridPyramid fresh;
+    grid_pyramid_init(&fresh);
+    ASSERT_EQ(grid_pyramid_build(&fresh, base, 5, 3, 11), 0);
+    for (uint32_t level = 1; level <= pyramid.level_count; level++) {
+        const GridPyramidLevel* a = grid_pyramid_level(&pyramid, level);
+        const GridPyramidLevel* b = grid_pyramid_level(&fresh, level);
+        ASSERT_EQ(memcmp(a->cells, b->cells, (size_t)a->width * a->height * sizeof(uint32_t)), 0);
+    }
+
+    grid_pyramid_destroy(&fresh);
+    grid_pyramid_destroy(&pyramid);
+}
+
+TEST(server_streams_pyramid_level_to_zoomed_out_client) {
+    Server* server = server_create(0, 64, 32, 2);
+    ASSERT_TRUE(server != NULL);
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ClientSession* client = server_add_client(server, make_mock_socket(true, fds[0]));
+    ASSERT_TRUE(client != NULL);
+
+    CommandSetViewport view = { .level = 2 };
+    server_handle_command(server, client, CMD_SET_VIEWPORT, &view);
+    ASSERT_TRUE(server->pyramid_wanted);
+    ASSERT_TRUE(!client->has_viewport);
+
+    for (int y = 0; y < 32; y++) {
+        for (int x = 0; x < 64; x++) {
+            server->world->cells[y * 64 + x].colony_id = x < 32 ? 1u : 2u;
+        }
+    }
+    server->world->tick = 10;
+    server_broadcast_world_state(server);
+
+    // Small world, but the level grid replaces the inline full grid
+    MessageType type;
+    uint8_t* payload = NULL;
+    size_t len = 0;
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    ProtoWorld state;
+    proto_world_init(&state);
+    ASSERT_EQ(protocol_deserialize_world_state(payload, len, &state), 0);
+    free(payload);
+    ASSERT_TRUE(!state.has_grid);
+    proto_world_free(&state);
+
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_DELTA);
+    ProtoWorldDeltaGridChunk chunk;
+    proto_world_delta_grid_chunk_init(&chunk);
+    ASSERT_EQ(protocol_deserialize_world_delta_grid_chunk(payload, len, &chunk), 0);
+    free(payload);
+    ASSERT_EQ(chunk.width, 16u);
+    ASSERT_EQ(chunk.height, 8u);
+    ASSERT_EQ(chunk.cell_count, 128u);
+    ASSERT_TRUE(chunk.final_chunk);
+    ASSERT_EQ(chunk.cells[0], 1u);
+    ASSERT_EQ(chunk.cells[15], 2u);
+    proto_world_delta_grid_chunk_free(&chunk);
+    server_note_world_ack(server, client, 10);
+
+    // A 4x4 block flipping changes one level-2 cell; a single stray cell does not
+    for (int y = 8; y < 12; y++) {
+        for (int x = 4; x < 8; x++) {
+            server->world->cells[y * 64 + x].colony_id = 3;
+        }
+    }
+    server->world->cells[20 * 64 + 40].colony_id = 3;
+    server->world->tick = 11;
+    server_broadcast_world_state(server);
+
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_STATE);
+    free(payload);
+    ASSERT_EQ(read_world_message(fds[1], &type, &payload, &len), 0);
+    ASSERT_EQ(type, MSG_WORLD_DELTA);
+    ProtoWorldDeltaSpans delta;
+    proto_world_delta_spans_init(&delta);
+    ASSERT_EQ(protocol_deserialize_world_delta_spans(payload, len, &delta), 0);
+    free(payload);
+    ASSERT_EQ(delta.width, 16u);
+    ASSERT_EQ(delta.height, 8u);
+    ASSERT_EQ(delta.span_count, 1u);
+    ASSERT_EQ(delta.spans[0].start, 2u * 16u + 1u);
+    ASSERT_EQ(delta.cells[0], 3u);
+    proto_world_delta_spans_free(&delta);
+
+    server_destroy(server);
+    close(fds[1]);
+}
+
 TEST(server_remove_client_noop_when_target_missing) {
     Server* server = server_create(0, 20, 20, 2);
     ASSERT_TRUE(server != NULL);
@@ -275,6 +1526,46 @@ TEST(server_process_clients_skips_non_connected_clients) {
     server_destroy(server);
 }
 
+TEST(server_process_clients_reassembles_split_frames) {
+    Server* server = server_create(0, 20, 20, 2);
+    ASSERT_TRUE(server != NULL);
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ClientSession* client = server_add_client(server, make_mock_socket(true, fds[0]));
+    ASSERT_TRUE(client != NULL);
+
+    uint8_t frame[MESSAGE_HEADER_SIZE + 64];
+    int payload_len = protocol_serialize_command(CMD_PAUSE, NULL, frame + MESSAGE_HEADER_SIZE);
+    ASSERT_TRUE(payload_len > 0);
+    MessageHeader header = {
+        .magic = PROTOCOL_MAGIC,
+        .type = MSG_COMMAND,
+        .payload_len = (uint32_t)payload_len,
+        .sequence = 1
+    };
+    ASSERT_EQ(protocol_serialize_header(&header, frame), MESSAGE_HEADER_SIZE);
+    size_t frame_len = MESSAGE_HEADER_SIZE + (size_t)payload_len;
+
+    // Half a header: nothing to apply yet, and nothing blocks
+    ASSERT_EQ(send(fds[1], frame, 5, 0), 5);
+    server_process_clients(server);
+    ASSERT_TRUE(!server->paused);
+    ASSERT_EQ(client->reader.len, 5u);
+
+    ASSERT_EQ(send(fds[1], frame + 5, frame_len - 5, 0), (ssize_t)(frame_len - 5));
+    server_process_clients(server);
+    ASSERT_TRUE(server->paused);
+    ASSERT_EQ(client->reader.len, 0u);
+
+    // EOF is delivered after earlier frames as a disconnect
+    close(fds[1]);
+    server_process_clients(server);
+    ASSERT_TRUE(!client->active);
+
+    server_destroy(server);
+}
+
 TEST(server_stop_and_get_port_guard_branches) {
     Server* server = server_create(0, 20, 20, 2);
     ASSERT_TRUE(server != NULL);
@@ -293,15 +1584,391 @@ TEST(server_stop_and_get_port_guard_branches) {
     server_destroy(server);
 }
 
+TEST(world_snapshot_recycles_buffers_and_keeps_held_copies) {
+    World* world = world_create(100, 100);
+    ASSERT_TRUE(world != NULL);
+    WorldSnapshotPublisher publisher;
+    world_snapshot_publisher_init(&publisher);
+    ASSERT_TRUE(world_snapshot_acquire(&publisher) == NULL);
+
+    world->cells[5].colony_id = 3;
+    world->tick = 1;
+    WorldSnapshot* first = world_snapshot_begin(&publisher, world);
+    ASSERT_TRUE(first != NULL);
+    ASSERT_EQ(first->tile_count, 3u);
+    world_snapshot_publish(&publisher, first);
+    WorldSnapshot* held = world_snapshot_acquire(&publisher);
+    ASSERT_TRUE(held == first);
+
+    // A held snapshot is left alone; the next one goes into a new buffer
+    world->cells[9000].colony_id = 7;
+    world->tick = 2;
+    WorldSnapshot* second = world_snapshot_begin(&publisher, world);
+    ASSERT_TRUE(second != NULL && second != first);
+    world_snapshot_publish(&publisher, second);
+    ASSERT_EQ(held->tick, 1u);
+    ASSERT_EQ(held->cells[9000], 0u);
+    ASSERT_EQ(second->cells[9000], 7u);
+    ASSERT_EQ(second->cells[5], 3u);
+    ASSERT_EQ(second->tile_tick[0], 1u);
+    ASSERT_EQ(second->tile_tick[1], 1u);
+    ASSERT_EQ(second->tile_tick[2], 2u);
+    world_snapshot_release(held);
+
+    // The freed buffer is recycled and only its stale tile is rewritten
+    uint64_t written = publisher.tiles_written;
+    world->tick = 3;
+    WorldSnapshot* third = world_snapshot_begin(&publisher, world);
+    ASSERT_TRUE(third == first);
+    ASSERT_EQ(publisher.tiles_reused, 2u);
+    ASSERT_EQ(publisher.tiles_written, written + 1u);
+    ASSERT_EQ(third->cells[9000], 7u);
+    ASSERT_EQ(third->tile_tick[2], 2u);
+    world_snapshot_publish(&publisher, third);
+
+    // A tick that does not advance starts a new history
+    world->tick = 3;
+    WorldSnapshot* restarted = world_snapshot_begin(&publisher, world);
+    ASSERT_TRUE(restarted != NULL);
+    ASSERT_TRUE(restarted->generation != third->generation);
+    ASSERT_EQ(restarted->tile_tick[0], 3u);
+    world_snapshot_abandon(&publisher, restarted);
+    ASSERT_TRUE(world_snapshot_acquire(&publisher) == third);
+    world_snapshot_release(third);
+
+    world_snapshot_publisher_destroy(&publisher);
+    world_destroy(world);
+}
+
+typedef struct {
+    WorldSnapshotPublisher* publisher;
+    atomic_bool done;
+    atomic_uint torn;
+} SnapshotReaderArgs;
+
+static void* snapshot_reader_thread(void* arg) {
+    SnapshotReaderArgs* args = (SnapshotReaderArgs*)arg;
+    while (!atomic_load(&args->done)) {
+        WorldSnapshot* snapshot = world_snapshot_acquire(args->publisher);
+        if (!snapshot) {
+            continue;
+        }
+        // Every cell of tick T holds T; anything else was rewritten under us
+        for (uint32_t i = 0; i < snapshot->width * snapshot->height; i++) {
+            if (snapshot->cells[i] != snapshot->tick) {
+                atomic_fetch_add(&args->torn, 1u);
+                break;
+            }
+        }
+        world_snapshot_release(snapshot);
+    }
+    return NULL;
+}
+
+TEST(world_snapshot_readers_never_see_a_buffer_being_rewritten) {
+    World* world = world_create(96, 64);
+    ASSERT_TRUE(world != NULL);
+    WorldSnapshotPublisher publisher;
+    world_snapshot_publisher_init(&publisher);
+    SnapshotReaderArgs args = { .publisher = &publisher };
+    atomic_init(&args.done, false);
+    atomic_init(&args.torn, 0u);
+
+    pthread_t readers[2];
+    for (int r = 0; r < 2; r++) {
+        ASSERT_EQ(pthread_create(&readers[r], NULL, snapshot_reader_thread, &args), 0);
+    }
+    for (uint32_t tick = 1; tick <= 3000; tick++) {
+        for (int i = 0; i < 96 * 64; i++) {
+            world->cells[i].colony_id = tick;
+        }
+        world->tick = tick;
+        WorldSnapshot* snapshot = world_snapshot_begin(&publisher, world);
+        if (snapshot) {
+            world_snapshot_publish(&publisher, snapshot);
+        }
+    }
+    atomic_store(&args.done, true);
+    for (int r = 0; r < 2; r++) {
+        pthread_join(readers[r], NULL);
+    }
+    ASSERT_EQ(atomic_load(&args.torn), 0u);
+    ASSERT_TRUE(publisher.slot_count <= 4u);
+
+    world_snapshot_publisher_destroy(&publisher);
+    world_destroy(world);
+}
+
+TEST(server_broadcast_leaves_held_snapshot_intact) {
+    Server* server = server_create(0, 64, 32, 2);
+    ASSERT_TRUE(server != NULL);
+
+    server->world->cells[10].colony_id = 2;
+    server->world->tick = 4;
+    server_broadcast_world_state(server);
+    WorldSnapshot* held = world_snapshot_acquire(&server->snapshots);
+    ASSERT_TRUE(held != NULL);
+    ASSERT_EQ(held->tick, 4u);
+    ASSERT_TRUE(held->world.has_grid);
+    ASSERT_TRUE(held->world.grid == held->cells);
+
+    server->world->cells[10].colony_id = 0;
+    server->world->tick = 5;
+    server_broadcast_world_state(server);
+    ASSERT_EQ(held->cells[10], 2u);
+    ASSERT_EQ(held->tick, 4u);
+    WorldSnapshot* latest = world_snapshot_acquire(&server->snapshots);
+    ASSERT_TRUE(latest != NULL && latest != held);
+    ASSERT_EQ(latest->cells[10], 0u);
+    ASSERT_EQ(latest->world.tick, 5u);
+    world_snapshot_release(latest);
+    world_snapshot_release(held);
+
+    server_destroy(server);
+}
+
+typedef struct {
+    int fd;
+    uint32_t final_tick;
+    uint32_t last_tick;
+    uint32_t states;
+    bool out_of_order;
+} WorldStreamReaderArgs;
+
+static void* world_stream_reader_thread(void* arg) {
+    WorldStreamReaderArgs* args = (WorldStreamReaderArgs*)arg;
+    while (args->last_tick != args->final_tick) {
+        MessageType type;
+        uint8_t* payload = NULL;
+        size_t len = 0;
+        if (read_world_message(args->fd, &type, &payload, &len) < 0) {
+            break;
+        }
+        ProtoWorld state;
+        proto_world_init(&state);
+        if (type == MSG_WORLD_STATE && protocol_deserialize_world_state(payload, len, &state) == 0) {
+            if (args->states > 0 && state.tick <= args->last_tick) {
+                args->out_of_order = true;
+            }
+            args->last_tick = state.tick;
+            args->states++;
+        }
+        proto_world_free(&state);
+        free(payload);
+    }
+    return NULL;
+}
+
+TEST(server_broadcast_thread_sends_newest_snapshot_while_ticking) {
+    Server* server = server_create(0, 64, 32, 2);
+    ASSERT_TRUE(server != NULL);
+
+    int fds[2] = {-1, -1};
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ClientSession* client = server_add_client(server, make_mock_socket(true, fds[0]));
+    ASSERT_TRUE(client != NULL);
+    Colony colony;
+    memset(&colony, 0, sizeof(colony));
+    colony.active = true;
+    colony.cell_count = 1;
+    uint32_t selected = world_add_colony(server->world, colony);
+    ASSERT_TRUE(selected != 0);
+    CommandSelectColony select_colony = {.colony_id = selected};
+    server_handle_command(server, client, CMD_SELECT_COLONY, &select_colony);
+    ASSERT_EQ(server->watched_colony_count, 1u);
+
+    WorldStreamReaderArgs args = {.fd = fds[1], .final_tick = 200};
+    pthread_t reader;
+    ASSERT_EQ(pthread_create(&reader, NULL, world_stream_reader_thread, &args), 0);
+    ASSERT_EQ(server_start_broadcast_thread(server), 0);
+    for (uint32_t tick = 1; tick <= 200; tick++) {
+        server->world->cells[(tick * 13) % (64 * 32)].colony_id = selected;
+        server->world->tick = tick;
+        server_broadcast_world_state(server);
+    }
+    // Stopping sends whatever was handed over last
+    server_stop_broadcast_thread(server);
+    pthread_join(reader, NULL);
+
+    ASSERT_EQ(args.last_tick, 200u);
+    ASSERT_TRUE(!args.out_of_order);
+    ASSERT_EQ(server->broadcast_published, 200u);
+    ASSERT_TRUE(server->broadcast_encoded >= 1u && server->broadcast_encoded <= 200u);
+    ASSERT_TRUE(args.states <= server->broadcast_encoded);
+    WorldSnapshot* latest = world_snapshot_acquire(&server->snapshots);
+    ASSERT_TRUE(latest != NULL);
+    ASSERT_TRUE(world_snapshot_colony_info(latest, selected) != NULL);
+    world_snapshot_release(latest);
+
+    server_destroy(server);
+    close(fds[1]);
+}
+
+TEST(frame_schedule_keeps_phase_and_skips_missed_slots) {
+    FrameSchedule schedule;
+    frame_schedule_init(&schedule, 100, 1000);
+    ASSERT_TRUE(frame_schedule_due(&schedule, 1000));
+
+    // Time spent working does not push later slots back
+    frame_schedule_advance(&schedule, 1030);
+    ASSERT_EQ(schedule.next_ns, 1100u);
+    ASSERT_TRUE(!frame_schedule_due(&schedule, 1099));
+    ASSERT_TRUE(frame_schedule_due(&schedule, 1100));
+
+    // Falling behind skips the missed slots instead of bursting through them
+    frame_schedule_advance(&schedule, 1350);
+    ASSERT_EQ(schedule.next_ns, 1400u);
+
+    // A new period is anchored at the last slot
+    frame_schedule_set_period(&schedule, 50, 1360);
+    ASSERT_EQ(schedule.next_ns, 1350u);
+    frame_schedule_set_period(&schedule, 0, 1360);
+    ASSERT_TRUE(frame_schedule_due(&schedule, 0));
+    frame_schedule_set_period(&schedule, 200, 1500);
+    ASSERT_EQ(schedule.next_ns, 1500u);
+
+    ASSERT_EQ(frame_schedule_period_ns(30.0), 33333333u);
+    ASSERT_EQ(frame_schedule_period_ns(0.0), 0u);
+
+    uint64_t start = frame_schedule_now_ns();
+    frame_schedule_sleep_until(start + 2000000u);
+    ASSERT_TRUE(frame_schedule_now_ns() >= start + 2000000u);
+    frame_schedule_sleep_until(start);
+}
+
+static void* run_server_thread(void* arg) {
+    server_run((Server*)arg);
+    return NULL;
+}
+
+// Threads in this process, or -1 where /proc is not available
+static int count_process_threads(void) {
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir) {
+        return -1;
+    }
+    int count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        count += entry->d_name[0] != '.';
+    }
+    closedir(dir);
+    return count;
+}
+
+TEST(server_run_keeps_threads_within_core_budget) {
+    FeroxHardwareInfo info;
+    ferox_hardware_info_init(&info);
+    info.logical_cpus = 8;
+    FeroxRuntimeTuning tuning;
+    ferox_runtime_tuning_init(&info, FEROX_ACCELERATOR_PREFERENCE_CPU, &tuning);
+    ASSERT_TRUE(tuning.encode_helpers > 0);
+
+    int before = count_process_threads();
+    if (before < 0) {
+        return;
+    }
+    char helpers[16];
+    snprintf(helpers, sizeof(helpers), "%d", tuning.encode_helpers);
+    setenv("FEROX_ENCODE_HELPERS", helpers, 1);
+    Server* server = server_create(0, 64, 32, tuning.recommended_threads);
+    unsetenv("FEROX_ENCODE_HELPERS");
+    ASSERT_TRUE(server != NULL);
+    ASSERT_TRUE(server->encode_pool != NULL);
+    server->tick_rate_ms = 0;
+
+    // The runner is the simulation thread; this one only watches
+    pthread_t runner;
+    ASSERT_EQ(pthread_create(&runner, NULL, run_server_thread, server), 0);
+    uint64_t deadline = frame_schedule_now_ns() + 2ull * FRAME_SCHEDULE_NS_PER_SEC;
+    while (!(server->io_thread_running && server->broadcast_thread_running) &&
+           frame_schedule_now_ns() < deadline) {
+        usleep(1000);
+    }
+    uint64_t ticks_before = server->world->tick;
+    usleep(50000);
+    int running = count_process_threads() - before;
+    bool ticked = server->world->tick > ticks_before;
+    server_stop(server);
+    pthread_join(runner, NULL);
+
+    ASSERT_TRUE(ticked);
+    ASSERT_EQ(running, tuning.core_budget);
+    server_destroy(server);
+    ASSERT_EQ(count_process_threads(), before);
+}
+
+TEST(server_run_broadcasts_at_frame_rate_while_ticking_unpaced) {
+    Server* server = server_create(0, 64, 32, 2);
+    ASSERT_TRUE(server != NULL);
+    server->tick_rate_ms = 0;
+    server->broadcast_hz = 20;
+
+    pthread_t runner;
+    ASSERT_EQ(pthread_create(&runner, NULL, run_server_thread, server), 0);
+    NetSocket* socket = net_client_connect("127.0.0.1", server_get_port(server));
+    ASSERT_TRUE(socket != NULL);
+
+    uint32_t states = 0;
+    uint64_t start = frame_schedule_now_ns();
+    while (frame_schedule_now_ns() - start < 300000000u) {
+        MessageType type;
+        uint8_t* payload = NULL;
+        size_t len = 0;
+        if (read_world_message(socket->fd, &type, &payload, &len) < 0) {
+            break;
+        }
+        states += type == MSG_WORLD_STATE;
+        free(payload);
+    }
+    server_stop(server);
+    pthread_join(runner, NULL);
+    uint64_t ticks = server->world->tick;
+
+    // About 6 frames in 300 ms, however many ticks ran meanwhile
+    ASSERT_TRUE(states >= 2u);
+    ASSERT_TRUE(states <= 9u);
+    ASSERT_TRUE(ticks > 2u * states);
+
+    net_socket_close(socket);
+    server_destroy(server);
+}
+
 int main(void) {
     printf("=== Server Branch Coverage Tests ===\n");
 
     RUN_TEST(server_handle_command_clamps_speed_limits);
     RUN_TEST(server_handle_command_reset_rebuilds_world);
     RUN_TEST(server_handle_command_data_branches_for_select_and_spawn);
+    RUN_TEST(server_broadcast_sends_span_delta_against_acked_tick);
+    RUN_TEST(server_broadcast_shares_encoded_frames_across_clients);
+    RUN_TEST(server_broadcast_coalesces_unsent_world_updates);
+    RUN_TEST(send_queue_keeps_partially_sent_group_when_coalescing);
+    RUN_TEST(send_queue_batches_frames_into_one_sendmsg);
+    RUN_TEST(send_queue_zerocopy_releases_frames_on_completion);
+    RUN_TEST(server_negotiates_version_and_capabilities);
+    RUN_TEST(server_shares_world_through_shm_with_same_host_clients);
+    RUN_TEST(shm_world_writer_round_trips_frames_to_readers);
+    RUN_TEST(shm_world_readers_never_keep_a_torn_frame);
+    RUN_TEST(server_broadcast_compresses_for_negotiating_clients);
+    RUN_TEST(server_pages_colonies_and_widens_ids_for_capable_clients);
+    RUN_TEST(server_sends_colony_table_deltas_against_acked_tick);
+    RUN_TEST(server_resends_colony_info_only_when_detail_changes);
+    RUN_TEST(server_viewport_limits_keyframe_chunks_and_deltas);
+    RUN_TEST(server_encodes_keyframe_chunks_on_the_pool_in_order);
+    RUN_TEST(grid_pyramid_tracks_block_majority_incrementally);
+    RUN_TEST(server_streams_pyramid_level_to_zoomed_out_client);
     RUN_TEST(server_remove_client_noop_when_target_missing);
     RUN_TEST(server_process_clients_skips_non_connected_clients);
+    RUN_TEST(server_process_clients_reassembles_split_frames);
     RUN_TEST(server_stop_and_get_port_guard_branches);
+    RUN_TEST(world_snapshot_recycles_buffers_and_keeps_held_copies);
+    RUN_TEST(world_snapshot_readers_never_see_a_buffer_being_rewritten);
+    RUN_TEST(server_broadcast_leaves_held_snapshot_intact);
+    RUN_TEST(server_broadcast_thread_sends_newest_snapshot_while_ticking);
+    RUN_TEST(frame_schedule_keeps_phase_and_skips_missed_slots);
+    RUN_TEST(server_run_broadcasts_at_frame_rate_while_ticking_unpaced);
+    RUN_TEST(server_run_keeps_threads_within_core_budget);
 
     printf("Passed: %d\n", tests_passed);
     printf("Failed: %d\n", tests_failed);
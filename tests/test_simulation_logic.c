@@ -899,6 +899,79 @@ TEST(atomic_spread_step_swaps_buffers_for_new_claims) {
     world_destroy(world);
 }
 
+// One frontier spread run from a fixed start; writes the grid after `steps`
+static void run_frontier_spread(const Colony* colonies, int colony_count, int steps, uint32_t* out_ids,
+                                int* out_frontier_steps) {
+    World* world = world_create(96, 96);
+    ThreadPool* pool = threadpool_create(4);
+    setenv("FEROX_ATOMIC_FRONTIER_MIN_CHUNK", "1", 1);
+    AtomicWorld* aworld = (world && pool) ? atomic_world_create(world, pool, threadpool_gang_width(pool)) : NULL;
+    unsetenv("FEROX_ATOMIC_FRONTIER_MIN_CHUNK");
+    *out_frontier_steps = 0;
+    if (aworld) {
+        for (int i = 0; i < world->width * world->height; i++) {
+            world->nutrients[i] = 1.0f;
+            world->toxins[i] = 0.0f;
+        }
+        for (int c = 0; c < colony_count; c++) {
+            uint32_t id = world_add_colony(world, colonies[c]);
+            fill_colony_rect(world, id, 8 + c * 72, 8 + c * 72, 3, 3);
+            world_get_colony(world, id)->cell_count = 9;
+        }
+        atomic_world_sync_from_world(aworld);
+        atomic_set_spread_frontier_enabled(aworld, true);
+        for (int step = 0; step < steps; step++) {
+            world->tick++;
+            atomic_spread_step(aworld);
+            *out_frontier_steps += aworld->spread_state.spread_slots_used == aworld->phase_worker_count;
+        }
+        atomic_world_sync_to_world(aworld);
+        for (int i = 0; i < world->width * world->height; i++) {
+            out_ids[i] = world->cells[i].colony_id;
+        }
+    }
+    atomic_world_destroy(aworld);
+    threadpool_destroy(pool);
+    world_destroy(world);
+}
+
+TEST(atomic_frontier_spread_is_independent_of_claim_order) {
+    // Far enough apart never to meet, so no two colonies race for a cell
+    Colony colonies[2];
+    for (int c = 0; c < 2; c++) {
+        colonies[c] = create_test_colony();
+        colonies[c].genome.spread_rate = 0.8f;
+        colonies[c].genome.metabolism = 1.0f;
+        colonies[c].genome.nutrient_sensitivity = 1.0f;
+        for (int d = 0; d < 8; d++) {
+            colonies[c].genome.spread_weights[d] = 0.5f + 0.05f * (float)d;
+        }
+    }
+
+    // Single-cell chunks claimed by five gang members: which worker takes
+    // which chunk differs from run to run, the outcome must not
+    uint32_t* first = (uint32_t*)calloc(96 * 96, sizeof(uint32_t));
+    uint32_t* second = (uint32_t*)calloc(96 * 96, sizeof(uint32_t));
+    ASSERT_NOT_NULL(first);
+    ASSERT_NOT_NULL(second);
+    int frontier_steps = 0;
+    run_frontier_spread(colonies, 2, 10, first, &frontier_steps);
+    ASSERT_EQ(frontier_steps, 10);
+    int grown = 0;
+    for (int i = 0; i < 96 * 96; i++) {
+        grown += first[i] != 0;
+    }
+    ASSERT_GT(grown, 18);
+    for (int run = 0; run < 3; run++) {
+        run_frontier_spread(colonies, 2, 10, second, &frontier_steps);
+        ASSERT_EQ(frontier_steps, 10);
+        ASSERT_EQ(memcmp(first, second, 96 * 96 * sizeof(uint32_t)), 0);
+    }
+
+    free(first);
+    free(second);
+}
+
 TEST(atomic_relaxed_claim_and_stats_roundtrip_remain_consistent) {
     World* world = world_create(9, 9);
     ASSERT_NOT_NULL(world);
@@ -2193,6 +2266,7 @@ int run_simulation_logic_tests(void) {
     RUN_TEST(atomic_tick_preserves_cell_count);
     RUN_TEST(atomic_spread_step_swaps_buffers_for_new_claims);
     RUN_TEST(atomic_relaxed_claim_and_stats_roundtrip_remain_consistent);
+    RUN_TEST(atomic_frontier_spread_is_independent_of_claim_order);
     
     printf("\nCell Count Stability Tests:\n");
     RUN_TEST(cell_count_stable_without_spreading);
@@ -14,6 +14,9 @@
 
 #include "../src/server/threadpool.h"
 #include "../src/server/atomic_sim.h"
+#include "../src/server/phase_wait.h"
+#include "../src/server/mpsc_queue.h"
+#include "../src/server/world.h"
 
 // Test framework
 static int tests_passed = 0;
@@ -289,6 +292,278 @@ TEST(hot_shared_structs_are_cacheline_aligned) {
     ASSERT_EQ(offsetof(ThreadPool, counters) % FEROX_CACHELINE_SIZE, 0);
     ASSERT_EQ(offsetof(AtomicWorld, spread_state) % FEROX_CACHELINE_SIZE, 0);
     ASSERT_EQ(offsetof(AtomicWorld, phase_state) % FEROX_CACHELINE_SIZE, 0);
+    ASSERT_EQ(offsetof(ThreadPool, gang_barrier) % FEROX_CACHELINE_SIZE, 0);
+}
+
+// ============================================================================
+// Phase Barrier Tests
+// ============================================================================
+
+#define BARRIER_TEST_THREADS 4
+#define BARRIER_TEST_EPISODES 2000
+
+typedef struct {
+    PhaseBarrier* barrier;
+    atomic_int* arrivals;
+    atomic_int* mismatches;
+} BarrierTestArgs;
+
+static void* barrier_test_thread(void* arg) {
+    BarrierTestArgs* args = (BarrierTestArgs*)arg;
+    int local_sense = 0;
+
+    for (int episode = 0; episode < BARRIER_TEST_EPISODES; episode++) {
+        atomic_fetch_add_explicit(args->arrivals, 1, memory_order_relaxed);
+        phase_barrier_wait(args->barrier, &local_sense);
+        // Every participant must observe the full arrival count of this
+        // episode before anyone can start the next one.
+        int seen = atomic_load_explicit(args->arrivals, memory_order_relaxed);
+        if (seen < (episode + 1) * BARRIER_TEST_THREADS) {
+            atomic_fetch_add(args->mismatches, 1);
+        }
+        phase_barrier_wait(args->barrier, &local_sense);
+    }
+
+    return NULL;
+}
+
+TEST(phase_barrier_episodes_are_consistent) {
+    static PhaseBarrier barrier;
+    atomic_int arrivals = ATOMIC_VAR_INIT(0);
+    atomic_int mismatches = ATOMIC_VAR_INIT(0);
+    ASSERT_EQ(phase_barrier_init(&barrier, BARRIER_TEST_THREADS, 256), 0);
+
+    pthread_t threads[BARRIER_TEST_THREADS];
+    BarrierTestArgs args = {
+        .barrier = &barrier,
+        .arrivals = &arrivals,
+        .mismatches = &mismatches,
+    };
+    for (int i = 0; i < BARRIER_TEST_THREADS; i++) {
+        ASSERT_EQ(pthread_create(&threads[i], NULL, barrier_test_thread, &args), 0);
+    }
+    for (int i = 0; i < BARRIER_TEST_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    PhaseBarrierStats stats;
+    phase_barrier_get_stats(&barrier, &stats);
+    ASSERT_EQ(atomic_load(&mismatches), 0);
+    ASSERT_EQ(atomic_load(&arrivals), BARRIER_TEST_THREADS * BARRIER_TEST_EPISODES);
+    ASSERT_EQ(stats.releases, (uint64_t)(BARRIER_TEST_EPISODES * 2));
+    ASSERT_EQ(stats.spin_waits + stats.park_waits,
+              stats.releases * (uint64_t)(BARRIER_TEST_THREADS - 1));
+    ASSERT_TRUE(stats.wake_calls <= stats.releases);
+}
+
+TEST(phase_barrier_zero_spin_always_parks) {
+    static PhaseBarrier barrier;
+    atomic_int arrivals = ATOMIC_VAR_INIT(0);
+    atomic_int mismatches = ATOMIC_VAR_INIT(0);
+    ASSERT_EQ(phase_barrier_init(&barrier, BARRIER_TEST_THREADS, 0), 0);
+
+    pthread_t threads[BARRIER_TEST_THREADS];
+    BarrierTestArgs args = {
+        .barrier = &barrier,
+        .arrivals = &arrivals,
+        .mismatches = &mismatches,
+    };
+    for (int i = 0; i < BARRIER_TEST_THREADS; i++) {
+        ASSERT_EQ(pthread_create(&threads[i], NULL, barrier_test_thread, &args), 0);
+    }
+    for (int i = 0; i < BARRIER_TEST_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    PhaseBarrierStats stats;
+    phase_barrier_get_stats(&barrier, &stats);
+    ASSERT_EQ(atomic_load(&mismatches), 0);
+    ASSERT_EQ(stats.spin_waits, 0);
+    ASSERT_EQ(stats.park_waits, stats.releases * (uint64_t)(BARRIER_TEST_THREADS - 1));
+
+    phase_barrier_reset_stats(&barrier);
+    phase_barrier_get_stats(&barrier, &stats);
+    ASSERT_EQ(stats.releases, 0);
+    ASSERT_EQ(stats.park_waits, 0);
+}
+
+TEST(atomic_phase_barrier_counts_tick_waits) {
+    World* world = world_create(128, 64);
+    ASSERT_NOT_NULL(world);
+    world_init_random_colonies(world, 12);
+    ThreadPool* pool = threadpool_create(4);
+    ASSERT_NOT_NULL(pool);
+    AtomicWorld* aworld = atomic_world_create(world, pool, 4);
+    ASSERT_NOT_NULL(aworld);
+
+    // Creation already ran gangs (first touch, optional pinning); count from here.
+    PhaseBarrierStats before;
+    atomic_get_phase_barrier_stats(aworld, &before);
+
+    AtomicTickBreakdown breakdown;
+    atomic_tick_with_breakdown(aworld, &breakdown);
+
+    PhaseBarrierStats stats;
+    atomic_get_phase_barrier_stats(aworld, &stats);
+    uint64_t releases = stats.releases - before.releases;
+    uint64_t waits = (stats.spin_waits - before.spin_waits) + (stats.park_waits - before.park_waits);
+    if (aworld->phase_state.phase_system_ready) {
+        // age + spread phases, one gang each; the dispatcher or a worker
+        // releases, the other pool->thread_count participants wait.
+        ASSERT_EQ(releases, 2);
+        ASSERT_EQ(waits, releases * (uint64_t)pool->thread_count);
+        ASSERT_EQ(breakdown.barrier_spin_waits + breakdown.barrier_park_waits, waits);
+        ASSERT_EQ(breakdown.worker_count, aworld->phase_worker_count);
+        for (int w = 0; w < breakdown.worker_count; w++) {
+            ASSERT_TRUE(breakdown.worker_busy_ms[w] >= 0.0);
+            ASSERT_TRUE(breakdown.worker_idle_ms[w] >= 0.0);
+        }
+    } else {
+        ASSERT_EQ(releases, 0);
+        ASSERT_EQ(breakdown.worker_count, 0);
+    }
+
+    atomic_world_destroy(aworld);
+    threadpool_destroy(pool);
+    world_destroy(world);
+}
+
+#define GANG_TEST_THREADS 4
+#define GANG_TEST_WIDTH (GANG_TEST_THREADS + 1)  // Workers plus the dispatcher
+#define GANG_TEST_ROUNDS 500
+
+typedef struct {
+    atomic_int hits[GANG_TEST_WIDTH];
+    atomic_int calls;
+    int bad_count;
+} GangTestState;
+
+static void gang_record_worker(void* arg, int worker_id, int worker_count) {
+    GangTestState* state = (GangTestState*)arg;
+    if (worker_id < 0 || worker_id >= GANG_TEST_WIDTH || worker_count != GANG_TEST_WIDTH) {
+        state->bad_count++;
+        return;
+    }
+    atomic_fetch_add(&state->hits[worker_id], 1);
+    atomic_fetch_add(&state->calls, 1);
+}
+
+TEST(gang_runs_once_per_worker_and_waits) {
+    ThreadPool* pool = threadpool_create(GANG_TEST_THREADS);
+    ASSERT_NOT_NULL(pool);
+
+    GangTestState state;
+    memset(&state, 0, sizeof(state));
+
+    ASSERT_EQ(threadpool_gang_width(pool), GANG_TEST_WIDTH);
+    for (int round = 0; round < GANG_TEST_ROUNDS; round++) {
+        threadpool_run_gang(pool, gang_record_worker, &state);
+        // Every member has returned by the time run_gang does.
+        ASSERT_EQ(atomic_load(&state.calls), (round + 1) * GANG_TEST_WIDTH);
+    }
+
+    ASSERT_EQ(state.bad_count, 0);
+    for (int w = 0; w < GANG_TEST_WIDTH; w++) {
+        ASSERT_EQ(atomic_load(&state.hits[w]), GANG_TEST_ROUNDS);
+    }
+
+    PhaseBarrierStats stats;
+    threadpool_get_gang_stats(pool, &stats);
+    ASSERT_EQ(stats.releases, GANG_TEST_ROUNDS);
+
+    threadpool_destroy(pool);
+}
+
+TEST(gang_interleaves_with_queued_tasks) {
+    ThreadPool* pool = threadpool_create(GANG_TEST_THREADS);
+    ASSERT_NOT_NULL(pool);
+
+    atomic_store(&task_counter, 0);
+    GangTestState state;
+    memset(&state, 0, sizeof(state));
+
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 100; i++) {
+            threadpool_submit(pool, increment_task, NULL);
+        }
+        threadpool_run_gang(pool, gang_record_worker, &state);
+    }
+    threadpool_wait(pool);
+
+    ASSERT_EQ(atomic_load(&task_counter), 50 * 100);
+    ASSERT_EQ(atomic_load(&state.calls), 50 * GANG_TEST_WIDTH);
+    ASSERT_EQ(state.bad_count, 0);
+
+    threadpool_destroy(pool);
+}
+
+// ============================================================================
+// MPSC Queue Tests
+// ============================================================================
+
+#define MPSC_TEST_PRODUCERS 4
+#define MPSC_TEST_PER_PRODUCER 20000
+
+typedef struct {
+    MpscNode node;
+    int producer;
+    int seq;
+} MpscTestItem;
+
+typedef struct {
+    MpscQueue* queue;
+    MpscTestItem* items;
+    int producer;
+} MpscProducerArgs;
+
+static void* mpsc_producer_thread(void* arg) {
+    MpscProducerArgs* args = (MpscProducerArgs*)arg;
+    for (int i = 0; i < MPSC_TEST_PER_PRODUCER; i++) {
+        MpscTestItem* item = &args->items[i];
+        item->producer = args->producer;
+        item->seq = i;
+        mpsc_queue_push(args->queue, &item->node);
+    }
+    return NULL;
+}
+
+TEST(mpsc_queue_preserves_per_producer_order) {
+    MpscQueue queue;
+    mpsc_queue_init(&queue);
+    ASSERT_NULL(mpsc_queue_pop(&queue));
+
+    MpscTestItem* items = calloc(MPSC_TEST_PRODUCERS * MPSC_TEST_PER_PRODUCER, sizeof(MpscTestItem));
+    ASSERT_NOT_NULL(items);
+    pthread_t threads[MPSC_TEST_PRODUCERS];
+    MpscProducerArgs args[MPSC_TEST_PRODUCERS];
+    for (int p = 0; p < MPSC_TEST_PRODUCERS; p++) {
+        args[p].queue = &queue;
+        args[p].items = items + p * MPSC_TEST_PER_PRODUCER;
+        args[p].producer = p;
+        pthread_create(&threads[p], NULL, mpsc_producer_thread, &args[p]);
+    }
+
+    int next_seq[MPSC_TEST_PRODUCERS] = {0};
+    int received = 0;
+    int out_of_order = 0;
+    while (received < MPSC_TEST_PRODUCERS * MPSC_TEST_PER_PRODUCER) {
+        MpscTestItem* item = (MpscTestItem*)mpsc_queue_pop(&queue);
+        if (!item) {
+            continue;
+        }
+        if (item->seq != next_seq[item->producer]) {
+            out_of_order++;
+        }
+        next_seq[item->producer] = item->seq + 1;
+        received++;
+    }
+
+    for (int p = 0; p < MPSC_TEST_PRODUCERS; p++) {
+        pthread_join(threads[p], NULL);
+    }
+    ASSERT_EQ(out_of_order, 0);
+    ASSERT_NULL(mpsc_queue_pop(&queue));
+    free(items);
 }
 
 // ============================================================================
@@ -542,6 +817,16 @@ int run_threadpool_stress_tests(void) {
     RUN_TEST(batch_submit_with_remainder);
     RUN_TEST(worker_follow_on_submit_chain);
     RUN_TEST(hot_shared_structs_are_cacheline_aligned);
+
+    printf("\nPhase Barrier Tests:\n");
+    RUN_TEST(phase_barrier_episodes_are_consistent);
+    RUN_TEST(phase_barrier_zero_spin_always_parks);
+    RUN_TEST(atomic_phase_barrier_counts_tick_waits);
+    RUN_TEST(gang_runs_once_per_worker_and_waits);
+    RUN_TEST(gang_interleaves_with_queued_tasks);
+    
+    printf("\nMPSC Queue Tests:\n");
+    RUN_TEST(mpsc_queue_preserves_per_producer_order);
     
     printf("\nConcurrent Submit Tests:\n");
     RUN_TEST(concurrent_submits_multiple_threads);